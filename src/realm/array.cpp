@@ -41,6 +41,7 @@
 #include <realm/column_string.hpp>
 #include <realm/index_string.hpp>
 #include <realm/array_integer.hpp>
+#include <realm/row_bitmap.hpp>
 
 
 // Header format (8 bytes):
@@ -557,6 +558,11 @@ void Array::add_to_column(IntegerColumn* column, int64_t value)
     column->add(value);
 }
 
+void QueryState<int64_t>::add_to_bitmap(size_t index)
+{
+    m_bitmap->add(index); // Throws
+}
+
 void Array::set(size_t ndx, int64_t value)
 {
     REALM_ASSERT_3(ndx, <, m_size);
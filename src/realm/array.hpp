@@ -110,6 +110,7 @@ const size_t not_found = npos;
 class Array;
 class StringColumn;
 class GroupWriter;
+class RowBitmap;
 template <class T>
 class QueryState;
 namespace _impl {
@@ -1067,6 +1068,11 @@ public:
     size_t m_limit;
     size_t m_minmax_index; // used only for min/max, to save index of current min/max value
 
+    // If set, act_FindAll adds the matches to this bitmap instead of to the column passed to init()
+    RowBitmap* m_bitmap;
+
+    void add_to_bitmap(size_t index);
+
     template <Action action>
     bool uses_val()
     {
@@ -1081,6 +1087,7 @@ public:
         m_match_count = 0;
         m_limit = limit;
         m_minmax_index = not_found;
+        m_bitmap = nullptr;
 
         if (action == act_Max)
             m_state = -0x7fffffffffffffffLL - 1LL;
@@ -1141,7 +1148,10 @@ public:
             m_match_count = size_t(m_state);
         }
         else if (action == act_FindAll) {
-            Array::add_to_column(reinterpret_cast<IntegerColumn*>(m_state), index);
+            if (m_bitmap)
+                add_to_bitmap(index);
+            else
+                Array::add_to_column(reinterpret_cast<IntegerColumn*>(m_state), index);
         }
         else if (action == act_ReturnFirst) {
             m_state = index;
@@ -1168,7 +1178,10 @@ public:
             m_match_count = size_t(m_state);
         }
         else if (action == act_FindAll) {
-            Array::add_to_column(reinterpret_cast<IntegerColumn*>(m_state), index);
+            if (m_bitmap)
+                add_to_bitmap(index);
+            else
+                Array::add_to_column(reinterpret_cast<IntegerColumn*>(m_state), index);
         }
         else if (action == act_ReturnFirst) {
             m_match_count++;
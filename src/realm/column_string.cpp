@@ -208,14 +208,7 @@ void StringColumn::set_null(size_t ndx)
 void StringColumn::populate_search_index()
 {
     REALM_ASSERT(m_search_index);
-
-    size_t num_rows = size();
-    for (size_t row_ndx = 0; row_ndx != num_rows; ++row_ndx) {
-        StringData value = get(row_ndx);
-        size_t num_rows_to_insert = 1;
-        bool is_append = true;
-        m_search_index->insert(row_ndx, value, num_rows_to_insert, is_append); // Throws
-    }
+    m_search_index->populate(); // Throws
 }
 
 StringIndex* StringColumn::create_search_index()
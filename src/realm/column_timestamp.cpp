@@ -254,13 +254,7 @@ StringData TimestampColumn::get_index_data(size_t ndx, StringIndex::StringConver
 void TimestampColumn::populate_search_index()
 {
     REALM_ASSERT(has_search_index());
-    // Populate the index
-    size_t num_rows = size();
-    for (size_t row_ndx = 0; row_ndx != num_rows; ++row_ndx) {
-        bool is_append = true;
-        auto value = get(row_ndx);
-        m_search_index->insert(row_ndx, value, 1, is_append); // Throws
-    }
+    m_search_index->populate(); // Throws
 }
 
 StringIndex* TimestampColumn::create_search_index()
@@ -61,7 +61,29 @@ enum ColumnAttr {
     col_attr_StrongLinks = 8,
 
     /// Specifies that elements in the column can be null.
-    col_attr_Nullable = 16
+    col_attr_Nullable = 16,
+
+    /// Specifies that the column has an ordered index (see
+    /// Table::add_ordered_index()). Unlike a search index, the index is not
+    /// stored in the file. The table accessor keeps it in memory, as it does
+    /// the indexes of the attributes that follow.
+    col_attr_OrderedIndexed = 32,
+
+    /// Specifies that the column has a hash index (see
+    /// Table::add_hash_index()).
+    col_attr_HashIndexed = 64,
+
+    /// Specifies that the column has a trigram index (see
+    /// Table::add_trigram_index()).
+    col_attr_TrigramIndexed = 128,
+
+    /// Specifies that the column has a full-text index (see
+    /// Table::add_fulltext_index()).
+    col_attr_FullTextIndexed = 256,
+
+    /// Specifies that the column has a case folded index (see
+    /// Table::add_case_fold_index()).
+    col_attr_CaseFoldIndexed = 512
 };
 
 
@@ -1387,49 +1387,58 @@ public:
         return true;
     }
 
-    bool set_int(size_t, size_t, int_fast64_t, _impl::Instruction, size_t) noexcept
+    bool set_int(size_t, size_t row_ndx, int_fast64_t, _impl::Instruction, size_t) noexcept
     {
-        return true; // No-op
+        set_row(row_ndx);
+        return true;
     }
 
-    bool add_int(size_t, size_t, int_fast64_t) noexcept
+    bool add_int(size_t, size_t row_ndx, int_fast64_t) noexcept
     {
-        return true; // No-op
+        set_row(row_ndx);
+        return true;
     }
 
-    bool set_bool(size_t, size_t, bool, _impl::Instruction) noexcept
+    bool set_bool(size_t, size_t row_ndx, bool, _impl::Instruction) noexcept
     {
-        return true; // No-op
+        set_row(row_ndx);
+        return true;
     }
 
-    bool set_float(size_t, size_t, float, _impl::Instruction) noexcept
+    bool set_float(size_t, size_t row_ndx, float, _impl::Instruction) noexcept
     {
-        return true; // No-op
+        set_row(row_ndx);
+        return true;
     }
 
-    bool set_double(size_t, size_t, double, _impl::Instruction) noexcept
+    bool set_double(size_t, size_t row_ndx, double, _impl::Instruction) noexcept
     {
-        return true; // No-op
+        set_row(row_ndx);
+        return true;
     }
 
-    bool set_string(size_t, size_t, StringData, _impl::Instruction, size_t) noexcept
+    bool set_string(size_t, size_t row_ndx, StringData, _impl::Instruction, size_t) noexcept
     {
-        return true; // No-op
+        set_row(row_ndx);
+        return true;
     }
 
-    bool set_binary(size_t, size_t, BinaryData, _impl::Instruction) noexcept
+    bool set_binary(size_t, size_t row_ndx, BinaryData, _impl::Instruction) noexcept
     {
-        return true; // No-op
+        set_row(row_ndx);
+        return true;
     }
 
-    bool set_olddatetime(size_t, size_t, OldDateTime, _impl::Instruction) noexcept
+    bool set_olddatetime(size_t, size_t row_ndx, OldDateTime, _impl::Instruction) noexcept
     {
-        return true; // No-op
+        set_row(row_ndx);
+        return true;
     }
 
-    bool set_timestamp(size_t, size_t, Timestamp, _impl::Instruction) noexcept
+    bool set_timestamp(size_t, size_t row_ndx, Timestamp, _impl::Instruction) noexcept
     {
-        return true; // No-op
+        set_row(row_ndx);
+        return true;
     }
 
     bool set_table(size_t col_ndx, size_t row_ndx, _impl::Instruction) noexcept
@@ -1452,9 +1461,10 @@ public:
         return true;
     }
 
-    bool set_null(size_t, size_t, _impl::Instruction, size_t) noexcept
+    bool set_null(size_t, size_t row_ndx, _impl::Instruction, size_t) noexcept
     {
-        return true; // No-op
+        set_row(row_ndx);
+        return true;
     }
 
     bool set_link(size_t col_ndx, size_t, size_t, size_t, _impl::Instruction) noexcept
@@ -1484,14 +1494,16 @@ public:
         return true;
     }
 
-    bool insert_substring(size_t, size_t, size_t, StringData)
+    bool insert_substring(size_t, size_t row_ndx, size_t, StringData)
     {
-        return true; // No-op
+        set_row(row_ndx);
+        return true;
     }
 
-    bool erase_substring(size_t, size_t, size_t, size_t)
+    bool erase_substring(size_t, size_t row_ndx, size_t, size_t)
     {
-        return true; // No-op
+        set_row(row_ndx);
+        return true;
     }
 
     bool optimize_table() noexcept
@@ -1644,12 +1656,48 @@ public:
         return true;
     }
 
-    bool add_search_index(size_t) noexcept
+    // Adding or removing a search index changes how queries on the column are
+    // best evaluated
+    bool add_search_index(size_t col_ndx) noexcept
+    {
+        using tf = _impl::TableFriend;
+        if (m_table)
+            tf::discard_query_statistics(*m_table, col_ndx);
+        return true;
+    }
+
+    bool remove_search_index(size_t col_ndx) noexcept
+    {
+        using tf = _impl::TableFriend;
+        if (m_table)
+            tf::discard_query_statistics(*m_table, col_ndx);
+        return true;
+    }
+
+    // The table accessor drops the in-memory indexes that have been removed
+    // when it is refreshed (see Table::refresh_accessor_indexes())
+    bool add_accessor_index(size_t col_ndx, ColumnAttr) noexcept
+    {
+        using tf = _impl::TableFriend;
+        if (m_table)
+            tf::discard_query_statistics(*m_table, col_ndx);
+        return true;
+    }
+
+    bool remove_accessor_index(size_t col_ndx, ColumnAttr) noexcept
+    {
+        using tf = _impl::TableFriend;
+        if (m_table)
+            tf::discard_query_statistics(*m_table, col_ndx);
+        return true;
+    }
+
+    bool add_composite_index(const std::vector<size_t>&) noexcept
     {
         return true; // No-op
     }
 
-    bool remove_search_index(size_t) noexcept
+    bool remove_composite_index(const std::vector<size_t>&) noexcept
     {
         return true; // No-op
     }
@@ -1727,9 +1775,18 @@ private:
     const size_t* m_desc_path_begin;
     const size_t* m_desc_path_end;
     bool& m_schema_changed;
+
+    // Tell the views of the selected table that the values of the specified
+    // row have been changed (see Group::refresh_dirty_accessors()).
+    void set_row(size_t row_ndx) noexcept
+    {
+        typedef _impl::TableFriend tf;
+        if (m_table)
+            tf::adj_acc_set_row(*m_table, row_ndx);
+    }
 };
 
-void Group::refresh_dirty_accessors()
+void Group::refresh_dirty_accessors(bool row_changes_told)
 {
     m_top.get_alloc().bump_global_version();
 
@@ -1742,7 +1799,12 @@ void Group::refresh_dirty_accessors()
             if (tf::is_marked(*table)) {
                 tf::refresh_accessor_tree(*table); // Throws
                 bool bump_global = false;
-                tf::bump_version(*table, bump_global);
+                if (row_changes_told) {
+                    tf::bump_version_of_rows(*table, bump_global);
+                }
+                else {
+                    tf::bump_version(*table, bump_global);
+                }
             }
         }
     }
@@ -1851,6 +1913,16 @@ void Group::advance_transact(ref_type new_top_ref, size_t new_file_size, _impl::
     // traversal to the set of accessors that were touched by the changes in the
     // transaction logs.
 
+    // Views that share their row indexes with other views after handover
+    // must get a private copy before the row accessors are adjusted, because
+    // the adjustment cannot throw. Only group-level tables can have such
+    // views.
+    for (const auto& table_accessor : m_table_accessors) {
+        typedef _impl::TableFriend tf;
+        if (Table* table = table_accessor)
+            tf::unshare_view_payloads(*table); // Throws
+    }
+
     bool schema_changed = false;
     _impl::TransactLogParser parser; // Throws
     TransactAdvancer advancer(*this, schema_changed);
@@ -1865,7 +1937,11 @@ void Group::advance_transact(ref_type new_top_ref, size_t new_file_size, _impl::
     m_top.detach();                                 // Soft detach
     bool create_group_when_missing = false;         // See Group::attach_shared().
     attach(new_top_ref, create_group_when_missing); // Throws
-    refresh_dirty_accessors();                      // Throws
+
+    // Unless the schema has changed, the views of the tables have been told
+    // which rows are changed by the transaction logs
+    bool row_changes_told = !schema_changed;
+    refresh_dirty_accessors(row_changes_told); // Throws
 
     if (schema_changed)
         send_schema_change_notification();
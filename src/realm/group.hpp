@@ -691,7 +691,10 @@ private:
     void set_replication(Replication*) noexcept;
     class TransactAdvancer;
     void advance_transact(ref_type new_top_ref, size_t new_file_size, _impl::NoCopyInputStream&);
-    void refresh_dirty_accessors();
+    // If `row_changes_told` is true, the views of the refreshed tables have
+    // been told about every change of the rows of the tables (see
+    // Table::bump_version_of_rows()).
+    void refresh_dirty_accessors(bool row_changes_told = false);
     template <class F>
     void update_table_indices(F&& map_function);
 
@@ -0,0 +1,322 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <cstring>
+
+#include <realm/column_string_enum.hpp>
+#include <realm/exceptions.hpp>
+#include <realm/group_by.hpp>
+#include <realm/index_hash.hpp>
+#include <realm/query.hpp>
+#include <realm/table_view.hpp>
+
+using namespace realm;
+
+size_t GroupBy::add_key(size_t column_ndx, const std::vector<size_t>& link_column_ndxs)
+{
+    Key key;
+    key.link_column_ndxs = link_column_ndxs; // Throws
+    key.table = &m_table;
+    for (size_t link_column_ndx : link_column_ndxs) {
+        if (REALM_UNLIKELY(link_column_ndx >= key.table->get_column_count()))
+            throw LogicError(LogicError::column_index_out_of_range);
+        if (REALM_UNLIKELY(key.table->get_column_type(link_column_ndx) != type_Link))
+            throw LogicError(LogicError::type_mismatch);
+        key.link_targets.push_back(key.table->get_link_target(link_column_ndx)); // Throws
+        key.table = key.link_targets.back().get();
+    }
+
+    if (REALM_UNLIKELY(column_ndx >= key.table->get_column_count()))
+        throw LogicError(LogicError::column_index_out_of_range);
+    key.column_ndx = column_ndx;
+    key.type = key.table->get_column_type(column_ndx);
+    key.column = nullptr;
+    switch (key.type) {
+        case type_Int:
+        case type_Bool:
+        case type_String:
+        case type_Binary:
+        case type_OldDateTime:
+        case type_Timestamp:
+        case type_Float:
+        case type_Double:
+            break;
+        case type_Table:
+        case type_Mixed:
+        case type_Link:
+        case type_LinkList:
+            throw LogicError(LogicError::type_mismatch);
+    }
+
+    m_keys.push_back(std::move(key)); // Throws
+    return m_keys.size() - 1;
+}
+
+
+size_t GroupBy::add_aggregate(Table::AggrType type, size_t column_ndx)
+{
+    if (REALM_UNLIKELY(column_ndx >= m_table.get_column_count()))
+        throw LogicError(LogicError::column_index_out_of_range);
+    DataType type_of_column = m_table.get_column_type(column_ndx);
+    if (type != Table::aggr_count && type_of_column != type_Int && type_of_column != type_Float &&
+        type_of_column != type_Double)
+        throw LogicError(LogicError::type_mismatch);
+
+    m_aggregates.push_back(Aggregate{type, column_ndx, type_of_column}); // Throws
+    return m_aggregates.size() - 1;
+}
+
+
+void GroupBy::run()
+{
+    start();
+    size_t num_rows = m_table.size();
+    for (size_t row_ndx = 0; row_ndx < num_rows; ++row_ndx)
+        add_row(row_ndx); // Throws
+}
+
+
+void GroupBy::run(Query& query)
+{
+    if (REALM_UNLIKELY(query.get_table().get() != &m_table))
+        throw LogicError(LogicError::illegal_combination);
+
+    TableView rows = query.find_all(); // Throws
+    start();
+    for (size_t i = 0; i < rows.size(); ++i)
+        add_row(rows.get_source_ndx(i)); // Throws
+}
+
+
+int64_t GroupBy::get_int(size_t group_ndx, size_t aggr_ndx) const noexcept
+{
+    const Aggregate& aggregate = m_aggregates[aggr_ndx];
+    const State& state = m_states[group_ndx * m_aggregates.size() + aggr_ndx];
+    bool is_int = aggregate.type_of_column == type_Int;
+    switch (aggregate.type) {
+        case Table::aggr_count:
+            return int64_t(m_counts[group_ndx]);
+        case Table::aggr_avg:
+            return int64_t(get_double(group_ndx, aggr_ndx));
+        case Table::aggr_sum:
+        case Table::aggr_min:
+        case Table::aggr_max:
+            return is_int ? state.int_value : int64_t(state.double_value);
+    }
+    REALM_UNREACHABLE();
+}
+
+
+double GroupBy::get_double(size_t group_ndx, size_t aggr_ndx) const noexcept
+{
+    const Aggregate& aggregate = m_aggregates[aggr_ndx];
+    const State& state = m_states[group_ndx * m_aggregates.size() + aggr_ndx];
+    bool is_int = aggregate.type_of_column == type_Int;
+    switch (aggregate.type) {
+        case Table::aggr_count:
+            return double(m_counts[group_ndx]);
+        case Table::aggr_avg:
+            if (state.value_count == 0)
+                return 0;
+            return (is_int ? double(state.int_value) : state.double_value) / state.value_count;
+        case Table::aggr_sum:
+        case Table::aggr_min:
+        case Table::aggr_max:
+            return is_int ? double(state.int_value) : state.double_value;
+    }
+    REALM_UNREACHABLE();
+}
+
+
+void GroupBy::start()
+{
+    m_rows.clear();
+    m_counts.clear();
+    m_states.clear();
+    m_slots.clear();
+    m_hashes.clear();
+    m_enum_groups.clear();
+
+    // The column accessors are looked up for each run, since the table
+    // accessor may have replaced them since the keys were added
+    for (Key& key : m_keys)
+        key.column = &_impl::TableFriend::get_column(*key.table, key.column_ndx);
+
+    // An auto-enumerated key has a known number of distinct values, so they
+    // can be mapped directly to their groups
+    if (m_keys.size() == 1 && m_keys[0].link_column_ndxs.empty() &&
+        _impl::TableFriend::get_spec(m_table).get_column_type(m_keys[0].column_ndx) == col_type_StringEnum) {
+        const StringEnumColumn& column = static_cast<const StringEnumColumn&>(*m_keys[0].column);
+        m_enum_groups.assign(column.get_keys().size(), 0); // Throws
+    }
+}
+
+
+void GroupBy::add_row(size_t row_ndx)
+{
+    size_t group_ndx = m_enum_groups.empty() ? find_or_add_group(row_ndx) : find_or_add_enum_group(row_ndx); // Throws
+    aggregate(group_ndx, row_ndx);
+}
+
+
+size_t GroupBy::find_or_add_group(size_t row_ndx)
+{
+    if ((m_rows.size() + 1) * 2 > m_slots.size())
+        grow_slots(); // Throws
+
+    uint64_t hash = hash_keys(row_ndx);
+    size_t mask = m_slots.size() - 1;
+    for (size_t i = size_t(hash) & mask;; i = (i + 1) & mask) {
+        size_t slot = m_slots[i];
+        if (slot == 0) {
+            size_t group_ndx = add_group(row_ndx); // Throws
+            m_hashes.push_back(hash);              // Throws
+            m_slots[i] = group_ndx + 1;
+            return group_ndx;
+        }
+        if (m_hashes[slot - 1] == hash && keys_equal(row_ndx, m_rows[slot - 1]))
+            return slot - 1;
+    }
+}
+
+
+size_t GroupBy::find_or_add_enum_group(size_t row_ndx)
+{
+    const StringEnumColumn& column = static_cast<const StringEnumColumn&>(*m_keys[0].column);
+    size_t& slot = m_enum_groups[to_size_t(column.IntegerColumn::get(row_ndx))];
+    if (slot == 0)
+        slot = add_group(row_ndx) + 1; // Throws
+    return slot - 1;
+}
+
+
+size_t GroupBy::add_group(size_t row_ndx)
+{
+    m_rows.push_back(row_ndx); // Throws
+    m_counts.push_back(0);     // Throws
+    m_states.resize(m_states.size() + m_aggregates.size(), State{0, 0, 0}); // Throws
+    return m_rows.size() - 1;
+}
+
+
+void GroupBy::aggregate(size_t group_ndx, size_t row_ndx) noexcept
+{
+    ++m_counts[group_ndx];
+    State* states = m_states.data() + group_ndx * m_aggregates.size();
+    for (size_t i = 0; i < m_aggregates.size(); ++i) {
+        const Aggregate& aggregate = m_aggregates[i];
+        State& state = states[i];
+        if (aggregate.type == Table::aggr_count || m_table.is_null(aggregate.column_ndx, row_ndx))
+            continue;
+
+        bool first = state.value_count++ == 0;
+        if (aggregate.type_of_column == type_Int) {
+            int64_t value = m_table.get_int(aggregate.column_ndx, row_ndx);
+            if (aggregate.type == Table::aggr_sum || aggregate.type == Table::aggr_avg) {
+                state.int_value += value;
+            }
+            else if (first || (aggregate.type == Table::aggr_max ? value > state.int_value : value < state.int_value)) {
+                state.int_value = value;
+            }
+        }
+        else {
+            double value = aggregate.type_of_column == type_Float ? m_table.get_float(aggregate.column_ndx, row_ndx)
+                                                                  : m_table.get_double(aggregate.column_ndx, row_ndx);
+            if (aggregate.type == Table::aggr_sum || aggregate.type == Table::aggr_avg) {
+                state.double_value += value;
+            }
+            else if (first ||
+                     (aggregate.type == Table::aggr_max ? value > state.double_value : value < state.double_value)) {
+                state.double_value = value;
+            }
+        }
+    }
+}
+
+
+void GroupBy::grow_slots()
+{
+    size_t num_slots = m_slots.empty() ? 16 : m_slots.size() * 2;
+    m_slots.assign(num_slots, 0); // Throws
+    size_t mask = num_slots - 1;
+    for (size_t group_ndx = 0; group_ndx < m_hashes.size(); ++group_ndx) {
+        size_t i = size_t(m_hashes[group_ndx]) & mask;
+        while (m_slots[i] != 0)
+            i = (i + 1) & mask;
+        m_slots[i] = group_ndx + 1;
+    }
+}
+
+
+uint64_t GroupBy::hash_keys(size_t row_ndx) const noexcept
+{
+    uint64_t hash = 0;
+    StringIndex::StringConversionBuffer buffer;
+    for (const Key& key : m_keys)
+        hash = (hash ^ HashIndex::hash(get_key_data(key, row_ndx, buffer))) * 1099511628211ULL;
+    return hash;
+}
+
+
+bool GroupBy::keys_equal(size_t row_ndx_1, size_t row_ndx_2) const noexcept
+{
+    StringIndex::StringConversionBuffer buffer_1, buffer_2;
+    for (const Key& key : m_keys) {
+        if (get_key_data(key, row_ndx_1, buffer_1) != get_key_data(key, row_ndx_2, buffer_2))
+            return false;
+    }
+    return true;
+}
+
+
+StringData GroupBy::get_key_data(const Key& key, size_t row_ndx, StringIndex::StringConversionBuffer& buffer) const
+    noexcept
+{
+    // Follow the links to the row that holds the key
+    const Table* table = &m_table;
+    for (size_t i = 0; i < key.link_column_ndxs.size(); ++i) {
+        if (table->is_null_link(key.link_column_ndxs[i], row_ndx))
+            return StringData();
+        row_ndx = table->get_link(key.link_column_ndxs[i], row_ndx);
+        table = key.link_targets[i].get();
+    }
+
+    switch (key.type) {
+        case type_Float:
+        case type_Double: {
+            if (table->is_null(key.column_ndx, row_ndx))
+                return StringData();
+            double value = key.type == type_Float ? table->get_float(key.column_ndx, row_ndx)
+                                                  : table->get_double(key.column_ndx, row_ndx);
+            // Zero and negative zero are the same key
+            if (value == 0)
+                value = 0;
+            static_assert(sizeof value <= StringIndex::string_conversion_buffer_size, "");
+            std::memcpy(buffer.data(), &value, sizeof value);
+            return StringData(buffer.data(), sizeof value);
+        }
+        case type_Binary: {
+            BinaryData value = table->get_binary(key.column_ndx, row_ndx);
+            if (value.is_null())
+                return StringData();
+            return StringData(value.data(), value.size());
+        }
+        default:
+            return key.column->get_index_data(row_ndx, buffer);
+    }
+}
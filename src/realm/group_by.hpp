@@ -0,0 +1,189 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_GROUP_BY_HPP
+#define REALM_GROUP_BY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <realm/index_string.hpp>
+#include <realm/table.hpp>
+
+namespace realm {
+
+class ColumnBase;
+class Query;
+
+/// The rows of a table grouped by the values of one or more key columns, with
+/// any number of aggregates of each group, computed in a single pass over the
+/// rows.
+///
+/// A key is a column of any type that holds single values (int, bool, string,
+/// binary, timestamp, float and double), either of the table itself or of the
+/// row that is reached by following a chain of link columns. Rows where a link
+/// of the chain is null have a null key. Null values form a group of their
+/// own.
+///
+/// The groups are found with a hash table that refers to the first row of
+/// each group, so that the keys are neither copied nor compared in any other
+/// form than their values in the table, and each aggregate of a group takes a
+/// fixed amount of memory. When the only key is an auto-enumerated string
+/// column of the table (see Table::optimize()), rows are grouped by their
+/// position in the list of distinct values instead of by hashing.
+///
+/// The groups are listed in the order of their first rows, and the results
+/// refer to the table, so they are valid until the table is modified.
+class GroupBy {
+public:
+    explicit GroupBy(const Table& table) noexcept;
+
+    /// Add a key column and return its index among the keys. If
+    /// `link_column_ndxs` are specified, they are followed in turn from the
+    /// grouped table, and `column_ndx` is a column of the table that the last
+    /// of them links to.
+    size_t add_key(size_t column_ndx, const std::vector<size_t>& link_column_ndxs = {});
+
+    /// Add an aggregate and return its index among the aggregates. A count
+    /// (Table::aggr_count) is the number of rows in the group, and ignores
+    /// `column_ndx`. Other aggregates require an int, float or double column,
+    /// and skip null values.
+    size_t add_aggregate(Table::AggrType type, size_t column_ndx);
+
+    /// Group every row of the table, replacing the groups of any previous
+    /// call.
+    void run();
+
+    /// Group the rows of the table that match `query`.
+    void run(Query& query);
+
+    /// The number of groups.
+    size_t size() const noexcept;
+
+    /// The first row of the specified group, where the values of its keys can
+    /// be read.
+    size_t get_row(size_t group_ndx) const noexcept;
+
+    /// The number of rows in the specified group.
+    size_t get_count(size_t group_ndx) const noexcept;
+
+    /// The result of the specified aggregate of the specified group, as an
+    /// integer. This is exact for the count, and for the sum, minimum and
+    /// maximum of an int column.
+    int64_t get_int(size_t group_ndx, size_t aggr_ndx) const noexcept;
+
+    /// The result as a double. This is exact for the average, and for the sum,
+    /// minimum and maximum of a float or double column. The average, minimum
+    /// and maximum of no values are zero.
+    double get_double(size_t group_ndx, size_t aggr_ndx) const noexcept;
+
+    /// The number of values that the specified aggregate of the specified
+    /// group is computed from, which is the number of rows in the group for a
+    /// count, and otherwise the number of rows where the column is not null.
+    size_t get_value_count(size_t group_ndx, size_t aggr_ndx) const noexcept;
+
+private:
+    struct Key {
+        std::vector<size_t> link_column_ndxs;
+        std::vector<ConstTableRef> link_targets; // One per link column
+        const Table* table;
+        size_t column_ndx;
+        DataType type;
+        const ColumnBase* column;
+    };
+
+    struct Aggregate {
+        Table::AggrType type;
+        size_t column_ndx;
+        DataType type_of_column;
+    };
+
+    // The state of an aggregate of a group. Only one of the values is used,
+    // depending on the type of the column.
+    struct State {
+        int64_t int_value;
+        double double_value;
+        size_t value_count;
+    };
+
+    const Table& m_table;
+    std::vector<Key> m_keys;
+    std::vector<Aggregate> m_aggregates;
+
+    // The first row and the number of rows of each group
+    std::vector<size_t> m_rows;
+    std::vector<size_t> m_counts;
+
+    // The states of group `g` are at `[g * m_aggregates.size(), (g + 1) *
+    // m_aggregates.size())`
+    std::vector<State> m_states;
+
+    // Open addressing hash table of one plus the index of a group, or zero for
+    // an empty slot, and the hash of the keys of each group
+    std::vector<size_t> m_slots;
+    std::vector<uint64_t> m_hashes;
+
+    // The group of each distinct value, plus one, for an auto-enumerated key
+    std::vector<size_t> m_enum_groups;
+
+    void start();
+    void add_row(size_t row_ndx);
+    size_t find_or_add_group(size_t row_ndx);
+    size_t find_or_add_enum_group(size_t row_ndx);
+    size_t add_group(size_t row_ndx);
+    void aggregate(size_t group_ndx, size_t row_ndx) noexcept;
+    void grow_slots();
+    uint64_t hash_keys(size_t row_ndx) const noexcept;
+    bool keys_equal(size_t row_ndx_1, size_t row_ndx_2) const noexcept;
+    StringData get_key_data(const Key&, size_t row_ndx, StringIndex::StringConversionBuffer&) const noexcept;
+};
+
+
+// Implementation:
+
+inline GroupBy::GroupBy(const Table& table) noexcept
+    : m_table(table)
+{
+}
+
+inline size_t GroupBy::size() const noexcept
+{
+    return m_rows.size();
+}
+
+inline size_t GroupBy::get_row(size_t group_ndx) const noexcept
+{
+    return m_rows[group_ndx];
+}
+
+inline size_t GroupBy::get_count(size_t group_ndx) const noexcept
+{
+    return m_counts[group_ndx];
+}
+
+inline size_t GroupBy::get_value_count(size_t group_ndx, size_t aggr_ndx) const noexcept
+{
+    if (m_aggregates[aggr_ndx].type == Table::aggr_count)
+        return m_counts[group_ndx];
+    return m_states[group_ndx * m_aggregates.size() + aggr_ndx].value_count;
+}
+
+} // namespace realm
+
+#endif // REALM_GROUP_BY_HPP
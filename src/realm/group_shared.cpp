@@ -70,7 +70,8 @@ const uint16_t relaxed_sync_threshold = 50;
 //         changing `daemon_started` and `daemon_ready` from 1-bit to 8-bit
 //         fields.
 // 8       Placing the commitlog history inside the Realm file.
-const uint_fast16_t g_shared_info_version = 8;
+// 9       Tracking the number of used ringbuffer entries in `Ringbuffer::used`.
+const uint_fast16_t g_shared_info_version = 9;
 
 // The following functions are carefully designed for minimal overhead
 // in case of contention among read transactions. In case of contention,
@@ -227,6 +228,7 @@ public:
             data[i].next = i + 1;
         }
         old_pos = 0;
+        used = 1;
         data[0].count.store(0, std::memory_order_relaxed);
         data[init_readers_size - 1].next = 0;
         put_pos.store(0, std::memory_order_release);
@@ -260,8 +262,11 @@ public:
             data[i].filesize = 0;
             data[i].next = i + 1;
         }
-        data[new_entries - 1].next = old_pos;
-        data[put_pos.load(std::memory_order_relaxed)].next = entries;
+        // Splice the new entries in as the first free entries. The buffer
+        // need not be full, so the current free entries follow them.
+        uint_fast32_t last_ndx = put_pos.load(std::memory_order_relaxed);
+        data[new_entries - 1].next = data[last_ndx].next;
+        data[last_ndx].next = entries;
         entries = new_entries;
         // dump();
     }
@@ -313,9 +318,14 @@ public:
         return r;
     }
 
+    uint_fast32_t first() const noexcept
+    {
+        return old_pos.load(std::memory_order_relaxed);
+    }
+
     const ReadCount& get_oldest() const noexcept
     {
-        return get(old_pos.load(std::memory_order_relaxed));
+        return get(first());
     }
 
     bool is_full() const noexcept
@@ -324,6 +334,14 @@ public:
         return idx == old_pos.load(std::memory_order_relaxed);
     }
 
+    // True if less than a quarter of the entries are free. This reads the
+    // writer maintained count of used entries, so it must only be called by
+    // the writer.
+    bool is_nearly_full() const noexcept
+    {
+        return entries - used < entries / 4;
+    }
+
     uint_fast32_t next() const noexcept
     {
         // do not call this if the buffer is full!
@@ -341,6 +359,7 @@ public:
     {
         atomic_dec(get_next().count); // .store_release(0);
         put_pos.store(next(), std::memory_order_release);
+        ++used;
     }
 
     void cleanup() noexcept
@@ -354,6 +373,7 @@ public:
                 break;
             auto next_ndx = get(old_pos.load(std::memory_order_relaxed)).next;
             old_pos.store(next_ndx, std::memory_order_relaxed);
+            --used;
         }
     }
 
@@ -362,6 +382,9 @@ private:
     uint32_t entries;
     std::atomic<uint32_t> put_pos; // only changed under lock, but accessed outside lock
     std::atomic<uint32_t> old_pos; // only changed during write transactions and under lock
+    // number of entries from old_pos to put_pos, both included. Only accessed
+    // by the writer, as part of use_next() and cleanup().
+    uint32_t used;
 
     const static int init_readers_size = 32;
 
@@ -729,6 +752,8 @@ void SharedGroup::do_open(const std::string& path, bool no_create_file, bool is_
     m_lockfile_path = path + ".lock";
     try_make_dir(m_coordination_dir);
     m_key = options.encryption_key;
+    m_max_version_lag = options.max_version_lag;
+    m_version_lag_callback = options.version_lag_callback;
     m_lockfile_prefix = m_coordination_dir + "/access_control";
     SlabAlloc& alloc = m_group.m_alloc;
 
@@ -1197,6 +1222,8 @@ bool SharedGroup::compact()
     new_options.durability = dura;
     new_options.encryption_key = m_key;
     new_options.allow_file_format_upgrade = false;
+    new_options.max_version_lag = m_max_version_lag;
+    new_options.version_lag_callback = m_version_lag_callback;
     do_open(m_db_path, true, false, new_options);
     return true;
 }
@@ -1208,6 +1235,35 @@ uint_fast64_t SharedGroup::get_number_of_versions()
     return info->number_of_versions;
 }
 
+SharedGroup::RetentionStats SharedGroup::get_retention_stats()
+{
+    RetentionStats stats;
+    SharedInfo* info = m_file_map.get_addr();
+    {
+        std::lock_guard<InterprocessMutex> lock(m_controlmutex); // Throws
+        stats.latest_version = info->latest_version_number;
+        stats.oldest_version = info->latest_version_number - info->number_of_versions + 1;
+    }
+
+    // The oldest ringbuffer entry only moves during cleanup in a write
+    // transaction, so this is a snapshot that may be stale by the time it is
+    // returned. An odd count means that the entry has already been released.
+    uint_fast32_t oldest_idx = m_reader_map.get_addr()->readers.first();
+    grow_reader_mapping(oldest_idx); // Throws
+    const Ringbuffer::ReadCount& r = m_reader_map.get_addr()->readers.get(oldest_idx);
+    uint_fast32_t count = r.count.load(std::memory_order_relaxed);
+    stats.num_oldest_readers = (count & 1) ? 0 : count / 2;
+
+    stats.local_oldest_version = std::numeric_limits<version_type>::max();
+    if (m_transact_stage != transact_Ready)
+        stats.local_oldest_version = m_read_lock.m_version;
+    if (!m_pinned_versions.empty())
+        stats.local_oldest_version = std::min(stats.local_oldest_version, m_pinned_versions.begin()->first);
+    stats.num_local_pins = m_pinned_versions.size();
+    stats.locked_space = m_locked_space;
+    return stats;
+}
+
 SharedGroup::~SharedGroup() noexcept
 {
     close();
@@ -1230,6 +1286,9 @@ void SharedGroup::close() noexcept
     }
     m_group.detach();
     m_transact_stage = transact_Ready;
+    // Pins that are still outstanding belong to the session that ends here
+    m_pinned_versions.clear();
+    m_version_lag.pending = false;
     SharedInfo* info = m_file_map.get_addr();
     {
         bool is_sync_agent = false;
@@ -1630,6 +1689,7 @@ SharedGroup::version_type SharedGroup::commit()
     do_end_read();
 
     m_transact_stage = transact_Ready;
+    report_version_lag(); // Throws
     return new_version;
 }
 
@@ -1667,6 +1727,9 @@ SharedGroup::VersionID SharedGroup::pin_version()
 
     ReadLockInfo read_lock;
     grab_read_lock(read_lock, version_id); // Throws
+    ReadLockUnlockGuard g(*this, read_lock);
+    m_pinned_versions.emplace(version_id.version, version_id.index); // Throws
+    g.release();
 
     return version_id;
 }
@@ -1677,6 +1740,12 @@ void SharedGroup::unpin_version(VersionID token)
     read_lock.m_reader_idx = token.index;
 
     release_read_lock(read_lock);
+
+    // The pin may have been made through a different SharedGroup. Pins of the
+    // same snapshot share the same reader index, so they cannot be told apart.
+    auto i = m_pinned_versions.find(std::make_pair(token.version, token.index));
+    if (i != m_pinned_versions.end())
+        m_pinned_versions.erase(i);
 }
 
 
@@ -1801,6 +1870,7 @@ SharedGroup::version_type SharedGroup::commit_and_continue_as_read()
     gf::remap_and_update_refs(m_group, m_read_lock.m_top_ref, m_read_lock.m_file_size); // Throws
 
     m_transact_stage = transact_Reading;
+    report_version_lag(); // Throws
 
     return version;
 }
@@ -1812,18 +1882,32 @@ bool SharedGroup::grow_reader_mapping(uint_fast32_t index)
     SimulatedFailure::trigger(SimulatedFailure::shared_group__grow_reader_mapping); // Throws
 
     if (index >= m_local_max_entry) {
-        // handle mapping expansion if required
+        // handle mapping expansion if required. The whole lock file is
+        // mapped, including the room reserved for future expansion of the
+        // ringbuffer, so that the expansion itself does not require a remap.
         SharedInfo* r_info = m_reader_map.get_addr();
-        m_local_max_entry = r_info->readers.get_num_entries();
-        size_t info_size = sizeof(SharedInfo) + r_info->readers.compute_required_space(m_local_max_entry);
+        uint_fast32_t entries = r_info->readers.get_num_entries();
+        size_t info_size = sizeof(SharedInfo) + r_info->readers.compute_required_space(entries);
+        size_t file_size = size_t(m_file.get_size()); // Throws
+        if (file_size > info_size) {
+            entries += uint_fast32_t((file_size - info_size) / sizeof(Ringbuffer::ReadCount));
+            info_size = sizeof(SharedInfo) + r_info->readers.compute_required_space(entries);
+        }
         // std::cout << "Growing reader mapping to " << infosize << std::endl;
         m_reader_map.remap(m_file, util::File::access_ReadWrite, info_size); // Throws
+        m_local_max_entry = entries;
         return true;
     }
     return false;
 }
 
 
+uint_fast32_t SharedGroup::get_num_reader_entries() const noexcept
+{
+    return m_reader_map.get_addr()->readers.get_num_entries();
+}
+
+
 SharedGroup::version_type SharedGroup::get_version_of_latest_snapshot()
 {
     // As get_version_of_latest_snapshot() may be called outside of the write
@@ -1871,7 +1955,7 @@ void SharedGroup::low_level_commit(uint_fast64_t new_version)
         // the cleanup process may access the entire ring buffer, so make sure it is mapped.
         // this is not ensured as part of begin_read, which only makes sure that the current
         // last entry in the buffer is available.
-        if (grow_reader_mapping(r_info->readers.get_num_entries())) { // throws
+        if (grow_reader_mapping(r_info->readers.get_num_entries() - 1)) { // throws
             r_info = m_reader_map.get_addr();
         }
         r_info->readers.cleanup();
@@ -1894,6 +1978,7 @@ void SharedGroup::low_level_commit(uint_fast64_t new_version)
     ref_type new_top_ref = out.write_group(); // Throws
     m_free_space = out.get_free_space();
     m_used_space = out.get_file_size() - m_free_space;
+    m_locked_space = out.get_locked_space();
     // std::cout << "Writing version " << new_version << ", Topptr " << new_top_ref
     //     << " Read lock at version " << oldest_version << std::endl;
     switch (Durability(info->durability)) {
@@ -1916,16 +2001,21 @@ void SharedGroup::low_level_commit(uint_fast64_t new_version)
     info->commit_in_critical_phase = 1;
     {
         SharedInfo* r_info = m_reader_map.get_addr();
-        if (r_info->readers.is_full()) {
-            // buffer expansion
-            uint_fast32_t entries = r_info->readers.get_num_entries();
-            entries = entries + 32;
-            size_t new_info_size = sizeof(SharedInfo) + r_info->readers.compute_required_space(entries);
-            // std::cout << "resizing: " << entries << " = " << new_info_size << std::endl;
-            m_file.prealloc(0, new_info_size);                                       // Throws
-            m_reader_map.remap(m_file, util::File::access_ReadWrite, new_info_size); // Throws
-            r_info = m_reader_map.get_addr();
-            m_local_max_entry = entries;
+        if (r_info->readers.is_nearly_full()) {
+            // Buffer expansion. The buffer is doubled before it runs full, so
+            // that readers never have to wait for it. Room for one more
+            // doubling is reserved in the lock file at the same time, and
+            // since grow_reader_mapping() maps the whole file, the next
+            // expansion will not force readers to remap.
+            uint_fast32_t entries = 2 * r_info->readers.get_num_entries();
+            if (entries > m_local_max_entry) {
+                size_t new_info_size = sizeof(SharedInfo) + r_info->readers.compute_required_space(2 * entries);
+                // std::cout << "resizing: " << entries << " = " << new_info_size << std::endl;
+                m_file.prealloc(0, new_info_size);                                       // Throws
+                m_reader_map.remap(m_file, util::File::access_ReadWrite, new_info_size); // Throws
+                r_info = m_reader_map.get_addr();
+                m_local_max_entry = 2 * entries;
+            }
             r_info->readers.expand_to(entries);
         }
         Ringbuffer::ReadCount& r = r_info->readers.get_next();
@@ -1945,6 +2035,25 @@ void SharedGroup::low_level_commit(uint_fast64_t new_version)
         m_new_commit_available.notify_all();
 #endif
     }
+
+    // The callback is invoked by the caller once the write transaction has
+    // ended (see report_version_lag()).
+    if (m_max_version_lag != 0 && new_version - oldest_version > m_max_version_lag && m_version_lag_callback) {
+        m_version_lag.pending = true;
+        m_version_lag.oldest_version = oldest_version;
+        m_version_lag.new_version = new_version;
+        m_version_lag.locked_space = m_locked_space;
+    }
+}
+
+
+void SharedGroup::report_version_lag()
+{
+    if (!m_version_lag.pending)
+        return;
+    m_version_lag.pending = false;
+    m_version_lag_callback(m_version_lag.oldest_version, m_version_lag.new_version,
+                           m_version_lag.locked_space); // Throws
 }
 
 
@@ -25,6 +25,8 @@
 
 #include <functional>
 #include <limits>
+#include <set>
+#include <utility>
 #include <realm/util/features.h>
 #include <realm/util/thread.hpp>
 #ifndef _WIN32
@@ -379,6 +381,36 @@ public:
     /// a read transaction will not immediately release any versions.
     uint_fast64_t get_number_of_versions();
 
+    struct RetentionStats {
+        /// Version of the oldest snapshot that is still bound by a read
+        /// transaction or a pinned version in any process, as seen by the
+        /// latest commit.
+        version_type oldest_version;
+        /// Version of the latest snapshot.
+        version_type latest_version;
+        /// Number of read transactions and pins (in all processes) currently
+        /// holding on to the oldest snapshot. Zero means that the oldest
+        /// snapshot will be released by the next commit.
+        size_t num_oldest_readers;
+        /// Version of the oldest snapshot bound by this SharedGroup, either by
+        /// its current transaction or by one of its pinned versions, or
+        /// `std::numeric_limits<version_type>::max()` if it holds none.
+        version_type local_oldest_version;
+        /// Number of versions pinned through this SharedGroup and not yet
+        /// unpinned through it.
+        size_t num_local_pins;
+        /// Number of bytes of free space that could not be reused by the last
+        /// commit done on THIS shared group, because it was freed after the
+        /// oldest bound snapshot was created. Like get_stats(), this is zero
+        /// until this shared group has committed.
+        size_t locked_space;
+    };
+
+    /// Report how far the oldest bound snapshot lags behind the latest one,
+    /// who holds on to it, and how much free space it holds hostage. See also
+    /// SharedGroupOptions::max_version_lag.
+    RetentionStats get_retention_stats();
+
     /// Compact the database file.
     /// - The method will throw if called inside a transaction.
     /// - The method will throw if called in unattached state.
@@ -437,6 +469,16 @@ public:
     ///   of a new payload. This form of handover is indicated to
     ///   handover_export() by the argument ConstSourcePayload::Stay.
     ///
+    /// - with payload share: the payload is shared by the accessors on the
+    ///   exporting side and the importing side, instead of being copied. The
+    ///   shared payload is reference counted, and an accessor that is about to
+    ///   modify its payload (due to a sync, sort, or change of the underlying
+    ///   table) first obtains a private copy of it, unless it is the last
+    ///   accessor referring to it. This makes handover of large table views
+    ///   between two SharedGroups bound to the same version cheap. This form of
+    ///   handover is indicated to handover_export() by the argument
+    ///   ConstSourcePayload::Share.
+    ///
     /// For all other (non-TableView) accessors, handover is done with payload
     /// copy, since the payload is trivial.
     ///
@@ -444,8 +486,9 @@ public:
     /// with its query for execution in a background thread. Handover with
     /// *payload move* is useful when you want to transfer the result back.
     ///
-    /// Handover *without* payload or with payload copy is guaranteed *not* to
-    /// change the accessors on the exporting side.
+    /// Handover *without* payload, with payload copy, or with payload share is
+    /// guaranteed *not* to change the observable state of the accessors on the
+    /// exporting side.
     ///
     /// Handover is *not* thread safe and should be carried out
     /// by the thread that "owns" the involved accessors.
@@ -466,7 +509,7 @@ public:
     template <typename T>
     struct Handover;
 
-    /// thread-safe/const export (mode is Stay or Copy)
+    /// thread-safe/const export (mode is Stay, Copy or Share)
     /// during export, the following operations on the shared group is locked:
     /// - advance_read(), promote_to_write(), commit_and_continue_as_read(),
     ///   rollback_and_continue_as_read(), close()
@@ -530,6 +573,17 @@ private:
     // Member variables
     size_t m_free_space = 0;
     size_t m_used_space = 0;
+    size_t m_locked_space = 0;
+    std::multiset<std::pair<version_type, uint_fast32_t>> m_pinned_versions; // (version, reader index)
+    uint_fast64_t m_max_version_lag = 0;
+    std::function<void(uint_fast64_t, uint_fast64_t, size_t)> m_version_lag_callback;
+    struct VersionLag {
+        bool pending = false;
+        uint_fast64_t oldest_version = 0;
+        uint_fast64_t new_version = 0;
+        size_t locked_space = 0;
+    };
+    VersionLag m_version_lag; // Set by low_level_commit() for report_version_lag()
     Group m_group;
     ReadLockInfo m_read_lock;
     uint_fast32_t m_local_max_entry;
@@ -609,9 +663,13 @@ private:
     // if not, expand the mapped area. Returns true if the area is expanded.
     bool grow_reader_mapping(uint_fast32_t index);
 
+    // Returns the number of entries in the shared ringbuffer of read locks.
+    uint_fast32_t get_num_reader_entries() const noexcept;
+
     // Must be called only by someone that has a lock on the write
     // mutex.
     void low_level_commit(uint_fast64_t new_version);
+    void report_version_lag();
 
     void do_async_commits();
 
@@ -1151,6 +1209,16 @@ public:
     {
         return sg.get_version_of_bound_snapshot();
     }
+
+    static uint_fast32_t get_num_reader_entries(const SharedGroup& sg) noexcept
+    {
+        return sg.get_num_reader_entries();
+    }
+
+    static uint_fast32_t get_num_mapped_reader_entries(const SharedGroup& sg) noexcept
+    {
+        return sg.m_local_max_entry;
+    }
 };
 
 inline const Group& ReadTransaction::get_group() const noexcept
@@ -19,6 +19,8 @@
 #ifndef REALM_GROUP_SHARED_OPTIONS_HPP
 #define REALM_GROUP_SHARED_OPTIONS_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <string>
 
@@ -87,6 +89,25 @@ struct SharedGroupOptions {
     /// This string should include a trailing slash '/'.
     std::string temp_dir;
 
+    /// If nonzero, every commit checks how many versions the oldest snapshot
+    /// still bound by a reader (in any process) lags behind the version being
+    /// committed. When the lag exceeds \a max_version_lag, \a
+    /// version_lag_callback is called. Long-lived read transactions and pinned
+    /// versions prevent reuse of all space freed after the version they hold,
+    /// so a growing lag is what makes the Realm file grow.
+    uint_fast64_t max_version_lag = 0;
+
+    /// Called by the committing SharedGroup when \a max_version_lag is
+    /// exceeded. The parameters are the version of the oldest bound snapshot,
+    /// the version just committed, and the number of bytes of free space that
+    /// cannot be reused as long as the oldest snapshot is bound. The callback
+    /// runs at the end of commit() or commit_and_continue_as_read(), after the
+    /// write transaction has ended and the write mutex has been released. If
+    /// it throws, the exception propagates from the commit function, but the
+    /// commit has already completed. A typical use is to signal the offending
+    /// readers to advance or end their transactions.
+    std::function<void(uint_fast64_t, uint_fast64_t, size_t)> version_lag_callback;
+
 private:
     const static std::string sys_tmp_dir;
 };
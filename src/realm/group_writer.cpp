@@ -493,6 +493,18 @@ size_t GroupWriter::get_free_space() {
     }
 }
 
+size_t GroupWriter::get_locked_space()
+{
+    if (!m_free_versions.is_attached())
+        return 0;
+    size_t sum = 0;
+    for (size_t j = 0; j < m_free_versions.size(); ++j) {
+        if (to_size_t(m_free_versions.get(j)) >= m_readlock_version)
+            sum += to_size_t(m_free_lengths.get(j));
+    }
+    return sum;
+}
+
 void GroupWriter::merge_free_space()
 {
     bool is_shared = m_group.m_is_shared;
@@ -78,6 +78,10 @@ public:
 #endif
 
     size_t get_free_space();
+
+    /// Returns the amount of free space that cannot be reused because it was
+    /// freed after the oldest snapshot still bound by a reader.
+    size_t get_locked_space();
 private:
     class MapWindow;
     Group& m_group;
@@ -24,7 +24,7 @@
 
 namespace realm {
 
-enum class ConstSourcePayload { Copy, Stay };
+enum class ConstSourcePayload { Copy, Stay, Share };
 enum class MutableSourcePayload { Move };
 
 struct RowBaseHandoverPatch;
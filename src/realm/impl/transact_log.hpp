@@ -20,6 +20,7 @@
 #define REALM_IMPL_TRANSACT_LOG_HPP
 
 #include <stdexcept>
+#include <vector>
 
 #include <realm/string_data.hpp>
 #include <realm/data_type.hpp>
@@ -81,6 +82,10 @@ enum Instruction {
     instr_LinkListNullify = 36, // Remove an entry from a link list due to linked row being erased
     instr_LinkListClear = 37,   // Ramove all entries from a link list
     instr_LinkListSetAll = 38,  // Assign to link list entry
+    instr_AddAccessorIndex = 39,    // Add an in-memory index to a column
+    instr_RemoveAccessorIndex = 40, // Remove an in-memory index from a column
+    instr_AddCompositeIndex = 41,    // Add a composite index to the selected table
+    instr_RemoveCompositeIndex = 42, // Remove a composite index from the selected table
 };
 
 
@@ -277,6 +282,22 @@ public:
     {
         return true;
     }
+    bool add_accessor_index(size_t, ColumnAttr)
+    {
+        return true;
+    }
+    bool remove_accessor_index(size_t, ColumnAttr)
+    {
+        return true;
+    }
+    bool add_composite_index(const std::vector<size_t>&)
+    {
+        return true;
+    }
+    bool remove_composite_index(const std::vector<size_t>&)
+    {
+        return true;
+    }
     bool set_link_type(size_t, LinkType)
     {
         return true;
@@ -370,6 +391,10 @@ public:
     bool move_column(size_t col_ndx_1, size_t col_ndx_2);
     bool add_search_index(size_t col_ndx);
     bool remove_search_index(size_t col_ndx);
+    bool add_accessor_index(size_t col_ndx, ColumnAttr index_attr);
+    bool remove_accessor_index(size_t col_ndx, ColumnAttr index_attr);
+    bool add_composite_index(const std::vector<size_t>& col_ndxs);
+    bool remove_composite_index(const std::vector<size_t>& col_ndxs);
     bool set_link_type(size_t col_ndx, LinkType);
 
     // Must have linklist selected:
@@ -485,6 +510,10 @@ public:
     void merge_rows(const Table*, size_t row_ndx, size_t new_row_ndx);
     void add_search_index(const Table*, size_t col_ndx);
     void remove_search_index(const Table*, size_t col_ndx);
+    void add_accessor_index(const Table*, size_t col_ndx, ColumnAttr index_attr);
+    void remove_accessor_index(const Table*, size_t col_ndx, ColumnAttr index_attr);
+    void add_composite_index(const Table*, const std::vector<size_t>& col_ndxs);
+    void remove_composite_index(const Table*, const std::vector<size_t>& col_ndxs);
     void set_link_type(const Table*, size_t col_ndx, LinkType);
     void clear_table(const Table*);
     void optimize_table(const Table*);
@@ -608,6 +637,9 @@ private:
     Timestamp read_timestamp();
     void read_mixed(Mixed*);
 
+    // Read the number of columns, followed by that many column indexes
+    void read_column_list(std::vector<size_t>&);
+
     // Advance m_input_begin and m_input_end to reflect the next block of instructions
     // Returns false if no more input was available
     bool next_input_buffer();
@@ -617,6 +649,7 @@ private:
 
     bool is_valid_data_type(int type);
     bool is_valid_link_type(int type);
+    bool is_valid_accessor_index_attr(int attr);
 };
 
 
@@ -1479,6 +1512,60 @@ inline void TransactLogConvenientEncoder::remove_search_index(const Table* t, si
     m_encoder.remove_search_index(col_ndx); // Throws
 }
 
+inline bool TransactLogEncoder::add_accessor_index(size_t col_ndx, ColumnAttr index_attr)
+{
+    append_simple_instr(instr_AddAccessorIndex, util::tuple(col_ndx, int(index_attr))); // Throws
+    return true;
+}
+
+inline void TransactLogConvenientEncoder::add_accessor_index(const Table* t, size_t col_ndx, ColumnAttr index_attr)
+{
+    select_table(t);                                   // Throws
+    m_encoder.add_accessor_index(col_ndx, index_attr); // Throws
+}
+
+
+inline bool TransactLogEncoder::remove_accessor_index(size_t col_ndx, ColumnAttr index_attr)
+{
+    append_simple_instr(instr_RemoveAccessorIndex, util::tuple(col_ndx, int(index_attr))); // Throws
+    return true;
+}
+
+inline void TransactLogConvenientEncoder::remove_accessor_index(const Table* t, size_t col_ndx,
+                                                                ColumnAttr index_attr)
+{
+    select_table(t);                                      // Throws
+    m_encoder.remove_accessor_index(col_ndx, index_attr); // Throws
+}
+
+inline bool TransactLogEncoder::add_composite_index(const std::vector<size_t>& col_ndxs)
+{
+    append_variable_size_instr(instr_AddCompositeIndex, util::tuple(col_ndxs.size()), col_ndxs.begin(),
+                               col_ndxs.end()); // Throws
+    return true;
+}
+
+inline void TransactLogConvenientEncoder::add_composite_index(const Table* t, const std::vector<size_t>& col_ndxs)
+{
+    select_table(t);                          // Throws
+    m_encoder.add_composite_index(col_ndxs); // Throws
+}
+
+
+inline bool TransactLogEncoder::remove_composite_index(const std::vector<size_t>& col_ndxs)
+{
+    append_variable_size_instr(instr_RemoveCompositeIndex, util::tuple(col_ndxs.size()), col_ndxs.begin(),
+                               col_ndxs.end()); // Throws
+    return true;
+}
+
+inline void TransactLogConvenientEncoder::remove_composite_index(const Table* t,
+                                                                 const std::vector<size_t>& col_ndxs)
+{
+    select_table(t);                             // Throws
+    m_encoder.remove_composite_index(col_ndxs); // Throws
+}
+
 inline bool TransactLogEncoder::set_link_type(size_t col_ndx, LinkType link_type)
 {
     append_simple_instr(instr_SetLinkType, util::tuple(col_ndx, int(link_type))); // Throws
@@ -1981,6 +2068,38 @@ void TransactLogParser::parse_one(InstructionHandler& handler)
                 parser_error();
             return;
         }
+        case instr_AddAccessorIndex: {
+            size_t col_ndx = read_int<size_t>(); // Throws
+            int index_attr = read_int<int>();    // Throws
+            if (!is_valid_accessor_index_attr(index_attr))
+                parser_error();
+            if (!handler.add_accessor_index(col_ndx, ColumnAttr(index_attr))) // Throws
+                parser_error();
+            return;
+        }
+        case instr_RemoveAccessorIndex: {
+            size_t col_ndx = read_int<size_t>(); // Throws
+            int index_attr = read_int<int>();    // Throws
+            if (!is_valid_accessor_index_attr(index_attr))
+                parser_error();
+            if (!handler.remove_accessor_index(col_ndx, ColumnAttr(index_attr))) // Throws
+                parser_error();
+            return;
+        }
+        case instr_AddCompositeIndex: {
+            std::vector<size_t> col_ndxs;
+            read_column_list(col_ndxs);                    // Throws
+            if (!handler.add_composite_index(col_ndxs)) // Throws
+                parser_error();
+            return;
+        }
+        case instr_RemoveCompositeIndex: {
+            std::vector<size_t> col_ndxs;
+            read_column_list(col_ndxs);                       // Throws
+            if (!handler.remove_composite_index(col_ndxs)) // Throws
+                parser_error();
+            return;
+        }
         case instr_SetLinkType: {
             size_t col_ndx = read_int<size_t>(); // Throws
             int link_type = read_int<int>();     // Throws
@@ -2208,6 +2327,13 @@ inline double TransactLogParser::read_double()
 }
 
 
+inline void TransactLogParser::read_column_list(std::vector<size_t>& col_ndxs)
+{
+    size_t num_cols = read_int<size_t>(); // Throws
+    for (size_t i = 0; i < num_cols; ++i)
+        col_ndxs.push_back(read_int<size_t>()); // Throws
+}
+
 inline StringData TransactLogParser::read_string(util::StringBuffer& buf)
 {
     size_t size = read_int<size_t>(); // Throws
@@ -2342,6 +2468,19 @@ inline bool TransactLogParser::is_valid_link_type(int type)
     return false;
 }
 
+inline bool TransactLogParser::is_valid_accessor_index_attr(int attr)
+{
+    switch (attr) {
+        case col_attr_OrderedIndexed:
+        case col_attr_HashIndexed:
+        case col_attr_TrigramIndexed:
+        case col_attr_FullTextIndexed:
+        case col_attr_CaseFoldIndexed:
+            return true;
+    }
+    return false;
+}
+
 
 class TransactReverser {
 public:
@@ -2549,6 +2688,26 @@ public:
         return true; // No-op
     }
 
+    bool add_accessor_index(size_t, ColumnAttr)
+    {
+        return true; // No-op
+    }
+
+    bool remove_accessor_index(size_t, ColumnAttr)
+    {
+        return true; // No-op
+    }
+
+    bool add_composite_index(const std::vector<size_t>&)
+    {
+        return true; // No-op
+    }
+
+    bool remove_composite_index(const std::vector<size_t>&)
+    {
+        return true; // No-op
+    }
+
     bool set_link_type(size_t, LinkType)
     {
         return true; // No-op
@@ -0,0 +1,319 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/index_accessor.hpp>
+#include <realm/table.hpp>
+
+using namespace realm;
+
+namespace {
+
+// Reading more changed rows than this one by one is assumed to be slower than
+// building the index again
+size_t max_changed_rows(size_t num_rows) noexcept
+{
+    return std::max(num_rows / 4, size_t(16));
+}
+
+} // anonymous namespace
+
+
+bool AccessorIndex::can_update_incrementally(const Table& table) const noexcept
+{
+    return m_built && m_num_rows == table.size();
+}
+
+
+void AccessorIndex::update(const Table& table)
+{
+    try {
+        if (!can_update_incrementally(table)) {
+            discard();
+            do_build(table);                          // Throws
+            m_is_changed.assign(table.size(), false); // Throws
+            m_num_rows = table.size();
+            m_built = true;
+            return;
+        }
+
+        // Rows are added in row order, which is the cheapest order for most
+        // indexes
+        std::sort(m_changed_rows.begin(), m_changed_rows.end());
+        for (size_t row_ndx : m_changed_rows) {
+            do_add_row(table, row_ndx); // Throws
+            m_is_changed[row_ndx] = false;
+        }
+        m_changed_rows.clear();
+    }
+    catch (...) {
+        discard();
+        throw;
+    }
+}
+
+
+void AccessorIndex::adj_insert_rows(size_t row_ndx, size_t num_rows) noexcept
+{
+    if (!m_built)
+        return;
+    if (row_ndx > m_num_rows || m_changed_rows.size() + num_rows > max_changed_rows(m_num_rows + num_rows)) {
+        discard();
+        return;
+    }
+
+    try {
+        do_insert_rows(row_ndx, num_rows); // Throws
+        for (size_t& i : m_changed_rows) {
+            if (i >= row_ndx)
+                i += num_rows;
+        }
+        m_is_changed.insert(m_is_changed.begin() + row_ndx, num_rows, false); // Throws
+        m_num_rows += num_rows;
+        for (size_t i = 0; i < num_rows; ++i)
+            add_changed_row(row_ndx + i); // Throws
+    }
+    catch (...) {
+        discard();
+    }
+}
+
+
+void AccessorIndex::adj_erase_row(size_t row_ndx) noexcept
+{
+    if (!m_built)
+        return;
+    if (REALM_UNLIKELY(row_ndx >= m_num_rows)) {
+        discard();
+        return;
+    }
+
+    if (m_is_changed[row_ndx]) {
+        remove_changed_row(row_ndx);
+    }
+    else {
+        do_remove_row(row_ndx);
+    }
+    do_erase_row(row_ndx);
+    for (size_t& i : m_changed_rows) {
+        if (i > row_ndx)
+            --i;
+    }
+    m_is_changed.erase(m_is_changed.begin() + row_ndx);
+    --m_num_rows;
+}
+
+
+void AccessorIndex::adj_move_over(size_t from_row_ndx, size_t to_row_ndx) noexcept
+{
+    if (!m_built)
+        return;
+
+    if (REALM_UNLIKELY(from_row_ndx > m_num_rows || to_row_ndx > m_num_rows)) {
+        discard();
+        return;
+    }
+
+    try {
+        if (to_row_ndx == m_num_rows) {
+            // Unordered insertion, where the row at `from_row_ndx` is moved to
+            // the end to make room for the new row
+            do_insert_rows(m_num_rows, 1); // Throws
+            m_is_changed.push_back(false); // Throws
+            ++m_num_rows;
+            if (from_row_ndx == to_row_ndx) {
+                add_changed_row(to_row_ndx); // Throws
+                return;
+            }
+        }
+        else {
+            // Unordered removal, where the last row is moved over the removed
+            // one
+            if (REALM_UNLIKELY(from_row_ndx != m_num_rows - 1)) {
+                discard();
+                return;
+            }
+            if (m_is_changed[to_row_ndx]) {
+                remove_changed_row(to_row_ndx);
+            }
+            else {
+                do_remove_row(to_row_ndx);
+            }
+            if (from_row_ndx == to_row_ndx) {
+                do_erase_row(from_row_ndx);
+                m_is_changed.pop_back();
+                --m_num_rows;
+                return;
+            }
+        }
+
+        if (m_is_changed[from_row_ndx]) {
+            remove_changed_row(from_row_ndx);
+            add_changed_row(to_row_ndx); // Throws
+        }
+        else {
+            do_move_row(from_row_ndx, to_row_ndx); // Throws
+        }
+
+        if (to_row_ndx == m_num_rows - 1) {
+            add_changed_row(from_row_ndx); // Throws
+        }
+        else {
+            do_erase_row(from_row_ndx);
+            m_is_changed.pop_back();
+            --m_num_rows;
+        }
+    }
+    catch (...) {
+        discard();
+    }
+}
+
+
+void AccessorIndex::adj_swap_rows(size_t row_ndx_1, size_t row_ndx_2) noexcept
+{
+    if (!m_built)
+        return;
+    if (REALM_UNLIKELY(row_ndx_1 >= m_num_rows || row_ndx_2 >= m_num_rows)) {
+        discard();
+        return;
+    }
+
+    try {
+        take_out(row_ndx_1); // Throws
+        take_out(row_ndx_2); // Throws
+    }
+    catch (...) {
+        discard();
+    }
+}
+
+
+void AccessorIndex::adj_set_rows(size_t row_ndx, size_t num_rows) noexcept
+{
+    if (!m_built)
+        return;
+
+    // Table::insert_empty_row() tells of rows appended to the table as
+    // changed rows
+    if (row_ndx + num_rows > m_num_rows) {
+        if (row_ndx == m_num_rows) {
+            adj_insert_rows(row_ndx, num_rows);
+        }
+        else {
+            discard();
+        }
+        return;
+    }
+
+    if (m_changed_rows.size() + num_rows > max_changed_rows(m_num_rows)) {
+        discard();
+        return;
+    }
+
+    try {
+        for (size_t i = row_ndx; i < row_ndx + num_rows; ++i)
+            take_out(i); // Throws
+    }
+    catch (...) {
+        discard();
+    }
+}
+
+
+void AccessorIndex::adj_clear() noexcept
+{
+    if (!m_built)
+        return;
+
+    do_clear();
+    m_num_rows = 0;
+    m_changed_rows.clear();
+    m_is_changed.clear();
+}
+
+
+void AccessorIndex::adj_insert_column(size_t col_ndx) noexcept
+{
+    for (size_t& i : m_columns) {
+        if (i >= col_ndx)
+            ++i;
+    }
+}
+
+
+void AccessorIndex::adj_erase_column(size_t col_ndx) noexcept
+{
+    for (size_t& i : m_columns) {
+        REALM_ASSERT(i != col_ndx);
+        if (i > col_ndx)
+            --i;
+    }
+}
+
+
+void AccessorIndex::adj_move_column(size_t from_col_ndx, size_t to_col_ndx) noexcept
+{
+    for (size_t& i : m_columns) {
+        if (i == from_col_ndx) {
+            i = to_col_ndx;
+        }
+        else if (from_col_ndx < to_col_ndx && i > from_col_ndx && i <= to_col_ndx) {
+            --i;
+        }
+        else if (to_col_ndx < from_col_ndx && i >= to_col_ndx && i < from_col_ndx) {
+            ++i;
+        }
+    }
+}
+
+
+void AccessorIndex::add_changed_row(size_t row_ndx)
+{
+    m_changed_rows.push_back(row_ndx); // Throws
+    m_is_changed[row_ndx] = true;
+}
+
+
+void AccessorIndex::remove_changed_row(size_t row_ndx) noexcept
+{
+    auto i = std::find(m_changed_rows.begin(), m_changed_rows.end(), row_ndx);
+    REALM_ASSERT(i != m_changed_rows.end());
+    *i = m_changed_rows.back();
+    m_changed_rows.pop_back();
+    m_is_changed[row_ndx] = false;
+}
+
+
+void AccessorIndex::take_out(size_t row_ndx)
+{
+    if (m_is_changed[row_ndx])
+        return;
+    m_changed_rows.reserve(m_changed_rows.size() + 1); // Throws
+    do_remove_row(row_ndx);
+    add_changed_row(row_ndx);
+}
+
+
+void AccessorIndex::discard() noexcept
+{
+    do_clear();
+    m_built = false;
+    m_num_rows = 0;
+    m_changed_rows.clear();
+    m_is_changed.clear();
+}
@@ -0,0 +1,459 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_ACCESSOR_HPP
+#define REALM_INDEX_ACCESSOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <realm/util/assert.hpp>
+
+namespace realm {
+
+class Table;
+
+/// The base class of the indexes that a table accessor keeps in memory for
+/// columns whose attributes ask for them (see Table::add_ordered_index()).
+///
+/// An index is built from the table the first time it is used. After that,
+/// the table accessor tells it about every change of its rows as the change
+/// happens (see Table::adj_row_acc_insert_rows()). Rows that are inserted,
+/// removed or moved are only renumbered, and rows whose values change are
+/// taken out of the index, and put back with their new values by the next
+/// call of update(). When so many rows have changed that reading them one by
+/// one would be slower than building the index again, the index gives up
+/// following the changes, and is built again by the next call of update().
+///
+/// The adjustments must assume no more than minimal consistency of the
+/// accessor hierarchy (see AccessorConsistencyLevels), so they never read the
+/// table. They must be called with the accessor mutex of the table locked.
+class AccessorIndex {
+public:
+    AccessorIndex(const AccessorIndex&) = delete;
+    AccessorIndex& operator=(const AccessorIndex&) = delete;
+    virtual ~AccessorIndex() noexcept
+    {
+    }
+
+    /// The columns of the table that the index is of, in the order of the
+    /// index.
+    const std::vector<size_t>& get_columns() const noexcept
+    {
+        return m_columns;
+    }
+
+    /// Bring the index up to date with `table`, which must be the table that
+    /// the changes have been told of, at full accessor consistency.
+    void update(const Table& table);
+
+    /// Whether update() would bring the index up to date with `table` row by
+    /// row, rather than build it from scratch.
+    bool can_update_incrementally(const Table& table) const noexcept;
+
+    void adj_insert_rows(size_t row_ndx, size_t num_rows) noexcept;
+    void adj_erase_row(size_t row_ndx) noexcept;
+    void adj_move_over(size_t from_row_ndx, size_t to_row_ndx) noexcept;
+    void adj_swap_rows(size_t row_ndx_1, size_t row_ndx_2) noexcept;
+    void adj_set_rows(size_t row_ndx, size_t num_rows) noexcept;
+    void adj_clear() noexcept;
+
+    /// Forget the rows, so that the index is built again by the next call of
+    /// update(), after a change that it cannot be told about row by row.
+    void discard() noexcept;
+
+    // The table accessor adjusts the columns of the index when columns are
+    // inserted, removed, or moved. An index is dropped along with any of its
+    // columns.
+    void adj_insert_column(size_t col_ndx) noexcept;
+    void adj_erase_column(size_t col_ndx) noexcept;
+    void adj_move_column(size_t from_col_ndx, size_t to_col_ndx) noexcept;
+
+protected:
+    explicit AccessorIndex(std::vector<size_t> col_ndxs) noexcept
+        : m_columns(std::move(col_ndxs))
+    {
+    }
+
+    /// Add every row of `table` to the index, which is empty.
+    virtual void do_build(const Table& table) = 0;
+
+    /// Make the index empty.
+    virtual void do_clear() noexcept = 0;
+
+    /// Read the value of the specified row from `table` and add it to the
+    /// index. The row is not in the index.
+    virtual void do_add_row(const Table& table, size_t row_ndx) = 0;
+
+    /// Take the specified row out of the index. The row is in the index.
+    virtual void do_remove_row(size_t row_ndx) noexcept = 0;
+
+    /// Make room for `num_rows` new rows at `row_ndx`, which are not in the
+    /// index, by adding `num_rows` to the rows at `row_ndx` and after.
+    virtual void do_insert_rows(size_t row_ndx, size_t num_rows) = 0;
+
+    /// Drop the specified row, which is not in the index, by subtracting one
+    /// from the rows after it.
+    virtual void do_erase_row(size_t row_ndx) noexcept = 0;
+
+    /// Give the row `from_row_ndx`, which is in the index, the number
+    /// `to_row_ndx`, which is not in use. Afterwards, `from_row_ndx` is not in
+    /// the index.
+    virtual void do_move_row(size_t from_row_ndx, size_t to_row_ndx) = 0;
+
+private:
+    std::vector<size_t> m_columns;
+    bool m_built = false;
+    size_t m_num_rows = 0;
+
+    // The rows that have been taken out of the index since the last update,
+    // in no particular order, and whether each row is one of them
+    std::vector<size_t> m_changed_rows;
+    std::vector<bool> m_is_changed;
+
+    void add_changed_row(size_t row_ndx);
+    void remove_changed_row(size_t row_ndx) noexcept;
+    void take_out(size_t row_ndx);
+};
+
+
+/// A sequence of distinct row indexes sorted by `Less`, which must give any
+/// two distinct rows an order, typically by their values and then by row
+/// index. The rows are kept in blocks of limited size, so that a row is
+/// inserted or removed in time proportional to the size of a block and the
+/// logarithm of the number of rows, rather than to the number of rows.
+template <class Less>
+class SortedRows {
+public:
+    class const_iterator;
+
+    explicit SortedRows(Less less) noexcept
+        : m_less(less)
+    {
+    }
+
+    /// Replace the rows with `rows`, which must be sorted.
+    void assign(const std::vector<size_t>& rows);
+
+    void insert(size_t row_ndx);
+
+    /// Remove the specified row, which must be in the sequence.
+    void erase(size_t row_ndx) noexcept;
+
+    void clear() noexcept
+    {
+        m_blocks.clear();
+        m_size = 0;
+    }
+
+    size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return const_iterator(m_blocks, 0, 0);
+    }
+    const_iterator end() const noexcept
+    {
+        return const_iterator(m_blocks, m_blocks.size(), 0);
+    }
+
+    /// The first row `r` for which `before(r)` is false. `before` must be
+    /// true for every row before that row, and false for every row after.
+    template <class Pred>
+    const_iterator partition_point(Pred before) const noexcept;
+
+    /// Replace every row `r` with `func(r)`, which must keep the rows in the
+    /// same order.
+    template <class Func>
+    void renumber(Func func) noexcept;
+
+    class const_iterator {
+    public:
+        size_t operator*() const noexcept
+        {
+            return (*m_blocks)[m_block][m_offset];
+        }
+        const_iterator& operator++() noexcept
+        {
+            if (++m_offset == (*m_blocks)[m_block].size()) {
+                ++m_block;
+                m_offset = 0;
+            }
+            return *this;
+        }
+        bool operator==(const const_iterator& other) const noexcept
+        {
+            return m_block == other.m_block && m_offset == other.m_offset;
+        }
+        bool operator!=(const const_iterator& other) const noexcept
+        {
+            return !(*this == other);
+        }
+
+    private:
+        const std::vector<std::vector<size_t>>* m_blocks;
+        size_t m_block, m_offset;
+
+        const_iterator(const std::vector<std::vector<size_t>>& blocks, size_t block, size_t offset) noexcept
+            : m_blocks(&blocks)
+            , m_block(block)
+            , m_offset(offset)
+        {
+        }
+
+        friend class SortedRows;
+    };
+
+private:
+    static const size_t max_block_size = 1024;
+
+    Less m_less;
+    std::vector<std::vector<size_t>> m_blocks; // None of them empty
+    size_t m_size = 0;
+
+    // The first block whose last row is not before `row_ndx`, or the number
+    // of blocks
+    size_t find_block(size_t row_ndx) const noexcept;
+};
+
+
+/// Lists of rows by term, for indexes that list each row under every term
+/// that occurs in its value, such as the trigrams or the words of a string.
+/// The lists are kept in row order. The terms of each row are kept too, so
+/// that a row is taken out of its lists without reading its old value, as
+/// AccessorIndex requires.
+template <class Term>
+class PostingLists {
+public:
+    /// The rows of the specified term, in row order, or null if no row has
+    /// the term.
+    const std::vector<size_t>* find(const Term& term) const noexcept
+    {
+        auto i = m_lists.find(term);
+        return i == m_lists.end() ? nullptr : &i->second;
+    }
+
+    /// Number of distinct terms.
+    size_t size() const noexcept
+    {
+        return m_lists.size();
+    }
+
+    /// Number of rows in use, whether they are in the lists or not.
+    size_t num_rows() const noexcept
+    {
+        return m_row_terms.size();
+    }
+
+    /// Add the specified row, which is not in the lists, under each of
+    /// `terms`, which must be distinct. The row must be in use (see
+    /// insert_rows()).
+    void add_row(size_t row_ndx, std::vector<Term> terms);
+
+    /// Take the specified row out of the lists of its terms.
+    void remove_row(size_t row_ndx) noexcept;
+
+    // These have the meaning of the same functions of AccessorIndex, where
+    // the rows that are not in the lists still have numbers in use
+    void insert_rows(size_t row_ndx, size_t num_rows);
+    void erase_row(size_t row_ndx) noexcept;
+    void move_row(size_t from_row_ndx, size_t to_row_ndx);
+
+    void clear() noexcept
+    {
+        m_lists.clear();
+        m_row_terms.clear();
+    }
+
+private:
+    std::map<Term, std::vector<size_t>> m_lists; // None of them empty
+    std::vector<std::vector<Term>> m_row_terms;  // By row index
+
+    // Add `delta` to every row at or after `row_ndx` in the lists
+    void renumber(size_t row_ndx, size_t delta) noexcept;
+};
+
+
+// Implementation:
+
+template <class Less>
+void SortedRows<Less>::assign(const std::vector<size_t>& rows)
+{
+    clear();
+    for (size_t i = 0; i < rows.size(); i += max_block_size / 2) {
+        size_t end = std::min(rows.size(), i + max_block_size / 2);
+        m_blocks.emplace_back(rows.begin() + i, rows.begin() + end); // Throws
+    }
+    m_size = rows.size();
+}
+
+template <class Less>
+size_t SortedRows<Less>::find_block(size_t row_ndx) const noexcept
+{
+    auto i = std::partition_point(m_blocks.begin(), m_blocks.end(),
+                                  [&](const std::vector<size_t>& block) { return m_less(block.back(), row_ndx); });
+    return size_t(i - m_blocks.begin());
+}
+
+template <class Less>
+void SortedRows<Less>::insert(size_t row_ndx)
+{
+    size_t block_ndx = find_block(row_ndx);
+    if (block_ndx == m_blocks.size()) {
+        if (m_blocks.empty())
+            m_blocks.emplace_back(); // Throws
+        block_ndx = m_blocks.size() - 1;
+    }
+    std::vector<size_t>& block = m_blocks[block_ndx];
+    auto i = std::partition_point(block.begin(), block.end(), [&](size_t r) { return m_less(r, row_ndx); });
+    block.insert(i, row_ndx); // Throws
+    ++m_size;
+
+    if (block.size() > max_block_size) {
+        std::vector<size_t> second_half(block.begin() + max_block_size / 2, block.end()); // Throws
+        m_blocks.insert(m_blocks.begin() + block_ndx + 1, std::move(second_half)); // Throws
+        m_blocks[block_ndx].resize(max_block_size / 2);
+    }
+}
+
+template <class Less>
+void SortedRows<Less>::erase(size_t row_ndx) noexcept
+{
+    size_t block_ndx = find_block(row_ndx);
+    REALM_ASSERT(block_ndx < m_blocks.size());
+    std::vector<size_t>& block = m_blocks[block_ndx];
+    auto i = std::partition_point(block.begin(), block.end(), [&](size_t r) { return m_less(r, row_ndx); });
+    REALM_ASSERT(i != block.end() && *i == row_ndx);
+    block.erase(i);
+    --m_size;
+    if (block.empty())
+        m_blocks.erase(m_blocks.begin() + block_ndx);
+}
+
+template <class Less>
+template <class Pred>
+typename SortedRows<Less>::const_iterator SortedRows<Less>::partition_point(Pred before) const noexcept
+{
+    auto i = std::partition_point(m_blocks.begin(), m_blocks.end(),
+                                  [&](const std::vector<size_t>& block) { return before(block.back()); });
+    if (i == m_blocks.end())
+        return end();
+    auto j = std::partition_point(i->begin(), i->end(), before);
+    return const_iterator(m_blocks, size_t(i - m_blocks.begin()), size_t(j - i->begin()));
+}
+
+template <class Less>
+template <class Func>
+void SortedRows<Less>::renumber(Func func) noexcept
+{
+    for (std::vector<size_t>& block : m_blocks) {
+        for (size_t& row_ndx : block)
+            row_ndx = func(row_ndx);
+    }
+}
+
+template <class Term>
+void PostingLists<Term>::add_row(size_t row_ndx, std::vector<Term> terms)
+{
+    REALM_ASSERT(row_ndx < m_row_terms.size() && m_row_terms[row_ndx].empty());
+    for (size_t i = 0; i < terms.size(); ++i) {
+        try {
+            std::vector<size_t>& rows = m_lists[terms[i]]; // Throws
+            if (rows.empty() || rows.back() < row_ndx) {
+                rows.push_back(row_ndx); // Throws
+            }
+            else {
+                rows.insert(std::lower_bound(rows.begin(), rows.end(), row_ndx), row_ndx); // Throws
+            }
+        }
+        catch (...) {
+            // Keep the terms that the row was added under, so that it can be
+            // removed again
+            terms.resize(i);
+            m_row_terms[row_ndx] = std::move(terms);
+            remove_row(row_ndx);
+            throw;
+        }
+    }
+    m_row_terms[row_ndx] = std::move(terms);
+}
+
+template <class Term>
+void PostingLists<Term>::remove_row(size_t row_ndx) noexcept
+{
+    REALM_ASSERT(row_ndx < m_row_terms.size());
+    for (const Term& term : m_row_terms[row_ndx]) {
+        auto i = m_lists.find(term);
+        REALM_ASSERT(i != m_lists.end());
+        std::vector<size_t>& rows = i->second;
+        auto j = std::lower_bound(rows.begin(), rows.end(), row_ndx);
+        REALM_ASSERT(j != rows.end() && *j == row_ndx);
+        rows.erase(j);
+        if (rows.empty())
+            m_lists.erase(i);
+    }
+    m_row_terms[row_ndx].clear();
+}
+
+template <class Term>
+void PostingLists<Term>::insert_rows(size_t row_ndx, size_t num_rows)
+{
+    m_row_terms.insert(m_row_terms.begin() + row_ndx, num_rows, std::vector<Term>()); // Throws
+
+    // Appending rows, which is the common case, leaves the other rows alone
+    if (row_ndx + num_rows < m_row_terms.size())
+        renumber(row_ndx, num_rows);
+}
+
+template <class Term>
+void PostingLists<Term>::erase_row(size_t row_ndx) noexcept
+{
+    REALM_ASSERT(m_row_terms[row_ndx].empty());
+    m_row_terms.erase(m_row_terms.begin() + row_ndx);
+    if (row_ndx < m_row_terms.size())
+        renumber(row_ndx + 1, size_t(-1)); // Subtracts one
+}
+
+template <class Term>
+void PostingLists<Term>::move_row(size_t from_row_ndx, size_t to_row_ndx)
+{
+    REALM_ASSERT(m_row_terms[to_row_ndx].empty());
+    std::vector<Term> terms = m_row_terms[from_row_ndx]; // Throws
+    remove_row(from_row_ndx);
+    add_row(to_row_ndx, std::move(terms)); // Throws
+}
+
+template <class Term>
+void PostingLists<Term>::renumber(size_t row_ndx, size_t delta) noexcept
+{
+    for (auto& list : m_lists) {
+        std::vector<size_t>& rows = list.second;
+        for (auto i = std::lower_bound(rows.begin(), rows.end(), row_ndx); i != rows.end(); ++i)
+            *i += delta;
+    }
+}
+
+} // namespace realm
+
+#endif // REALM_INDEX_ACCESSOR_HPP
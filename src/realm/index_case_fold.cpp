@@ -0,0 +1,157 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+
+#include <realm/index_case_fold.hpp>
+#include <realm/table.hpp>
+#include <realm/unicode.hpp>
+
+using namespace realm;
+
+CaseFoldIndex::CaseFoldIndex(size_t col_ndx)
+    : AccessorIndex({col_ndx}) // Throws
+    , m_sorted(RowLess{this})
+{
+}
+
+
+void CaseFoldIndex::do_build(const Table& table)
+{
+    size_t col_ndx = get_columns()[0];
+    size_t num_rows = table.size();
+    m_values.resize(num_rows); // Throws
+    m_is_null.resize(num_rows); // Throws
+    std::vector<size_t> rows;
+    rows.reserve(num_rows); // Throws
+    for (size_t row = 0; row < num_rows; ++row) {
+        StringData value = table.get_string(col_ndx, row);
+        m_is_null[row] = value.is_null();
+        if (!value.is_null()) {
+            m_values[row] = fold(value); // Throws
+            rows.push_back(row);
+        }
+    }
+
+    // The rows were added in order, so a stable sort by value gives the order
+    // of RowLess
+    std::stable_sort(rows.begin(), rows.end(), [&](size_t a, size_t b) { return get(a) < get(b); });
+    m_sorted.assign(rows); // Throws
+}
+
+
+void CaseFoldIndex::do_clear() noexcept
+{
+    m_values.clear();
+    m_is_null.clear();
+    m_sorted.clear();
+}
+
+
+void CaseFoldIndex::do_add_row(const Table& table, size_t row_ndx)
+{
+    StringData value = table.get_string(get_columns()[0], row_ndx);
+    if (value.is_null()) {
+        m_values[row_ndx].clear();
+        m_is_null[row_ndx] = true;
+        return;
+    }
+    m_values[row_ndx] = fold(value); // Throws
+    m_is_null[row_ndx] = false;
+    m_sorted.insert(row_ndx); // Throws
+}
+
+
+void CaseFoldIndex::do_remove_row(size_t row_ndx) noexcept
+{
+    if (!m_is_null[row_ndx])
+        m_sorted.erase(row_ndx);
+}
+
+
+void CaseFoldIndex::do_insert_rows(size_t row_ndx, size_t num_rows)
+{
+    m_values.insert(m_values.begin() + row_ndx, num_rows, std::string()); // Throws
+    m_is_null.insert(m_is_null.begin() + row_ndx, num_rows, true);        // Throws
+
+    // Appending rows, which is the common case, leaves the other rows alone
+    if (row_ndx + num_rows < m_values.size())
+        m_sorted.renumber([=](size_t i) { return i < row_ndx ? i : i + num_rows; });
+}
+
+
+void CaseFoldIndex::do_erase_row(size_t row_ndx) noexcept
+{
+    m_values.erase(m_values.begin() + row_ndx);
+    m_is_null.erase(m_is_null.begin() + row_ndx);
+    if (row_ndx < m_values.size())
+        m_sorted.renumber([=](size_t i) { return i < row_ndx ? i : i - 1; });
+}
+
+
+void CaseFoldIndex::do_move_row(size_t from_row_ndx, size_t to_row_ndx)
+{
+    bool is_null = m_is_null[from_row_ndx];
+    if (!is_null)
+        m_sorted.erase(from_row_ndx);
+    m_values[to_row_ndx].swap(m_values[from_row_ndx]);
+    m_is_null[to_row_ndx] = is_null;
+    m_is_null[from_row_ndx] = true;
+    if (!is_null)
+        m_sorted.insert(to_row_ndx); // Throws
+}
+
+
+std::string CaseFoldIndex::fold(StringData value)
+{
+    if (util::Optional<std::string> lower = case_map(value, false)) // Throws
+        return std::move(*lower);
+
+    std::string result(value); // Throws
+    for (char& c : result) {
+        if (c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+    }
+    return result;
+}
+
+
+CaseFoldIndex::Rows::const_iterator CaseFoldIndex::find_first_not_before(StringData folded) const noexcept
+{
+    return m_sorted.partition_point([&](size_t row) { return get(row) < folded; });
+}
+
+
+void CaseFoldIndex::find_equal(StringData folded, std::vector<size_t>& rows) const
+{
+    REALM_ASSERT(!folded.is_null());
+
+    // Rows with equal values are in row order
+    for (auto i = find_first_not_before(folded); i != m_sorted.end() && get(*i) == folded; ++i)
+        rows.push_back(*i); // Throws
+}
+
+
+void CaseFoldIndex::find_prefix(StringData folded, std::vector<size_t>& rows) const
+{
+    REALM_ASSERT(!folded.is_null());
+    size_t begin = rows.size();
+    for (auto i = find_first_not_before(folded); i != m_sorted.end() && get(*i).begins_with(folded); ++i)
+        rows.push_back(*i); // Throws
+    std::sort(rows.begin() + begin, rows.end());
+}
@@ -0,0 +1,100 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_CASE_FOLD_HPP
+#define REALM_INDEX_CASE_FOLD_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <realm/index_accessor.hpp>
+#include <realm/string_data.hpp>
+
+namespace realm {
+
+class Table;
+
+/// A copy of a string column with every value mapped to lower case (see
+/// fold()), and the rows sorted by their folded value. Case insensitive
+/// conditions compare the folded values with the folded pattern byte by byte
+/// instead of mapping every character of every value, and find the rows that
+/// are equal to, or begin with, a pattern with a binary search.
+///
+/// The folded value of a row is replaced when the row is set, and the row is
+/// moved to its new place in the sorted rows (see SortedRows), so a write
+/// folds one string rather than the whole column (see AccessorIndex, and
+/// Table::add_case_fold_index()).
+class CaseFoldIndex : public AccessorIndex {
+public:
+    /// Create an empty index of the specified string column.
+    explicit CaseFoldIndex(size_t col_ndx);
+
+    /// The folded value of the specified row. Null if the value is null.
+    StringData get(size_t row) const noexcept
+    {
+        if (m_is_null[row])
+            return StringData();
+        return m_values[row];
+    }
+
+    /// Append the rows whose folded value is equal to `folded` to `rows`, in
+    /// row order. `folded` must not be null.
+    void find_equal(StringData folded, std::vector<size_t>& rows) const;
+
+    /// Append the rows whose folded value begins with `folded` to `rows`, in
+    /// row order. `folded` must not be null.
+    void find_prefix(StringData folded, std::vector<size_t>& rows) const;
+
+    /// The value mapped to lower case with case_map(), which preserves the
+    /// size. If the value is not valid UTF-8, only ASCII letters are mapped.
+    static std::string fold(StringData value);
+
+private:
+    // Orders rows by folded value, then by row index
+    struct RowLess {
+        const CaseFoldIndex* m_index;
+        bool operator()(size_t a, size_t b) const noexcept
+        {
+            StringData value_a = m_index->get(a), value_b = m_index->get(b);
+            return value_a < value_b || (value_a == value_b && a < b);
+        }
+    };
+    using Rows = SortedRows<RowLess>;
+
+    // The folded value of each row, empty if the value is null, by row index
+    std::vector<std::string> m_values;
+    std::vector<bool> m_is_null;
+
+    Rows m_sorted; // Rows that are not null
+
+    // The first of the sorted rows whose folded value is not before `folded`
+    Rows::const_iterator find_first_not_before(StringData folded) const noexcept;
+
+    void do_build(const Table&) override;
+    void do_clear() noexcept override;
+    void do_add_row(const Table&, size_t row_ndx) override;
+    void do_remove_row(size_t row_ndx) noexcept override;
+    void do_insert_rows(size_t row_ndx, size_t num_rows) override;
+    void do_erase_row(size_t row_ndx) noexcept override;
+    void do_move_row(size_t from_row_ndx, size_t to_row_ndx) override;
+};
+
+} // namespace realm
+
+#endif // REALM_INDEX_CASE_FOLD_HPP
@@ -0,0 +1,176 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+#include <iterator>
+
+#include <realm/index_case_fold.hpp>
+#include <realm/index_fulltext.hpp>
+#include <realm/table.hpp>
+
+using namespace realm;
+
+namespace {
+
+bool is_word_char(char c) noexcept
+{
+    unsigned char b = static_cast<unsigned char>(c);
+    return (b >= '0' && b <= '9') || (b >= 'a' && b <= 'z') || (b >= 'A' && b <= 'Z') || b >= 0x80;
+}
+
+} // anonymous namespace
+
+
+FullTextIndex::FullTextIndex(size_t col_ndx)
+    : AccessorIndex({col_ndx}) // Throws
+{
+}
+
+
+void FullTextIndex::do_build(const Table& table)
+{
+    size_t num_rows = table.size();
+    m_lists.insert_rows(0, num_rows); // Throws
+    for (size_t row_ndx = 0; row_ndx < num_rows; ++row_ndx)
+        do_add_row(table, row_ndx); // Throws
+}
+
+
+void FullTextIndex::do_clear() noexcept
+{
+    m_lists.clear();
+}
+
+
+void FullTextIndex::do_add_row(const Table& table, size_t row_ndx)
+{
+    std::vector<std::string> words;
+    tokenize(table.get_string(get_columns()[0], row_ndx), words); // Throws
+    m_lists.add_row(row_ndx, std::move(words));                    // Throws
+}
+
+
+void FullTextIndex::do_remove_row(size_t row_ndx) noexcept
+{
+    m_lists.remove_row(row_ndx);
+}
+
+
+void FullTextIndex::do_insert_rows(size_t row_ndx, size_t num_rows)
+{
+    m_lists.insert_rows(row_ndx, num_rows); // Throws
+}
+
+
+void FullTextIndex::do_erase_row(size_t row_ndx) noexcept
+{
+    m_lists.erase_row(row_ndx);
+}
+
+
+void FullTextIndex::do_move_row(size_t from_row_ndx, size_t to_row_ndx)
+{
+    m_lists.move_row(from_row_ndx, to_row_ndx); // Throws
+}
+
+
+void FullTextIndex::tokenize(StringData text, std::vector<std::string>& words)
+{
+    if (text.is_null())
+        return;
+
+    size_t begin = words.size();
+    std::string s = CaseFoldIndex::fold(text); // Throws
+    size_t i = 0;
+    while (i < s.size()) {
+        if (!is_word_char(s[i])) {
+            ++i;
+            continue;
+        }
+        size_t j = i;
+        while (j < s.size() && is_word_char(s[j]))
+            ++j;
+        words.emplace_back(s, i, j - i); // Throws
+        i = j;
+    }
+    std::sort(words.begin() + begin, words.end());
+    words.erase(std::unique(words.begin() + begin, words.end()), words.end());
+}
+
+
+void FullTextIndex::find_all(const std::vector<std::string>& words, std::vector<size_t>& rows) const
+{
+    if (words.empty()) {
+        for (size_t row = 0; row < m_lists.num_rows(); ++row)
+            rows.push_back(row); // Throws
+        return;
+    }
+
+    // Intersect the lists of rows, shortest first
+    std::vector<const std::vector<size_t>*> lists;
+    for (const std::string& word : words) {
+        const std::vector<size_t>* list = m_lists.find(word);
+        if (!list)
+            return; // No row has this word
+        lists.push_back(list); // Throws
+    }
+    std::sort(lists.begin(), lists.end(), [](const std::vector<size_t>* a, const std::vector<size_t>* b) {
+        return a->size() < b->size();
+    });
+
+    std::vector<size_t> matches(*lists[0]); // Throws
+    std::vector<size_t> next;
+    for (size_t i = 1; i < lists.size() && !matches.empty(); ++i) {
+        next.clear();
+        std::set_intersection(matches.begin(), matches.end(), lists[i]->begin(), lists[i]->end(),
+                              std::back_inserter(next)); // Throws
+        matches.swap(next);
+    }
+    rows.insert(rows.end(), matches.begin(), matches.end()); // Throws
+}
+
+
+void FullTextIndex::find_ranked(const std::vector<std::string>& words, std::vector<size_t>& rows) const
+{
+    std::vector<std::string> distinct(words); // Throws
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+
+    // The rows of all the words, where a row occurs once per word it contains
+    std::vector<size_t> all;
+    for (const std::string& word : distinct) {
+        if (const std::vector<size_t>* list = m_lists.find(word))
+            all.insert(all.end(), list->begin(), list->end()); // Throws
+    }
+    std::sort(all.begin(), all.end());
+
+    using Match = std::pair<size_t, size_t>; // Number of words, row
+    std::vector<Match> matches;
+    for (size_t i = 0; i < all.size();) {
+        size_t j = i + 1;
+        while (j < all.size() && all[j] == all[i])
+            ++j;
+        matches.emplace_back(j - i, all[i]); // Throws
+        i = j;
+    }
+    std::stable_sort(matches.begin(), matches.end(), [](const Match& a, const Match& b) {
+        return a.first > b.first;
+    });
+    for (const Match& match : matches)
+        rows.push_back(match.second); // Throws
+}
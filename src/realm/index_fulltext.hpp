@@ -0,0 +1,82 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_FULLTEXT_HPP
+#define REALM_INDEX_FULLTEXT_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <realm/index_accessor.hpp>
+#include <realm/string_data.hpp>
+
+namespace realm {
+
+class Table;
+
+/// The rows of a string column listed by the words that occur in their values
+/// (an inverted index). A full-text index finds the rows that contain a set
+/// of words by intersecting their lists of rows, without reading the strings
+/// (see Query::matches()).
+///
+/// Each row is listed under the words of its value as they were when it was
+/// last added, so that setting a string, or removing or moving a row, only
+/// touches the lists of the words involved (see AccessorIndex, and
+/// Table::add_fulltext_index()).
+class FullTextIndex : public AccessorIndex {
+public:
+    /// Create an empty index of the specified string column.
+    explicit FullTextIndex(size_t col_ndx);
+
+    /// Append the rows whose value contains each of `words` to `rows`, in row
+    /// order. The words must be in the form given by tokenize(). Every row
+    /// contains an empty list of words.
+    void find_all(const std::vector<std::string>& words, std::vector<size_t>& rows) const;
+
+    /// Append the rows whose value contains at least one of `words` to
+    /// `rows`, ordered by the number of distinct words that they contain,
+    /// most first, and then by row index.
+    void find_ranked(const std::vector<std::string>& words, std::vector<size_t>& rows) const;
+
+    /// Number of distinct words in the column.
+    size_t size() const noexcept
+    {
+        return m_lists.size();
+    }
+
+    /// Append the distinct words of `text` to `words`, sorted. A word is a
+    /// maximal sequence of ASCII letters and digits and non-ASCII characters,
+    /// mapped to lower case by CaseFoldIndex::fold(). Null has no words.
+    static void tokenize(StringData text, std::vector<std::string>& words);
+
+private:
+    PostingLists<std::string> m_lists;
+
+    void do_build(const Table&) override;
+    void do_clear() noexcept override;
+    void do_add_row(const Table&, size_t row_ndx) override;
+    void do_remove_row(size_t row_ndx) noexcept override;
+    void do_insert_rows(size_t row_ndx, size_t num_rows) override;
+    void do_erase_row(size_t row_ndx) noexcept override;
+    void do_move_row(size_t from_row_ndx, size_t to_row_ndx) override;
+};
+
+} // namespace realm
+
+#endif // REALM_INDEX_FULLTEXT_HPP
@@ -0,0 +1,204 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+
+#include <realm/column.hpp>
+#include <realm/index_hash.hpp>
+#include <realm/table.hpp>
+
+using namespace realm;
+
+HashIndex::HashIndex(size_t col_ndx)
+    : AccessorIndex({col_ndx}) // Throws
+{
+}
+
+
+void HashIndex::do_build(const Table& table)
+{
+    const ColumnBase& column = _impl::TableFriend::get_column(table, get_columns()[0]);
+    size_t num_rows = column.size();
+
+    // At least as many buckets as rows, so that the expected number of rows
+    // with other values in a bucket is at most one
+    size_t num_buckets = 1;
+    while (num_buckets < num_rows)
+        num_buckets *= 2;
+    m_buckets.resize(num_buckets); // Throws
+    m_hashes.resize(num_rows);     // Throws
+
+    // Place the rows in their buckets in row order
+    StringIndex::StringConversionBuffer buffer;
+    for (size_t row = 0; row < num_rows; ++row) {
+        uint64_t h = hash(column.get_index_data(row, buffer));
+        m_hashes[row] = h;
+        get_bucket(h).push_back(row); // Throws
+    }
+    m_size = num_rows;
+}
+
+
+void HashIndex::do_clear() noexcept
+{
+    m_hashes.clear();
+    m_buckets.clear();
+    m_size = 0;
+}
+
+
+void HashIndex::grow()
+{
+    std::vector<std::vector<size_t>> buckets(std::max(m_buckets.size() * 2, size_t(1))); // Throws
+    m_buckets.swap(buckets);
+    for (const std::vector<size_t>& bucket : buckets) {
+        for (size_t row : bucket)
+            get_bucket(m_hashes[row]).push_back(row); // Throws
+    }
+
+    // Each new bucket takes rows from a single old bucket, so its rows are
+    // still in row order
+}
+
+
+void HashIndex::do_add_row(const Table& table, size_t row_ndx)
+{
+    if (m_size == m_buckets.size())
+        grow(); // Throws
+
+    const ColumnBase& column = _impl::TableFriend::get_column(table, get_columns()[0]);
+    StringIndex::StringConversionBuffer buffer;
+    uint64_t h = hash(column.get_index_data(row_ndx, buffer));
+    std::vector<size_t>& bucket = get_bucket(h);
+    bucket.insert(std::lower_bound(bucket.begin(), bucket.end(), row_ndx), row_ndx); // Throws
+    m_hashes[row_ndx] = h;
+    ++m_size;
+}
+
+
+void HashIndex::do_remove_row(size_t row_ndx) noexcept
+{
+    std::vector<size_t>& bucket = get_bucket(m_hashes[row_ndx]);
+    auto i = std::lower_bound(bucket.begin(), bucket.end(), row_ndx);
+    REALM_ASSERT(i != bucket.end() && *i == row_ndx);
+    bucket.erase(i);
+    --m_size;
+}
+
+
+template <class Func>
+void HashIndex::renumber(Func func) noexcept
+{
+    for (std::vector<size_t>& bucket : m_buckets) {
+        for (size_t& row : bucket)
+            row = func(row);
+    }
+}
+
+
+void HashIndex::do_insert_rows(size_t row_ndx, size_t num_rows)
+{
+    m_hashes.insert(m_hashes.begin() + row_ndx, num_rows, 0); // Throws
+
+    // Appending rows, which is the common case, leaves the other rows alone
+    if (row_ndx + num_rows < m_hashes.size())
+        renumber([=](size_t i) { return i < row_ndx ? i : i + num_rows; });
+}
+
+
+void HashIndex::do_erase_row(size_t row_ndx) noexcept
+{
+    m_hashes.erase(m_hashes.begin() + row_ndx);
+    if (row_ndx < m_hashes.size())
+        renumber([=](size_t i) { return i < row_ndx ? i : i - 1; });
+}
+
+
+void HashIndex::do_move_row(size_t from_row_ndx, size_t to_row_ndx)
+{
+    uint64_t h = m_hashes[from_row_ndx];
+    std::vector<size_t>& bucket = get_bucket(h);
+    bucket.erase(std::lower_bound(bucket.begin(), bucket.end(), from_row_ndx));
+    bucket.insert(std::lower_bound(bucket.begin(), bucket.end(), to_row_ndx), to_row_ndx); // Throws
+    m_hashes[to_row_ndx] = h;
+}
+
+
+uint64_t HashIndex::hash(StringData value) noexcept
+{
+    if (value.is_null())
+        return 0;
+
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < value.size(); ++i) {
+        h ^= static_cast<unsigned char>(value[i]);
+        h *= 1099511628211ULL;
+    }
+    // Zero is reserved for null
+    return h == 0 ? 1 : h;
+}
+
+
+template <class Handler>
+void HashIndex::for_each_match(const ColumnBase& column, StringData value, Handler handler) const
+{
+    if (m_buckets.empty())
+        return;
+    uint64_t h = hash(value);
+    const std::vector<size_t>& bucket = m_buckets[size_t(h & (m_buckets.size() - 1))];
+    StringIndex::StringConversionBuffer buffer;
+    for (size_t row : bucket) {
+        if (m_hashes[row] == h && column.get_index_data(row, buffer) == value) {
+            if (!handler(row))
+                return;
+        }
+    }
+}
+
+
+void HashIndex::find_all(const ColumnBase& column, StringData value, std::vector<size_t>& rows) const
+{
+    for_each_match(column, value, [&](size_t row) {
+        rows.push_back(row); // Throws
+        return true;
+    });
+}
+
+
+size_t HashIndex::find_first(const ColumnBase& column, StringData value, size_t begin) const noexcept
+{
+    size_t first = not_found;
+    for_each_match(column, value, [&](size_t row) {
+        if (row < begin)
+            return true;
+        first = row;
+        return false;
+    });
+    return first;
+}
+
+
+size_t HashIndex::count(const ColumnBase& column, StringData value) const noexcept
+{
+    size_t n = 0;
+    for_each_match(column, value, [&](size_t) {
+        ++n;
+        return true;
+    });
+    return n;
+}
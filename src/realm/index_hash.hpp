@@ -0,0 +1,127 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_HASH_HPP
+#define REALM_INDEX_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <realm/index_accessor.hpp>
+#include <realm/index_string.hpp>
+#include <realm/string_data.hpp>
+
+namespace realm {
+
+class ColumnBase;
+class Table;
+
+/// The rows of a column grouped by the hash of their values, for the column
+/// types that support a search index (string, int, bool, timestamp). A hash
+/// index only finds equal values, but it finds them with a single hash table
+/// probe, where StringIndex descends one level per 4 bytes of the value, which
+/// is slow for long values with common prefixes, such as URLs.
+///
+/// Values are compared in the form given by ColumnBase::get_index_data(), so
+/// lookups must be passed the column that the index is of.
+///
+/// The hash table grows as rows are added, and each row is moved between
+/// buckets as its value changes, so that a write costs a bucket update rather
+/// than a new table. Table::find_first_int() and the other lookups of the
+/// table use the index only once it has been built (see
+/// Table::add_hash_index()).
+class HashIndex : public AccessorIndex {
+public:
+    /// Create an empty index of the specified column.
+    explicit HashIndex(size_t col_ndx);
+
+    /// Append the rows where `column` has the specified value to `rows`, in
+    /// row order.
+    void find_all(const ColumnBase& column, StringData value, std::vector<size_t>& rows) const;
+    template <class T>
+    void find_all(const ColumnBase& column, T value, std::vector<size_t>& rows) const
+    {
+        StringIndex::StringConversionBuffer buffer;
+        find_all(column, to_str(value, buffer), rows); // Throws
+    }
+
+    /// The first row, at or after `begin`, where `column` has the specified
+    /// value, or `not_found`.
+    size_t find_first(const ColumnBase& column, StringData value, size_t begin = 0) const noexcept;
+    template <class T>
+    size_t find_first(const ColumnBase& column, T value, size_t begin = 0) const noexcept
+    {
+        StringIndex::StringConversionBuffer buffer;
+        return find_first(column, to_str(value, buffer), begin);
+    }
+
+    /// The number of rows where `column` has the specified value.
+    size_t count(const ColumnBase& column, StringData value) const noexcept;
+    template <class T>
+    size_t count(const ColumnBase& column, T value) const noexcept
+    {
+        StringIndex::StringConversionBuffer buffer;
+        return count(column, to_str(value, buffer));
+    }
+
+    /// The 64-bit FNV-1a hash of the specified value. Null has a hash
+    /// different from that of the empty string.
+    static uint64_t hash(StringData value) noexcept;
+
+private:
+    // The hash of the value of each row, by row index
+    std::vector<uint64_t> m_hashes;
+
+    // The rows whose hash `h` has `h & (m_buckets.size() - 1) == b` are in
+    // `m_buckets[b]`, in row order. The number of buckets is a power of two
+    // that is at least the number of rows in the buckets, unless there are
+    // none.
+    std::vector<std::vector<size_t>> m_buckets;
+    size_t m_size = 0;
+
+    std::vector<size_t>& get_bucket(uint64_t hash) noexcept
+    {
+        return m_buckets[size_t(hash & (m_buckets.size() - 1))];
+    }
+
+    // Double the number of buckets, or create the first one
+    void grow();
+
+    void do_build(const Table&) override;
+    void do_clear() noexcept override;
+    void do_add_row(const Table&, size_t row_ndx) override;
+    void do_remove_row(size_t row_ndx) noexcept override;
+    void do_insert_rows(size_t row_ndx, size_t num_rows) override;
+    void do_erase_row(size_t row_ndx) noexcept override;
+    void do_move_row(size_t from_row_ndx, size_t to_row_ndx) override;
+
+    // Replace every row `r` in the buckets with `func(r)`, which must keep
+    // the rows in the same order
+    template <class Func>
+    void renumber(Func func) noexcept;
+
+    // Call `handler(row)` for each row where `column` has `value`, in row
+    // order, until it returns false.
+    template <class Handler>
+    void for_each_match(const ColumnBase& column, StringData value, Handler handler) const;
+};
+
+} // namespace realm
+
+#endif // REALM_INDEX_HASH_HPP
@@ -0,0 +1,377 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <realm/index_ordered.hpp>
+#include <realm/table.hpp>
+
+using namespace realm;
+
+OrderedIndex::OrderedIndex(size_t col_ndx)
+    : AccessorIndex({col_ndx}) // Throws
+    , m_sorted(RowLess{&m_keys})
+{
+}
+
+
+OrderedIndex::Key OrderedIndex::to_key(double value) noexcept
+{
+    // Zero and negative zero are equal
+    if (value == 0)
+        value = 0;
+
+    // Flip the bits of negative values, and the sign bit of positive ones, so
+    // that the bit patterns have the same order as the values when read as
+    // unsigned integers. Then flip the sign bit to get the same order as
+    // signed integers.
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof bits);
+    const uint64_t sign = uint64_t(1) << 63;
+    bits = (bits & sign) ? ~bits : bits | sign;
+    return Key(int64_t(bits ^ sign), 0);
+}
+
+
+namespace {
+
+// The key of null (and of NaN in a composite index), and the smallest and the
+// largest key of a value
+const OrderedIndex::Key null_key(std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::min());
+const OrderedIndex::Key min_key(std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::min() + 1);
+const OrderedIndex::Key max_key(std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::max());
+
+// The key of NaN in an ordered index, which is never the key of a value
+const OrderedIndex::Key nan_key(std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min());
+
+} // anonymous namespace
+
+
+OrderedIndex::Key OrderedIndex::get_key(const Table& table, size_t col_ndx, size_t row_ndx) noexcept
+{
+    if (table.is_nullable(col_ndx) && table.is_null(col_ndx, row_ndx))
+        return null_key;
+    switch (table.get_column_type(col_ndx)) {
+        case type_Int:
+            return to_key(table.get_int(col_ndx, row_ndx));
+        case type_Timestamp:
+            return to_key(table.get_timestamp(col_ndx, row_ndx));
+        case type_Float: {
+            float value = table.get_float(col_ndx, row_ndx);
+            return is_null(value) ? nan_key : to_key(value);
+        }
+        case type_Double: {
+            double value = table.get_double(col_ndx, row_ndx);
+            return is_null(value) ? nan_key : to_key(value);
+        }
+        default:
+            break;
+    }
+    REALM_ASSERT(false);
+    return null_key;
+}
+
+
+void OrderedIndex::do_build(const Table& table)
+{
+    size_t col_ndx = get_columns()[0];
+    size_t num_rows = table.size();
+    m_keys.resize(num_rows); // Throws
+    std::vector<size_t> rows;
+    rows.reserve(num_rows); // Throws
+    for (size_t row = 0; row < num_rows; ++row) {
+        Key key = get_key(table, col_ndx, row);
+        m_keys[row] = key;
+        if (key == nan_key) {
+            ++m_num_nans;
+            continue;
+        }
+        if (key == null_key)
+            ++m_num_nulls;
+        rows.push_back(row);
+    }
+
+    // The rows were added in order, so a stable sort by key gives the order
+    // of RowLess
+    std::stable_sort(rows.begin(), rows.end(), [&](size_t a, size_t b) { return m_keys[a] < m_keys[b]; });
+    m_sorted.assign(rows); // Throws
+}
+
+
+void OrderedIndex::do_clear() noexcept
+{
+    m_keys.clear();
+    m_sorted.clear();
+    m_num_nulls = 0;
+    m_num_nans = 0;
+}
+
+
+void OrderedIndex::do_add_row(const Table& table, size_t row_ndx)
+{
+    Key key = get_key(table, get_columns()[0], row_ndx);
+    m_keys[row_ndx] = key;
+    if (key == nan_key) {
+        ++m_num_nans;
+        return;
+    }
+    m_sorted.insert(row_ndx); // Throws
+    if (key == null_key)
+        ++m_num_nulls;
+}
+
+
+void OrderedIndex::do_remove_row(size_t row_ndx) noexcept
+{
+    const Key& key = m_keys[row_ndx];
+    if (key == nan_key) {
+        --m_num_nans;
+        return;
+    }
+    m_sorted.erase(row_ndx);
+    if (key == null_key)
+        --m_num_nulls;
+}
+
+
+void OrderedIndex::do_insert_rows(size_t row_ndx, size_t num_rows)
+{
+    m_keys.insert(m_keys.begin() + row_ndx, num_rows, nan_key); // Throws
+
+    // Appending rows, which is the common case, leaves the other rows alone
+    if (row_ndx + num_rows < m_keys.size())
+        m_sorted.renumber([=](size_t i) { return i < row_ndx ? i : i + num_rows; });
+}
+
+
+void OrderedIndex::do_erase_row(size_t row_ndx) noexcept
+{
+    m_keys.erase(m_keys.begin() + row_ndx);
+    if (row_ndx < m_keys.size())
+        m_sorted.renumber([=](size_t i) { return i < row_ndx ? i : i - 1; });
+}
+
+
+void OrderedIndex::do_move_row(size_t from_row_ndx, size_t to_row_ndx)
+{
+    Key key = m_keys[from_row_ndx];
+    m_keys[to_row_ndx] = key;
+    if (key == nan_key)
+        return;
+    m_sorted.erase(from_row_ndx);
+    m_sorted.insert(to_row_ndx); // Throws
+}
+
+
+bool OrderedIndex::get_range(Equal, Key key, KeyRange& range) noexcept
+{
+    range = KeyRange{key, next(key)};
+    return true;
+}
+
+
+bool OrderedIndex::get_range(Less, Key key, KeyRange& range) noexcept
+{
+    range = KeyRange{min_key, key};
+    return true;
+}
+
+
+bool OrderedIndex::get_range(LessEqual, Key key, KeyRange& range) noexcept
+{
+    range = KeyRange{min_key, next(key)};
+    return true;
+}
+
+
+bool OrderedIndex::get_range(Greater, Key key, KeyRange& range) noexcept
+{
+    range = KeyRange{next(key), max_key};
+    return true;
+}
+
+
+bool OrderedIndex::get_range(GreaterEqual, Key key, KeyRange& range) noexcept
+{
+    range = KeyRange{key, max_key};
+    return true;
+}
+
+
+OrderedIndex::Rows::const_iterator OrderedIndex::lower_bound(Key key) const noexcept
+{
+    return m_sorted.partition_point([&](size_t row) { return m_keys[row] < key; });
+}
+
+
+void OrderedIndex::append_rows(Rows::const_iterator begin, Rows::const_iterator end, std::vector<size_t>& rows)
+{
+    for (auto i = begin; i != end; ++i)
+        rows.push_back(*i); // Throws
+}
+
+
+bool OrderedIndex::find(NotEqual, Key key, std::vector<size_t>& rows) const
+{
+    if (m_num_nans > 0)
+        return false;
+
+    // Null is not equal to any value, and nulls come first
+    append_rows(m_sorted.begin(), lower_bound(key), rows);     // Throws
+    append_rows(lower_bound(next(key)), m_sorted.end(), rows); // Throws
+    return true;
+}
+
+
+bool OrderedIndex::get_sorted_rows(bool ascending, std::vector<size_t>& rows) const
+{
+    if (m_num_nans > 0)
+        return false;
+
+    size_t begin = rows.size();
+    rows.reserve(begin + m_sorted.size()); // Throws
+    append_rows(m_sorted.begin(), m_sorted.end(), rows);
+    if (ascending)
+        return true;
+
+    // The nulls go last, and runs of equal values are reversed as a whole, so
+    // that rows with equal values stay in row order
+    auto first = rows.begin() + begin;
+    std::rotate(first, first + m_num_nulls, rows.end());
+    auto values_end = rows.end() - m_num_nulls;
+    std::reverse(first, values_end);
+    auto run = first;
+    while (run != values_end) {
+        auto run_end = run + 1;
+        while (run_end != values_end && m_keys[*run_end] == m_keys[*run])
+            ++run_end;
+        std::reverse(run, run_end);
+        run = run_end;
+    }
+    return true;
+}
+
+
+CompositeIndex::CompositeIndex(std::vector<size_t> col_ndxs)
+    : AccessorIndex(std::move(col_ndxs)) // Throws
+    , m_sorted(RowLess{this})
+{
+}
+
+
+void CompositeIndex::read_keys(const Table& table, size_t row_ndx) noexcept
+{
+    const std::vector<size_t>& col_ndxs = get_columns();
+    size_t num_cols = col_ndxs.size();
+    for (size_t i = 0; i < num_cols; ++i) {
+        // NaN matches no condition, just like null
+        Key key = OrderedIndex::get_key(table, col_ndxs[i], row_ndx);
+        m_keys[row_ndx * num_cols + i] = key == nan_key ? null_key : key;
+    }
+}
+
+
+void CompositeIndex::do_build(const Table& table)
+{
+    size_t num_rows = table.size();
+    m_keys.resize(num_rows * get_columns().size()); // Throws
+    std::vector<size_t> rows(num_rows);              // Throws
+    for (size_t row = 0; row < num_rows; ++row) {
+        read_keys(table, row);
+        rows[row] = row;
+    }
+    std::sort(rows.begin(), rows.end(), RowLess{this});
+    m_sorted.assign(rows); // Throws
+}
+
+
+void CompositeIndex::do_clear() noexcept
+{
+    m_keys.clear();
+    m_sorted.clear();
+}
+
+
+void CompositeIndex::do_add_row(const Table& table, size_t row_ndx)
+{
+    read_keys(table, row_ndx);
+    m_sorted.insert(row_ndx); // Throws
+}
+
+
+void CompositeIndex::do_remove_row(size_t row_ndx) noexcept
+{
+    m_sorted.erase(row_ndx);
+}
+
+
+void CompositeIndex::do_insert_rows(size_t row_ndx, size_t num_rows)
+{
+    size_t num_cols = get_columns().size();
+    m_keys.insert(m_keys.begin() + row_ndx * num_cols, num_rows * num_cols, null_key); // Throws
+
+    // Appending rows, which is the common case, leaves the other rows alone
+    if ((row_ndx + num_rows) * num_cols < m_keys.size())
+        m_sorted.renumber([=](size_t i) { return i < row_ndx ? i : i + num_rows; });
+}
+
+
+void CompositeIndex::do_erase_row(size_t row_ndx) noexcept
+{
+    size_t num_cols = get_columns().size();
+    auto begin = m_keys.begin() + row_ndx * num_cols;
+    m_keys.erase(begin, begin + num_cols);
+    if (row_ndx * num_cols < m_keys.size())
+        m_sorted.renumber([=](size_t i) { return i < row_ndx ? i : i - 1; });
+}
+
+
+void CompositeIndex::do_move_row(size_t from_row_ndx, size_t to_row_ndx)
+{
+    size_t num_cols = get_columns().size();
+    std::copy_n(&m_keys[from_row_ndx * num_cols], num_cols, &m_keys[to_row_ndx * num_cols]);
+    m_sorted.erase(from_row_ndx);
+    m_sorted.insert(to_row_ndx); // Throws
+}
+
+
+void CompositeIndex::find(const std::vector<KeyRange>& ranges, std::vector<size_t>& rows) const
+{
+    size_t num_cols = get_columns().size();
+    size_t prefix_size = ranges.size();
+    REALM_ASSERT(prefix_size > 0 && prefix_size <= num_cols);
+
+    // Whether the first `prefix_size` keys of row `r` are less than the
+    // beginning or the end of the ranges
+    auto key_less = [&](size_t r, bool end) {
+        const Key* keys = &m_keys[r * num_cols];
+        for (size_t i = 0; i < prefix_size; ++i) {
+            const Key& bound = end && i == prefix_size - 1 ? ranges[i].end : ranges[i].begin;
+            if (keys[i] != bound)
+                return keys[i] < bound;
+        }
+        return false;
+    };
+
+    auto begin = m_sorted.partition_point([&](size_t r) { return key_less(r, false); });
+    auto end = m_sorted.partition_point([&](size_t r) { return key_less(r, true); });
+    for (auto i = begin; i != end; ++i)
+        rows.push_back(*i); // Throws
+}
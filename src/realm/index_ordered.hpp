@@ -0,0 +1,284 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_ORDERED_HPP
+#define REALM_INDEX_ORDERED_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <realm/index_accessor.hpp>
+#include <realm/query_conditions.hpp>
+#include <realm/timestamp.hpp>
+#include <realm/util/optional.hpp>
+
+namespace realm {
+
+class Table;
+
+/// The rows of a column sorted by value, for columns of type int, timestamp,
+/// float and double. Unlike StringIndex, which can only find equal values, an
+/// ordered index finds the rows matching a range condition with a binary
+/// search, and lists the rows in sorted order.
+///
+/// The values are kept in blocks of sorted rows (see SortedRows), so that a
+/// row whose value changes is moved to its new place without sorting the
+/// column again. The table accessor keeps the index up to date with its rows
+/// (see AccessorIndex, and Table::add_ordered_index()).
+class OrderedIndex : public AccessorIndex {
+public:
+    // Values are compared as pairs of integers. Integers map to themselves,
+    // timestamps to their seconds and nanoseconds, and floating point values
+    // to integers that have the same order. The second element of the key of
+    // a value is never less than -999999999.
+    using Key = std::pair<int64_t, int64_t>;
+
+    /// The values matched by a condition, as the half-open range of keys
+    /// `[begin, end)`.
+    struct KeyRange {
+        Key begin;
+        Key end;
+
+        /// Whether the range matches a single value.
+        bool is_single() const noexcept
+        {
+            return end == next(begin);
+        }
+    };
+
+    /// Create an empty index of the specified column.
+    explicit OrderedIndex(size_t col_ndx);
+
+    /// Get the range of keys of the values `v` that satisfy `Cond()(v,
+    /// value)`. Returns false if `Cond` is not one of Equal, Less, LessEqual,
+    /// Greater and GreaterEqual, or if `value` is null or NaN.
+    template <class Cond, class T>
+    static bool get_range(T value, KeyRange& range) noexcept
+    {
+        if (is_null(value))
+            return false;
+        return get_range(Cond(), to_key(value), range);
+    }
+
+    /// Append the rows whose value `v` satisfies `Cond()(v, value)` to `rows`,
+    /// in the order of their values. Returns false, without appending
+    /// anything, if `Cond` is not one of Equal, NotEqual, Less, LessEqual,
+    /// Greater and GreaterEqual, if `value` is null or NaN, or if `Cond` is
+    /// NotEqual and the column has NaN values.
+    template <class Cond, class T>
+    bool find(T value, std::vector<size_t>& rows) const
+    {
+        if (is_null(value))
+            return false;
+        return find(Cond(), to_key(value), rows);
+    }
+
+    /// Append all rows to `rows` in the same order as a stable sort of the
+    /// column would give them, that is, with nulls first when ascending and
+    /// last when descending, and rows with equal values in row order. Returns
+    /// false, without appending anything, if the column has NaN values, which
+    /// have no well defined order.
+    bool get_sorted_rows(bool ascending, std::vector<size_t>& rows) const;
+
+    /// Number of rows with a value other than null and NaN.
+    size_t size() const noexcept
+    {
+        return m_sorted.size() - m_num_nulls;
+    }
+
+private:
+    // Orders rows by key, then by row index
+    struct RowLess {
+        const std::vector<Key>* m_keys;
+        bool operator()(size_t a, size_t b) const noexcept
+        {
+            const Key& key_a = (*m_keys)[a];
+            const Key& key_b = (*m_keys)[b];
+            return key_a < key_b || (key_a == key_b && a < b);
+        }
+    };
+    using Rows = SortedRows<RowLess>;
+
+    static Key to_key(int64_t value) noexcept
+    {
+        return Key(value, 0);
+    }
+    static Key to_key(Timestamp value) noexcept
+    {
+        return Key(value.get_seconds(), value.get_nanoseconds());
+    }
+    static Key to_key(double value) noexcept;
+    static Key to_key(float value) noexcept
+    {
+        return to_key(double(value));
+    }
+    template <class T>
+    static Key to_key(const util::Optional<T>& value) noexcept
+    {
+        return to_key(*value);
+    }
+
+    // The smallest key that is greater than `key`
+    static Key next(Key key) noexcept
+    {
+        return Key(key.first, key.second + 1);
+    }
+
+    template <class T>
+    static bool is_null(const T&) noexcept
+    {
+        return false;
+    }
+    template <class T>
+    static bool is_null(const util::Optional<T>& value) noexcept
+    {
+        return !value;
+    }
+    static bool is_null(Timestamp value) noexcept
+    {
+        return value.is_null();
+    }
+    static bool is_null(float value) noexcept
+    {
+        return value != value;
+    }
+    static bool is_null(double value) noexcept
+    {
+        return value != value;
+    }
+
+    // The key of the value of the specified row, which is the null key for
+    // null, and the NaN key for NaN
+    static Key get_key(const Table& table, size_t col_ndx, size_t row_ndx) noexcept;
+
+    static bool get_range(Equal, Key key, KeyRange& range) noexcept;
+    static bool get_range(Less, Key key, KeyRange& range) noexcept;
+    static bool get_range(LessEqual, Key key, KeyRange& range) noexcept;
+    static bool get_range(Greater, Key key, KeyRange& range) noexcept;
+    static bool get_range(GreaterEqual, Key key, KeyRange& range) noexcept;
+    template <class Cond>
+    static bool get_range(Cond, Key, KeyRange&) noexcept
+    {
+        return false;
+    }
+
+    // The first row in m_sorted whose key is not less than `key`
+    Rows::const_iterator lower_bound(Key key) const noexcept;
+
+    bool find(NotEqual, Key key, std::vector<size_t>& rows) const;
+    template <class Cond>
+    bool find(Cond cond, Key key, std::vector<size_t>& rows) const
+    {
+        KeyRange range;
+        if (!get_range(cond, key, range))
+            return false;
+        append_rows(lower_bound(range.begin), lower_bound(range.end), rows); // Throws
+        return true;
+    }
+
+    static void append_rows(Rows::const_iterator begin, Rows::const_iterator end, std::vector<size_t>& rows);
+
+    void do_build(const Table&) override;
+    void do_clear() noexcept override;
+    void do_add_row(const Table&, size_t row_ndx) override;
+    void do_remove_row(size_t row_ndx) noexcept override;
+    void do_insert_rows(size_t row_ndx, size_t num_rows) override;
+    void do_erase_row(size_t row_ndx) noexcept override;
+    void do_move_row(size_t from_row_ndx, size_t to_row_ndx) override;
+
+    // The key of each row, by row index. Rows with NaN values are not in
+    // m_sorted, and rows with null values come first in it.
+    std::vector<Key> m_keys;
+    Rows m_sorted;
+    size_t m_num_nulls = 0;
+    size_t m_num_nans = 0;
+
+    friend class CompositeIndex;
+};
+
+
+/// The rows of a table sorted by the values of several columns, each of type
+/// int, timestamp, float or double, first by the first column, then by the
+/// second, and so on. A composite index finds the rows matching conditions of
+/// equality on a prefix of its columns, and an optional range condition on
+/// the column that follows the prefix, with a binary search.
+///
+/// The columns of a composite index are recorded in the spec of the table,
+/// while the sorted rows are kept in memory by the table accessor, which
+/// moves a row to its new place when one of its values changes (see
+/// AccessorIndex, and Table::add_composite_index()).
+class CompositeIndex : public AccessorIndex {
+public:
+    using Key = OrderedIndex::Key;
+    using KeyRange = OrderedIndex::KeyRange;
+
+    /// Create an empty index of the specified columns.
+    explicit CompositeIndex(std::vector<size_t> col_ndxs);
+
+    /// Append the rows whose values in the first `ranges.size()` columns of
+    /// the index are in the corresponding ranges to `rows`. All ranges but the
+    /// last must match a single value (see KeyRange::is_single()). The rows
+    /// are appended in the order of their values.
+    void find(const std::vector<KeyRange>& ranges, std::vector<size_t>& rows) const;
+
+    size_t size() const noexcept
+    {
+        return m_sorted.size();
+    }
+
+private:
+    // Orders rows by their keys, column by column, then by row index
+    struct RowLess {
+        const CompositeIndex* m_index;
+        bool operator()(size_t a, size_t b) const noexcept
+        {
+            size_t num_cols = m_index->get_columns().size();
+            const Key* keys_a = &m_index->m_keys[a * num_cols];
+            const Key* keys_b = &m_index->m_keys[b * num_cols];
+            for (size_t i = 0; i < num_cols; ++i) {
+                if (keys_a[i] != keys_b[i])
+                    return keys_a[i] < keys_b[i];
+            }
+            return a < b;
+        }
+    };
+    using Rows = SortedRows<RowLess>;
+
+    // Read the keys of the specified row from `table` into m_keys
+    void read_keys(const Table& table, size_t row_ndx) noexcept;
+
+    void do_build(const Table&) override;
+    void do_clear() noexcept override;
+    void do_add_row(const Table&, size_t row_ndx) override;
+    void do_remove_row(size_t row_ndx) noexcept override;
+    void do_insert_rows(size_t row_ndx, size_t num_rows) override;
+    void do_erase_row(size_t row_ndx) noexcept override;
+    void do_move_row(size_t from_row_ndx, size_t to_row_ndx) override;
+
+    // The key of the value of column `i` of row `r` is at `m_keys[r *
+    // get_columns().size() + i]`. Null and NaN, which match no condition, are
+    // given a key that is less than the key of any value.
+    std::vector<Key> m_keys;
+    Rows m_sorted;
+};
+
+} // namespace realm
+
+#endif // REALM_INDEX_ORDERED_HPP
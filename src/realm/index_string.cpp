@@ -16,8 +16,10 @@
  *
  **************************************************************************/
 
+#include <algorithm>
 #include <cstdio>
 #include <iomanip>
+#include <vector>
 
 #ifdef REALM_DEBUG
 #include <iostream>
@@ -376,6 +378,133 @@ void StringIndex::insert_with_offset(size_t row_ndx, StringData value, size_t of
     TreeInsert(row_ndx, key, offset, value); // Throws
 }
 
+void StringIndex::populate()
+{
+    REALM_ASSERT(is_empty());
+
+    size_t num_rows = m_target_column->size();
+    if (num_rows == 0)
+        return;
+
+    // Sort the rows in the order of the index, that is, by the keys of their
+    // values at increasing offsets, then, beyond s_max_offset, by value as in
+    // the lists of the index, and rows with equal values by row number. The
+    // first key decides most comparisons, so it is computed up front.
+    struct Entry {
+        key_type key;
+        size_t row;
+    };
+    std::vector<Entry> entries;
+    entries.reserve(num_rows); // Throws
+    StringConversionBuffer buffer, buffer_2;
+    for (size_t row = 0; row < num_rows; ++row)
+        entries.push_back(Entry{create_key(get(row, buffer), 0), row}); // Throws
+    auto less = [&](const Entry& a, const Entry& b) {
+        if (a.key != b.key)
+            return a.key < b.key;
+        StringData value = get(a.row, buffer);
+        StringData value_2 = get(b.row, buffer_2);
+        if (value == value_2)
+            return a.row < b.row;
+        for (size_t offset = s_index_key_length; offset <= s_max_offset; offset += s_index_key_length) {
+            key_type key = create_key(value, offset);
+            key_type key_2 = create_key(value_2, offset);
+            if (key != key_2)
+                return key < key_2;
+        }
+        if (value.is_null() || value_2.is_null())
+            return value.is_null();
+        return value < value_2;
+    };
+    std::sort(entries.begin(), entries.end(), less); // Throws
+
+    // Equal values are now adjacent
+    if (m_deny_duplicate_values) {
+        for (size_t i = 1; i < num_rows; ++i) {
+            if (entries[i - 1].key == entries[i].key &&
+                get(entries[i - 1].row, buffer) == get(entries[i].row, buffer_2))
+                throw LogicError(LogicError::unique_constraint_violation);
+        }
+    }
+
+    std::vector<size_t> rows(num_rows); // Throws
+    for (size_t i = 0; i < num_rows; ++i)
+        rows[i] = entries[i].row;
+    entries = std::vector<Entry>();
+    ref_type ref = build_tree(rows.data(), rows.data() + num_rows, 0); // Throws
+
+    // Replace the empty root
+    m_array->destroy_deep();
+    m_array->init_from_ref(ref);
+    m_array->update_parent();
+}
+
+
+ref_type StringIndex::build_tree(const size_t* begin, const size_t* end, size_t offset)
+{
+    Allocator& alloc = m_array->get_alloc();
+    size_t suboffset = offset + s_index_key_length;
+
+    // The keys of the entries of the leaves, and for each key, either a
+    // literal row number, or the ref of a list of rows or of a sub-index, as
+    // leaf_insert() would have stored them
+    std::vector<std::pair<key_type, int_fast64_t>> entries;
+    StringConversionBuffer buffer, buffer_2;
+    const size_t* i = begin;
+    while (i != end) {
+        StringData value = get(*i, buffer);
+        key_type key = create_key(value, offset);
+        const size_t* j = i + 1;
+        while (j != end && create_key(get(*j, buffer_2), offset) == key)
+            ++j;
+
+        int_fast64_t slot_value;
+        if (j - i == 1) {
+            slot_value = int_fast64_t((uint64_t(*i) << 1) + 1); // shift to indicate literal
+        }
+        else if (suboffset > s_max_offset || get(*(j - 1), buffer_2) == value) {
+            // Equal values, or values with a common prefix that is too long
+            // to recurse on, go in a list in sorted order
+            IntegerColumn list(alloc, IntegerColumn::create(alloc)); // Throws
+            for (const size_t* k = i; k != j; ++k)
+                list.add(*k); // Throws
+            slot_value = int_fast64_t(list.get_ref());
+        }
+        else {
+            slot_value = int_fast64_t(build_tree(i, j, suboffset)); // Throws
+        }
+        entries.emplace_back(key, slot_value); // Throws
+        i = j;
+    }
+
+    // Build the leaves, then the inner nodes one level at a time, spreading
+    // the entries evenly over as few nodes as possible. The key of a child of
+    // an inner node is the last key of the child.
+    std::vector<std::pair<key_type, int_fast64_t>> nodes;
+    bool is_leaf = true;
+    for (;;) {
+        size_t num_entries = entries.size();
+        size_t num_nodes = std::max<size_t>((num_entries + REALM_MAX_BPNODE_SIZE - 1) / REALM_MAX_BPNODE_SIZE, 1);
+        for (size_t n = 0; n < num_nodes; ++n) {
+            std::unique_ptr<IndexArray> node(create_node(alloc, is_leaf)); // Throws
+            Array keys(alloc);
+            get_child(*node, 0, keys);
+            size_t entries_begin = n * num_entries / num_nodes;
+            size_t entries_end = (n + 1) * num_entries / num_nodes;
+            for (size_t e = entries_begin; e < entries_end; ++e) {
+                keys.add(entries[e].first);   // Throws
+                node->add(entries[e].second); // Throws
+            }
+            if (num_nodes == 1)
+                return node->get_ref();
+            nodes.emplace_back(entries[entries_end - 1].first, int_fast64_t(node->get_ref())); // Throws
+        }
+        entries.swap(nodes);
+        nodes.clear();
+        is_leaf = false;
+    }
+}
+
 void StringIndex::insert_to_existing_list_at_lower(size_t row, StringData value, IntegerColumn& list,
                                                    const IntegerColumnIterator& lower)
 {
@@ -120,6 +120,14 @@ public:
 
     bool is_empty() const;
 
+    /// Add all rows of the target column to the index, which must be empty.
+    /// The rows are sorted by value first, and the nodes of the index are
+    /// then built bottom-up, which is much faster than inserting the rows one
+    /// by one. Throws LogicError::unique_constraint_violation, leaving the
+    /// index empty, if duplicate values are not allowed and the column has
+    /// any.
+    void populate();
+
     template <class T>
     void insert(size_t row_ndx, T value, size_t num_rows, bool is_append);
     template <class T>
@@ -205,6 +213,10 @@ private:
     static IndexArray* create_node(Allocator&, bool is_leaf);
 
     void insert_with_offset(size_t row_ndx, StringData value, size_t offset);
+    // Build the nodes for the rows `[begin, end)`, which are sorted as
+    // populate() sorts them, and whose values have equal keys at every offset
+    // before `offset`. Returns the ref of the root node.
+    ref_type build_tree(const size_t* begin, const size_t* end, size_t offset);
     void insert_row_list(size_t ref, size_t offset, StringData value);
     void insert_to_existing_list(size_t row, StringData value, IntegerColumn& list);
     void insert_to_existing_list_at_lower(size_t row, StringData value, IntegerColumn& list,
@@ -0,0 +1,132 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+#include <iterator>
+
+#include <realm/index_trigram.hpp>
+#include <realm/table.hpp>
+
+using namespace realm;
+
+namespace {
+
+uint32_t fold(char c) noexcept
+{
+    unsigned char b = static_cast<unsigned char>(c);
+    return b >= 'A' && b <= 'Z' ? b + ('a' - 'A') : b;
+}
+
+} // anonymous namespace
+
+
+TrigramIndex::TrigramIndex(size_t col_ndx)
+    : AccessorIndex({col_ndx}) // Throws
+{
+}
+
+
+void TrigramIndex::do_build(const Table& table)
+{
+    size_t num_rows = table.size();
+    m_lists.insert_rows(0, num_rows); // Throws
+    for (size_t row_ndx = 0; row_ndx < num_rows; ++row_ndx)
+        do_add_row(table, row_ndx); // Throws
+}
+
+
+void TrigramIndex::do_clear() noexcept
+{
+    m_lists.clear();
+}
+
+
+void TrigramIndex::do_add_row(const Table& table, size_t row_ndx)
+{
+    std::vector<uint32_t> trigrams;
+    get_trigrams(table.get_string(get_columns()[0], row_ndx), trigrams); // Throws
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    m_lists.add_row(row_ndx, std::move(trigrams)); // Throws
+}
+
+
+void TrigramIndex::do_remove_row(size_t row_ndx) noexcept
+{
+    m_lists.remove_row(row_ndx);
+}
+
+
+void TrigramIndex::do_insert_rows(size_t row_ndx, size_t num_rows)
+{
+    m_lists.insert_rows(row_ndx, num_rows); // Throws
+}
+
+
+void TrigramIndex::do_erase_row(size_t row_ndx) noexcept
+{
+    m_lists.erase_row(row_ndx);
+}
+
+
+void TrigramIndex::do_move_row(size_t from_row_ndx, size_t to_row_ndx)
+{
+    m_lists.move_row(from_row_ndx, to_row_ndx); // Throws
+}
+
+
+void TrigramIndex::get_trigrams(StringData value, std::vector<uint32_t>& trigrams)
+{
+    for (size_t i = 0; i + 3 <= value.size(); ++i)
+        trigrams.push_back(fold(value[i]) << 16 | fold(value[i + 1]) << 8 | fold(value[i + 2])); // Throws
+}
+
+
+bool TrigramIndex::find_candidates(const std::vector<StringData>& substrings, std::vector<size_t>& rows) const
+{
+    std::vector<uint32_t> trigrams;
+    for (StringData substring : substrings)
+        get_trigrams(substring, trigrams); // Throws
+    if (trigrams.empty())
+        return false;
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    // The lists of rows of the trigrams, shortest first
+    std::vector<const std::vector<size_t>*> lists;
+    for (uint32_t trigram : trigrams) {
+        const std::vector<size_t>* list = m_lists.find(trigram);
+        if (!list)
+            return true; // No row has this trigram
+        lists.push_back(list); // Throws
+    }
+    std::sort(lists.begin(), lists.end(), [](const std::vector<size_t>* a, const std::vector<size_t>* b) {
+        return a->size() < b->size();
+    });
+
+    std::vector<size_t> candidates(*lists[0]); // Throws
+    std::vector<size_t> next;
+    for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+        next.clear();
+        std::set_intersection(candidates.begin(), candidates.end(), lists[i]->begin(), lists[i]->end(),
+                              std::back_inserter(next)); // Throws
+        candidates.swap(next);
+    }
+    rows.insert(rows.end(), candidates.begin(), candidates.end()); // Throws
+    return true;
+}
@@ -0,0 +1,80 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_TRIGRAM_HPP
+#define REALM_INDEX_TRIGRAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <realm/index_accessor.hpp>
+#include <realm/string_data.hpp>
+
+namespace realm {
+
+class Table;
+
+/// The rows of a string column listed by the sequences of three bytes
+/// (trigrams) that occur in their values. A trigram index finds the rows that
+/// may contain a substring by intersecting the lists of the trigrams of the
+/// substring, so that substring conditions (contains, begins with, ends with,
+/// like) only need to check those rows instead of every row.
+///
+/// Trigrams are taken after mapping ASCII letters to lower case, so the same
+/// index serves case sensitive and case insensitive conditions.
+///
+/// Each row remembers its trigrams, so when its value changes, only the lists
+/// of the trigrams of its old and new value are updated (see PostingLists).
+class TrigramIndex : public AccessorIndex {
+public:
+    /// Create an empty index of the specified string column.
+    explicit TrigramIndex(size_t col_ndx);
+
+    /// Append to `rows`, in row order, every row whose value contains each of
+    /// `substrings`, ignoring the case of ASCII letters. Other rows may be
+    /// appended too, so the rows are only candidates that must be checked
+    /// against the actual condition. Returns false, without appending
+    /// anything, if none of the substrings is at least three bytes long, in
+    /// which case every row is a candidate.
+    bool find_candidates(const std::vector<StringData>& substrings, std::vector<size_t>& rows) const;
+
+    /// Number of distinct trigrams in the column.
+    size_t size() const noexcept
+    {
+        return m_lists.size();
+    }
+
+private:
+    PostingLists<uint32_t> m_lists;
+
+    // Append the trigrams of `value` to `trigrams`
+    static void get_trigrams(StringData value, std::vector<uint32_t>& trigrams);
+
+    void do_build(const Table&) override;
+    void do_clear() noexcept override;
+    void do_add_row(const Table&, size_t row_ndx) override;
+    void do_remove_row(size_t row_ndx) noexcept override;
+    void do_insert_rows(size_t row_ndx, size_t num_rows) override;
+    void do_erase_row(size_t row_ndx) noexcept override;
+    void do_move_row(size_t from_row_ndx, size_t to_row_ndx) override;
+};
+
+} // namespace realm
+
+#endif // REALM_INDEX_TRIGRAM_HPP
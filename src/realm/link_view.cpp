@@ -310,13 +310,13 @@ void LinkView::sort(size_t column_index, bool ascending)
 }
 
 
-void LinkView::sort(const SortDescriptor& order)
+void LinkView::sort(const SortDescriptor& order, util::ThreadPool* pool)
 {
     if (Replication* repl = get_repl()) {
         // todo, write to the replication log that we're doing a sort
         repl->set_link_list(*this, m_row_indexes); // Throws
     }
-    do_sort(order, {});
+    do_sort(order, {}, size_t(-1), pool);
 }
 
 TableView LinkView::get_sorted_view(SortDescriptor order) const
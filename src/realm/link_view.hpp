@@ -78,7 +78,9 @@ public:
     void clear();
 
     void sort(size_t column, bool ascending = true);
-    void sort(const SortDescriptor& order);
+    /// If `pool` is not null, large link lists are sorted on its threads (see
+    /// TableViewBase::set_thread_pool()).
+    void sort(const SortDescriptor& order, util::ThreadPool* pool = nullptr);
 
     TableView get_sorted_view(size_t column_index, bool ascending = true) const;
     TableView get_sorted_view(SortDescriptor order) const;
@@ -0,0 +1,258 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+
+#include <realm/exceptions.hpp>
+#include <realm/materialized_aggregate.hpp>
+
+using namespace realm;
+
+MaterializedAggregate::MaterializedAggregate(Query& query, Table::AggrType type, size_t column_ndx)
+    : m_type(type)
+    , m_column_ndx(column_ndx)
+    , m_column_type(type_Int)
+{
+    const Table& table = *query.get_table();
+    if (REALM_UNLIKELY(column_ndx >= table.get_column_count()))
+        throw LogicError(LogicError::column_index_out_of_range);
+    if (type != Table::aggr_count) {
+        m_column_type = table.get_column_type(column_ndx);
+        if (REALM_UNLIKELY(m_column_type != type_Int && m_column_type != type_Float &&
+                           m_column_type != type_Double))
+            throw LogicError(LogicError::type_mismatch);
+    }
+
+    m_view = query.find_all(); // Throws
+    if (m_type == Table::aggr_count)
+        return;
+    if (is_int()) {
+        compute(m_ints); // Throws
+    }
+    else {
+        compute(m_doubles); // Throws
+    }
+}
+
+
+void MaterializedAggregate::sync_if_needed()
+{
+    if (m_view.is_in_sync())
+        return;
+
+    // A count is the size of the view
+    if (m_type == Table::aggr_count) {
+        m_view.sync_if_needed(); // Throws
+        return;
+    }
+
+    // The rows of the view before it is synchronized, where the values are
+    // taken out of the result
+    std::vector<int64_t> old_rows;
+    std::vector<size_t> changed_rows;
+    if (m_view.m_row_changes_tracked) {
+        old_rows.reserve(m_view.m_row_indexes.size()); // Throws
+        for (size_t i = 0; i < m_view.m_row_indexes.size(); ++i)
+            old_rows.push_back(m_view.m_row_indexes.get(i));
+        if (m_view.do_sync_changed_rows(&changed_rows)) { // Throws
+            if (is_int()) {
+                apply_changes(m_ints, old_rows, changed_rows); // Throws
+            }
+            else {
+                apply_changes(m_doubles, old_rows, changed_rows); // Throws
+            }
+            return;
+        }
+    }
+
+    m_view.do_sync(); // Throws
+    if (is_int()) {
+        compute(m_ints); // Throws
+    }
+    else {
+        compute(m_doubles); // Throws
+    }
+}
+
+
+int64_t MaterializedAggregate::get_int()
+{
+    sync_if_needed(); // Throws
+    switch (m_type) {
+        case Table::aggr_count:
+            return int64_t(m_view.size());
+        case Table::aggr_sum:
+            return is_int() ? m_ints.sum : int64_t(m_doubles.sum);
+        case Table::aggr_avg:
+            return int64_t(get_double());
+        case Table::aggr_min:
+        case Table::aggr_max:
+            if (m_num_values == 0)
+                return 0;
+            return is_int() ? m_ints.extreme : int64_t(m_doubles.extreme);
+    }
+    REALM_UNREACHABLE();
+}
+
+
+double MaterializedAggregate::get_double()
+{
+    sync_if_needed(); // Throws
+    switch (m_type) {
+        case Table::aggr_count:
+            return double(m_view.size());
+        case Table::aggr_sum:
+            return is_int() ? double(m_ints.sum) : m_doubles.sum;
+        case Table::aggr_avg:
+            if (m_num_values == 0)
+                return 0;
+            return (is_int() ? double(m_ints.sum) : m_doubles.sum) / m_num_values;
+        case Table::aggr_min:
+        case Table::aggr_max:
+            if (m_num_values == 0)
+                return 0;
+            return is_int() ? double(m_ints.extreme) : m_doubles.extreme;
+    }
+    REALM_UNREACHABLE();
+}
+
+
+size_t MaterializedAggregate::get_value_count()
+{
+    sync_if_needed(); // Throws
+    return m_type == Table::aggr_count ? m_view.size() : m_num_values;
+}
+
+
+namespace realm {
+
+template <>
+util::Optional<int64_t> MaterializedAggregate::get_value<int64_t>(size_t row_ndx) const
+{
+    const Table& table = m_view.get_parent();
+    if (table.is_null(m_column_ndx, row_ndx))
+        return util::none;
+    return table.get_int(m_column_ndx, row_ndx);
+}
+
+template <>
+util::Optional<double> MaterializedAggregate::get_value<double>(size_t row_ndx) const
+{
+    const Table& table = m_view.get_parent();
+    if (table.is_null(m_column_ndx, row_ndx))
+        return util::none;
+    if (m_column_type == type_Float)
+        return double(table.get_float(m_column_ndx, row_ndx));
+    return table.get_double(m_column_ndx, row_ndx);
+}
+
+} // namespace realm
+
+
+template <class T>
+void MaterializedAggregate::compute(Values<T>& v)
+{
+    v.values.clear();
+    v.values.reserve(m_view.m_row_indexes.size()); // Throws
+    v.sum = 0;
+    m_num_values = 0;
+    for (size_t i = 0; i < m_view.m_row_indexes.size(); ++i) {
+        util::Optional<T> value = get_value<T>(size_t(m_view.m_row_indexes.get(i)));
+        v.values.push_back(value);
+        if (value) {
+            v.sum += *value;
+            ++m_num_values;
+        }
+    }
+    if (is_extreme())
+        find_extreme(v);
+}
+
+
+template <class T>
+void MaterializedAggregate::apply_changes(Values<T>& v, const std::vector<int64_t>& old_rows,
+                                          const std::vector<size_t>& changed_rows)
+{
+    bool is_max = m_type == Table::aggr_max;
+    bool extreme_lost = false;
+
+    // Take the values of the rows that were removed or changed out of the
+    // result. The values of the other rows are kept in view order.
+    std::vector<util::Optional<T>> kept_values;
+    kept_values.reserve(old_rows.size()); // Throws
+    for (size_t i = 0; i < old_rows.size(); ++i) {
+        int64_t row_ndx = old_rows[i];
+        const util::Optional<T>& value = v.values[i];
+        if (row_ndx != detached_ref &&
+            !std::binary_search(changed_rows.begin(), changed_rows.end(), size_t(row_ndx))) {
+            kept_values.push_back(value);
+            continue;
+        }
+        if (value) {
+            v.sum -= *value;
+            --m_num_values;
+            if (*value == v.extreme)
+                extreme_lost = true;
+        }
+    }
+
+    // Put the values of the changed rows that match into the result. The view
+    // keeps its unchanged rows in the same order, so they get their values
+    // back in turn.
+    std::vector<util::Optional<T>> values;
+    values.reserve(m_view.m_row_indexes.size()); // Throws
+    auto kept = kept_values.begin();
+    for (size_t i = 0; i < m_view.m_row_indexes.size(); ++i) {
+        size_t row_ndx = size_t(m_view.m_row_indexes.get(i));
+        if (!std::binary_search(changed_rows.begin(), changed_rows.end(), row_ndx)) {
+            REALM_ASSERT_DEBUG(kept != kept_values.end());
+            values.push_back(*kept++);
+            continue;
+        }
+        util::Optional<T> value = get_value<T>(row_ndx);
+        values.push_back(value);
+        if (value) {
+            v.sum += *value;
+            if (m_num_values++ == 0 || !(is_max ? *value < v.extreme : *value > v.extreme)) {
+                v.extreme = *value;
+                extreme_lost = false;
+            }
+        }
+    }
+    REALM_ASSERT_DEBUG(kept == kept_values.end());
+    v.values.swap(values);
+
+    // A new value that is at least as extreme as the lost one takes its place,
+    // otherwise the extreme must be found among all the values
+    if (is_extreme() && extreme_lost)
+        find_extreme(v);
+}
+
+
+template <class T>
+void MaterializedAggregate::find_extreme(Values<T>& v) const noexcept
+{
+    bool is_max = m_type == Table::aggr_max;
+    bool found = false;
+    for (const util::Optional<T>& value : v.values) {
+        if (value && (!found || (is_max ? *value > v.extreme : *value < v.extreme))) {
+            v.extreme = *value;
+            found = true;
+        }
+    }
+}
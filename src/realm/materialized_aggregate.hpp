@@ -0,0 +1,150 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_MATERIALIZED_AGGREGATE_HPP
+#define REALM_MATERIALIZED_AGGREGATE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <realm/query.hpp>
+#include <realm/table.hpp>
+#include <realm/table_view.hpp>
+#include <realm/util/optional.hpp>
+
+namespace realm {
+
+/// An aggregate of a column over the rows that match a query, which is kept
+/// up to date as the table changes, instead of being computed again from all
+/// the matching rows every time it is read.
+///
+/// The aggregate follows its table through local modifications as well as
+/// through the changes of other transactions that are applied by
+/// SharedGroup::advance_read() and friends. When the aggregate is read after
+/// such changes, only the rows that were inserted, removed or modified are
+/// checked against the query, and their old and new values are taken out of
+/// and put into the result. The result is computed again from the matching
+/// rows only when the change cannot be applied that way: for the minimum and
+/// maximum when a row that held the current extreme leaves the query or gets a
+/// different value, and when a query cannot be checked row by row or too many
+/// rows have changed (see TableViewBase::sync_if_needed()).
+///
+/// The value of each matching row is kept by the aggregate, so it uses about
+/// as much memory as a TableView of the query plus one value per row.
+///
+/// Sums of float and double columns are updated by adding and subtracting the
+/// changed values, so they may differ from a sum computed by Query in the last
+/// bits.
+class MaterializedAggregate {
+public:
+    MaterializedAggregate();
+
+    /// Aggregate the specified column of the rows that match `query`. A count
+    /// (Table::aggr_count) is the number of matching rows, and ignores
+    /// `column_ndx`. Other aggregates require an int, float or double column,
+    /// and skip null values.
+    MaterializedAggregate(Query& query, Table::AggrType type, size_t column_ndx);
+
+    bool is_attached() const noexcept;
+
+    /// Whether the result accounts for every change of the table. The result
+    /// is updated by get_int(), get_double(), get_value_count() and
+    /// sync_if_needed().
+    bool is_in_sync() const;
+
+    void sync_if_needed();
+
+    /// The result as an integer. This is exact for the count, and for the sum,
+    /// minimum and maximum of an int column.
+    int64_t get_int();
+
+    /// The result as a double. This is exact for the average, and for the sum,
+    /// minimum and maximum of a float or double column. The average, minimum
+    /// and maximum of no values are zero.
+    double get_double();
+
+    /// The number of values that the aggregate is computed from, which is the
+    /// number of matching rows for a count, and otherwise the number of
+    /// matching rows where the column is not null.
+    size_t get_value_count();
+
+private:
+    // The values of the rows of m_view, in the same order, and what the
+    // aggregate needs to know of them
+    template <class T>
+    struct Values {
+        std::vector<util::Optional<T>> values;
+        T sum = 0;
+        T extreme = 0; // Minimum or maximum, if m_num_values > 0
+    };
+
+    Table::AggrType m_type;
+    size_t m_column_ndx;
+    DataType m_column_type;
+    TableView m_view;
+    size_t m_num_values = 0;
+    Values<int64_t> m_ints;
+    Values<double> m_doubles;
+
+    bool is_int() const noexcept;
+    bool is_extreme() const noexcept;
+
+    template <class T>
+    util::Optional<T> get_value(size_t row_ndx) const;
+    template <class T>
+    void compute(Values<T>&);
+    template <class T>
+    void apply_changes(Values<T>&, const std::vector<int64_t>& old_rows, const std::vector<size_t>& changed_rows);
+    template <class T>
+    void find_extreme(Values<T>&) const noexcept;
+};
+
+
+// Implementation:
+
+inline MaterializedAggregate::MaterializedAggregate()
+    : m_type(Table::aggr_count)
+    , m_column_ndx(0)
+    , m_column_type(type_Int)
+{
+}
+
+inline bool MaterializedAggregate::is_attached() const noexcept
+{
+    return m_view.is_attached();
+}
+
+inline bool MaterializedAggregate::is_in_sync() const
+{
+    return m_view.is_in_sync();
+}
+
+inline bool MaterializedAggregate::is_int() const noexcept
+{
+    return m_column_type == type_Int;
+}
+
+inline bool MaterializedAggregate::is_extreme() const noexcept
+{
+    return m_type == Table::aggr_min || m_type == Table::aggr_max;
+}
+
+} // namespace realm
+
+#endif // REALM_MATERIALIZED_AGGREGATE_HPP
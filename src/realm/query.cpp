@@ -18,6 +18,9 @@
 
 #include <cstdio>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ostream>
 
 #include <realm/array.hpp>
 #include <realm/column_fwd.hpp>
@@ -26,6 +29,7 @@
 #include <realm/descriptor.hpp>
 #include <realm/table_view.hpp>
 #include <realm/link_view.hpp>
+#include <realm/util/thread_pool.hpp>
 
 using namespace realm;
 
@@ -96,6 +100,7 @@ Query::Query(const Query& source)
     , m_groups(source.m_groups)
     , m_current_descriptor(source.m_current_descriptor)
     , m_table(source.m_table)
+    , m_thread_pool(source.m_thread_pool)
 {
     if (source.m_owned_source_table_view) {
         m_owned_source_table_view = source.m_owned_source_table_view->clone();
@@ -117,6 +122,7 @@ Query& Query::operator=(const Query& source)
     if (this != &source) {
         m_groups = source.m_groups;
         m_table = source.m_table;
+        m_thread_pool = source.m_thread_pool;
 
         if (source.m_owned_source_table_view) {
             m_owned_source_table_view = source.m_owned_source_table_view->clone();
@@ -775,6 +781,52 @@ Query& Query::like(size_t column_ndx, StringData value, bool case_sensitive)
 }
 
 
+Query& Query::in(size_t column_ndx, const std::vector<int64_t>& values)
+{
+    REALM_ASSERT_DEBUG(m_current_descriptor);
+    DataType type = m_current_descriptor->get_column_type(column_ndx);
+    if (type != type_Int && type != type_Bool && type != type_OldDateTime)
+        throw LogicError{LogicError::type_mismatch};
+
+    std::unique_ptr<ParentNode> node;
+    if (m_current_descriptor->is_nullable(column_ndx))
+        node.reset(new IntegerInNode<IntNullColumn>(values, column_ndx));
+    else
+        node.reset(new IntegerInNode<IntegerColumn>(values, column_ndx));
+    add_node(std::move(node));
+    return *this;
+}
+
+Query& Query::in(size_t column_ndx, const std::vector<StringData>& values)
+{
+    REALM_ASSERT_DEBUG(m_current_descriptor);
+    if (m_current_descriptor->get_column_type(column_ndx) != type_String)
+        throw LogicError{LogicError::type_mismatch};
+
+    add_node(std::unique_ptr<ParentNode>(new StringInNode(values, column_ndx)));
+    return *this;
+}
+
+Query& Query::in(size_t column_ndx, const std::vector<Timestamp>& values)
+{
+    REALM_ASSERT_DEBUG(m_current_descriptor);
+    if (m_current_descriptor->get_column_type(column_ndx) != type_Timestamp)
+        throw LogicError{LogicError::type_mismatch};
+
+    add_node(std::unique_ptr<ParentNode>(new TimestampInNode(values, column_ndx)));
+    return *this;
+}
+
+Query& Query::matches(size_t column_ndx, StringData terms)
+{
+    REALM_ASSERT_DEBUG(m_current_descriptor);
+    if (m_current_descriptor->get_column_type(column_ndx) != type_String)
+        throw LogicError{LogicError::type_mismatch};
+
+    add_node(std::unique_ptr<ParentNode>(new FullTextNode(terms, column_ndx)));
+    return *this;
+}
+
 // Aggregates =================================================================================
 
 size_t Query::peek_tablerow(size_t tablerow) const
@@ -790,6 +842,34 @@ size_t Query::peek_tablerow(size_t tablerow) const
     return tablerow;
 }
 
+namespace {
+
+// Fold the state of a partial aggregate over a later range of rows into `st`
+template <Action action, class R>
+void merge_query_state(QueryState<R>& st, const QueryState<R>& task_st)
+{
+    if (task_st.m_match_count == 0)
+        return;
+    if (action == act_Sum) {
+        st.m_state += task_st.m_state;
+    }
+    else if (action == act_Max) {
+        if (task_st.m_state > st.m_state) {
+            st.m_state = task_st.m_state;
+            st.m_minmax_index = task_st.m_minmax_index;
+        }
+    }
+    else if (action == act_Min) {
+        if (task_st.m_state < st.m_state) {
+            st.m_state = task_st.m_state;
+            st.m_minmax_index = task_st.m_minmax_index;
+        }
+    }
+    st.m_match_count += task_st.m_match_count;
+}
+
+} // anonymous namespace
+
 template <Action action, typename T, typename R, class ColType>
 R Query::aggregate(R (ColType::*aggregateMethod)(size_t start, size_t end, size_t limit, size_t* return_ndx) const,
                    size_t column_ndx, size_t* resultcount, size_t start, size_t end, size_t limit,
@@ -824,11 +904,29 @@ R Query::aggregate(R (ColType::*aggregateMethod)(size_t start, size_t end, size_
         st.init(action, nullptr, limit);
 
         SequentialGetter<ColType> source_column(*m_table, column_ndx);
+        auto ranges = get_parallel_ranges(start, end, limit);
 
-        if (!m_view) {
+        if (!m_view && ranges.empty()) {
             aggregate_internal(action, ColumnTypeTraits<T>::id, ColType::nullable, root_node(), &st, start, end,
                                &source_column);
         }
+        else if (!m_view) {
+            std::vector<std::unique_ptr<SequentialGetter<ColType>>> source_columns;
+            for (size_t i = 0; i < m_thread_pool->get_num_threads(); ++i)
+                source_columns.emplace_back(new SequentialGetter<ColType>(*m_table, column_ndx)); // Throws
+            std::vector<QueryState<R>> states(ranges.size());
+            run_parallel(ranges, [&](ParentNode* root, size_t task_ndx, size_t thread_ndx) {
+                QueryState<R>& task_st = states[task_ndx];
+                task_st.init(action, nullptr, limit);
+                aggregate_internal(action, ColumnTypeTraits<T>::id, ColType::nullable, root, &task_st,
+                                   ranges[task_ndx].first, ranges[task_ndx].second,
+                                   source_columns[thread_ndx].get());
+            });
+            // Merging in row order makes min/max pick the first of equal
+            // values, like the serial evaluation does
+            for (const QueryState<R>& task_st : states)
+                merge_query_state<action>(st, task_st);
+        }
         else {
             for (size_t t = 0; t < m_view->size(); t++) {
                 size_t tablerow = static_cast<size_t>(m_view->m_row_indexes.get(t));
@@ -853,6 +951,90 @@ R Query::aggregate(R (ColType::*aggregateMethod)(size_t start, size_t end, size_
     }
 }
 
+std::vector<std::pair<size_t, size_t>> Query::get_parallel_ranges(size_t start, size_t end, size_t limit) const
+{
+    std::vector<std::pair<size_t, size_t>> ranges;
+    if (!m_thread_pool || m_view || limit != size_t(-1) || !has_conditions())
+        return ranges;
+    if (!root_node()->can_evaluate_in_parallel())
+        return ranges;
+
+    // Aim for a few ranges per thread, so that work stealing can balance the
+    // load, but never split a leaf between two ranges.
+    const size_t leaf_size = REALM_MAX_BPNODE_SIZE;
+    size_t num_threads = m_thread_pool->get_num_threads();
+    size_t size = end - start;
+    if (num_threads < 2 || size < 2 * leaf_size)
+        return ranges;
+    size_t ranges_wanted = 4 * num_threads;
+    size_t range_size = (size + ranges_wanted - 1) / ranges_wanted;
+    range_size = (range_size + leaf_size - 1) / leaf_size * leaf_size;
+    for (size_t begin = start; begin < end;) {
+        size_t next = std::min((begin / range_size + 1) * range_size, end);
+        ranges.emplace_back(begin, next);
+        begin = next;
+    }
+    return ranges;
+}
+
+template <class F>
+void Query::run_parallel(const std::vector<std::pair<size_t, size_t>>& ranges, F func) const
+{
+    // Nodes keep evaluation state (cached leaves and statistics), so every
+    // thread needs its own copy of the tree. The copies are made and
+    // initialized here rather than on the worker threads, because
+    // initialization may instantiate accessors.
+    size_t num_threads = m_thread_pool->get_num_threads();
+    std::vector<std::unique_ptr<ParentNode>> roots;
+    roots.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+        roots.push_back(root_node()->clone()); // Throws
+        init_tree(roots.back().get());
+    }
+    m_thread_pool->run(ranges.size(), [&](size_t task_ndx, size_t thread_ndx) {
+        func(roots[thread_ndx].get(), task_ndx, thread_ndx); // Throws
+    });
+}
+
+namespace {
+
+// Evaluate rows from `start` on by calling `func`, which returns the next row to evaluate, and if `profile` is
+// non-null, attribute the rows, matches and time to `condition`
+template <class F>
+size_t run_profiled(QueryProfile* profile, size_t condition, QueryStateBase* st, size_t start, F func)
+{
+    if (!profile)
+        return func();
+
+    auto& state = static_cast<QueryState<int64_t>&>(*st);
+    int64_t matches = state.m_state;
+    auto time_start = std::chrono::steady_clock::now();
+    size_t next = func();
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - time_start;
+    size_t rows = next - start;
+
+    if (condition == QueryProfile::bitmap) {
+        profile->bitmap_rows += rows;
+        profile->bitmap_matches += size_t(state.m_state - matches);
+        profile->bitmap_seconds += seconds.count();
+    }
+    else {
+        QueryProfile::Condition& c = profile->conditions[condition];
+        ++c.times_driving;
+        c.rows += rows;
+        c.matches += size_t(state.m_state - matches);
+        c.seconds += seconds.count();
+    }
+
+    if (!profile->plan.empty() && profile->plan.back().first == condition)
+        profile->plan.back().second += rows;
+    else
+        profile->plan.emplace_back(condition, rows);
+    return next;
+}
+
+} // anonymous namespace
+
 /**************************************************************************************************************
 *                                                                                                             *
 * Main entry point of a query. Schedules calls to aggregate_local                                             *
@@ -861,8 +1043,8 @@ R Query::aggregate(R (ColType::*aggregateMethod)(size_t start, size_t end, size_
 **************************************************************************************************************/
 
 void Query::aggregate_internal(Action TAction, DataType TSourceColumn, bool nullable, ParentNode* pn,
-                               QueryStateBase* st, size_t start, size_t end,
-                               SequentialGetterBase* source_column) const
+                               QueryStateBase* st, size_t start, size_t end, SequentialGetterBase* source_column,
+                               QueryProfile* profile) const
 {
     if (end == not_found)
         end = m_table->size();
@@ -872,11 +1054,25 @@ void Query::aggregate_internal(Action TAction, DataType TSourceColumn, bool null
 
     size_t td;
 
+    // The bitmap strategy pays off only if there are several conditions to combine
+    bool bitmap_evaluation = pn->m_children.size() > 1;
+    for (size_t c = 0; c < pn->m_children.size() && bitmap_evaluation; c++)
+        bitmap_evaluation = pn->m_children[c]->has_bitmap_evaluation();
+
     while (start < end) {
         auto score_compare = [](const ParentNode* a, const ParentNode* b) { return a->cost() < b->cost(); };
         size_t best = std::distance(pn->m_children.begin(),
                                     std::min_element(pn->m_children.begin(), pn->m_children.end(), score_compare));
 
+        // If even the best condition matches often, evaluate all conditions for a window of rows at a time, rather
+        // than testing the other conditions for each match of the best one
+        if (bitmap_evaluation && pn->m_children[best]->m_dD < bitmap_dist) {
+            td = start + bitmap_window > end ? end : start + bitmap_window;
+            start = run_profiled(profile, QueryProfile::bitmap, st, start,
+                                 [&] { return pn->aggregate_bitmap(st, start, td, source_column); });
+            continue;
+        }
+
         // Find a large amount of local matches in best condition
         td = pn->m_children[best]->m_dT == 0.0 ? end : (start + 1000 > end ? end : start + 1000);
 
@@ -884,7 +1080,9 @@ void Query::aggregate_internal(Action TAction, DataType TSourceColumn, bool null
         // on. Can be called on any node; yields same result, but different performance. Returns prematurely if
         // condition of called node has evaluated to true local_matches number of times.
         // Return value is the next row for resuming aggregating (next row that caller must call aggregate_local on)
-        start = pn->m_children[best]->aggregate_local(st, start, td, findlocals, source_column);
+        start = run_profiled(profile, best, st, start, [&] {
+            return pn->m_children[best]->aggregate_local(st, start, td, findlocals, source_column);
+        });
 
         // Make remaining conditions compute their m_dD (statistics)
         for (size_t c = 0; c < pn->m_children.size() && start < end; c++) {
@@ -898,10 +1096,15 @@ void Query::aggregate_internal(Action TAction, DataType TSourceColumn, bool null
                 // Limit to bestdist in order not to skip too large parts of index nodes
                 size_t maxD = pn->m_children[c]->m_dT == 0.0 ? end - start : bestdist;
                 td = pn->m_children[c]->m_dT == 0.0 ? end : (start + maxD > end ? end : start + maxD);
-                start = pn->m_children[c]->aggregate_local(st, start, td, probe_matches, source_column);
+                start = run_profiled(profile, c, st, start, [&] {
+                    return pn->m_children[c]->aggregate_local(st, start, td, probe_matches, source_column);
+                });
             }
         }
     }
+
+    for (size_t c = 0; c < pn->m_children.size(); c++)
+        pn->m_children[c]->save_statistics();
 }
 
 
@@ -1186,6 +1389,13 @@ size_t Query::find(size_t begin)
 }
 
 void Query::find_all(TableViewBase& ret, size_t begin, size_t end, size_t limit) const
+{
+    QueryState<int64_t> st;
+    st.init(act_FindAll, &ret.m_row_indexes, limit);
+    find_all(st, begin, end, limit);
+}
+
+void Query::find_all(QueryState<int64_t>& st, size_t begin, size_t end, size_t limit) const
 {
     if (limit == 0 || m_table->is_degenerate())
         return;
@@ -1198,36 +1408,374 @@ void Query::find_all(TableViewBase& ret, size_t begin, size_t end, size_t limit)
         end = m_table->size();
 
     if (m_view) {
-        for (size_t t = 0; t < m_view->size() && ret.size() < limit; t++) {
+        for (size_t t = 0; t < m_view->size(); t++) {
             size_t tablerow = static_cast<size_t>(m_view->m_row_indexes.get(t));
             if (tablerow >= begin && tablerow < end && peek_tablerow(tablerow) != not_found) {
-                ret.m_row_indexes.add(tablerow);
+                if (!st.match<act_FindAll, false>(tablerow, 0, 0))
+                    break;
             }
         }
     }
-    else {
-        if (!has_conditions()) {
-            IntegerColumn& refs = ret.m_row_indexes;
-            for (size_t i = begin; i < end && refs.size() < limit; ++i) {
-                refs.add(i);
-            }
+    else if (!has_conditions()) {
+        if (st.m_bitmap) {
+            st.m_bitmap->add_range(begin, begin + std::min(end - begin, limit)); // Throws
         }
         else {
-            QueryState<int64_t> st;
-            st.init(act_FindAll, &ret.m_row_indexes, limit);
+            for (size_t i = begin; i < end; ++i) {
+                if (!st.match<act_FindAll, false>(i, 0, 0))
+                    break;
+            }
+        }
+    }
+    else {
+        auto ranges = get_parallel_ranges(begin, end, limit);
+        if (ranges.empty()) {
             aggregate_internal(act_FindAll, ColumnTypeTraits<int64_t>::id, false, root_node(), &st, begin, end,
                                nullptr);
         }
+        else {
+            // Every range collects its matches separately. They are passed on
+            // in range order afterwards.
+            std::vector<RowBitmap> results(ranges.size());
+            run_parallel(ranges, [&](ParentNode* root, size_t task_ndx, size_t) {
+                QueryState<int64_t> task_st;
+                task_st.init(act_FindAll, nullptr, limit);
+                task_st.m_bitmap = &results[task_ndx];
+                aggregate_internal(act_FindAll, ColumnTypeTraits<int64_t>::id, false, root, &task_st,
+                                   ranges[task_ndx].first, ranges[task_ndx].second, nullptr);
+            });
+            if (st.m_bitmap) {
+                for (auto& result : results)
+                    *st.m_bitmap |= result; // Throws
+            }
+            else {
+                for (auto& result : results)
+                    result.for_each([&](size_t row) { st.match<act_FindAll, false>(row, 0, 0); }); // Throws
+            }
+        }
     }
 }
 
+RowBitmap Query::find_all_bitmap(size_t begin, size_t end, size_t limit) const
+{
+    RowBitmap result;
+    QueryState<int64_t> st;
+    st.init(act_FindAll, nullptr, limit);
+    st.m_bitmap = &result;
+    find_all(st, begin, end, limit);
+    return result;
+}
+
 TableView Query::find_all(size_t start, size_t end, size_t limit)
 {
     TableView ret(*m_table, *this, start, end, limit);
     find_all(ret, start, end, limit);
+    ret.m_row_changes_tracked = ret.can_sync_changed_rows();
     return ret;
 }
 
+TableView Query::find_top_k(SortDescriptor order, size_t k, size_t start, size_t end)
+{
+    REALM_ASSERT(order);
+    TableView ret(*m_table, *this, start, end, size_t(-1));
+    ret.m_sorting_predicate = std::move(order);
+    ret.m_top_k = k;
+    find_top_k(ret, ret.m_sorting_predicate, k, start, end);
+    return ret;
+}
+
+void Query::find_top_k(TableViewBase& ret, const SortDescriptor& order, size_t k, size_t start, size_t end) const
+{
+    if (k == 0 || m_table->is_degenerate())
+        return;
+
+    if (end == size_t(-1))
+        end = m_table->size();
+
+    if (m_view) {
+        // The view decides the order in which matches are found, so it must be
+        // traversed in one go
+        find_all(ret, start, end);
+        ret.do_sort(order, SortDescriptor(), k);
+        return;
+    }
+
+    // With an ordered index on the sort column, the rows can be visited in
+    // sorted order, and the search stops at the k-th match
+    bool ascending = true;
+    const ColumnBase* sort_column = order.get_single_column(ascending);
+    if (sort_column && sort_column->get_column_index() != npos) {
+        size_t col_ndx = sort_column->get_column_index();
+        DataType type = m_table->get_column_type(col_ndx);
+        std::shared_ptr<const OrderedIndex> index;
+        if (type == type_Int || type == type_Timestamp)
+            index = _impl::TableFriend::get_ordered_index(*m_table, col_ndx); // Throws
+        std::vector<size_t> rows;
+        if (index && index->get_sorted_rows(ascending, rows)) { // Throws
+            if (has_conditions())
+                init();
+            ParentNode* root = has_conditions() ? root_node() : nullptr;
+            size_t matches = 0;
+            for (size_t row : rows) {
+                if (row < start || row >= end)
+                    continue;
+                if (root && root->find_first(row, row + 1) == not_found)
+                    continue;
+                ret.m_row_indexes.add(row); // Throws
+                if (++matches == k)
+                    break;
+            }
+            return;
+        }
+    }
+
+    // Collect matches a batch of rows at a time, and cut the candidates down
+    // to the first k whenever they reach 2k. Because candidates are added in
+    // table order, and the sort is stable, rows that compare equal end up in
+    // table order like they would after a full sort.
+    const size_t batch_size = std::max(size_t(REALM_MAX_BPNODE_SIZE), k);
+    for (size_t begin = start; begin < end;) {
+        size_t batch_end = end - begin > batch_size ? begin + batch_size : end;
+        find_all(ret, begin, batch_end);
+        if (ret.m_row_indexes.size() >= 2 * k)
+            ret.do_sort(order, SortDescriptor(), k);
+        begin = batch_end;
+    }
+    ret.do_sort(order, SortDescriptor(), k);
+}
+
+QueryCursor Query::get_cursor(size_t start, size_t end) const
+{
+    return QueryCursor(*this, start, end);
+}
+
+QueryCursor::QueryCursor(const Query& query, size_t start, size_t end)
+    : m_query(query) // Throws
+    , m_start(start)
+    , m_end(end == size_t(-1) ? query.m_table->size() : end)
+    , m_next(query.m_view ? 0 : start)
+{
+    REALM_ASSERT_3(m_start, <=, m_query.m_table->size());
+    init();
+}
+
+void QueryCursor::init()
+{
+    // Rows may have been removed since the last call
+    size_t size = m_query.m_table->size();
+    if (m_end > size)
+        m_end = size;
+    if (!m_query.m_view && m_next > m_end)
+        m_next = m_end;
+    if (m_query.has_conditions())
+        m_query.init();
+    m_table_version = m_query.m_table->get_version_counter();
+}
+
+size_t QueryCursor::next(size_t* rows, size_t size)
+{
+    if (m_done)
+        return 0;
+    if (m_query.m_table->get_version_counter() != m_table_version)
+        init();
+
+    ParentNode* root = m_query.has_conditions() ? m_query.root_node() : nullptr;
+    size_t n = 0;
+    if (const RowIndexes* view = m_query.m_view) {
+        size_t view_size = view->size();
+        for (; n < size && m_next < view_size; ++m_next) {
+            size_t row = static_cast<size_t>(view->m_row_indexes.get(m_next));
+            if (row >= m_start && row < m_end && (!root || root->find_first(row, row + 1) != not_found))
+                rows[n++] = row;
+        }
+        m_done = m_next >= view_size;
+    }
+    else {
+        while (n < size && m_next < m_end) {
+            // The node tree is initialized, so leaves cached by the previous
+            // call are reused
+            size_t row = root ? root->find_first(m_next, m_end) : m_next;
+            if (row == not_found || row >= m_end) {
+                m_next = m_end;
+                break;
+            }
+            rows[n++] = row;
+            m_next = row + 1;
+        }
+        m_done = m_next == m_end;
+    }
+    return n;
+}
+
+
+QueryProfile Query::explain() const
+{
+    QueryProfile profile;
+    if (m_table->is_degenerate() || !has_conditions())
+        return profile;
+
+    init();
+    for (ParentNode* node : root_node()->m_children) {
+        QueryProfile::Condition c;
+        c.description = node->describe();
+        c.initial_match_dist = node->m_dD;
+        c.match_dist = node->m_dD;
+        c.row_cost = node->m_dT;
+        profile.conditions.push_back(std::move(c));
+    }
+    return profile;
+}
+
+QueryProfile Query::profile(size_t start, size_t end) const
+{
+    QueryProfile profile = explain();
+    if (m_table->is_degenerate())
+        return profile;
+
+    if (end == size_t(-1))
+        end = m_table->size();
+
+    auto time_start = std::chrono::steady_clock::now();
+    if (m_view) {
+        // Rows of a view are tested one at a time, so no condition drives the search
+        for (size_t t = 0; t < m_view->size(); t++) {
+            size_t tablerow = static_cast<size_t>(m_view->m_row_indexes.get(t));
+            if (tablerow >= start && tablerow < end) {
+                ++profile.num_rows;
+                if (peek_tablerow(tablerow) != not_found)
+                    ++profile.num_matches;
+            }
+        }
+    }
+    else if (!has_conditions()) {
+        profile.num_rows = end - start;
+        profile.num_matches = end - start;
+    }
+    else {
+        // The node tree keeps its counters across evaluations
+        const std::vector<ParentNode*>& nodes = root_node()->m_children;
+        std::vector<std::pair<size_t, size_t>> counters_before;
+        for (ParentNode* node : nodes)
+            counters_before.emplace_back(node->m_probes, node->m_leaves_loaded);
+
+        QueryState<int64_t> st;
+        st.init(act_Count, nullptr, size_t(-1));
+        aggregate_internal(act_Count, ColumnTypeTraits<int64_t>::id, false, root_node(), &st, start, end, nullptr,
+                           &profile);
+        profile.num_rows = end - start;
+        profile.num_matches = size_t(st.m_state);
+
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            QueryProfile::Condition& c = profile.conditions[i];
+            c.match_dist = nodes[i]->m_dD;
+            c.row_cost = nodes[i]->m_dT;
+            c.probes = nodes[i]->m_probes - counters_before[i].first;
+            c.leaves_loaded = nodes[i]->m_leaves_loaded - counters_before[i].second;
+        }
+    }
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - time_start;
+    profile.seconds = seconds.count();
+    return profile;
+}
+
+void QueryProfile::to_string(std::ostream& out) const
+{
+    out << num_matches << " of " << num_rows << " rows matched in " << seconds << " s\n";
+    for (size_t i = 0; i < conditions.size(); ++i) {
+        const Condition& c = conditions[i];
+        out << "#" << i << " " << c.description << "\n";
+        out << "    match distance " << c.initial_match_dist << " -> " << c.match_dist << ", row cost "
+            << c.row_cost << "\n";
+        out << "    drove the search " << c.times_driving << " times: " << c.rows << " rows, " << c.matches
+            << " matches, " << c.seconds << " s\n";
+        out << "    " << c.probes << " probes, " << c.leaves_loaded << " leaves loaded\n";
+    }
+    if (bitmap_rows != 0) {
+        out << "bitmap evaluation: " << bitmap_rows << " rows, " << bitmap_matches << " matches, " << bitmap_seconds
+            << " s\n";
+    }
+    if (!plan.empty()) {
+        out << "plan:";
+        for (const auto& step : plan) {
+            if (step.first == bitmap)
+                out << " bitmap";
+            else
+                out << " #" << step.first;
+            out << " (" << step.second << " rows)";
+        }
+        out << "\n";
+    }
+}
+
+namespace {
+
+void out_json_string(std::ostream& out, const std::string& str)
+{
+    const char* hex = "0123456789abcdef";
+    out << '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            unsigned char u = static_cast<unsigned char>(c);
+            out << "\\u00" << hex[u >> 4] << hex[u & 0xF];
+        }
+        else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+void out_json_number(std::ostream& out, double value)
+{
+    // JSON has no representation of infinity and NaN
+    if (std::isfinite(value))
+        out << value;
+    else
+        out << "null";
+}
+
+} // anonymous namespace
+
+void QueryProfile::to_json(std::ostream& out) const
+{
+    out << "{\"rows\":" << num_rows << ",\"matches\":" << num_matches << ",\"seconds\":";
+    out_json_number(out, seconds);
+    out << ",\"conditions\":[";
+    for (size_t i = 0; i < conditions.size(); ++i) {
+        const Condition& c = conditions[i];
+        if (i != 0)
+            out << ",";
+        out << "{\"description\":";
+        out_json_string(out, c.description);
+        out << ",\"initial_match_distance\":";
+        out_json_number(out, c.initial_match_dist);
+        out << ",\"match_distance\":";
+        out_json_number(out, c.match_dist);
+        out << ",\"row_cost\":";
+        out_json_number(out, c.row_cost);
+        out << ",\"times_driving\":" << c.times_driving << ",\"rows\":" << c.rows << ",\"matches\":" << c.matches
+            << ",\"probes\":" << c.probes << ",\"leaves_loaded\":" << c.leaves_loaded << ",\"seconds\":";
+        out_json_number(out, c.seconds);
+        out << "}";
+    }
+    out << "],\"bitmap\":{\"rows\":" << bitmap_rows << ",\"matches\":" << bitmap_matches << ",\"seconds\":";
+    out_json_number(out, bitmap_seconds);
+    out << "},\"plan\":[";
+    for (size_t i = 0; i < plan.size(); ++i) {
+        if (i != 0)
+            out << ",";
+        out << "{\"condition\":";
+        if (plan[i].first == bitmap)
+            out << "\"bitmap\"";
+        else
+            out << plan[i].first;
+        out << ",\"rows\":" << plan[i].second << "}";
+    }
+    out << "]}";
+}
 
 size_t Query::count(size_t start, size_t end, size_t limit) const
 {
@@ -1259,10 +1807,26 @@ size_t Query::count(size_t start, size_t end, size_t limit) const
         }
     }
     else {
-        QueryState<int64_t> st;
-        st.init(act_Count, nullptr, limit);
-        aggregate_internal(act_Count, ColumnTypeTraits<int64_t>::id, false, root_node(), &st, start, end, nullptr);
-        cnt = size_t(st.m_state);
+        auto ranges = get_parallel_ranges(start, end, limit);
+        if (ranges.empty()) {
+            QueryState<int64_t> st;
+            st.init(act_Count, nullptr, limit);
+            aggregate_internal(act_Count, ColumnTypeTraits<int64_t>::id, false, root_node(), &st, start, end,
+                               nullptr);
+            cnt = size_t(st.m_state);
+        }
+        else {
+            std::vector<size_t> counts(ranges.size());
+            run_parallel(ranges, [&](ParentNode* root, size_t task_ndx, size_t) {
+                QueryState<int64_t> st;
+                st.init(act_Count, nullptr, limit);
+                aggregate_internal(act_Count, ColumnTypeTraits<int64_t>::id, false, root, &st,
+                                   ranges[task_ndx].first, ranges[task_ndx].second, nullptr);
+                counts[task_ndx] = size_t(st.m_state);
+            });
+            for (size_t task_cnt : counts)
+                cnt += task_cnt;
+        }
     }
 
     return cnt;
@@ -1281,135 +1845,6 @@ size_t Query::remove()
     return rows;
 }
 
-#if REALM_MULTITHREAD_QUERY
-TableView Query::find_all_multi(size_t start, size_t end)
-{
-    static_cast<void>(start);
-    static_cast<void>(end);
-
-    // Initialization
-    init();
-    ts.next_job = start;
-    ts.end_job = end;
-    ts.done_job = 0;
-    ts.count = 0;
-    ts.table = &table;
-    ts.node = first[0];
-
-    // Signal all threads to start
-    pthread_mutex_unlock(&ts.jobs_mutex);
-    pthread_cond_broadcast(&ts.jobs_cond);
-
-    // Wait until all threads have completed
-    pthread_mutex_lock(&ts.completed_mutex);
-    while (ts.done_job < ts.end_job)
-        pthread_cond_wait(&ts.completed_cond, &ts.completed_mutex);
-    pthread_mutex_lock(&ts.jobs_mutex);
-    pthread_mutex_unlock(&ts.completed_mutex);
-
-    TableView tv(*m_table);
-
-    // Sort search results because user expects ascending order
-    sort(ts.chunks.begin(), ts.chunks.end(), &Query::comp);
-    for (size_t i = 0; i < ts.chunks.size(); ++i) {
-        const size_t from = ts.chunks[i].m_root_node;
-        const size_t upto = (i == ts.chunks.size() - 1) ? size_t(-1) : ts.chunks[i + 1].m_root_node;
-        size_t first = ts.chunks[i].second;
-
-        while (first < ts.results.size() && ts.results[first] < upto && ts.results[first] >= from) {
-            tv.get_ref_column().add(ts.results[first]);
-            ++first;
-        }
-    }
-
-    return move(tv);
-}
-
-int Query::set_threads(unsigned int threadcount)
-{
-#if defined(_WIN32) || defined(__WIN32__) || defined(_WIN64)
-    pthread_win32_process_attach_np();
-#endif
-    pthread_mutex_init(&ts.result_mutex, nullptr);
-    pthread_cond_init(&ts.completed_cond, nullptr);
-    pthread_mutex_init(&ts.jobs_mutex, nullptr);
-    pthread_mutex_init(&ts.completed_mutex, nullptr);
-    pthread_cond_init(&ts.jobs_cond, nullptr);
-
-    pthread_mutex_lock(&ts.jobs_mutex);
-
-    for (size_t i = 0; i < m_threadcount; ++i)
-        pthread_detach(threads[i]);
-
-    for (size_t i = 0; i < threadcount; ++i) {
-        int r = pthread_create(&threads[i], nullptr, query_thread, (void*)&ts);
-        if (r != 0)
-            REALM_ASSERT(false); // todo
-    }
-    m_threadcount = threadcount;
-    return 0;
-}
-
-
-void* Query::query_thread(void* arg)
-{
-    static_cast<void>(arg);
-    thread_state* ts = static_cast<thread_state*>(arg);
-
-    std::vector<size_t> res;
-    std::vector<pair<size_t, size_t>> chunks;
-
-    for (;;) {
-        // Main waiting loop that waits for a query to start
-        pthread_mutex_lock(&ts->jobs_mutex);
-        while (ts->next_job == ts->end_job)
-            pthread_cond_wait(&ts->jobs_cond, &ts->jobs_mutex);
-        pthread_mutex_unlock(&ts->jobs_mutex);
-
-        for (;;) {
-            // Pick a job
-            pthread_mutex_lock(&ts->jobs_mutex);
-            if (ts->next_job == ts->end_job)
-                break;
-            const size_t chunk = min(ts->end_job - ts->next_job, thread_chunk_size);
-            const size_t mine = ts->next_job;
-            ts->next_job += chunk;
-            size_t r = mine - 1;
-            const size_t end = mine + chunk;
-
-            pthread_mutex_unlock(&ts->jobs_mutex);
-
-            // Execute job
-            for (;;) {
-                r = ts->node->find_first(r + 1, end);
-                if (r == end)
-                    break;
-                res.push_back(r);
-            }
-
-            // Append result in common queue shared by all threads.
-            pthread_mutex_lock(&ts->result_mutex);
-            ts->done_job += chunk;
-            if (res.size() > 0) {
-                ts->chunks.push_back(std::pair<size_t, size_t>(mine, ts->results.size()));
-                ts->count += res.size();
-                for (size_t i = 0; i < res.size(); i++) {
-                    ts->results.push_back(res[i]);
-                }
-                res.clear();
-            }
-            pthread_mutex_unlock(&ts->result_mutex);
-
-            // Signal main thread that we might have compleeted
-            pthread_mutex_lock(&ts->completed_mutex);
-            pthread_cond_signal(&ts->completed_cond);
-            pthread_mutex_unlock(&ts->completed_mutex);
-        }
-    }
-    return 0;
-}
-
-#endif // REALM_MULTITHREADQUERY
 
 std::string Query::validate()
 {
@@ -1428,11 +1863,18 @@ std::string Query::validate()
 void Query::init() const
 {
     REALM_ASSERT(m_table);
-    if (ParentNode* root = root_node()) {
-        root->init();
-        std::vector<ParentNode*> v;
-        root->gather_children(v);
-    }
+    if (ParentNode* root = root_node())
+        init_tree(root);
+}
+
+void Query::init_tree(ParentNode* root)
+{
+    root->init();
+    std::vector<ParentNode*> v;
+    root->gather_children(v);
+    root->use_composite_indexes(); // Throws
+    for (ParentNode* node : root->m_children)
+        node->load_statistics();
 }
 
 size_t Query::find_internal(size_t start, size_t end) const
@@ -1454,11 +1896,6 @@ size_t Query::find_internal(size_t start, size_t end) const
         return r;
 }
 
-bool Query::comp(const std::pair<size_t, size_t>& a, const std::pair<size_t, size_t>& b)
-{
-    return a.first < b.first;
-}
-
 void Query::add_node(std::unique_ptr<ParentNode> node)
 {
     REALM_ASSERT(node);
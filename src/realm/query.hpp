@@ -23,17 +23,10 @@
 #include <cstdio>
 #include <climits>
 #include <algorithm>
+#include <iosfwd>
 #include <string>
 #include <vector>
 
-#define REALM_MULTITHREAD_QUERY 0
-
-#if REALM_MULTITHREAD_QUERY
-// FIXME: Use our C++ thread abstraction API since it provides a much
-// higher level of encapsulation and safety.
-#include <pthread.h>
-#endif
-
 #include <realm/views.hpp>
 #include <realm/table_ref.hpp>
 #include <realm/binary_data.hpp>
@@ -42,6 +35,7 @@
 #include <realm/link_view_fwd.hpp>
 #include <realm/descriptor_fwd.hpp>
 #include <realm/row.hpp>
+#include <realm/row_bitmap.hpp>
 
 namespace realm {
 
@@ -56,6 +50,12 @@ class Array;
 class Expression;
 class SequentialGetterBase;
 class Group;
+class QueryCursor;
+struct QueryProfile;
+
+namespace util {
+class ThreadPool;
+}
 
 struct QueryGroup {
     enum class State {
@@ -225,6 +225,21 @@ public:
     Query& ends_with(size_t column_ndx, BinaryData value);
     Query& contains(size_t column_ndx, BinaryData value);
 
+    // Conditions: the value is one of `values`. This matches the same rows as
+    // a group of equal() conditions joined by Or(), but the time to test a row
+    // grows with the logarithm of the number of values rather than linearly.
+    // If the column has a search index, each of the values is looked up in the
+    // index instead of testing the rows. A null value matches null.
+    Query& in(size_t column_ndx, const std::vector<int64_t>& values);
+    Query& in(size_t column_ndx, const std::vector<StringData>& values);
+    Query& in(size_t column_ndx, const std::vector<Timestamp>& values);
+
+    // Conditions: the string value contains each of the words of `terms`,
+    // ignoring case (see FullTextIndex::tokenize()). If the column has a
+    // full-text index (see Table::add_fulltext_index()), the matching rows are
+    // looked up in the index instead of reading the strings.
+    Query& matches(size_t column_ndx, StringData terms);
+
     // Negation
     Query& Not();
 
@@ -247,6 +262,41 @@ public:
     TableView find_all(size_t start = 0, size_t end = size_t(-1), size_t limit = size_t(-1));
     ConstTableView find_all(size_t start = 0, size_t end = size_t(-1), size_t limit = size_t(-1)) const;
 
+    /// Find the same rows as find_all(), but return them as a RowBitmap. For
+    /// queries with many matches, a RowBitmap is much faster to build and takes
+    /// up much less memory than the row index column of a TableView, and it can
+    /// be combined with other results cheaply. Use Table::get_bitmap_view() to
+    /// turn it into a TableView, for example in order to sort it.
+    ///
+    /// If the query is restricted by a view, duplicate rows are only reported
+    /// once, and the order of the view is not retained.
+    RowBitmap find_all_bitmap(size_t start = 0, size_t end = size_t(-1), size_t limit = size_t(-1)) const;
+
+    /// Find the first `k` matching rows in [start, end) according to `order`,
+    /// which must be a valid sort descriptor. The result is the same as the
+    /// first `k` rows of find_all() sorted by `order`, including the order of
+    /// rows that compare equal, but only about `k` rows are kept in memory while
+    /// the query is evaluated. The returned view keeps the limit when it is
+    /// synchronized, and applies it before distinct().
+    TableView find_top_k(SortDescriptor order, size_t k, size_t start = 0, size_t end = size_t(-1));
+
+    /// Return a cursor that reports the matching rows in [start, end) a batch
+    /// at a time, in the same order as find_all(). Unlike find_all(), the
+    /// cursor uses the same amount of memory regardless of the number of
+    /// matches. See QueryCursor.
+    QueryCursor get_cursor(size_t start = 0, size_t end = size_t(-1)) const;
+
+    /// Evaluate the query over [start, end) and report how it was executed:
+    /// which condition drove the search for each range of rows, how many rows
+    /// and matches each condition accounted for, and where the time was
+    /// spent. The query is evaluated on the calling thread, even if a thread
+    /// pool is set. See QueryProfile.
+    QueryProfile profile(size_t start = 0, size_t end = size_t(-1)) const;
+
+    /// Describe the conditions of the query and the initial estimates that the
+    /// execution order is chosen from, without evaluating the query.
+    QueryProfile explain() const;
+
     // Aggregates
     size_t count(size_t start = 0, size_t end = size_t(-1), size_t limit = size_t(-1)) const;
 
@@ -303,12 +353,26 @@ public:
     // Deletion
     size_t remove();
 
-#if REALM_MULTITHREAD_QUERY
     // Multi-threading
-    TableView find_all_multi(size_t start = 0, size_t end = size_t(-1));
-    ConstTableView find_all_multi(size_t start = 0, size_t end = size_t(-1)) const;
-    int set_threads(unsigned int threadcount);
-#endif
+
+    /// Evaluate find_all(), count(), and the sum, average, minimum and maximum
+    /// aggregates on the threads of the specified pool, or serially if \a pool
+    /// is null. The table is split into ranges of B+-tree leaves, each thread
+    /// evaluates its own copy of the query, and the results are merged in row
+    /// order. Queries that are restricted by a view or a link view, and calls
+    /// that specify a limit, are always evaluated serially, as are queries on
+    /// small tables. So are queries with conditions on subtables, on link
+    /// lists (including links_to() on a link list column), or through link
+    /// lists or backlinks in a query expression, because evaluating them
+    /// instantiates accessors that are shared by all copies of the query.
+    ///
+    /// The pool must outlive every use of the query (and its copies) for
+    /// evaluation. The table must not be modified while a query is evaluated.
+    Query& set_thread_pool(util::ThreadPool* pool) noexcept
+    {
+        m_thread_pool = pool;
+        return *this;
+    }
 
     const TableRef& get_table()
     {
@@ -338,8 +402,6 @@ private:
     void handle_pending_not();
     void set_table(TableRef tr);
 
-    static bool comp(const std::pair<size_t, size_t>& a, const std::pair<size_t, size_t>& b);
-
 public:
     using HandoverPatch = QueryHandoverPatch;
 
@@ -399,12 +461,32 @@ private:
     R aggregate(R (ColClass::*method)(size_t, size_t, size_t, size_t*) const, size_t column_ndx, size_t* resultcount,
                 size_t start, size_t end, size_t limit, size_t* return_ndx = nullptr) const;
 
+    // If `profile` is non-null, `st` must be a QueryState<int64_t> initialized for act_Count
     void aggregate_internal(Action TAction, DataType TSourceColumn, bool nullable, ParentNode* pn, QueryStateBase* st,
-                            size_t start, size_t end, SequentialGetterBase* source_column) const;
+                            size_t start, size_t end, SequentialGetterBase* source_column,
+                            QueryProfile* profile = nullptr) const;
 
     void find_all(TableViewBase& tv, size_t start = 0, size_t end = size_t(-1), size_t limit = size_t(-1)) const;
+    void find_top_k(TableViewBase& tv, const SortDescriptor& order, size_t k, size_t start, size_t end) const;
+
+    // Pass the matching rows in [start, end) to `st`, which must have been
+    // initialized for act_FindAll. Rows are passed in table order, or in view
+    // order if the query is restricted by a view.
+    void find_all(QueryState<int64_t>& st, size_t start, size_t end, size_t limit) const;
     void delete_nodes() noexcept;
 
+    // Split [start, end) into row ranges for parallel evaluation. Returns an
+    // empty vector if the query must be evaluated serially.
+    std::vector<std::pair<size_t, size_t>> get_parallel_ranges(size_t start, size_t end, size_t limit) const;
+
+    // Evaluate `func(root, task_ndx, thread_ndx)` for every range on
+    // m_thread_pool, passing the root of a node tree private to the thread.
+    template <class F>
+    void run_parallel(const std::vector<std::pair<size_t, size_t>>& ranges, F func) const;
+
+    // Prepare the node tree rooted at `root` for evaluation
+    static void init_tree(ParentNode* root);
+
     bool has_conditions() const
     {
         return m_groups.size() > 0 && m_groups[0].m_root_node;
@@ -419,6 +501,7 @@ private:
 
     friend class Table;
     friend class TableViewBase;
+    friend class QueryCursor;
 
     std::string error_code;
 
@@ -439,6 +522,105 @@ private:
     LinkViewRef m_source_link_view;               // link views are refcounted and shared.
     TableViewBase* m_source_table_view = nullptr; // table views are not refcounted, and not owned by the query.
     std::unique_ptr<TableViewBase> m_owned_source_table_view; // <--- except when indicated here
+
+    util::ThreadPool* m_thread_pool = nullptr;
+};
+
+/// Incremental evaluation of a query, as returned by Query::get_cursor().
+///
+/// The cursor has its own copy of the query, and keeps the evaluation state of
+/// the query nodes, such as cached leaves and match statistics, between calls
+/// to next(). If the table is modified between two calls, the evaluation
+/// state is reset, and the search continues from the same row index, so rows
+/// may be skipped or reported twice if rows are inserted or removed before
+/// that row.
+class QueryCursor {
+public:
+    /// Write the next matching rows, at most `size` of them, to `rows`, and
+    /// return the number of rows written. Fewer than `size` rows are written
+    /// only when there are no more matches.
+    size_t next(size_t* rows, size_t size);
+
+    /// True if all matching rows have been reported.
+    bool is_done() const noexcept
+    {
+        return m_done;
+    }
+
+private:
+    QueryCursor(const Query& query, size_t start, size_t end);
+
+    void init();
+
+    Query m_query;
+    // Rows outside [m_start, m_end) are not reported
+    size_t m_start;
+    size_t m_end;
+    // The next table row to search from, or, if the query is restricted by a
+    // view, the next position in the view
+    size_t m_next;
+    bool m_done = false;
+    uint_fast64_t m_table_version;
+
+    friend class Query;
+};
+
+/// The execution profile of a query, as returned by Query::profile() and
+/// Query::explain().
+///
+/// The conditions are those of the top level of the query, in the order they
+/// were added. Conditions in a group, such as the alternatives of an OR, are
+/// evaluated as one condition. A condition that drives the search finds its
+/// own matches and tests the other conditions on them, so the rows, matches
+/// and time of a condition include testing the other conditions. Rows
+/// evaluated a window at a time for all conditions (see
+/// ParentNode::aggregate_bitmap()) are not attributed to any condition.
+struct QueryProfile {
+    /// Plan entries for windows of rows that were evaluated as bitmaps
+    static const size_t bitmap = size_t(-1);
+
+    struct Condition {
+        std::string description;
+        /// The estimated average distance between matches before and after
+        /// the evaluation. The condition with the lowest cost, which is
+        /// based on this estimate, drives the search.
+        double initial_match_dist = 0;
+        double match_dist = 0;
+        /// The estimated cost of testing a single row
+        double row_cost = 0;
+        /// Number of times the condition drove the search
+        size_t times_driving = 0;
+        /// Number of rows searched, and matching rows found, while the
+        /// condition drove the search
+        size_t rows = 0;
+        size_t matches = 0;
+        /// Number of single rows tested on behalf of another condition that
+        /// drove the search. Only counted when the driving condition is on an
+        /// integer column.
+        size_t probes = 0;
+        /// Number of column leaves loaded. Only conditions on integer and
+        /// string columns count them.
+        size_t leaves_loaded = 0;
+        double seconds = 0;
+    };
+
+    std::vector<Condition> conditions;
+
+    /// The order in which the conditions drove the search, as pairs of
+    /// condition index, or `bitmap`, and the number of rows searched.
+    /// Consecutive runs of the same condition are merged.
+    std::vector<std::pair<size_t, size_t>> plan;
+
+    size_t bitmap_rows = 0;
+    size_t bitmap_matches = 0;
+    double bitmap_seconds = 0;
+
+    size_t num_rows = 0;
+    size_t num_matches = 0;
+    double seconds = 0;
+
+    void to_string(std::ostream&) const;
+    void to_json(std::ostream&) const;
 };
 
 // Implementation:
@@ -87,6 +87,10 @@ struct Contains : public HackClass {
     }
 
     static const int condition = -1;
+    static const char* description()
+    {
+        return "CONTAINS";
+    }
 };
 
 // Does v2 contain something like v1 (wildcard matching)?
@@ -126,6 +130,10 @@ struct Like : public HackClass {
     }
 
     static const int condition = -1;
+    static const char* description()
+    {
+        return "LIKE";
+    }
 };
 
 // Does v2 begin with v1?
@@ -157,6 +165,10 @@ struct BeginsWith : public HackClass {
     }
 
     static const int condition = -1;
+    static const char* description()
+    {
+        return "BEGINSWITH";
+    }
 };
 
 // Does v2 end with v1?
@@ -188,6 +200,10 @@ struct EndsWith : public HackClass {
     }
 
     static const int condition = -1;
+    static const char* description()
+    {
+        return "ENDSWITH";
+    }
 };
 
 struct Equal {
@@ -209,6 +225,10 @@ struct Equal {
         return (v1null && v2null) || (!v1null && !v2null && v1 == v2);
     }
     static const int condition = cond_Equal;
+    static const char* description()
+    {
+        return "==";
+    }
     bool can_match(int64_t v, int64_t lbound, int64_t ubound)
     {
         return (v >= lbound && v <= ubound);
@@ -240,6 +260,10 @@ struct NotEqual {
     }
 
     static const int condition = cond_NotEqual;
+    static const char* description()
+    {
+        return "!=";
+    }
     bool can_match(int64_t v, int64_t lbound, int64_t ubound)
     {
         return !(v == 0 && ubound == 0 && lbound == 0);
@@ -317,6 +341,10 @@ struct ContainsIns : public HackClass {
     }
 
     static const int condition = -1;
+    static const char* description()
+    {
+        return "CONTAINS[c]";
+    }
 };
 
 // Does v2 contain something like v1 (wildcard matching)?
@@ -362,6 +390,10 @@ struct LikeIns : public HackClass {
     }
 
     static const int condition = -1;
+    static const char* description()
+    {
+        return "LIKE[c]";
+    }
 };
 
 // Does v2 begin with v1?
@@ -406,6 +438,10 @@ struct BeginsWithIns : public HackClass {
     }
 
     static const int condition = -1;
+    static const char* description()
+    {
+        return "BEGINSWITH[c]";
+    }
 };
 
 // Does v2 end with v1?
@@ -451,6 +487,10 @@ struct EndsWithIns : public HackClass {
     }
 
     static const int condition = -1;
+    static const char* description()
+    {
+        return "ENDSWITH[c]";
+    }
 };
 
 struct EqualIns : public HackClass {
@@ -495,6 +535,10 @@ struct EqualIns : public HackClass {
     }
 
     static const int condition = -1;
+    static const char* description()
+    {
+        return "==[c]";
+    }
 };
 
 struct NotEqualIns : public HackClass {
@@ -533,6 +577,10 @@ struct NotEqualIns : public HackClass {
     }
 
     static const int condition = -1;
+    static const char* description()
+    {
+        return "!=[c]";
+    }
 };
 
 struct Greater {
@@ -546,6 +594,10 @@ struct Greater {
         return v1 > v2;
     }
     static const int condition = cond_Greater;
+    static const char* description()
+    {
+        return ">";
+    }
     template <class A, class B, class C, class D>
     bool operator()(A, B, C, D) const
     {
@@ -572,6 +624,10 @@ struct None {
         return true;
     }
     static const int condition = cond_None;
+    static const char* description()
+    {
+        return "NONE";
+    }
     template <class A, class B, class C, class D>
     bool operator()(A, B, C, D) const
     {
@@ -601,6 +657,10 @@ struct NotNull {
         return !v;
     }
     static const int condition = cond_LeftNotNull;
+    static const char* description()
+    {
+        return "!= NULL";
+    }
     template <class A, class B, class C, class D>
     bool operator()(A, B, C, D) const
     {
@@ -641,6 +701,10 @@ struct Less {
         return false;
     }
     static const int condition = cond_Less;
+    static const char* description()
+    {
+        return "<";
+    }
     bool can_match(int64_t v, int64_t lbound, int64_t ubound)
     {
         static_cast<void>(ubound);
@@ -670,6 +734,10 @@ struct LessEqual : public HackClass {
         return false;
     }
     static const int condition = -1;
+    static const char* description()
+    {
+        return "<=";
+    }
 };
 
 struct GreaterEqual : public HackClass {
@@ -689,6 +757,10 @@ struct GreaterEqual : public HackClass {
         return false;
     }
     static const int condition = -1;
+    static const char* description()
+    {
+        return ">=";
+    }
 };
 
 
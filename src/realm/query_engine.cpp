@@ -49,6 +49,111 @@ size_t ParentNode::find_first(size_t start, size_t end)
     return not_found;
 }
 
+void ParentNode::load_statistics()
+{
+    if (m_condition_column_idx != npos && m_table) {
+        m_statistics_key = describe(); // Throws
+        double dist = m_table->get_query_match_dist(m_condition_column_idx, typeid(*this), m_statistics_key);
+        if (dist > 0)
+            m_dD = dist;
+    }
+    m_dD_at_start = m_dD;
+}
+
+void ParentNode::save_statistics() const
+{
+    if (m_condition_column_idx != npos && m_table && m_dD != m_dD_at_start)
+        m_table->record_query_match_dist(m_condition_column_idx, typeid(*this), m_statistics_key, m_dD); // Throws
+}
+
+void StringNodeBase::find_trigram_candidates(StringData pattern, bool is_like, const std::string* upper,
+                                             const std::string* lower)
+{
+    m_candidates.clear();
+    auto index = _impl::TableFriend::get_trigram_index(*m_table, m_condition_column_idx); // Throws
+    if (!index)
+        return;
+
+    // A case insensitive condition compares the bytes of a value with the
+    // bytes of the upper and lower case pattern at the same position
+    bool ignore_case = upper && lower;
+    if (ignore_case && (upper->size() != pattern.size() || lower->size() != pattern.size()))
+        return;
+    const char* data = ignore_case ? lower->data() : pattern.data();
+
+    std::vector<StringData> parts;
+    size_t begin = 0;
+    for (size_t i = 0; i <= pattern.size(); ++i) {
+        bool is_end = i == pattern.size();
+        if (!is_end && is_like && (pattern[i] == '*' || pattern[i] == '?'))
+            is_end = true;
+        if (!is_end && ignore_case && (((*upper)[i] | (*lower)[i]) & 0x80) != 0)
+            is_end = true;
+        if (is_end) {
+            if (i > begin)
+                parts.emplace_back(data + begin, i - begin); // Throws
+            begin = i + 1;
+        }
+    }
+
+    std::vector<size_t> rows;
+    if (index->find_candidates(parts, rows))     // Throws
+        use_index_matches(std::move(rows), m_candidates); // Throws
+}
+
+
+void ParentNode::use_composite_indexes()
+{
+    std::vector<std::shared_ptr<const CompositeIndex>> indexes =
+        _impl::TableFriend::get_composite_indexes(*m_table); // Throws
+    if (indexes.empty())
+        return;
+
+    std::vector<std::pair<ParentNode*, OrderedIndex::KeyRange>> conditions;
+    for (ParentNode* node : m_children) {
+        OrderedIndex::KeyRange range;
+        if (node->get_key_range(range))
+            conditions.emplace_back(node, range); // Throws
+    }
+    if (conditions.size() < 2)
+        return;
+
+    // Use the index that covers the most conditions: equalities on a prefix of
+    // its columns, and a range on the next column
+    const CompositeIndex* best_index = nullptr;
+    ParentNode* best_node = nullptr;
+    std::vector<OrderedIndex::KeyRange> best_ranges;
+    for (const auto& index : indexes) {
+        ParentNode* node = nullptr;
+        std::vector<OrderedIndex::KeyRange> ranges;
+        for (size_t col_ndx : index->get_columns()) {
+            const std::pair<ParentNode*, OrderedIndex::KeyRange>* found = nullptr;
+            for (const auto& condition : conditions) {
+                if (condition.first->m_condition_column_idx == col_ndx && (!found || condition.second.is_single()))
+                    found = &condition;
+            }
+            if (!found)
+                break;
+            if (!node)
+                node = found->first;
+            ranges.push_back(found->second); // Throws
+            if (!found->second.is_single())
+                break;
+        }
+        if (ranges.size() >= 2 && ranges.size() > best_ranges.size()) {
+            best_index = index.get();
+            best_node = node;
+            best_ranges = std::move(ranges);
+        }
+    }
+    if (!best_index)
+        return;
+
+    std::vector<size_t> rows;
+    best_index->find(best_ranges, rows);            // Throws
+    best_node->set_index_matches(std::move(rows)); // Throws
+}
+
 void ParentNode::aggregate_local_prepare(Action TAction, DataType col_id, bool nullable)
 {
     if (TAction == act_ReturnFirst) {
@@ -175,6 +280,60 @@ size_t ParentNode::aggregate_local(QueryStateBase* st, size_t start, size_t end,
     }
 }
 
+void ParentNode::evaluate_bitmap(size_t start, size_t end, uint64_t* bits)
+{
+    REALM_ASSERT_DEBUG(end - start <= bitmap_window);
+    std::fill(bits, bits + (end - start + 63) / 64, 0);
+    for (size_t r = find_first_local(start, end); r != not_found; r = find_first_local(r + 1, end)) {
+        bits[(r - start) / 64] |= uint64_t(1) << ((r - start) % 64);
+        if (r + 1 == end)
+            break;
+    }
+}
+
+void ParentNode::evaluate_conjunction_bitmap(const std::vector<ParentNode*>& conditions, size_t start, size_t end,
+                                             uint64_t* bits)
+{
+    size_t num_words = (end - start + 63) / 64;
+    uint64_t condition_bits[bitmap_window / 64];
+    for (size_t c = 0; c < conditions.size(); ++c) {
+        uint64_t* dest = c == 0 ? bits : condition_bits;
+        conditions[c]->evaluate_bitmap(start, end, dest);
+        size_t matches = 0;
+        uint64_t any = 0;
+        for (size_t i = 0; i < num_words; ++i) {
+            matches += size_t(fast_popcount64(int64_t(dest[i])));
+            if (c != 0)
+                bits[i] &= dest[i];
+            any |= bits[i];
+        }
+        conditions[c]->m_dD = (end - start) / (matches + 1.0);
+        if (any == 0) {
+            // No need to evaluate the remaining conditions
+            break;
+        }
+    }
+}
+
+size_t ParentNode::aggregate_bitmap(QueryStateBase* st, size_t start, size_t end,
+                                    SequentialGetterBase* source_column)
+{
+    uint64_t bits[bitmap_window / 64];
+    evaluate_conjunction_bitmap(m_children, start, end, bits);
+
+    size_t num_words = (end - start + 63) / 64;
+    for (size_t i = 0; i < num_words; ++i) {
+        uint64_t word = bits[i];
+        while (word) {
+            size_t r = start + i * 64 + lowest_bit64(word);
+            if (!(this->*m_column_action_specializer)(st, source_column, r))
+                return not_found;
+            word &= word - 1;
+        }
+    }
+    return end;
+}
+
 size_t NotNode::find_first_local(size_t start, size_t end)
 {
     if (start <= m_known_range_start && end >= m_known_range_end) {
@@ -54,6 +54,13 @@ find_first_local(n, n + 1) is a function that can be used to test a single row o
 this is very simplified. There are other statistical arguments to the methods, and also, find_first_local() can be
 called from a callback function called by an integer Array.
 
+When the best node matches a large fraction of the rows, testing the other conditions one row at a time costs more
+than the search itself. If all nodes support it, aggregate() then switches to the bitmap strategy for a window of
+rows: each node evaluates its condition for every row of the window into a bitmap (evaluate_bitmap()), the bitmaps
+are ANDed together, and the remaining bits are the matches. An OrNode computes the bitmap of each of its
+alternatives this way and ORs them. The statistics are updated as usual, so aggregate() switches back when the match
+frequency drops.
+
 
 Template arguments in methods:
 ----------------------------------------------------------------------------------------------------
@@ -86,6 +93,7 @@ AggregateState      State of the aggregate - contains a state variable that stor
 
 #include <algorithm>
 #include <functional>
+#include <sstream>
 #include <string>
 #include <array>
 
@@ -106,6 +114,11 @@ AggregateState      State of the aggregate - contains a state variable that stor
 #include <realm/column_timestamp.hpp>
 #include <realm/column_type_traits.hpp>
 #include <realm/column_type_traits.hpp>
+#include <realm/index_hash.hpp>
+#include <realm/index_ordered.hpp>
+#include <realm/index_trigram.hpp>
+#include <realm/index_fulltext.hpp>
+#include <realm/index_case_fold.hpp>
 #include <realm/link_view.hpp>
 #include <realm/query_conditions.hpp>
 #include <realm/query_expression.hpp>
@@ -136,6 +149,100 @@ const size_t probe_matches = 4;
 
 const size_t bitwidth_time_unit = 64;
 
+// Number of rows evaluated at a time by the bitmap strategy (see ParentNode::aggregate_bitmap()).
+const size_t bitmap_window = 1024;
+
+// The bitmap strategy is used when the best condition has an average match distance below this value. Evaluating a
+// simple condition for a row in a bitmap takes about as long as a single call of find_first_local(n, n + 1).
+const size_t bitmap_dist = 16;
+
+// The rows that match a condition, looked up in the search index or the ordered index of the column. Used by IN and
+// OR conditions, which would otherwise test every row against each value, and by range conditions on columns with an
+// ordered index.
+class IndexMatches {
+public:
+    // Look up each of `values` in the search index of `column`, and keep the matching rows in row order. Returns
+    // false if the column has no search index.
+    template <class T>
+    bool find(const ColumnBase& column, const std::vector<T>& values)
+    {
+        m_rows.clear();
+        const StringIndex* index = column.get_search_index();
+        m_active = index != nullptr;
+        if (!m_active)
+            return false;
+
+        for (const T& value : values)
+            find_rows(*index, column, value, m_rows);
+
+        // The rows of each value are in order, and the values are distinct
+        std::sort(m_rows.begin(), m_rows.end());
+        return true;
+    }
+
+    // Keep `rows`, which may contain duplicates, in row order
+    void assign(std::vector<size_t> rows)
+    {
+        m_rows = std::move(rows);
+        std::sort(m_rows.begin(), m_rows.end());
+        m_rows.erase(std::unique(m_rows.begin(), m_rows.end()), m_rows.end());
+        m_active = true;
+    }
+
+    // Append the rows where `column` has `value` to `rows`, in row order
+    template <class T>
+    static void find_rows(const StringIndex& index, const ColumnBase& column, const T& value,
+                          std::vector<size_t>& rows)
+    {
+        InternalFindResult res;
+        switch (index.find_all_no_copy(value, res)) {
+            case FindRes_single:
+                rows.push_back(res.payload);
+                break;
+            case FindRes_column: {
+                const IntegerColumn matches(column.get_alloc(), ref_type(res.payload)); // Throws
+                for (size_t i = res.start_ndx; i < res.end_ndx; ++i)
+                    rows.push_back(to_size_t(matches.get(i)));
+                break;
+            }
+            case FindRes_not_found:
+                break;
+        }
+    }
+
+    void clear() noexcept
+    {
+        m_rows.clear();
+        m_active = false;
+    }
+
+    bool is_active() const noexcept
+    {
+        return m_active;
+    }
+
+    size_t size() const noexcept
+    {
+        return m_rows.size();
+    }
+
+    const std::vector<size_t>& rows() const noexcept
+    {
+        return m_rows;
+    }
+
+    size_t find_first(size_t start, size_t end) const noexcept
+    {
+        auto it = std::lower_bound(m_rows.begin(), m_rows.end(), start);
+        return it != m_rows.end() && *it < end ? *it : not_found;
+    }
+
+private:
+    std::vector<size_t> m_rows;
+    bool m_active = false;
+};
+
+
 typedef bool (*CallbackDummy)(int64_t);
 
 
@@ -168,6 +275,15 @@ public:
 
     size_t find_first(size_t start, size_t end);
 
+    // Statistics are kept in the table accessor between executions, so that the
+    // first range of rows is evaluated in the order that earlier executions
+    // found to be best. load_statistics() must be called after init(), and
+    // replaces the initial guess of m_dD. save_statistics() records m_dD if
+    // the evaluation has changed it. Only nodes with a condition column take
+    // part.
+    void load_statistics();
+    void save_statistics() const;
+
     virtual void init()
     {
         if (m_child)
@@ -218,6 +334,50 @@ public:
     virtual size_t aggregate_local(QueryStateBase* st, size_t start, size_t end, size_t local_limit,
                                    SequentialGetterBase* source_column);
 
+    // Set bit `r - start` in `bits` for each row `r` in [start, end) that matches the condition of this node
+    // (ignoring m_child), and clear all other bits. At most bitmap_window rows can be evaluated at a time. The
+    // default implementation calls find_first_local() repeatedly.
+    virtual void evaluate_bitmap(size_t start, size_t end, uint64_t* bits);
+
+    // Returns true if evaluate_bitmap() is faster than testing the rows one by one
+    virtual bool has_bitmap_evaluation() const
+    {
+        return false;
+    }
+
+    // If the matches of the condition of this node (ignoring m_child) can be looked up in a search index, append
+    // them to `rows` and return true. Otherwise return false. Only called after init().
+    virtual bool find_index_matches(std::vector<size_t>&)
+    {
+        return false;
+    }
+
+    // If the condition of this node (ignoring m_child) matches a range of values of its column that can be looked up
+    // in a composite index (see Table::add_composite_index()), set `range` and return true. Otherwise return false.
+    virtual bool get_key_range(OrderedIndex::KeyRange&) const
+    {
+        return false;
+    }
+
+    // Make this node match only `rows`, which were found in a composite index, and drive the search. Every row that
+    // matches all the conditions of m_children is among `rows`, and every one of `rows` matches the condition of
+    // this node. Only called after init(), and only if get_key_range() returned true.
+    virtual void set_index_matches(std::vector<size_t>)
+    {
+    }
+
+    // Look up the conditions of m_children in the composite indexes of the table, and let the node of the first
+    // condition found in the best index drive the search. Only called after init() and gather_children().
+    void use_composite_indexes();
+
+    // Evaluate all conditions of m_children as bitmaps for the rows in [start, end), and pass the rows matching all
+    // of them to `st`. Returns `end`, or not_found if the aggregate state asked to stop.
+    size_t aggregate_bitmap(QueryStateBase* st, size_t start, size_t end, SequentialGetterBase* source_column);
+
+    // AND together the bitmaps of `conditions`, updating their statistics
+    static void evaluate_conjunction_bitmap(const std::vector<ParentNode*>& conditions, size_t start, size_t end,
+                                            uint64_t* bits);
+
 
     virtual std::string validate()
     {
@@ -229,6 +389,29 @@ public:
             return m_child->validate();
     }
 
+    // Human readable description of the condition of this node, ignoring m_child, for Query::profile()
+    virtual std::string describe() const
+    {
+        return "unknown condition";
+    }
+
+    // Describe this node and the nodes that follow it through m_child
+    std::string describe_chain() const
+    {
+        std::string s = describe();
+        if (m_child)
+            s += " && " + m_child->describe_chain();
+        return s;
+    }
+
+    // Returns false if this node, or any node below it, instantiates accessors through caches that are shared by
+    // all copies of the node tree (subtable and link list accessors). Such trees cannot be evaluated by several
+    // threads at once.
+    virtual bool can_evaluate_in_parallel() const
+    {
+        return !m_child || m_child->can_evaluate_in_parallel();
+    }
+
     ParentNode(const ParentNode& from)
         : ParentNode(from, nullptr)
     {
@@ -239,6 +422,8 @@ public:
         , m_condition_column_idx(from.m_condition_column_idx)
         , m_dD(from.m_dD)
         , m_dT(from.m_dT)
+        , m_dD_at_start(from.m_dD_at_start)
+        , m_statistics_key(from.m_statistics_key)
         , m_probes(from.m_probes)
         , m_matches(from.m_matches)
         , m_table(patches ? ConstTableRef{} : from.m_table)
@@ -268,10 +453,15 @@ public:
     double m_dD;       // Average row distance between each local match at current position
     double m_dT = 0.0; // Time overhead of testing index i + 1 if we have just tested index i. > 1 for linear scans, 0
     // for index/tableview
+    double m_dD_at_start = 0.0;    // Value of m_dD after load_statistics()
+    std::string m_statistics_key; // Value of describe() at load_statistics()
 
     size_t m_probes = 0;
     size_t m_matches = 0;
 
+    // Number of column leaves loaded, for Query::profile(). Only counted by nodes that cache leaves themselves.
+    size_t m_leaves_loaded = 0;
+
 protected:
     typedef bool (ParentNode::*Column_action_specialized)(QueryStateBase*, SequentialGetterBase*, size_t);
     Column_action_specialized m_column_action_specializer;
@@ -283,6 +473,85 @@ protected:
         return m_table->get_column_base(ndx);
     }
 
+    // Look up the rows matching `Cond` with `value` in the ordered index of
+    // the condition column (see Table::add_ordered_index()), and keep them in
+    // `matches`. Returns false, leaving `matches` inactive, if the column has
+    // no ordered index, or the index cannot answer the condition.
+    template <class Cond, class T>
+    bool find_ordered_index_matches(const T& value, IndexMatches& matches)
+    {
+        matches.clear();
+        auto index = _impl::TableFriend::get_ordered_index(*m_table, m_condition_column_idx); // Throws
+        std::vector<size_t> rows;
+        if (!index || !index->template find<Cond>(value, rows)) // Throws
+            return false;
+        use_index_matches(std::move(rows), matches); // Throws
+        return true;
+    }
+
+    // Look up the rows equal to `value` in the hash index of the condition
+    // column (see Table::add_hash_index()), and keep them in `matches`.
+    // Returns false, leaving `matches` inactive, if `Cond` is not Equal, or
+    // the column has no hash index.
+    template <class Cond, class T>
+    bool find_hash_index_matches(const T& value, IndexMatches& matches)
+    {
+        matches.clear();
+        if (!std::is_same<Cond, Equal>::value)
+            return false;
+        auto index = _impl::TableFriend::get_hash_index(*m_table, m_condition_column_idx); // Throws
+        if (!index)
+            return false;
+        std::vector<size_t> rows;
+        index->find_all(get_column_base(m_condition_column_idx), value, rows); // Throws
+        use_index_matches(std::move(rows), matches);                         // Throws
+        return true;
+    }
+
+    void use_index_matches(std::vector<size_t> rows, IndexMatches& matches)
+    {
+        matches.assign(std::move(rows)); // Throws
+        m_dT = 0.0;
+        m_dD = m_table->size() / (matches.size() + 1.0);
+    }
+
+    std::string describe_column(size_t ndx) const
+    {
+        if (m_table && ndx < m_table->get_column_count())
+            return "'" + std::string(m_table->get_column_name(ndx)) + "'";
+        return "column " + util::to_string(ndx);
+    }
+
+    template <class T>
+    static std::string describe_value(const T& value)
+    {
+        std::ostringstream out;
+        out.precision(17);
+        out << value;
+        return out.str();
+    }
+
+    template <class T>
+    static std::string describe_value(const util::Optional<T>& value)
+    {
+        return value ? describe_value(*value) : "NULL";
+    }
+
+    static std::string describe_value(StringData value)
+    {
+        return value.is_null() ? "NULL" : "\"" + std::string(value) + "\"";
+    }
+
+    static std::string describe_value(BinaryData value)
+    {
+        return value.is_null() ? "NULL" : "binary(" + util::to_string(value.size()) + " bytes)";
+    }
+
+    static std::string describe_value(Timestamp value)
+    {
+        return value.is_null() ? "NULL" : describe_value<Timestamp>(value);
+    }
+
     template <class ColType>
     const ColType& get_column(size_t ndx)
     {
@@ -390,6 +659,18 @@ public:
         return not_found;
     }
 
+    bool can_evaluate_in_parallel() const override
+    {
+        // SubtableColumn::get_subtable_ptr() updates the subtable accessor map of the column
+        return false;
+    }
+
+    std::string describe() const override
+    {
+        return describe_column(m_condition_column_idx) + " has a row where (" +
+               (m_condition ? m_condition->describe_chain() : "") + ")";
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new SubtableNode(*this, patches));
@@ -638,6 +919,7 @@ protected:
         col.get_leaf(ndx, ndx_in_leaf, leaf_info);
         m_leaf_start = ndx - ndx_in_leaf;
         m_leaf_end = m_leaf_start + m_leaf_ptr->size();
+        ++m_leaves_loaded;
     }
 
     void cache_leaf(size_t s)
@@ -696,16 +978,62 @@ public:
     {
     }
 
+    void init() override
+    {
+        BaseType::init();
+        if (!this->template find_ordered_index_matches<TConditionFunction>(this->m_value, m_index_matches)) // Throws
+            this->template find_hash_index_matches<TConditionFunction>(this->m_value, m_index_matches); // Throws
+    }
+
+    bool get_key_range(OrderedIndex::KeyRange& range) const override
+    {
+        return OrderedIndex::get_range<TConditionFunction>(this->m_value, range);
+    }
+
+    void set_index_matches(std::vector<size_t> rows) override
+    {
+        this->use_index_matches(std::move(rows), m_index_matches); // Throws
+    }
+
     void aggregate_local_prepare(Action action, DataType col_id, bool nullable) override
     {
+        // The generic specializer is used by the bitmap strategy
+        ParentNode::aggregate_local_prepare(action, col_id, nullable);
         this->m_fastmode_disabled = (col_id == type_Float || col_id == type_Double);
         this->m_action = action;
         this->m_find_callback_specialized = get_specialized_callback(action, col_id, nullable);
     }
 
+    bool has_bitmap_evaluation() const override
+    {
+        return !ColType::nullable;
+    }
+
+    bool find_index_matches(std::vector<size_t>& rows) override
+    {
+        if (m_index_matches.is_active()) {
+            rows.insert(rows.end(), m_index_matches.rows().begin(), m_index_matches.rows().end());
+            return true;
+        }
+        const StringIndex* index = this->m_condition_column->get_search_index();
+        if (!std::is_same<TConditionFunction, Equal>::value || !index)
+            return false;
+        IndexMatches::find_rows(*index, *this->m_condition_column, this->m_value, rows);
+        return true;
+    }
+
+    void evaluate_bitmap(size_t start, size_t end, uint64_t* bits) override
+    {
+        evaluate_bitmap(start, end, bits, std::integral_constant<bool, ColType::nullable>());
+    }
+
     size_t aggregate_local(QueryStateBase* st, size_t start, size_t end, size_t local_limit,
                            SequentialGetterBase* source_column) override
     {
+        // Visit the rows found in the ordered index one by one
+        if (m_index_matches.is_active())
+            return ParentNode::aggregate_local(st, start, end, local_limit, source_column);
+
         constexpr int cond = TConditionFunction::condition;
         return this->aggregate_local_impl(st, start, end, local_limit, source_column, cond);
     }
@@ -714,6 +1042,9 @@ public:
     {
         REALM_ASSERT(this->m_table);
 
+        if (m_index_matches.is_active())
+            return m_index_matches.find_first(start, end);
+
         while (start < end) {
 
             // Cache internal leaves
@@ -746,6 +1077,12 @@ public:
         return not_found;
     }
 
+    std::string describe() const override
+    {
+        return this->describe_column(this->m_condition_column_idx) + " " + TConditionFunction::description() + " " +
+               this->describe_value(this->m_value);
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new IntegerNode<ColType, TConditionFunction>(*this, patches));
@@ -754,6 +1091,42 @@ public:
 protected:
     using TFind_callback_specialized = typename BaseType::TFind_callback_specialized;
 
+    IndexMatches m_index_matches;
+
+    void evaluate_bitmap(size_t start, size_t end, uint64_t* bits, std::true_type /* nullable */)
+    {
+        ParentNode::evaluate_bitmap(start, end, bits);
+    }
+
+    void evaluate_bitmap(size_t start, size_t end, uint64_t* bits, std::false_type /* nullable */)
+    {
+        REALM_ASSERT_DEBUG(end - start <= bitmap_window);
+        TConditionFunction cond;
+        std::fill(bits, bits + (end - start + 63) / 64, 0);
+
+        size_t r = start;
+        while (r < end) {
+            if (r >= this->m_leaf_end || r < this->m_leaf_start)
+                this->get_leaf(*this->m_condition_column, r);
+            size_t end_in_leaf = std::min(end, this->m_leaf_end) - this->m_leaf_start;
+            size_t s = r - this->m_leaf_start;
+
+            // Decompress eight values at a time, and set the bits without branching
+            int64_t chunk[8];
+            for (; s + 8 <= end_in_leaf; s += 8) {
+                this->m_leaf_ptr->get_chunk(s, chunk);
+                size_t bit = s + this->m_leaf_start - start;
+                for (size_t i = 0; i < 8; ++i, ++bit)
+                    bits[bit / 64] |= uint64_t(cond(chunk[i], this->m_value)) << (bit % 64);
+            }
+            for (; s < end_in_leaf; ++s) {
+                size_t bit = s + this->m_leaf_start - start;
+                bits[bit / 64] |= uint64_t(cond(this->m_leaf_ptr->get(s), this->m_value)) << (bit % 64);
+            }
+            r = end_in_leaf + this->m_leaf_start;
+        }
+    }
+
     static TFind_callback_specialized get_specialized_callback(Action action, DataType col_id, bool nullable)
     {
         switch (action) {
@@ -844,10 +1217,25 @@ public:
     {
         ParentNode::init();
         m_dD = 100.0;
+        m_dT = 1.0;
+        find_ordered_index_matches<TConditionFunction>(m_value, m_index_matches); // Throws
+    }
+
+    bool get_key_range(OrderedIndex::KeyRange& range) const override
+    {
+        return OrderedIndex::get_range<TConditionFunction>(m_value, range);
+    }
+
+    void set_index_matches(std::vector<size_t> rows) override
+    {
+        use_index_matches(std::move(rows), m_index_matches); // Throws
     }
 
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (m_index_matches.is_active())
+            return m_index_matches.find_first(start, end);
+
         TConditionFunction cond;
 
         auto find = [&](bool nullability) {
@@ -868,6 +1256,47 @@ public:
             return find(false);
     }
 
+    bool find_index_matches(std::vector<size_t>& rows) override
+    {
+        if (!m_index_matches.is_active())
+            return false;
+        rows.insert(rows.end(), m_index_matches.rows().begin(), m_index_matches.rows().end());
+        return true;
+    }
+
+    bool has_bitmap_evaluation() const override
+    {
+        return true;
+    }
+
+    void evaluate_bitmap(size_t start, size_t end, uint64_t* bits) override
+    {
+        REALM_ASSERT_DEBUG(end - start <= bitmap_window);
+        TConditionFunction cond;
+        std::fill(bits, bits + (end - start + 63) / 64, 0);
+
+        auto evaluate = [&](bool nullability) {
+            bool m_value_nan = nullability ? null::is_null_float(m_value) : false;
+            for (size_t s = start; s < end; ++s) {
+                TConditionValue v = m_condition_column.get_next(s);
+                bool match = cond(v, m_value, nullability ? null::is_null_float<TConditionValue>(v) : false,
+                                  m_value_nan);
+                bits[(s - start) / 64] |= uint64_t(match) << ((s - start) % 64);
+            }
+        };
+
+        if (m_table->is_nullable(m_condition_column_idx))
+            evaluate(true);
+        else
+            evaluate(false);
+    }
+
+    std::string describe() const override
+    {
+        return describe_column(m_condition_column_idx) + " " + TConditionFunction::description() + " " +
+               describe_value(m_value);
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new FloatDoubleNode(*this, patches));
@@ -883,6 +1312,7 @@ public:
 protected:
     TConditionValue m_value;
     SequentialGetter<ColType> m_condition_column;
+    IndexMatches m_index_matches;
 };
 
 
@@ -928,6 +1358,12 @@ public:
         return not_found;
     }
 
+    std::string describe() const override
+    {
+        return describe_column(m_condition_column_idx) + " " + TConditionFunction::description() + " " +
+               describe_value(m_value.get());
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new BinaryNode(*this, patches));
@@ -973,17 +1409,52 @@ public:
     void init() override
     {
         m_dD = 100.0;
+        m_dT = 1.0;
+        if (!find_ordered_index_matches<TConditionFunction>(m_value, m_index_matches)) // Throws
+            find_hash_index_matches<TConditionFunction>(m_value, m_index_matches);     // Throws
 
         if (m_child)
             m_child->init();
     }
 
+    bool get_key_range(OrderedIndex::KeyRange& range) const override
+    {
+        return OrderedIndex::get_range<TConditionFunction>(m_value, range);
+    }
+
+    void set_index_matches(std::vector<size_t> rows) override
+    {
+        use_index_matches(std::move(rows), m_index_matches); // Throws
+    }
+
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (m_index_matches.is_active())
+            return m_index_matches.find_first(start, end);
+
         size_t ret = m_condition_column->find<TConditionFunction>(m_value, start, end);
         return ret;
     }
 
+    bool find_index_matches(std::vector<size_t>& rows) override
+    {
+        if (m_index_matches.is_active()) {
+            rows.insert(rows.end(), m_index_matches.rows().begin(), m_index_matches.rows().end());
+            return true;
+        }
+        const StringIndex* index = m_condition_column->get_search_index();
+        if (!std::is_same<TConditionFunction, Equal>::value || !index)
+            return false;
+        IndexMatches::find_rows(*index, *m_condition_column, m_value, rows);
+        return true;
+    }
+
+    std::string describe() const override
+    {
+        return describe_column(m_condition_column_idx) + " " + TConditionFunction::description() + " " +
+               describe_value(m_value);
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new TimestampNode(*this, patches));
@@ -1001,6 +1472,7 @@ public:
 private:
     Timestamp m_value;
     const TimestampColumn* m_condition_column;
+    IndexMatches m_index_matches;
 };
 
 class StringNodeBase : public ParentNode {
@@ -1020,6 +1492,12 @@ public:
         m_column_type = get_real_column_type(m_condition_column_idx);
     }
 
+    std::string describe_string(const char* condition) const
+    {
+        return describe_column(m_condition_column_idx) + " " + condition + " " +
+               describe_value(m_value ? StringData(*m_value) : StringData());
+    }
+
     void init() override
     {
         m_dT = 10.0;
@@ -1052,6 +1530,37 @@ protected:
     const ColumnBase* m_condition_column = nullptr;
     ColumnType m_column_type;
 
+    // Rows that may match a substring condition, found in the trigram index of
+    // the condition column. Only active if the index could narrow the search.
+    IndexMatches m_candidates;
+
+    // The case folded index of the condition column (see
+    // Table::add_case_fold_index()), if it is used by a case insensitive
+    // condition. Set by init().
+    std::shared_ptr<const CaseFoldIndex> m_case_fold;
+
+    // If the condition column has a trigram index (see
+    // Table::add_trigram_index()), keep the rows that may contain `pattern` in
+    // m_candidates. If `is_like`, only the parts between wildcards need to be
+    // contained. For a case insensitive condition, `upper` and `lower` are the
+    // case mapped pattern, and only the parts where both are ASCII are looked
+    // up. Must be called after StringNodeBase::init().
+    void find_trigram_candidates(StringData pattern, bool is_like, const std::string* upper = nullptr,
+                                 const std::string* lower = nullptr);
+
+    // The first of m_candidates in `[start, end)` whose value satisfies
+    // `match`, or `not_found`.
+    template <class Predicate>
+    size_t find_first_candidate(size_t start, size_t end, Predicate match)
+    {
+        const std::vector<size_t>& rows = m_candidates.rows();
+        for (auto it = std::lower_bound(rows.begin(), rows.end(), start); it != rows.end() && *it < end; ++it) {
+            if (match(get_string(*it)))
+                return *it;
+        }
+        return not_found;
+    }
+
     // Used for linear scan through short/long-string
     std::unique_ptr<const ArrayParent> m_leaf;
     StringColumn::LeafType m_leaf_type;
@@ -1077,6 +1586,7 @@ protected:
                 size_t ndx_in_leaf;
                 m_leaf = asc->get_leaf(s, ndx_in_leaf, m_leaf_type);
                 m_leaf_start = s - ndx_in_leaf;
+                ++m_leaves_loaded;
                 
                 if (m_leaf_type == StringColumn::leaf_type_Small)
                     m_end_s = m_leaf_start + static_cast<const ArrayString&>(*m_leaf).size();
@@ -1123,6 +1633,42 @@ public:
 
         StringNodeBase::init();
 
+        // Values that begin with, end with, or are like a pattern contain the
+        // pattern, or its parts between wildcards
+        using C = TConditionFunction;
+        const bool is_like = std::is_same<C, Like>::value || std::is_same<C, LikeIns>::value;
+        const bool is_substring = is_like || std::is_same<C, BeginsWith>::value ||
+                                  std::is_same<C, EndsWith>::value || std::is_same<C, BeginsWithIns>::value ||
+                                  std::is_same<C, EndsWithIns>::value;
+        const bool is_ins = std::is_same<C, LikeIns>::value || std::is_same<C, BeginsWithIns>::value ||
+                            std::is_same<C, EndsWithIns>::value;
+        m_candidates.clear();
+
+        // Case insensitive equal and begins with conditions look up the rows
+        // in a case folded index, and ends with conditions compare the folded
+        // values
+        const bool is_equal_ins = std::is_same<C, EqualIns>::value;
+        const bool is_begins_with_ins = std::is_same<C, BeginsWithIns>::value;
+        const bool is_ends_with_ins = std::is_same<C, EndsWithIns>::value;
+        m_case_fold.reset();
+        if ((is_equal_ins || is_begins_with_ins || is_ends_with_ins) && m_value && error_code.empty())
+            m_case_fold = _impl::TableFriend::get_case_fold_index(*m_table, m_condition_column_idx); // Throws
+
+        if (m_case_fold && (is_equal_ins || is_begins_with_ins)) {
+            std::vector<size_t> rows;
+            if (is_equal_ins)
+                m_case_fold->find_equal(m_lcase, rows); // Throws
+            else
+                m_case_fold->find_prefix(m_lcase, rows); // Throws
+            use_index_matches(std::move(rows), m_candidates); // Throws
+        }
+        else if (is_substring && error_code.empty()) {
+            if (is_ins)
+                find_trigram_candidates(StringData(m_value), is_like, &m_ucase, &m_lcase); // Throws
+            else
+                find_trigram_candidates(StringData(m_value), is_like); // Throws
+        }
+
         if (m_child)
             m_child->init();
     }
@@ -1132,6 +1678,21 @@ public:
     {
         TConditionFunction cond;
 
+        if (m_candidates.is_active()) {
+            return find_first_candidate(start, end, [&](StringData t) {
+                return cond(StringData(m_value), m_ucase.data(), m_lcase.data(), t);
+            });
+        }
+
+        if (std::is_same<TConditionFunction, EndsWithIns>::value && m_case_fold) {
+            for (size_t s = start; s < end; ++s) {
+                if (m_case_fold->get(s).ends_with(m_lcase) &&
+                    cond(StringData(m_value), m_ucase.data(), m_lcase.data(), get_string(s)))
+                    return s;
+            }
+            return not_found;
+        }
+
         for (size_t s = start; s < end; ++s) {
             StringData t = get_string(s);
             
@@ -1141,6 +1702,11 @@ public:
         return not_found;
     }
 
+    std::string describe() const override
+    {
+        return describe_string(TConditionFunction::description());
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new StringNode<TConditionFunction>(*this, patches));
@@ -1187,6 +1753,7 @@ public:
         m_dD = 100.0;
         
         StringNodeBase::init();
+        find_trigram_candidates(StringData(m_value), false); // Throws
         
         if (m_child)
             m_child->init();
@@ -1197,6 +1764,11 @@ public:
     {
         Contains cond;
         
+        if (m_candidates.is_active()) {
+            return find_first_candidate(start, end,
+                                        [&](StringData t) { return cond(StringData(m_value), m_charmap, t); });
+        }
+
         for (size_t s = start; s < end; ++s) {
             StringData t = get_string(s);
             
@@ -1206,6 +1778,11 @@ public:
         return not_found;
     }
     
+    std::string describe() const override
+    {
+        return describe_string(Contains::description());
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new StringNode<Contains>(*this, patches));
@@ -1263,6 +1840,13 @@ public:
         m_dD = 100.0;
         
         StringNodeBase::init();
+        m_candidates.clear();
+        m_case_fold.reset();
+        if (error_code.empty()) {
+            find_trigram_candidates(StringData(m_value), false, &m_ucase, &m_lcase); // Throws
+            if (!m_candidates.is_active() && m_value)
+                m_case_fold = _impl::TableFriend::get_case_fold_index(*m_table, m_condition_column_idx); // Throws
+        }
         
         if (m_child)
             m_child->init();
@@ -1273,6 +1857,24 @@ public:
     {
         ContainsIns cond;
         
+        if (m_candidates.is_active()) {
+            return find_first_candidate(start, end, [&](StringData t) {
+                return cond(StringData(m_value), m_ucase.data(), m_lcase.data(), m_charmap, t);
+            });
+        }
+
+        // Search the case folded values byte by byte
+        if (m_case_fold) {
+            StringData lcase(m_lcase);
+            for (size_t s = start; s < end; ++s) {
+                StringData folded = m_case_fold->get(s);
+                if (!folded.is_null() && folded.contains(lcase) &&
+                    cond(StringData(m_value), m_ucase.data(), m_lcase.data(), m_charmap, get_string(s)))
+                    return s;
+            }
+            return not_found;
+        }
+
         for (size_t s = start; s < end; ++s) {
             StringData t = get_string(s);
             
@@ -1282,6 +1884,11 @@ public:
         return not_found;
     }
     
+    std::string describe() const override
+    {
+        return describe_string(ContainsIns::description());
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new StringNode<ContainsIns>(*this, patches));
@@ -1396,6 +2003,9 @@ public:
             m_cse.init(static_cast<const StringEnumColumn*>(m_condition_column));
         }
 
+        if (!m_condition_column->has_search_index())
+            find_hash_index_matches<Equal>(StringData(m_value), m_hash_matches); // Throws
+
         if (m_child)
             m_child->init();
     }
@@ -1404,6 +2014,9 @@ public:
     {
         REALM_ASSERT(m_table);
 
+        if (m_hash_matches.is_active())
+            return m_hash_matches.find_first(start, end);
+
         if (m_condition_column->has_search_index()) {
             // Indexed string column
             if (!m_index_getter)
@@ -1464,6 +2077,7 @@ public:
                 size_t ndx_in_leaf;
                 m_leaf = asc->get_leaf(s, ndx_in_leaf, m_leaf_type);
                 m_leaf_start = s - ndx_in_leaf;
+                ++m_leaves_loaded;
                 if (m_leaf_type == StringColumn::leaf_type_Small)
                     m_leaf_end = m_leaf_start + static_cast<const ArrayString&>(*m_leaf).size();
                 else if (m_leaf_type == StringColumn::leaf_type_Medium)
@@ -1491,6 +2105,26 @@ public:
         return not_found;
     }
 
+    bool find_index_matches(std::vector<size_t>& rows) override
+    {
+        if (m_hash_matches.is_active()) {
+            rows.insert(rows.end(), m_hash_matches.rows().begin(), m_hash_matches.rows().end());
+            return true;
+        }
+        if (!m_condition_column->has_search_index())
+            return false;
+        if (m_index_getter) {
+            for (size_t i = m_results_start; i < m_results_end; ++i)
+                rows.push_back(to_size_t(m_index_matches->get(i)));
+        }
+        return true;
+    }
+
+    std::string describe() const override
+    {
+        return describe_string(Equal::description());
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new StringNode<Equal>(*this, patches));
@@ -1516,12 +2150,450 @@ private:
     // Used for index lookup
     std::unique_ptr<IntegerColumn> m_index_matches;
     bool m_index_matches_destroy = false;
+    IndexMatches m_hash_matches; // Rows found in the hash index of the column, if any
     std::unique_ptr<SequentialGetter<IntegerColumn>> m_index_getter;
     size_t m_results_start;
     size_t m_results_end;
     size_t m_last_start;
 };
 
+// Describe the condition of Query::in(), listing at most the first few values
+template <class T, class F>
+std::string describe_in(std::string column, const std::vector<T>& values, F describe_value)
+{
+    const size_t max_values = 8;
+    std::string s = column + " IN (";
+    for (size_t i = 0; i < values.size() && i < max_values; ++i) {
+        if (i != 0)
+            s += ", ";
+        s += describe_value(values[i]);
+    }
+    if (values.size() > max_values)
+        s += ", ... " + util::to_string(values.size()) + " values";
+    return s + ")";
+}
+
+// Integer column condition of Query::in(). Each row is looked up in the set of values, which is kept both sorted and,
+// when the values are close together, as a bitmap indexed by value.
+template <class ColType>
+class IntegerInNode : public ParentNode {
+public:
+    IntegerInNode(std::vector<int64_t> values, size_t column_ndx)
+        : m_values(std::move(values))
+    {
+        m_condition_column_idx = column_ndx;
+        std::sort(m_values.begin(), m_values.end());
+        m_values.erase(std::unique(m_values.begin(), m_values.end()), m_values.end());
+        if (m_values.empty())
+            return;
+
+        // A bitmap is used if it is not much larger than the sorted values
+        m_min = m_values.front();
+        m_max = m_values.back();
+        uint64_t range = uint64_t(m_max) - uint64_t(m_min);
+        if (range / 64 < 4 * m_values.size() + 64) {
+            m_bits.resize(range / 64 + 1);
+            for (int64_t v : m_values) {
+                uint64_t bit = uint64_t(v) - uint64_t(m_min);
+                m_bits[bit / 64] |= uint64_t(1) << (bit % 64);
+            }
+        }
+    }
+
+    void table_changed() override
+    {
+        m_condition_column.init(&get_column<ColType>(m_condition_column_idx));
+    }
+
+    void init() override
+    {
+        ParentNode::init();
+        m_dD = 100.0;
+        m_dT = 1.0 / 2.0;
+        if (m_index_matches.find(*m_condition_column.m_column, m_values)) {
+            m_dD = m_table->size() / (m_index_matches.size() + 1.0);
+            m_dT = 0.0;
+        }
+    }
+
+    size_t find_first_local(size_t start, size_t end) override
+    {
+        if (m_index_matches.is_active())
+            return m_index_matches.find_first(start, end);
+        if (m_values.empty())
+            return not_found;
+
+        using value_type = typename ColType::value_type;
+        for (size_t s = start; s < end;) {
+            m_condition_column.cache_next(s);
+            ++m_leaves_loaded;
+            const auto& leaf = *m_condition_column.m_leaf_ptr;
+            size_t leaf_start = m_condition_column.m_leaf_start;
+            size_t end_in_leaf = m_condition_column.local_end(end);
+            size_t i = s - leaf_start;
+
+            // Decompress eight values at a time
+            value_type chunk[8];
+            for (; i + 8 <= end_in_leaf; i += 8) {
+                leaf.get_chunk(i, chunk);
+                for (size_t j = 0; j < 8; ++j) {
+                    if (contains(chunk[j]))
+                        return leaf_start + i + j;
+                }
+            }
+            for (; i < end_in_leaf; ++i) {
+                if (contains(leaf.get(i)))
+                    return leaf_start + i;
+            }
+            s = leaf_start + end_in_leaf;
+        }
+        return not_found;
+    }
+
+    bool find_index_matches(std::vector<size_t>& rows) override
+    {
+        if (!m_index_matches.is_active())
+            return false;
+        rows.insert(rows.end(), m_index_matches.rows().begin(), m_index_matches.rows().end());
+        return true;
+    }
+
+    std::string describe() const override
+    {
+        return describe_in(describe_column(m_condition_column_idx), m_values,
+                           [](int64_t v) { return describe_value(v); });
+    }
+
+    std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
+    {
+        return std::unique_ptr<ParentNode>(new IntegerInNode(*this, patches));
+    }
+
+    IntegerInNode(const IntegerInNode& from, QueryNodeHandoverPatches* patches)
+        : ParentNode(from, patches)
+        , m_values(from.m_values)
+        , m_bits(from.m_bits)
+        , m_min(from.m_min)
+        , m_max(from.m_max)
+    {
+        copy_getter(m_condition_column, m_condition_column_idx, from.m_condition_column, patches);
+    }
+
+private:
+    bool contains(int64_t v) const noexcept
+    {
+        if (v < m_min || v > m_max)
+            return false;
+        if (!m_bits.empty()) {
+            uint64_t bit = uint64_t(v) - uint64_t(m_min);
+            return (m_bits[bit / 64] >> (bit % 64)) & 1;
+        }
+        return std::binary_search(m_values.begin(), m_values.end(), v);
+    }
+
+    bool contains(util::Optional<int64_t> v) const noexcept
+    {
+        return v && contains(*v);
+    }
+
+    std::vector<int64_t> m_values; // Sorted and distinct
+    std::vector<uint64_t> m_bits;  // Bit `v - m_min` is set for each value `v`, or empty
+    int64_t m_min = 0;
+    int64_t m_max = -1;
+    SequentialGetter<ColType> m_condition_column;
+    IndexMatches m_index_matches;
+};
+
+// String column condition of Query::in(). For a column with enumerated strings, the values are translated to keys
+// once, so that rows are tested without looking at the strings.
+class StringInNode : public StringNodeBase {
+public:
+    StringInNode(const std::vector<StringData>& values, size_t column)
+        : StringNodeBase(StringData(), column)
+    {
+        for (StringData v : values) {
+            if (v.is_null())
+                m_has_null = true;
+            else
+                m_values.push_back(v);
+        }
+        std::sort(m_values.begin(), m_values.end(), less);
+        m_values.erase(std::unique(m_values.begin(), m_values.end()), m_values.end());
+    }
+
+    void init() override
+    {
+        StringNodeBase::init();
+        m_dD = 100.0;
+        m_dT = 10.0;
+        m_keys.clear();
+
+        std::vector<StringData> values(m_values.begin(), m_values.end());
+        if (m_has_null && m_condition_column->is_nullable())
+            values.push_back(StringData());
+
+        if (m_index_matches.find(*m_condition_column, values)) {
+            m_dD = m_table->size() / (m_index_matches.size() + 1.0);
+            m_dT = 0.0;
+        }
+        else if (m_column_type == col_type_StringEnum) {
+            auto column = static_cast<const StringEnumColumn*>(m_condition_column);
+            for (StringData v : values) {
+                size_t key_ndx = column->get_key_ndx(v);
+                if (key_ndx != not_found)
+                    m_keys.push_back(key_ndx);
+            }
+            std::sort(m_keys.begin(), m_keys.end());
+            m_cse.init(column);
+            m_dT = 1.0;
+        }
+
+        if (m_child)
+            m_child->init();
+    }
+
+    size_t find_first_local(size_t start, size_t end) override
+    {
+        if (m_index_matches.is_active())
+            return m_index_matches.find_first(start, end);
+
+        if (m_column_type == col_type_StringEnum) {
+            if (m_keys.empty())
+                return not_found;
+            for (size_t s = start; s < end;) {
+                m_cse.cache_next(s);
+                ++m_leaves_loaded;
+                size_t end_in_leaf = m_cse.local_end(end);
+                for (size_t i = s - m_cse.m_leaf_start; i < end_in_leaf; ++i) {
+                    size_t key_ndx = to_size_t(m_cse.m_leaf_ptr->get(i));
+                    if (std::binary_search(m_keys.begin(), m_keys.end(), key_ndx))
+                        return m_cse.m_leaf_start + i;
+                }
+                s = m_cse.m_leaf_start + end_in_leaf;
+            }
+            return not_found;
+        }
+
+        for (size_t s = start; s < end; ++s) {
+            StringData v = get_string(s);
+            if (v.is_null() ? m_has_null : std::binary_search(m_values.begin(), m_values.end(), v, less))
+                return s;
+        }
+        return not_found;
+    }
+
+    bool find_index_matches(std::vector<size_t>& rows) override
+    {
+        if (!m_index_matches.is_active())
+            return false;
+        rows.insert(rows.end(), m_index_matches.rows().begin(), m_index_matches.rows().end());
+        return true;
+    }
+
+    std::string describe() const override
+    {
+        std::vector<StringData> values(m_values.begin(), m_values.end());
+        if (m_has_null)
+            values.push_back(StringData());
+        return describe_in(describe_column(m_condition_column_idx), values,
+                           [](StringData v) { return describe_value(v); });
+    }
+
+    std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
+    {
+        return std::unique_ptr<ParentNode>(new StringInNode(*this, patches));
+    }
+
+    StringInNode(const StringInNode& from, QueryNodeHandoverPatches* patches)
+        : StringNodeBase(from, patches)
+        , m_values(from.m_values)
+        , m_has_null(from.m_has_null)
+    {
+    }
+
+private:
+    static bool less(StringData a, StringData b) noexcept
+    {
+        return a < b;
+    }
+
+    std::vector<std::string> m_values; // Sorted and distinct, not including null
+    bool m_has_null = false;
+
+    // Keys of the values, for a column with enumerated strings
+    std::vector<size_t> m_keys;
+    SequentialGetter<StringEnumColumn> m_cse;
+
+    IndexMatches m_index_matches;
+};
+
+// String column condition of Query::matches()
+class FullTextNode : public StringNodeBase {
+public:
+    FullTextNode(StringData terms, size_t column)
+        : StringNodeBase(terms, column)
+    {
+        FullTextIndex::tokenize(terms, m_words);
+    }
+
+    void init() override
+    {
+        clear_leaf_state();
+
+        m_dD = 100.0;
+
+        StringNodeBase::init();
+
+        m_candidates.clear();
+        auto index = _impl::TableFriend::get_fulltext_index(*m_table, m_condition_column_idx); // Throws
+        if (index) {
+            // The index finds exactly the matching rows
+            std::vector<size_t> rows;
+            index->find_all(m_words, rows);                    // Throws
+            use_index_matches(std::move(rows), m_candidates); // Throws
+        }
+
+        if (m_child)
+            m_child->init();
+    }
+
+    size_t find_first_local(size_t start, size_t end) override
+    {
+        if (m_candidates.is_active())
+            return m_candidates.find_first(start, end);
+
+        std::vector<std::string> words;
+        for (size_t s = start; s < end; ++s) {
+            words.clear();
+            FullTextIndex::tokenize(get_string(s), words); // Throws
+            if (std::includes(words.begin(), words.end(), m_words.begin(), m_words.end()))
+                return s;
+        }
+        return not_found;
+    }
+
+    bool find_index_matches(std::vector<size_t>& rows) override
+    {
+        if (!m_candidates.is_active())
+            return false;
+        rows.insert(rows.end(), m_candidates.rows().begin(), m_candidates.rows().end());
+        return true;
+    }
+
+    std::string describe() const override
+    {
+        return describe_string("MATCHES");
+    }
+
+    std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
+    {
+        return std::unique_ptr<ParentNode>(new FullTextNode(*this, patches));
+    }
+
+    FullTextNode(const FullTextNode& from, QueryNodeHandoverPatches* patches)
+        : StringNodeBase(from, patches)
+        , m_words(from.m_words)
+    {
+    }
+
+private:
+    std::vector<std::string> m_words; // Sorted and distinct, see FullTextIndex::tokenize()
+};
+
+// Timestamp column condition of Query::in()
+class TimestampInNode : public ParentNode {
+public:
+    TimestampInNode(const std::vector<Timestamp>& values, size_t column)
+    {
+        m_condition_column_idx = column;
+        for (const Timestamp& v : values) {
+            if (v.is_null())
+                m_has_null = true;
+            else
+                m_values.push_back(v);
+        }
+        std::sort(m_values.begin(), m_values.end(), less);
+        m_values.erase(std::unique(m_values.begin(), m_values.end()), m_values.end());
+    }
+
+    void table_changed() override
+    {
+        m_condition_column = &get_column<TimestampColumn>(m_condition_column_idx);
+    }
+
+    void init() override
+    {
+        ParentNode::init();
+        m_dD = 100.0;
+        m_dT = 2.0;
+
+        std::vector<Timestamp> values = m_values;
+        if (m_has_null && m_condition_column->is_nullable())
+            values.push_back(Timestamp());
+        if (m_index_matches.find(*m_condition_column, values)) {
+            m_dD = m_table->size() / (m_index_matches.size() + 1.0);
+            m_dT = 0.0;
+        }
+    }
+
+    size_t find_first_local(size_t start, size_t end) override
+    {
+        if (m_index_matches.is_active())
+            return m_index_matches.find_first(start, end);
+
+        for (size_t s = start; s < end; ++s) {
+            Timestamp v = m_condition_column->get(s);
+            if (v.is_null() ? m_has_null : std::binary_search(m_values.begin(), m_values.end(), v, less))
+                return s;
+        }
+        return not_found;
+    }
+
+    bool find_index_matches(std::vector<size_t>& rows) override
+    {
+        if (!m_index_matches.is_active())
+            return false;
+        rows.insert(rows.end(), m_index_matches.rows().begin(), m_index_matches.rows().end());
+        return true;
+    }
+
+    std::string describe() const override
+    {
+        std::vector<Timestamp> values = m_values;
+        if (m_has_null)
+            values.push_back(Timestamp());
+        return describe_in(describe_column(m_condition_column_idx), values,
+                           [](Timestamp v) { return describe_value(v); });
+    }
+
+    std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
+    {
+        return std::unique_ptr<ParentNode>(new TimestampInNode(*this, patches));
+    }
+
+    TimestampInNode(const TimestampInNode& from, QueryNodeHandoverPatches* patches)
+        : ParentNode(from, patches)
+        , m_values(from.m_values)
+        , m_has_null(from.m_has_null)
+        , m_condition_column(from.m_condition_column)
+    {
+        if (m_condition_column && patches)
+            m_condition_column_idx = m_condition_column->get_column_index();
+    }
+
+private:
+    static bool less(const Timestamp& a, const Timestamp& b) noexcept
+    {
+        return a.get_seconds() < b.get_seconds() ||
+               (a.get_seconds() == b.get_seconds() && a.get_nanoseconds() < b.get_nanoseconds());
+    }
+
+    std::vector<Timestamp> m_values; // Sorted and distinct, not including null
+    bool m_has_null = false;
+    const TimestampColumn* m_condition_column = nullptr;
+    IndexMatches m_index_matches;
+};
+
 // OR node contains at least two node pointers: Two or more conditions to OR
 // together in m_conditions, and the next AND condition (if any) in m_child.
 //
@@ -1575,6 +2647,20 @@ public:
             condition->gather_children(v);
         }
 
+        // If each alternative is a single condition whose matches can be looked up in a search index, the matches
+        // of the OR are the union of the lookups
+        m_dT = 50.0;
+        m_index_matches.clear();
+        std::vector<size_t> rows;
+        bool use_index = !m_conditions.empty();
+        for (size_t c = 0; c < m_conditions.size() && use_index; ++c)
+            use_index = !m_conditions[c]->m_child && m_conditions[c]->find_index_matches(rows);
+        if (use_index) {
+            m_index_matches.assign(std::move(rows));
+            m_dT = 0.0;
+            m_dD = m_table->size() / (m_index_matches.size() + 1.0);
+        }
+
         if (m_child)
             m_child->init();
     }
@@ -1584,6 +2670,9 @@ public:
         if (start >= end)
             return not_found;
 
+        if (m_index_matches.is_active())
+            return m_index_matches.find_first(start, end);
+
         size_t index = not_found;
 
         for (size_t c = 0; c < m_conditions.size(); ++c) {
@@ -1614,6 +2703,39 @@ public:
         return index;
     }
 
+    bool can_evaluate_in_parallel() const override
+    {
+        for (auto& condition : m_conditions) {
+            if (!condition->can_evaluate_in_parallel())
+                return false;
+        }
+        return ParentNode::can_evaluate_in_parallel();
+    }
+
+    bool has_bitmap_evaluation() const override
+    {
+        for (auto& condition : m_conditions) {
+            for (ParentNode* node : condition->m_children) {
+                if (!node->has_bitmap_evaluation())
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    void evaluate_bitmap(size_t start, size_t end, uint64_t* bits) override
+    {
+        REALM_ASSERT_DEBUG(end - start <= bitmap_window);
+        size_t num_words = (end - start + 63) / 64;
+        std::fill(bits, bits + num_words, 0);
+        uint64_t condition_bits[bitmap_window / 64];
+        for (auto& condition : m_conditions) {
+            evaluate_conjunction_bitmap(condition->m_children, start, end, condition_bits);
+            for (size_t i = 0; i < num_words; ++i)
+                bits[i] |= condition_bits[i];
+        }
+    }
+
     std::string validate() override
     {
         if (error_code != "")
@@ -1635,6 +2757,17 @@ public:
         return "";
     }
 
+    std::string describe() const override
+    {
+        std::string s;
+        for (size_t i = 0; i < m_conditions.size(); ++i) {
+            if (i != 0)
+                s += " || ";
+            s += m_conditions[i]->describe_chain();
+        }
+        return "(" + s + ")";
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new OrNode(*this, patches));
@@ -1657,6 +2790,7 @@ private:
     // is a matching index if m_was_match is true
     std::vector<size_t> m_last;
     std::vector<bool> m_was_match;
+    IndexMatches m_index_matches;
 };
 
 
@@ -1711,6 +2845,16 @@ public:
         return "";
     }
 
+    bool can_evaluate_in_parallel() const override
+    {
+        return m_condition->can_evaluate_in_parallel() && ParentNode::can_evaluate_in_parallel();
+    }
+
+    std::string describe() const override
+    {
+        return "!(" + m_condition->describe_chain() + ")";
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new NotNode(*this, patches));
@@ -1830,6 +2974,12 @@ public:
         return not_found;
     }
 
+    std::string describe() const override
+    {
+        return describe_column(m_condition_column_idx1) + " " + TConditionFunction::description() + " " +
+               describe_column(m_condition_column_idx2);
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new TwoColumnsNode<ColType, TConditionFunction>(*this, patches));
@@ -1881,6 +3031,16 @@ public:
         return m_expression->find_first(start, end);
     }
 
+    bool can_evaluate_in_parallel() const override
+    {
+        return m_expression->can_evaluate_in_parallel() && ParentNode::can_evaluate_in_parallel();
+    }
+
+    std::string describe() const override
+    {
+        return "expression";
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new ExpressionNode(*this, patches));
@@ -1949,6 +3109,18 @@ public:
         return not_found;
     }
 
+    bool can_evaluate_in_parallel() const override
+    {
+        // LinkListColumn::get() updates the link list accessor cache of the column
+        return m_column_type == type_Link && ParentNode::can_evaluate_in_parallel();
+    }
+
+    std::string describe() const override
+    {
+        return describe_column(m_origin_column) + " links to row " +
+               (m_target_row.is_attached() ? util::to_string(m_target_row.get_index()) : "(detached)");
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(patches ? new LinksToNode(*this, patches) : new LinksToNode(*this));
@@ -88,6 +88,16 @@ containing 8 values representing table rows i...i + 7.
 So Value<T> contains 8 concecutive values and all operations are based on these chunks. This is
 to save overhead by virtual calls needed for evaluating a query that has been dynamically constructed at runtime.
 
+Batch evaluation:
+-----------------------------------------------------------------------------------------------------------------------
+Numeric expressions that involve neither links nor nullable columns are additionally evaluated in batches of up to
+Subexpr::batch_size rows. Subexpressions for which supports_batch() returns true implement evaluate_batch(), which
+writes the values of consecutive rows into a plain array of int64_t, float or double. Columns<T> reads them directly
+from the leaves, Operator<> and UnaryOperator<> apply their operation in a simple loop over such arrays, and Compare<>
+compares two arrays in a similar loop. These loops have no nulls, no virtual calls and no conversions inside them, so
+the compiler can vectorize them. Compare<> uses batch evaluation whenever both of its operands support it, and falls
+back to evaluate() otherwise.
+
 
 Memory allocation:
 -----------------------------------------------------------------------------------------------------------------------
@@ -358,6 +368,12 @@ public:
     virtual void set_base_table(const Table* table) = 0;
     virtual const Table* get_base_table() const = 0;
 
+    // See Subexpr::can_evaluate_in_parallel()
+    virtual bool can_evaluate_in_parallel() const
+    {
+        return false;
+    }
+
     virtual std::unique_ptr<Expression> clone(QueryNodeHandoverPatches*) const = 0;
     virtual void apply_handover_patch(QueryNodeHandoverPatches&, Group&)
     {
@@ -400,7 +416,46 @@ public:
         return nullptr;
     }
 
+    // Returns false if evaluation instantiates accessors through caches that are shared by all copies of the
+    // expression, such as the link list accessors of a LinkListColumn. Such expressions cannot be evaluated by
+    // several threads at once.
+    virtual bool can_evaluate_in_parallel() const
+    {
+        return true;
+    }
+
     virtual void evaluate(size_t index, ValueBase& destination) = 0;
+
+    // Maximum number of rows evaluated by a single call to evaluate_batch()
+    static const size_t batch_size = 256;
+
+    // Returns true if evaluate_batch() can be used. It must only be called after set_base_table(), and it must
+    // only return true for numeric expressions whose values can never be null, and which do not follow links.
+    virtual bool supports_batch() const
+    {
+        return false;
+    }
+
+    // Write the values of the `size` consecutive rows starting at `index` into `destination`, converted to the type
+    // of the destination. `size` must not exceed `batch_size`. Requires supports_batch().
+    virtual void evaluate_batch(size_t, size_t, int64_t*)
+    {
+        REALM_ASSERT(false);
+    }
+    virtual void evaluate_batch(size_t, size_t, float*)
+    {
+        REALM_ASSERT(false);
+    }
+    virtual void evaluate_batch(size_t, size_t, double*)
+    {
+        REALM_ASSERT(false);
+    }
+};
+
+// Types of values for which batch evaluation is supported
+template <class T>
+struct is_batch_type {
+    static const bool value = realm::is_any<T, int64_t, float, double>::value;
 };
 
 template <typename T, typename... Args>
@@ -1077,6 +1132,38 @@ public:
         destination.import(*this);
     }
 
+    bool supports_batch() const override
+    {
+        bool numeric = is_batch_type<T>::value || std::is_same<T, int>::value;
+        return numeric && !m_from_link_list && m_values > 0 && !m_storage.is_null(0);
+    }
+
+    void evaluate_batch(size_t, size_t size, int64_t* destination) override
+    {
+        fill_batch(size, destination);
+    }
+    void evaluate_batch(size_t, size_t size, float* destination) override
+    {
+        fill_batch(size, destination);
+    }
+    void evaluate_batch(size_t, size_t size, double* destination) override
+    {
+        fill_batch(size, destination);
+    }
+
+    // A Value used as a subexpression is a constant, so it is simply repeated for each row
+    template <class D>
+    typename std::enable_if<std::is_convertible<T, D>::value>::type fill_batch(size_t size, D* destination) const
+    {
+        std::fill_n(destination, size, static_cast<D>(m_storage[0]));
+    }
+
+    template <class D>
+    typename std::enable_if<!std::is_convertible<T, D>::value>::type fill_batch(size_t, D*) const
+    {
+        REALM_ASSERT_DEBUG(false);
+    }
+
 
     template <class TOperator>
     REALM_FORCEINLINE void fun(const Value* left, const Value* right)
@@ -1833,6 +1920,11 @@ public:
         return m_link_map.base_table();
     }
 
+    bool can_evaluate_in_parallel() const override
+    {
+        return m_link_map.only_unary_links();
+    }
+
     void set_base_table(const Table* table) override
     {
         if (table != get_base_table()) {
@@ -2084,6 +2176,11 @@ public:
         return m_link_map.base_table();
     }
 
+    bool can_evaluate_in_parallel() const override
+    {
+        return m_link_map.only_unary_links();
+    }
+
     size_t find_first(size_t start, size_t end) const override
     {
         for (; start < end;) {
@@ -2138,6 +2235,11 @@ public:
         return m_link_map.base_table();
     }
 
+    bool can_evaluate_in_parallel() const override
+    {
+        return false;
+    }
+
     void set_base_table(const Table* table) override
     {
         m_link_map.set_base_table(table);
@@ -2259,6 +2361,11 @@ public:
     {
         return m_link_map.base_table();
     }
+
+    bool can_evaluate_in_parallel() const override
+    {
+        return false;
+    }
     void set_base_table(const Table* table) override
     {
         m_link_map.set_base_table(table);
@@ -2457,6 +2564,11 @@ public:
         return m_link_map.base_table();
     }
 
+    bool can_evaluate_in_parallel() const override
+    {
+        return m_link_map.only_unary_links();
+    }
+
     template <class ColType2 = ColType>
     void evaluate_internal(size_t index, ValueBase& destination)
     {
@@ -2532,6 +2644,68 @@ public:
         }
     }
 
+    bool supports_batch() const override
+    {
+        return is_batch_type<T>::value && m_sg && !m_nullable && !links_exist();
+    }
+
+    void evaluate_batch(size_t index, size_t size, int64_t* destination) override
+    {
+        evaluate_batch_internal(index, size, destination);
+    }
+    void evaluate_batch(size_t index, size_t size, float* destination) override
+    {
+        evaluate_batch_internal(index, size, destination);
+    }
+    void evaluate_batch(size_t index, size_t size, double* destination) override
+    {
+        evaluate_batch_internal(index, size, destination);
+    }
+
+    // Copy the values straight out of the leaves that hold them
+    template <class D>
+    void evaluate_batch_internal(size_t index, size_t size, D* destination)
+    {
+        REALM_ASSERT_DEBUG(supports_batch());
+        auto sgc = static_cast<SequentialGetter<ColType>*>(m_sg.get());
+        size_t end = index + size;
+        while (index < end) {
+            sgc->cache_next(index);
+            size_t begin_in_leaf = index - sgc->m_leaf_start;
+            size_t end_in_leaf = sgc->local_end(end);
+            read_leaf(*sgc->m_leaf_ptr, begin_in_leaf, end_in_leaf, destination);
+            destination += end_in_leaf - begin_in_leaf;
+            index = sgc->m_leaf_start + end_in_leaf;
+        }
+    }
+
+    template <class D>
+    static void read_leaf(const ArrayInteger& leaf, size_t begin, size_t end, D* destination)
+    {
+        // Integer leaves are bit packed, so unpack them 8 values at a time (see Array::get_chunk())
+        int64_t chunk[8];
+        for (size_t i = begin; i < end; i += 8) {
+            leaf.get_chunk(i, chunk);
+            size_t n = std::min<size_t>(8, end - i);
+            for (size_t j = 0; j < n; ++j)
+                *destination++ = static_cast<D>(chunk[j]);
+        }
+    }
+
+    template <class D, class L>
+    static void read_leaf(const BasicArray<L>& leaf, size_t begin, size_t end, D* destination)
+    {
+        for (size_t i = begin; i < end; ++i)
+            *destination++ = static_cast<D>(leaf.get(i));
+    }
+
+    template <class D, class Leaf>
+    static void read_leaf(const Leaf&, size_t, size_t, D*)
+    {
+        // Instantiated for column types that never support batch evaluation
+        REALM_ASSERT_DEBUG(false);
+    }
+
     bool links_exist() const
     {
         return m_link_map.m_link_columns.size() > 0;
@@ -2601,6 +2775,11 @@ public:
         return m_link_map.base_table();
     }
 
+    bool can_evaluate_in_parallel() const override
+    {
+        return false;
+    }
+
     void set_base_table(const Table* table) override
     {
         m_link_map.set_base_table(table);
@@ -2662,6 +2841,11 @@ public:
         return m_link_map.base_table();
     }
 
+    bool can_evaluate_in_parallel() const override
+    {
+        return false;
+    }
+
     void set_base_table(const Table* table) override
     {
         m_link_map.set_base_table(table);
@@ -2725,6 +2909,11 @@ public:
         return m_link_map.base_table();
     }
 
+    bool can_evaluate_in_parallel() const override
+    {
+        return false;
+    }
+
     void set_base_table(const Table* table) override
     {
         m_link_map.set_base_table(table);
@@ -2926,6 +3115,11 @@ public:
         return m_left->get_base_table();
     }
 
+    bool can_evaluate_in_parallel() const override
+    {
+        return m_left->can_evaluate_in_parallel();
+    }
+
     // destination = operator(left)
     void evaluate(size_t index, ValueBase& destination) override
     {
@@ -2936,6 +3130,34 @@ public:
         destination.import(result);
     }
 
+    bool supports_batch() const override
+    {
+        return is_batch_type<T>::value && m_left->supports_batch();
+    }
+
+    void evaluate_batch(size_t index, size_t size, int64_t* destination) override
+    {
+        evaluate_batch_internal(index, size, destination);
+    }
+    void evaluate_batch(size_t index, size_t size, float* destination) override
+    {
+        evaluate_batch_internal(index, size, destination);
+    }
+    void evaluate_batch(size_t index, size_t size, double* destination) override
+    {
+        evaluate_batch_internal(index, size, destination);
+    }
+
+    template <class D>
+    void evaluate_batch_internal(size_t index, size_t size, D* destination)
+    {
+        BatchType left[Subexpr::batch_size];
+        m_left->evaluate_batch(index, size, left);
+        oper o;
+        for (size_t i = 0; i < size; ++i)
+            destination[i] = static_cast<D>(o(left[i]));
+    }
+
     std::unique_ptr<Subexpr> clone(QueryNodeHandoverPatches* patches) const override
     {
         return make_subexpr<UnaryOperator>(*this, patches);
@@ -2948,6 +3170,7 @@ public:
 
 private:
     typedef typename oper::type T;
+    typedef typename std::conditional<is_batch_type<T>::value, T, int64_t>::type BatchType;
     std::unique_ptr<TLeft> m_left;
 };
 
@@ -3001,6 +3224,11 @@ public:
         return l ? l : r;
     }
 
+    bool can_evaluate_in_parallel() const override
+    {
+        return m_left->can_evaluate_in_parallel() && m_right->can_evaluate_in_parallel();
+    }
+
     // destination = operator(left, right)
     void evaluate(size_t index, ValueBase& destination) override
     {
@@ -3013,6 +3241,36 @@ public:
         destination.import(result);
     }
 
+    bool supports_batch() const override
+    {
+        return is_batch_type<T>::value && m_left->supports_batch() && m_right->supports_batch();
+    }
+
+    void evaluate_batch(size_t index, size_t size, int64_t* destination) override
+    {
+        evaluate_batch_internal(index, size, destination);
+    }
+    void evaluate_batch(size_t index, size_t size, float* destination) override
+    {
+        evaluate_batch_internal(index, size, destination);
+    }
+    void evaluate_batch(size_t index, size_t size, double* destination) override
+    {
+        evaluate_batch_internal(index, size, destination);
+    }
+
+    template <class D>
+    void evaluate_batch_internal(size_t index, size_t size, D* destination)
+    {
+        BatchType left[Subexpr::batch_size];
+        BatchType right[Subexpr::batch_size];
+        m_left->evaluate_batch(index, size, left);
+        m_right->evaluate_batch(index, size, right);
+        oper o;
+        for (size_t i = 0; i < size; ++i)
+            destination[i] = static_cast<D>(o(left[i], right[i]));
+    }
+
     std::unique_ptr<Subexpr> clone(QueryNodeHandoverPatches* patches) const override
     {
         return make_subexpr<Operator>(*this, patches);
@@ -3026,6 +3284,7 @@ public:
 
 private:
     typedef typename oper::type T;
+    typedef typename std::conditional<is_batch_type<T>::value, T, int64_t>::type BatchType;
     std::unique_ptr<TLeft> m_left;
     std::unique_ptr<TRight> m_right;
 };
@@ -3045,6 +3304,7 @@ public:
     {
         m_left->set_base_table(table);
         m_right->set_base_table(table);
+        m_batch = is_batch_type<T>::value && m_left->supports_batch() && m_right->supports_batch();
     }
 
     // Recursively fetch tables of columns in expression tree. Used when user first builds a stand-alone expression
@@ -3062,8 +3322,16 @@ public:
         return l ? l : r;
     }
 
+    bool can_evaluate_in_parallel() const override
+    {
+        return m_left->can_evaluate_in_parallel() && m_right->can_evaluate_in_parallel();
+    }
+
     size_t find_first(size_t start, size_t end) const override
     {
+        if (m_batch)
+            return find_first_batch(start, end, std::integral_constant<bool, is_batch_type<T>::value>());
+
         size_t match;
         Value<T> right;
         Value<T> left;
@@ -3084,6 +3352,49 @@ public:
         return not_found; // no match
     }
 
+    size_t find_first_batch(size_t start, size_t end, std::true_type) const
+    {
+        T left[Subexpr::batch_size];
+        T right[Subexpr::batch_size];
+        bool matches[Subexpr::batch_size];
+        TCond c;
+
+        while (start < end) {
+            size_t size = std::min(m_batch_rows, end - start);
+            m_left->evaluate_batch(start, size, left);
+            m_right->evaluate_batch(start, size, right);
+            for (size_t i = 0; i < size; ++i)
+                matches[i] = c(left[i], right[i]);
+
+            const bool* match = std::find(matches, matches + size, true);
+            if (match != matches + size) {
+                // find_first() is called again right after the match, so when matches are dense, the rest of the
+                // batch would be evaluated in vain. Size the next batch according to the distance to this match.
+                size_t rows = size_t(match - matches) + 1;
+                set_batch_rows(2 * rows);
+                return start + (match - matches);
+            }
+            start += size;
+            set_batch_rows(2 * m_batch_rows);
+        }
+        return not_found;
+    }
+
+    size_t find_first_batch(size_t, size_t, std::false_type) const
+    {
+        REALM_ASSERT(false);
+        return not_found;
+    }
+
+    void set_batch_rows(size_t rows) const noexcept
+    {
+        if (rows < ValueBase::default_size)
+            rows = ValueBase::default_size;
+        if (rows > Subexpr::batch_size)
+            rows = Subexpr::batch_size;
+        m_batch_rows = rows;
+    }
+
     std::unique_ptr<Expression> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<Expression>(new Compare(*this, patches));
@@ -3099,11 +3410,18 @@ private:
     Compare(const Compare& other, QueryNodeHandoverPatches* patches)
         : m_left(other.m_left->clone(patches))
         , m_right(other.m_right->clone(patches))
+        , m_batch(other.m_batch && !patches)
     {
     }
 
     std::unique_ptr<TLeft> m_left;
     std::unique_ptr<TRight> m_right;
+
+    // Set by set_base_table() if both operands support batch evaluation
+    bool m_batch = false;
+
+    // Number of rows to evaluate in the next batch
+    mutable size_t m_batch_rows = ValueBase::default_size;
 };
 }
 #endif // REALM_QUERY_EXPRESSION_HPP
@@ -16,9 +16,11 @@
  *
  **************************************************************************/
 
+#include <algorithm>
 #include <stdexcept>
 #include <utility>
 #include <iomanip>
+#include <sstream>
 
 #include <realm/group.hpp>
 #include <realm/table.hpp>
@@ -393,6 +395,104 @@ public:
         return false;
     }
 
+    bool add_accessor_index(size_t col_ndx, ColumnAttr index_attr)
+    {
+        if (REALM_LIKELY(REALM_COVER_ALWAYS(m_table && m_table->is_attached()))) {
+            if (REALM_LIKELY(REALM_COVER_ALWAYS(!m_table->has_shared_type()))) {
+                if (REALM_LIKELY(REALM_COVER_ALWAYS(col_ndx < m_table->get_column_count()))) {
+                    switch (index_attr) {
+                        case col_attr_OrderedIndexed:
+                            log("table->add_ordered_index(%1);", col_ndx); // Throws
+                            m_table->add_ordered_index(col_ndx);           // Throws
+                            return true;
+                        case col_attr_HashIndexed:
+                            log("table->add_hash_index(%1);", col_ndx); // Throws
+                            m_table->add_hash_index(col_ndx);           // Throws
+                            return true;
+                        case col_attr_TrigramIndexed:
+                            log("table->add_trigram_index(%1);", col_ndx); // Throws
+                            m_table->add_trigram_index(col_ndx);           // Throws
+                            return true;
+                        case col_attr_FullTextIndexed:
+                            log("table->add_fulltext_index(%1);", col_ndx); // Throws
+                            m_table->add_fulltext_index(col_ndx);           // Throws
+                            return true;
+                        case col_attr_CaseFoldIndexed:
+                            log("table->add_case_fold_index(%1);", col_ndx); // Throws
+                            m_table->add_case_fold_index(col_ndx);           // Throws
+                            return true;
+                        default:
+                            break;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    bool remove_accessor_index(size_t col_ndx, ColumnAttr index_attr)
+    {
+        if (REALM_LIKELY(REALM_COVER_ALWAYS(m_table && m_table->is_attached()))) {
+            if (REALM_LIKELY(REALM_COVER_ALWAYS(!m_table->has_shared_type()))) {
+                if (REALM_LIKELY(REALM_COVER_ALWAYS(col_ndx < m_table->get_column_count()))) {
+                    switch (index_attr) {
+                        case col_attr_OrderedIndexed:
+                            log("table->remove_ordered_index(%1);", col_ndx); // Throws
+                            m_table->remove_ordered_index(col_ndx);           // Throws
+                            return true;
+                        case col_attr_HashIndexed:
+                            log("table->remove_hash_index(%1);", col_ndx); // Throws
+                            m_table->remove_hash_index(col_ndx);           // Throws
+                            return true;
+                        case col_attr_TrigramIndexed:
+                            log("table->remove_trigram_index(%1);", col_ndx); // Throws
+                            m_table->remove_trigram_index(col_ndx);           // Throws
+                            return true;
+                        case col_attr_FullTextIndexed:
+                            log("table->remove_fulltext_index(%1);", col_ndx); // Throws
+                            m_table->remove_fulltext_index(col_ndx);           // Throws
+                            return true;
+                        case col_attr_CaseFoldIndexed:
+                            log("table->remove_case_fold_index(%1);", col_ndx); // Throws
+                            m_table->remove_case_fold_index(col_ndx);           // Throws
+                            return true;
+                        default:
+                            break;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    bool add_composite_index(const std::vector<size_t>& col_ndxs)
+    {
+        if (REALM_LIKELY(REALM_COVER_ALWAYS(m_table && m_table->is_attached()))) {
+            if (REALM_LIKELY(REALM_COVER_ALWAYS(!m_table->has_shared_type()))) {
+                size_t num_cols = m_table->get_column_count();
+                auto is_valid = [=](size_t col_ndx) { return col_ndx < num_cols; };
+                if (REALM_LIKELY(REALM_COVER_ALWAYS(std::all_of(col_ndxs.begin(), col_ndxs.end(), is_valid)))) {
+                    log("table->add_composite_index(%1);", column_list_to_str(col_ndxs)); // Throws
+                    m_table->add_composite_index(col_ndxs);                                 // Throws
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    bool remove_composite_index(const std::vector<size_t>& col_ndxs)
+    {
+        if (REALM_LIKELY(REALM_COVER_ALWAYS(m_table && m_table->is_attached()))) {
+            if (REALM_LIKELY(REALM_COVER_ALWAYS(!m_table->has_shared_type()))) {
+                log("table->remove_composite_index(%1);", column_list_to_str(col_ndxs)); // Throws
+                m_table->remove_composite_index(col_ndxs);                                 // Throws
+                return true;
+            }
+        }
+        return false;
+    }
+
     bool set_link_type(size_t col_ndx, LinkType link_type)
     {
         if (REALM_LIKELY(REALM_COVER_ALWAYS(m_table && m_desc))) {
@@ -764,6 +864,16 @@ private:
         return "link_Unknown"; // LCOV_EXCL_LINE
     }
 
+    static std::string column_list_to_str(const std::vector<size_t>& col_ndxs)
+    {
+        std::ostringstream out;
+        out << "{";
+        for (size_t i = 0; i < col_ndxs.size(); ++i)
+            out << (i == 0 ? "" : ", ") << col_ndxs[i];
+        out << "}";
+        return out.str();
+    }
+
 #ifdef REALM_DEBUG
     template <class... Params>
     void log(const char* message, Params... params)
@@ -0,0 +1,296 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+#include <iterator>
+
+#include <realm/row_bitmap.hpp>
+#include <realm/utilities.hpp>
+
+using namespace realm;
+
+
+void RowBitmap::do_add(size_t row)
+{
+    uint_fast64_t key = uint_fast64_t(row) >> chunk_bits;
+    auto i = std::lower_bound(m_chunks.begin(), m_chunks.end(), key,
+                              [](const Chunk& chunk, uint_fast64_t k) { return chunk.m_key < k; });
+    if (i == m_chunks.end() || i->m_key != key)
+        i = m_chunks.insert(i, Chunk(key)); // Throws
+    if (add_to_chunk(*i, uint16_t(row))) // Throws
+        ++m_size;
+}
+
+
+void RowBitmap::add_range(size_t begin, size_t end)
+{
+    while (begin < end) {
+        uint_fast64_t key = uint_fast64_t(begin) >> chunk_bits;
+        size_t chunk_end = std::min(end, size_t((key + 1) << chunk_bits));
+        if (chunk_end - begin == chunk_size && (m_chunks.empty() || m_chunks.back().m_key < key)) {
+            // A complete chunk appended at the end
+            m_chunks.emplace_back(key);                              // Throws
+            m_chunks.back().m_words.resize(num_words, ~uint64_t(0)); // Throws
+            m_chunks.back().m_size = chunk_size;
+            m_size += chunk_size;
+        }
+        else {
+            for (size_t row = begin; row < chunk_end; ++row)
+                add(row); // Throws
+        }
+        begin = chunk_end;
+    }
+}
+
+
+bool RowBitmap::contains(size_t row) const noexcept
+{
+    const Chunk* chunk = find_chunk(uint_fast64_t(row) >> chunk_bits);
+    if (!chunk)
+        return false;
+    uint16_t offset = uint16_t(row);
+    if (chunk->is_bitmap())
+        return (chunk->m_words[offset / 64] >> (offset % 64)) & 1;
+    return std::binary_search(chunk->m_array.begin(), chunk->m_array.end(), offset);
+}
+
+
+void RowBitmap::clear() noexcept
+{
+    m_chunks.clear();
+    m_size = 0;
+}
+
+
+RowBitmap& RowBitmap::operator&=(const RowBitmap& other)
+{
+    auto out = m_chunks.begin();
+    auto j = other.m_chunks.begin();
+    m_size = 0;
+    for (auto i = m_chunks.begin(); i != m_chunks.end(); ++i) {
+        while (j != other.m_chunks.end() && j->m_key < i->m_key)
+            ++j;
+        if (j == other.m_chunks.end())
+            break;
+        if (j->m_key != i->m_key)
+            continue;
+        intersect_chunks(*i, *j); // Throws
+        if (i->m_size == 0)
+            continue;
+        m_size += i->m_size;
+        if (out != i)
+            *out = std::move(*i);
+        ++out;
+    }
+    m_chunks.erase(out, m_chunks.end());
+    return *this;
+}
+
+
+RowBitmap& RowBitmap::operator|=(const RowBitmap& other)
+{
+    if (&other == this)
+        return *this;
+
+    std::vector<Chunk> chunks;
+    chunks.reserve(m_chunks.size() + other.m_chunks.size()); // Throws
+    auto i = m_chunks.begin();
+    auto j = other.m_chunks.begin();
+    while (i != m_chunks.end() || j != other.m_chunks.end()) {
+        if (j == other.m_chunks.end() || (i != m_chunks.end() && i->m_key < j->m_key)) {
+            chunks.push_back(std::move(*i++));
+        }
+        else if (i == m_chunks.end() || j->m_key < i->m_key) {
+            chunks.push_back(*j++); // Throws
+        }
+        else {
+            unite_chunks(*i, *j++); // Throws
+            chunks.push_back(std::move(*i++));
+        }
+    }
+    m_chunks = std::move(chunks);
+    m_size = 0;
+    for (const Chunk& chunk : m_chunks)
+        m_size += chunk.m_size;
+    return *this;
+}
+
+
+bool RowBitmap::operator==(const RowBitmap& other) const noexcept
+{
+    if (m_size != other.m_size || m_chunks.size() != other.m_chunks.size())
+        return false;
+    for (size_t i = 0; i < m_chunks.size(); ++i) {
+        const Chunk& a = m_chunks[i];
+        const Chunk& b = other.m_chunks[i];
+        if (a.m_key != b.m_key || a.m_size != b.m_size)
+            return false;
+        if (a.is_bitmap() != b.is_bitmap()) {
+            // Both representations are possible for the same contents, for
+            // example after an intersection
+            const Chunk& bitmap = a.is_bitmap() ? a : b;
+            const Chunk& array = a.is_bitmap() ? b : a;
+            for (uint16_t offset : array.m_array) {
+                if (!((bitmap.m_words[offset / 64] >> (offset % 64)) & 1))
+                    return false;
+            }
+        }
+        else if (a.m_array != b.m_array || a.m_words != b.m_words) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+size_t RowBitmap::get_memory_usage() const noexcept
+{
+    size_t usage = m_chunks.capacity() * sizeof(Chunk);
+    for (const Chunk& chunk : m_chunks)
+        usage += chunk.m_array.capacity() * sizeof(uint16_t) + chunk.m_words.capacity() * sizeof(uint64_t);
+    return usage;
+}
+
+
+bool RowBitmap::add_to_chunk(Chunk& chunk, uint16_t offset)
+{
+    if (chunk.is_bitmap()) {
+        uint64_t& word = chunk.m_words[offset / 64];
+        uint64_t bit = uint64_t(1) << (offset % 64);
+        if (word & bit)
+            return false;
+        word |= bit;
+        ++chunk.m_size;
+        return true;
+    }
+
+    auto i = std::lower_bound(chunk.m_array.begin(), chunk.m_array.end(), offset);
+    if (i != chunk.m_array.end() && *i == offset)
+        return false;
+    if (chunk.m_size == max_array_size) {
+        convert_to_bitmap(chunk); // Throws
+        return add_to_chunk(chunk, offset);
+    }
+    chunk.m_array.insert(i, offset); // Throws
+    ++chunk.m_size;
+    return true;
+}
+
+
+void RowBitmap::convert_to_bitmap(Chunk& chunk)
+{
+    REALM_ASSERT_DEBUG(!chunk.is_bitmap());
+    std::vector<uint64_t> words(num_words, 0); // Throws
+    for (uint16_t offset : chunk.m_array)
+        words[offset / 64] |= uint64_t(1) << (offset % 64);
+    chunk.m_words = std::move(words);
+    std::vector<uint16_t>().swap(chunk.m_array);
+}
+
+
+void RowBitmap::convert_to_array(Chunk& chunk)
+{
+    REALM_ASSERT_DEBUG(chunk.is_bitmap());
+    std::vector<uint16_t> array;
+    array.reserve(chunk.m_size); // Throws
+    for (size_t i = 0; i < num_words; ++i) {
+        uint64_t word = chunk.m_words[i];
+        while (word) {
+            array.push_back(uint16_t(i * 64 + lowest_bit64(word)));
+            word &= word - 1;
+        }
+    }
+    chunk.m_array = std::move(array);
+    std::vector<uint64_t>().swap(chunk.m_words);
+}
+
+
+void RowBitmap::intersect_chunks(Chunk& chunk, const Chunk& other)
+{
+    if (chunk.is_bitmap() && other.is_bitmap()) {
+        size_t size = 0;
+        for (size_t i = 0; i < num_words; ++i) {
+            chunk.m_words[i] &= other.m_words[i];
+            size += size_t(fast_popcount64(int64_t(chunk.m_words[i])));
+        }
+        chunk.m_size = size;
+        if (size <= max_array_size)
+            convert_to_array(chunk); // Throws
+        return;
+    }
+
+    std::vector<uint16_t> result;
+    if (chunk.is_bitmap()) {
+        for (uint16_t offset : other.m_array) {
+            if ((chunk.m_words[offset / 64] >> (offset % 64)) & 1)
+                result.push_back(offset); // Throws
+        }
+        std::vector<uint64_t>().swap(chunk.m_words);
+    }
+    else if (other.is_bitmap()) {
+        for (uint16_t offset : chunk.m_array) {
+            if ((other.m_words[offset / 64] >> (offset % 64)) & 1)
+                result.push_back(offset); // Throws
+        }
+    }
+    else {
+        std::set_intersection(chunk.m_array.begin(), chunk.m_array.end(), other.m_array.begin(),
+                              other.m_array.end(), std::back_inserter(result)); // Throws
+    }
+    chunk.m_size = result.size();
+    chunk.m_array = std::move(result);
+}
+
+
+void RowBitmap::unite_chunks(Chunk& chunk, const Chunk& other)
+{
+    if (!chunk.is_bitmap() && !other.is_bitmap() && chunk.m_size + other.m_size <= max_array_size) {
+        std::vector<uint16_t> result;
+        result.reserve(chunk.m_size + other.m_size); // Throws
+        std::set_union(chunk.m_array.begin(), chunk.m_array.end(), other.m_array.begin(), other.m_array.end(),
+                       std::back_inserter(result));
+        chunk.m_size = result.size();
+        chunk.m_array = std::move(result);
+        return;
+    }
+
+    if (!chunk.is_bitmap())
+        convert_to_bitmap(chunk); // Throws
+    if (other.is_bitmap()) {
+        for (size_t i = 0; i < num_words; ++i)
+            chunk.m_words[i] |= other.m_words[i];
+    }
+    else {
+        for (uint16_t offset : other.m_array)
+            chunk.m_words[offset / 64] |= uint64_t(1) << (offset % 64);
+    }
+    size_t size = 0;
+    for (size_t i = 0; i < num_words; ++i)
+        size += size_t(fast_popcount64(int64_t(chunk.m_words[i])));
+    chunk.m_size = size;
+}
+
+
+const RowBitmap::Chunk* RowBitmap::find_chunk(uint_fast64_t key) const noexcept
+{
+    auto i = std::lower_bound(m_chunks.begin(), m_chunks.end(), key,
+                              [](const Chunk& chunk, uint_fast64_t k) { return chunk.m_key < k; });
+    if (i == m_chunks.end() || i->m_key != key)
+        return nullptr;
+    return &*i;
+}
@@ -0,0 +1,187 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_ROW_BITMAP_HPP
+#define REALM_ROW_BITMAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <realm/util/assert.hpp>
+#include <realm/util/features.h>
+#include <realm/utilities.hpp>
+
+namespace realm {
+
+/// A compressed set of row indexes, used as an alternative to the IntegerColumn
+/// of a TableView when a query produces many matches.
+///
+/// The row index space is divided into chunks of 2^16 rows. A chunk with few
+/// members stores them as a sorted array of 16-bit offsets, and a chunk with
+/// many members stores them as a bitmap of 2^16 bits. Only chunks with at
+/// least one member are stored. A chunk therefore never needs more than 8 KiB,
+/// and adding rows in increasing order, as a query does, appends to the last
+/// chunk without searching.
+class RowBitmap {
+public:
+    RowBitmap() noexcept;
+
+    /// Add the specified row. Adding a row that is already a member has no
+    /// effect. This is fastest when rows are added in increasing order.
+    void add(size_t row);
+
+    /// Add all rows in `[begin, end)`.
+    void add_range(size_t begin, size_t end);
+
+    bool contains(size_t row) const noexcept;
+
+    /// Returns the number of rows in the set.
+    size_t size() const noexcept;
+    bool empty() const noexcept;
+
+    void clear() noexcept;
+
+    /// Keep only the rows that are also members of `other`.
+    RowBitmap& operator&=(const RowBitmap& other);
+
+    /// Add all the members of `other`.
+    RowBitmap& operator|=(const RowBitmap& other);
+
+    bool operator==(const RowBitmap& other) const noexcept;
+    bool operator!=(const RowBitmap& other) const noexcept;
+
+    /// Call `func(row)` for each member in increasing order.
+    template <class F>
+    void for_each(F func) const;
+
+    /// Returns the number of bytes allocated by this set.
+    size_t get_memory_usage() const noexcept;
+
+private:
+    static const size_t chunk_bits = 16;
+    static const size_t chunk_size = size_t(1) << chunk_bits;
+    static const size_t num_words = chunk_size / 64;
+
+    // A chunk holding more offsets than this is converted to a bitmap, which
+    // then takes up less space than the array.
+    static const size_t max_array_size = 4096;
+
+    struct Chunk {
+        uint_fast64_t m_key;           // Row index divided by chunk_size
+        size_t m_size = 0;             // Number of members
+        std::vector<uint16_t> m_array; // Sorted offsets, unless is_bitmap()
+        std::vector<uint64_t> m_words; // Bitmap of num_words words, or empty
+
+        explicit Chunk(uint_fast64_t key)
+            : m_key(key)
+        {
+        }
+        bool is_bitmap() const noexcept
+        {
+            return !m_words.empty();
+        }
+    };
+
+    std::vector<Chunk> m_chunks; // Ordered by key
+    size_t m_size;
+
+    void do_add(size_t row);
+    static bool add_to_chunk(Chunk&, uint16_t offset);
+    static void convert_to_bitmap(Chunk&);
+    static void convert_to_array(Chunk&);
+    static void intersect_chunks(Chunk&, const Chunk&);
+    static void unite_chunks(Chunk&, const Chunk&);
+    const Chunk* find_chunk(uint_fast64_t key) const noexcept;
+};
+
+
+// Implementation:
+
+inline RowBitmap::RowBitmap() noexcept
+    : m_size(0)
+{
+}
+
+inline void RowBitmap::add(size_t row)
+{
+    // Fast path for the common case of appending to the last chunk
+    if (REALM_LIKELY(!m_chunks.empty())) {
+        Chunk& chunk = m_chunks.back();
+        if (chunk.m_key == (uint_fast64_t(row) >> chunk_bits)) {
+            uint16_t offset = uint16_t(row);
+            if (chunk.is_bitmap()) {
+                uint64_t& word = chunk.m_words[offset / 64];
+                uint64_t bit = uint64_t(1) << (offset % 64);
+                if (!(word & bit)) {
+                    word |= bit;
+                    ++chunk.m_size;
+                    ++m_size;
+                }
+                return;
+            }
+            if (chunk.m_size < max_array_size && chunk.m_array.back() < offset) {
+                chunk.m_array.push_back(offset);
+                ++chunk.m_size;
+                ++m_size;
+                return;
+            }
+        }
+    }
+    do_add(row);
+}
+
+inline size_t RowBitmap::size() const noexcept
+{
+    return m_size;
+}
+
+inline bool RowBitmap::empty() const noexcept
+{
+    return m_size == 0;
+}
+
+inline bool RowBitmap::operator!=(const RowBitmap& other) const noexcept
+{
+    return !(*this == other);
+}
+
+template <class F>
+void RowBitmap::for_each(F func) const
+{
+    for (const Chunk& chunk : m_chunks) {
+        size_t base = size_t(chunk.m_key << chunk_bits);
+        if (chunk.is_bitmap()) {
+            for (size_t i = 0; i < num_words; ++i) {
+                uint64_t word = chunk.m_words[i];
+                while (word) {
+                    func(base + i * 64 + lowest_bit64(word));
+                    word &= word - 1;
+                }
+            }
+        }
+        else {
+            for (uint16_t offset : chunk.m_array)
+                func(base + offset);
+        }
+    }
+}
+
+} // namespace realm
+
+#endif // REALM_ROW_BITMAP_HPP
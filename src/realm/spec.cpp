@@ -37,7 +37,7 @@ void Spec::init(MemRef mem) noexcept
 {
     m_top.init_from_mem(mem);
     size_t top_size = m_top.size();
-    REALM_ASSERT(top_size >= 3 && top_size <= 5);
+    REALM_ASSERT(top_size >= 3 && top_size <= 6);
 
     m_types.init_from_ref(m_top.get_as_ref(0));
     m_types.set_parent(&m_top, 0);
@@ -50,6 +50,7 @@ void Spec::init(MemRef mem) noexcept
     // from initialized children to uninitialized
     m_subspecs.detach();
     m_enumkeys.detach();
+    m_composite_indexes.detach();
 
     // Subspecs array is only there and valid when there are subtables
     // if there are enumkey, but no subtables yet it will be a zero-ref
@@ -60,11 +61,18 @@ void Spec::init(MemRef mem) noexcept
     }
 
     // Enumkeys array is only there when there are StringEnum columns
-    if (top_size >= 5) {
+    if (has_enumkeys()) {
         m_enumkeys.init_from_ref(m_top.get_as_ref(4));
         m_enumkeys.set_parent(&m_top, 4);
     }
 
+    // Composite index array is only there once a composite index has been
+    // added
+    if (top_size >= 6) {
+        m_composite_indexes.init_from_ref(m_top.get_as_ref(5));
+        m_composite_indexes.set_parent(&m_top, 5);
+    }
+
     update_has_strong_link_columns();
 }
 
@@ -94,8 +102,11 @@ void Spec::update_from_parent(size_t old_baseline) noexcept
     if (has_subspec())
         m_subspecs.update_from_parent(old_baseline);
 
-    if (m_top.size() > 4)
+    if (has_enumkeys())
         m_enumkeys.update_from_parent(old_baseline);
+
+    if (m_top.size() > 5)
+        m_composite_indexes.update_from_parent(old_baseline);
 }
 
 
@@ -201,6 +212,9 @@ void Spec::insert_column(size_t column_ndx, ColumnType type, StringData name, Co
         }
     }
 
+    if (m_composite_indexes.is_attached())
+        adj_composite_index_columns([=](size_t i) { return i < column_ndx ? i : i + 1; }); // Throws
+
     update_has_strong_link_columns();
 }
 
@@ -248,6 +262,13 @@ void Spec::erase_column(size_t column_ndx)
     m_types.erase(column_ndx);     // Throws
     m_attr.erase(column_ndx);      // Throws
 
+    // A composite index is removed along with any of its columns
+    if (m_composite_indexes.is_attached()) {
+        adj_composite_index_columns([=](size_t i) {
+            return i < column_ndx ? i : i == column_ndx ? npos : i - 1;
+        }); // Throws
+    }
+
     update_has_strong_link_columns();
 }
 
@@ -292,6 +313,18 @@ void Spec::move_column(size_t from_ndx, size_t to_ndx)
         m_names.move_rotate(from_ndx, to_ndx);
     m_types.move_rotate(from_ndx, to_ndx);
     m_attr.move_rotate(from_ndx, to_ndx);
+
+    if (m_composite_indexes.is_attached()) {
+        adj_composite_index_columns([=](size_t i) {
+            if (i == from_ndx)
+                return to_ndx;
+            if (from_ndx < to_ndx && i > from_ndx && i <= to_ndx)
+                return i - 1;
+            if (to_ndx < from_ndx && i >= to_ndx && i < from_ndx)
+                return i + 1;
+            return i;
+        }); // Throws
+    }
 }
 
 
@@ -339,7 +372,7 @@ void Spec::upgrade_string_to_enum(size_t column_ndx, ref_type keys_ref, ArrayPar
 {
     REALM_ASSERT(get_column_type(column_ndx) == col_type_String);
 
-    REALM_ASSERT_EX(m_enumkeys.is_attached() == (m_top.size() > 4), m_enumkeys.is_attached(), m_top.size());
+    REALM_ASSERT_EX(m_enumkeys.is_attached() == has_enumkeys(), m_enumkeys.is_attached(), m_top.size());
     // Create the enumkeys list if needed
     if (!m_enumkeys.is_attached()) {
         m_enumkeys.create(Array::type_HasRefs);
@@ -393,6 +426,111 @@ ref_type Spec::get_enumkeys_ref(size_t column_ndx, ArrayParent** keys_parent, si
 }
 
 
+bool Spec::has_composite_index(const std::vector<size_t>& column_ndxs) const noexcept
+{
+    if (!m_composite_indexes.is_attached())
+        return false;
+    size_t size = m_composite_indexes.size();
+    size_t i = 0;
+    while (i < size) {
+        size_t num_cols = to_size_t(m_composite_indexes.get(i++));
+        if (num_cols == column_ndxs.size()) {
+            size_t j = 0;
+            while (j < num_cols && to_size_t(m_composite_indexes.get(i + j)) == column_ndxs[j])
+                ++j;
+            if (j == num_cols)
+                return true;
+        }
+        i += num_cols;
+    }
+    return false;
+}
+
+
+std::vector<std::vector<size_t>> Spec::get_composite_indexes() const
+{
+    std::vector<std::vector<size_t>> indexes;
+    if (!m_composite_indexes.is_attached())
+        return indexes;
+    size_t size = m_composite_indexes.size();
+    size_t i = 0;
+    while (i < size) {
+        size_t num_cols = to_size_t(m_composite_indexes.get(i++));
+        std::vector<size_t> column_ndxs;
+        column_ndxs.reserve(num_cols); // Throws
+        for (size_t j = 0; j < num_cols; ++j)
+            column_ndxs.push_back(to_size_t(m_composite_indexes.get(i++)));
+        indexes.push_back(std::move(column_ndxs)); // Throws
+    }
+    return indexes;
+}
+
+
+void Spec::add_composite_index(const std::vector<size_t>& column_ndxs)
+{
+    REALM_ASSERT(!has_composite_index(column_ndxs));
+
+    // Create the composite index list if needed
+    if (!m_composite_indexes.is_attached()) {
+        m_composite_indexes.create(Array::type_Normal); // Throws
+        while (m_top.size() < 5)
+            m_top.add(0); // no subtables or enumkeys
+        m_top.add(from_ref(m_composite_indexes.get_ref())); // Throws
+        m_composite_indexes.set_parent(&m_top, 5);
+    }
+
+    m_composite_indexes.add(int_fast64_t(column_ndxs.size())); // Throws
+    for (size_t column_ndx : column_ndxs)
+        m_composite_indexes.add(int_fast64_t(column_ndx)); // Throws
+}
+
+
+void Spec::remove_composite_index(const std::vector<size_t>& column_ndxs)
+{
+    if (!m_composite_indexes.is_attached())
+        return;
+    size_t size = m_composite_indexes.size();
+    size_t i = 0;
+    while (i < size) {
+        size_t num_cols = to_size_t(m_composite_indexes.get(i));
+        bool is_match = num_cols == column_ndxs.size();
+        for (size_t j = 0; is_match && j < num_cols; ++j)
+            is_match = to_size_t(m_composite_indexes.get(i + 1 + j)) == column_ndxs[j];
+        if (is_match) {
+            m_composite_indexes.erase(i, i + 1 + num_cols); // Throws
+            return;
+        }
+        i += 1 + num_cols;
+    }
+}
+
+
+template <class F>
+void Spec::adj_composite_index_columns(F func)
+{
+    size_t i = 0;
+    while (i < m_composite_indexes.size()) {
+        size_t num_cols = to_size_t(m_composite_indexes.get(i));
+        bool is_dropped = false;
+        for (size_t j = 0; j < num_cols; ++j) {
+            if (func(to_size_t(m_composite_indexes.get(i + 1 + j))) == npos)
+                is_dropped = true;
+        }
+        if (is_dropped) {
+            m_composite_indexes.erase(i, i + 1 + num_cols); // Throws
+            continue;
+        }
+        for (size_t j = 0; j < num_cols; ++j) {
+            size_t column_ndx = to_size_t(m_composite_indexes.get(i + 1 + j));
+            size_t new_column_ndx = func(column_ndx);
+            if (new_column_ndx != column_ndx)
+                m_composite_indexes.set(i + 1 + j, int_fast64_t(new_column_ndx)); // Throws
+        }
+        i += 1 + num_cols;
+    }
+}
+
+
 size_t Spec::get_opposite_link_table_ndx(size_t column_ndx) const noexcept
 {
     REALM_ASSERT(column_ndx < get_column_count());
@@ -19,6 +19,8 @@
 #ifndef REALM_SPEC_HPP
 #define REALM_SPEC_HPP
 
+#include <vector>
+
 #include <realm/util/features.h>
 #include <realm/array.hpp>
 #include <realm/array_string.hpp>
@@ -87,6 +89,12 @@ public:
     ref_type get_enumkeys_ref(size_t column_ndx, ArrayParent** keys_parent = nullptr,
                               size_t* keys_ndx = nullptr) noexcept;
 
+    // Composite indexes (see Table::add_composite_index())
+    bool has_composite_index(const std::vector<size_t>& column_ndxs) const noexcept;
+    std::vector<std::vector<size_t>> get_composite_indexes() const;
+    void add_composite_index(const std::vector<size_t>& column_ndxs);
+    void remove_composite_index(const std::vector<size_t>& column_ndxs);
+
     // Links
     size_t get_opposite_link_table_ndx(size_t column_ndx) const noexcept;
     void set_opposite_link_table_ndx(size_t column_ndx, size_t table_ndx);
@@ -128,12 +136,16 @@ private:
     // columns the first entry is the group-level table index of the origin
     // table, and the second entry is the index of the origin column in the
     // origin table.
+    //
+    // `m_composite_indexes` lists the columns of each composite index as the
+    // number of columns followed by the column indexes.
     Array m_top;
-    ArrayInteger m_types; // 1st slot in m_top
-    ArrayString m_names;  // 2nd slot in m_top
-    ArrayInteger m_attr;  // 3rd slot in m_top
-    Array m_subspecs;     // 4th slot in m_top (optional)
-    Array m_enumkeys;     // 5th slot in m_top (optional)
+    ArrayInteger m_types;      // 1st slot in m_top
+    ArrayString m_names;       // 2nd slot in m_top
+    ArrayInteger m_attr;       // 3rd slot in m_top
+    Array m_subspecs;          // 4th slot in m_top (optional)
+    Array m_enumkeys;          // 5th slot in m_top (optional)
+    Array m_composite_indexes; // 6th slot in m_top (optional)
     bool m_has_strong_link_columns;
 
     Spec(Allocator&) noexcept; // Unattached
@@ -174,6 +186,12 @@ private:
     size_t get_subspec_ndx_after(size_t column_ndx, size_t skip_column_ndx) const noexcept;
     size_t get_subspec_entries_for_col_type(ColumnType type) const noexcept;
     bool has_subspec() const noexcept;
+    bool has_enumkeys() const noexcept;
+
+    // Replace each column `i` of the composite indexes with `func(i)`, and
+    // drop the indexes for which `func` returns `npos` for some column.
+    template <class F>
+    void adj_composite_index_columns(F func);
 
     // Returns false if the spec has no columns, otherwise it returns
     // true and sets `type` to the type of the first column.
@@ -258,6 +276,7 @@ inline Spec::Spec(SubspecRef r) noexcept
     , m_attr(r.m_parent->get_alloc())
     , m_subspecs(r.m_parent->get_alloc())
     , m_enumkeys(r.m_parent->get_alloc())
+    , m_composite_indexes(r.m_parent->get_alloc())
 {
     init(r);
 }
@@ -270,6 +289,7 @@ inline Spec::Spec(Allocator& alloc) noexcept
     , m_attr(alloc)
     , m_subspecs(alloc)
     , m_enumkeys(alloc)
+    , m_composite_indexes(alloc)
 {
 }
 
@@ -440,6 +460,13 @@ inline bool Spec::has_subspec() const noexcept
     return (m_top.size() >= 4) && (m_top.get_as_ref(3) != 0);
 }
 
+// Likewise, the entry for m_enumkeys (at index 4) may be empty if the spec
+// contains composite indexes (at index 5) but no StringEnum columns.
+inline bool Spec::has_enumkeys() const noexcept
+{
+    return (m_top.size() >= 5) && (m_top.get_as_ref(4) != 0);
+}
+
 inline bool Spec::operator!=(const Spec& s) const noexcept
 {
     return !(*this == s);
@@ -42,6 +42,11 @@
 #include <realm/column_linklist.hpp>
 #include <realm/column_backlink.hpp>
 #include <realm/index_string.hpp>
+#include <realm/index_hash.hpp>
+#include <realm/index_ordered.hpp>
+#include <realm/index_trigram.hpp>
+#include <realm/index_fulltext.hpp>
+#include <realm/index_case_fold.hpp>
 #include <realm/group.hpp>
 #include <realm/link_view.hpp>
 #include <realm/replication.hpp>
@@ -1730,6 +1735,10 @@ void Table::add_search_index(size_t col_ndx)
     // Update column accessors for all columns after the one we just added an
     // index for, as their position in `m_columns` has changed
     refresh_column_accessors(col_ndx + 1); // Throws
+    {
+        LockGuard lock(m_accessor_mutex);
+        discard_query_statistics(col_ndx, col_ndx + 1);
+    }
 
     if (Replication* repl = get_repl())
         repl->add_search_index(this, col_ndx); // Throws
@@ -1767,12 +1776,526 @@ void Table::remove_search_index(size_t col_ndx)
     // Update column accessors for all columns after the one we just removed the
     // index for, as their position in `m_columns` has changed
     refresh_column_accessors(col_ndx + 1); // Throws
+    {
+        LockGuard lock(m_accessor_mutex);
+        discard_query_statistics(col_ndx, col_ndx + 1);
+    }
 
     if (Replication* repl = get_repl())
         repl->remove_search_index(this, col_ndx); // Throws
 }
 
 
+bool Table::has_ordered_index(size_t col_ndx) const noexcept
+{
+    // Utilize the guarantee that m_cols.size() == 0 for a detached table accessor.
+    if (REALM_UNLIKELY(col_ndx >= m_cols.size()))
+        return false;
+    return (m_spec.get_column_attr(col_ndx) & col_attr_OrderedIndexed) != 0;
+}
+
+
+void Table::add_ordered_index(size_t col_ndx)
+{
+    if (REALM_UNLIKELY(!is_attached()))
+        throw LogicError(LogicError::detached_accessor);
+
+    if (REALM_UNLIKELY(has_shared_type()))
+        throw LogicError(LogicError::wrong_kind_of_table);
+
+    if (REALM_UNLIKELY(col_ndx >= m_cols.size()))
+        throw LogicError(LogicError::column_index_out_of_range);
+
+    switch (get_column_type(col_ndx)) {
+        case type_Int:
+        case type_Timestamp:
+        case type_Float:
+        case type_Double:
+            break;
+        default:
+            throw LogicError(LogicError::illegal_combination);
+    }
+
+    add_accessor_index(col_ndx, col_attr_OrderedIndexed); // Throws
+}
+
+
+void Table::remove_ordered_index(size_t col_ndx)
+{
+    if (REALM_UNLIKELY(!is_attached()))
+        throw LogicError(LogicError::detached_accessor);
+
+    if (REALM_UNLIKELY(has_shared_type()))
+        throw LogicError(LogicError::wrong_kind_of_table);
+
+    if (REALM_UNLIKELY(col_ndx >= m_cols.size()))
+        throw LogicError(LogicError::column_index_out_of_range);
+
+    remove_accessor_index(col_ndx, col_attr_OrderedIndexed); // Throws
+}
+
+
+void Table::add_accessor_index(size_t col_ndx, ColumnAttr index_attr)
+{
+    int attr = m_spec.get_column_attr(col_ndx);
+    if ((attr & index_attr) != 0)
+        return;
+
+    // The index is built when it is first needed
+    attr |= index_attr;
+    m_spec.set_column_attr(col_ndx, ColumnAttr(attr)); // Throws
+    {
+        LockGuard lock(m_accessor_mutex);
+        discard_query_statistics(col_ndx, col_ndx + 1);
+    }
+
+    if (Replication* repl = get_repl())
+        repl->add_accessor_index(this, col_ndx, index_attr); // Throws
+}
+
+
+void Table::remove_accessor_index(size_t col_ndx, ColumnAttr index_attr)
+{
+    int attr = m_spec.get_column_attr(col_ndx);
+    if ((attr & index_attr) == 0)
+        return;
+
+    attr &= ~index_attr;
+    m_spec.set_column_attr(col_ndx, ColumnAttr(attr)); // Throws
+    refresh_accessor_indexes();
+    {
+        LockGuard lock(m_accessor_mutex);
+        discard_query_statistics(col_ndx, col_ndx + 1);
+    }
+
+    if (Replication* repl = get_repl())
+        repl->remove_accessor_index(this, col_ndx, index_attr); // Throws
+}
+
+
+void Table::refresh_accessor_indexes() noexcept
+{
+    LockGuard lock(m_accessor_mutex);
+    size_t num_cols = std::min(m_column_indexes.size(), m_spec.get_column_count());
+    for (size_t col_ndx = 0; col_ndx < num_cols; ++col_ndx) {
+        ColumnIndexEntry& entry = m_column_indexes[col_ndx];
+        int attr = m_spec.get_column_attr(col_ndx);
+        if ((attr & col_attr_OrderedIndexed) == 0)
+            entry.m_ordered_index.reset();
+        if ((attr & col_attr_HashIndexed) == 0)
+            entry.m_hash_index.reset();
+        if ((attr & col_attr_TrigramIndexed) == 0)
+            entry.m_trigram_index.reset();
+        if ((attr & col_attr_FullTextIndexed) == 0)
+            entry.m_fulltext_index.reset();
+        if ((attr & col_attr_CaseFoldIndexed) == 0)
+            entry.m_case_fold_index.reset();
+    }
+    auto is_removed = [&](const std::shared_ptr<CompositeIndex>& index) {
+        return !m_spec.has_composite_index(index->get_columns());
+    };
+    m_composite_indexes.erase(std::remove_if(m_composite_indexes.begin(), m_composite_indexes.end(), is_removed),
+                              m_composite_indexes.end());
+}
+
+
+template <class F>
+void Table::for_each_accessor_index(F func) const
+{
+    for (ColumnIndexEntry& entry : m_column_indexes) {
+        if (entry.m_ordered_index)
+            func(*entry.m_ordered_index);
+        if (entry.m_hash_index)
+            func(*entry.m_hash_index);
+        if (entry.m_trigram_index)
+            func(*entry.m_trigram_index);
+        if (entry.m_fulltext_index)
+            func(*entry.m_fulltext_index);
+        if (entry.m_case_fold_index)
+            func(*entry.m_case_fold_index);
+    }
+    for (const std::shared_ptr<CompositeIndex>& index : m_composite_indexes)
+        func(*index);
+}
+
+
+bool Table::has_hash_index(size_t col_ndx) const noexcept
+{
+    // Utilize the guarantee that m_cols.size() == 0 for a detached table accessor.
+    if (REALM_UNLIKELY(col_ndx >= m_cols.size()))
+        return false;
+    return (m_spec.get_column_attr(col_ndx) & col_attr_HashIndexed) != 0;
+}
+
+
+void Table::add_hash_index(size_t col_ndx)
+{
+    if (REALM_UNLIKELY(!is_attached()))
+        throw LogicError(LogicError::detached_accessor);
+
+    if (REALM_UNLIKELY(has_shared_type()))
+        throw LogicError(LogicError::wrong_kind_of_table);
+
+    if (REALM_UNLIKELY(col_ndx >= m_cols.size()))
+        throw LogicError(LogicError::column_index_out_of_range);
+
+    switch (get_column_type(col_ndx)) {
+        case type_Int:
+        case type_Bool:
+        case type_String:
+        case type_OldDateTime:
+        case type_Timestamp:
+            break;
+        default:
+            throw LogicError(LogicError::illegal_combination);
+    }
+
+    add_accessor_index(col_ndx, col_attr_HashIndexed); // Throws
+}
+
+
+void Table::remove_hash_index(size_t col_ndx)
+{
+    if (REALM_UNLIKELY(!is_attached()))
+        throw LogicError(LogicError::detached_accessor);
+
+    if (REALM_UNLIKELY(has_shared_type()))
+        throw LogicError(LogicError::wrong_kind_of_table);
+
+    if (REALM_UNLIKELY(col_ndx >= m_cols.size()))
+        throw LogicError(LogicError::column_index_out_of_range);
+
+    remove_accessor_index(col_ndx, col_attr_HashIndexed); // Throws
+}
+
+
+bool Table::has_trigram_index(size_t col_ndx) const noexcept
+{
+    // Utilize the guarantee that m_cols.size() == 0 for a detached table accessor.
+    if (REALM_UNLIKELY(col_ndx >= m_cols.size()))
+        return false;
+    return (m_spec.get_column_attr(col_ndx) & col_attr_TrigramIndexed) != 0;
+}
+
+
+void Table::add_trigram_index(size_t col_ndx)
+{
+    if (REALM_UNLIKELY(!is_attached()))
+        throw LogicError(LogicError::detached_accessor);
+
+    if (REALM_UNLIKELY(has_shared_type()))
+        throw LogicError(LogicError::wrong_kind_of_table);
+
+    if (REALM_UNLIKELY(col_ndx >= m_cols.size()))
+        throw LogicError(LogicError::column_index_out_of_range);
+
+    if (REALM_UNLIKELY(get_column_type(col_ndx) != type_String))
+        throw LogicError(LogicError::illegal_combination);
+
+    add_accessor_index(col_ndx, col_attr_TrigramIndexed); // Throws
+}
+
+
+void Table::remove_trigram_index(size_t col_ndx)
+{
+    if (REALM_UNLIKELY(!is_attached()))
+        throw LogicError(LogicError::detached_accessor);
+
+    if (REALM_UNLIKELY(has_shared_type()))
+        throw LogicError(LogicError::wrong_kind_of_table);
+
+    if (REALM_UNLIKELY(col_ndx >= m_cols.size()))
+        throw LogicError(LogicError::column_index_out_of_range);
+
+    remove_accessor_index(col_ndx, col_attr_TrigramIndexed); // Throws
+}
+
+
+bool Table::has_fulltext_index(size_t col_ndx) const noexcept
+{
+    // Utilize the guarantee that m_cols.size() == 0 for a detached table accessor.
+    if (REALM_UNLIKELY(col_ndx >= m_cols.size()))
+        return false;
+    return (m_spec.get_column_attr(col_ndx) & col_attr_FullTextIndexed) != 0;
+}
+
+
+void Table::add_fulltext_index(size_t col_ndx)
+{
+    if (REALM_UNLIKELY(!is_attached()))
+        throw LogicError(LogicError::detached_accessor);
+
+    if (REALM_UNLIKELY(has_shared_type()))
+        throw LogicError(LogicError::wrong_kind_of_table);
+
+    if (REALM_UNLIKELY(col_ndx >= m_cols.size()))
+        throw LogicError(LogicError::column_index_out_of_range);
+
+    if (REALM_UNLIKELY(get_column_type(col_ndx) != type_String))
+        throw LogicError(LogicError::illegal_combination);
+
+    add_accessor_index(col_ndx, col_attr_FullTextIndexed); // Throws
+}
+
+
+void Table::remove_fulltext_index(size_t col_ndx)
+{
+    if (REALM_UNLIKELY(!is_attached()))
+        throw LogicError(LogicError::detached_accessor);
+
+    if (REALM_UNLIKELY(has_shared_type()))
+        throw LogicError(LogicError::wrong_kind_of_table);
+
+    if (REALM_UNLIKELY(col_ndx >= m_cols.size()))
+        throw LogicError(LogicError::column_index_out_of_range);
+
+    remove_accessor_index(col_ndx, col_attr_FullTextIndexed); // Throws
+}
+
+
+std::vector<size_t> Table::find_ranked_fulltext(size_t col_ndx, StringData terms) const
+{
+    if (REALM_UNLIKELY(!is_attached()))
+        throw LogicError(LogicError::detached_accessor);
+
+    if (REALM_UNLIKELY(col_ndx >= m_cols.size()))
+        throw LogicError(LogicError::column_index_out_of_range);
+
+    auto index = get_fulltext_index(col_ndx); // Throws
+    if (REALM_UNLIKELY(!index))
+        throw LogicError(LogicError::no_search_index);
+
+    std::vector<std::string> words;
+    FullTextIndex::tokenize(terms, words); // Throws
+    std::vector<size_t> rows;
+    index->find_ranked(words, rows); // Throws
+    return rows;
+}
+
+
+bool Table::has_case_fold_index(size_t col_ndx) const noexcept
+{
+    // Utilize the guarantee that m_cols.size() == 0 for a detached table accessor.
+    if (REALM_UNLIKELY(col_ndx >= m_cols.size()))
+        return false;
+    return (m_spec.get_column_attr(col_ndx) & col_attr_CaseFoldIndexed) != 0;
+}
+
+
+void Table::add_case_fold_index(size_t col_ndx)
+{
+    if (REALM_UNLIKELY(!is_attached()))
+        throw LogicError(LogicError::detached_accessor);
+
+    if (REALM_UNLIKELY(has_shared_type()))
+        throw LogicError(LogicError::wrong_kind_of_table);
+
+    if (REALM_UNLIKELY(col_ndx >= m_cols.size()))
+        throw LogicError(LogicError::column_index_out_of_range);
+
+    if (REALM_UNLIKELY(get_column_type(col_ndx) != type_String))
+        throw LogicError(LogicError::illegal_combination);
+
+    add_accessor_index(col_ndx, col_attr_CaseFoldIndexed); // Throws
+}
+
+
+void Table::remove_case_fold_index(size_t col_ndx)
+{
+    if (REALM_UNLIKELY(!is_attached()))
+        throw LogicError(LogicError::detached_accessor);
+
+    if (REALM_UNLIKELY(has_shared_type()))
+        throw LogicError(LogicError::wrong_kind_of_table);
+
+    if (REALM_UNLIKELY(col_ndx >= m_cols.size()))
+        throw LogicError(LogicError::column_index_out_of_range);
+
+    remove_accessor_index(col_ndx, col_attr_CaseFoldIndexed); // Throws
+}
+
+
+bool Table::has_composite_index(const std::vector<size_t>& col_ndxs) const noexcept
+{
+    return m_spec.has_composite_index(col_ndxs);
+}
+
+
+void Table::add_composite_index(const std::vector<size_t>& col_ndxs)
+{
+    if (REALM_UNLIKELY(!is_attached()))
+        throw LogicError(LogicError::detached_accessor);
+
+    if (REALM_UNLIKELY(has_shared_type()))
+        throw LogicError(LogicError::wrong_kind_of_table);
+
+    if (REALM_UNLIKELY(col_ndxs.size() < 2))
+        throw LogicError(LogicError::illegal_combination);
+
+    for (size_t i = 0; i < col_ndxs.size(); ++i) {
+        size_t col_ndx = col_ndxs[i];
+        if (REALM_UNLIKELY(col_ndx >= m_cols.size()))
+            throw LogicError(LogicError::column_index_out_of_range);
+        if (std::find(col_ndxs.begin(), col_ndxs.begin() + i, col_ndx) != col_ndxs.begin() + i)
+            throw LogicError(LogicError::illegal_combination);
+        switch (get_column_type(col_ndx)) {
+            case type_Int:
+            case type_Timestamp:
+            case type_Float:
+            case type_Double:
+                break;
+            default:
+                throw LogicError(LogicError::illegal_combination);
+        }
+    }
+
+    if (has_composite_index(col_ndxs))
+        return;
+
+    // The index is built when a query first needs it
+    m_spec.add_composite_index(col_ndxs); // Throws
+
+    if (Replication* repl = get_repl())
+        repl->add_composite_index(this, col_ndxs); // Throws
+}
+
+
+void Table::remove_composite_index(const std::vector<size_t>& col_ndxs)
+{
+    if (REALM_UNLIKELY(!is_attached()))
+        throw LogicError(LogicError::detached_accessor);
+
+    if (REALM_UNLIKELY(has_shared_type()))
+        throw LogicError(LogicError::wrong_kind_of_table);
+
+    if (!has_composite_index(col_ndxs))
+        return;
+
+    m_spec.remove_composite_index(col_ndxs); // Throws
+    refresh_accessor_indexes();
+
+    if (Replication* repl = get_repl())
+        repl->remove_composite_index(this, col_ndxs); // Throws
+}
+
+
+std::vector<std::shared_ptr<const CompositeIndex>> Table::get_composite_indexes() const
+{
+    std::vector<std::vector<size_t>> definitions = m_spec.get_composite_indexes(); // Throws
+    std::vector<std::shared_ptr<const CompositeIndex>> indexes;
+    if (definitions.empty())
+        return indexes;
+
+    LockGuard lock(m_accessor_mutex);
+    indexes.reserve(definitions.size()); // Throws
+    for (std::vector<size_t>& col_ndxs : definitions) {
+        auto is_match = [&](const std::shared_ptr<CompositeIndex>& index) {
+            return index->get_columns() == col_ndxs;
+        };
+        auto i = std::find_if(m_composite_indexes.begin(), m_composite_indexes.end(), is_match);
+        if (i == m_composite_indexes.end()) {
+            m_composite_indexes.push_back(std::make_shared<CompositeIndex>(std::move(col_ndxs))); // Throws
+            i = m_composite_indexes.end() - 1;
+        }
+        (*i)->update(*this); // Throws
+        indexes.push_back(*i);
+    }
+    return indexes;
+}
+
+
+std::shared_ptr<const OrderedIndex> Table::get_ordered_index(size_t col_ndx) const
+{
+    if (!has_ordered_index(col_ndx))
+        return nullptr;
+
+    LockGuard lock(m_accessor_mutex);
+    m_column_indexes.resize(m_cols.size()); // Throws
+    std::shared_ptr<OrderedIndex>& index = m_column_indexes[col_ndx].m_ordered_index;
+    if (!index)
+        index = std::make_shared<OrderedIndex>(col_ndx); // Throws
+    index->update(*this);                                // Throws
+    return index;
+}
+
+
+std::shared_ptr<const HashIndex> Table::get_hash_index(size_t col_ndx) const
+{
+    if (!has_hash_index(col_ndx))
+        return nullptr;
+
+    LockGuard lock(m_accessor_mutex);
+    m_column_indexes.resize(m_cols.size()); // Throws
+    std::shared_ptr<HashIndex>& index = m_column_indexes[col_ndx].m_hash_index;
+    if (!index)
+        index = std::make_shared<HashIndex>(col_ndx); // Throws
+    index->update(*this);                             // Throws
+    return index;
+}
+
+
+std::shared_ptr<const TrigramIndex> Table::get_trigram_index(size_t col_ndx) const
+{
+    if (!has_trigram_index(col_ndx))
+        return nullptr;
+
+    LockGuard lock(m_accessor_mutex);
+    m_column_indexes.resize(m_cols.size()); // Throws
+    std::shared_ptr<TrigramIndex>& index = m_column_indexes[col_ndx].m_trigram_index;
+    if (!index)
+        index = std::make_shared<TrigramIndex>(col_ndx); // Throws
+    index->update(*this);                                // Throws
+    return index;
+}
+
+
+std::shared_ptr<const FullTextIndex> Table::get_fulltext_index(size_t col_ndx) const
+{
+    if (!has_fulltext_index(col_ndx))
+        return nullptr;
+
+    LockGuard lock(m_accessor_mutex);
+    m_column_indexes.resize(m_cols.size()); // Throws
+    std::shared_ptr<FullTextIndex>& index = m_column_indexes[col_ndx].m_fulltext_index;
+    if (!index)
+        index = std::make_shared<FullTextIndex>(col_ndx); // Throws
+    index->update(*this);                                 // Throws
+    return index;
+}
+
+
+std::shared_ptr<const CaseFoldIndex> Table::get_case_fold_index(size_t col_ndx) const
+{
+    if (!has_case_fold_index(col_ndx))
+        return nullptr;
+
+    LockGuard lock(m_accessor_mutex);
+    m_column_indexes.resize(m_cols.size()); // Throws
+    std::shared_ptr<CaseFoldIndex>& index = m_column_indexes[col_ndx].m_case_fold_index;
+    if (!index)
+        index = std::make_shared<CaseFoldIndex>(col_ndx); // Throws
+    index->update(*this);                                 // Throws
+    return index;
+}
+
+
+std::shared_ptr<const HashIndex> Table::get_lookup_hash_index(size_t col_ndx) const
+{
+    // Building the hash table takes longer than scanning the column once
+    if (has_search_index(col_ndx) || !has_hash_index(col_ndx))
+        return nullptr;
+
+    LockGuard lock(m_accessor_mutex);
+    if (col_ndx >= m_column_indexes.size())
+        return nullptr;
+    const std::shared_ptr<HashIndex>& index = m_column_indexes[col_ndx].m_hash_index;
+    if (!index || !index->can_update_incrementally(*this))
+        return nullptr;
+    index->update(*this); // Throws
+    return index;
+}
+
+
 // FIXME:
 //
 // Note the two versions of get_column_base(). The difference between
@@ -2145,15 +2668,20 @@ void Table::insert_empty_row(size_t row_ndx, size_t num_rows)
         throw LogicError(LogicError::table_has_no_columns);
     }
 
-    bump_version();
+    unshare_view_payloads(); // Throws
+    bump_version_of_rows();
 
     for (size_t col_ndx = 0; col_ndx != num_cols; ++col_ndx) {
         ColumnBase& col = get_column_base(col_ndx);
         bool insert_nulls = is_nullable(col_ndx);
         col.insert_rows(row_ndx, num_rows, m_size, insert_nulls); // Throws
     }
-    if (row_ndx < m_size)
+    if (row_ndx < m_size) {
         adj_row_acc_insert_rows(row_ndx, num_rows);
+    }
+    else {
+        adj_row_acc_set_rows(row_ndx, num_rows);
+    }
     m_size += num_rows;
 
     if (Replication* repl = get_repl()) {
@@ -2324,6 +2852,7 @@ void Table::batch_erase_rows(const IntegerColumn& row_indexes, bool is_move_last
 // directly with broken_reciprocal_backlinks=false.
 void Table::do_remove(size_t row_ndx, bool broken_reciprocal_backlinks)
 {
+    unshare_view_payloads(); // Throws
     size_t num_cols = m_spec.get_column_count();
     for (size_t col_ndx = 0; col_ndx < num_cols; ++col_ndx) {
         ColumnBase& col = get_column_base(col_ndx);
@@ -2332,7 +2861,7 @@ void Table::do_remove(size_t row_ndx, bool broken_reciprocal_backlinks)
     }
     adj_row_acc_erase_row(row_ndx);
     --m_size;
-    bump_version();
+    bump_version_of_rows();
 }
 
 
@@ -2340,6 +2869,7 @@ void Table::do_remove(size_t row_ndx, bool broken_reciprocal_backlinks)
 // directly with broken_reciprocal_backlinks=false.
 void Table::do_move_last_over(size_t row_ndx, bool broken_reciprocal_backlinks)
 {
+    unshare_view_payloads(); // Throws
     size_t num_cols = m_spec.get_column_count();
     // We must start with backlink columns in case the corresponding link
     // columns are in the same table so that the link columns are not updated
@@ -2354,7 +2884,7 @@ void Table::do_move_last_over(size_t row_ndx, bool broken_reciprocal_backlinks)
     size_t last_row_ndx = m_size - 1;
     adj_row_acc_move_over(last_row_ndx, row_ndx);
     --m_size;
-    bump_version();
+    bump_version_of_rows();
 }
 
 
@@ -2440,6 +2970,7 @@ void Table::clear()
 // directly with broken_reciprocal_backlinks=false.
 void Table::do_clear(bool broken_reciprocal_backlinks)
 {
+    unshare_view_payloads(); // Throws
     size_t num_cols = m_spec.get_column_count();
     for (size_t col_ndx = 0; col_ndx != num_cols; ++col_ndx) {
         ColumnBase& col = get_column_base(col_ndx);
@@ -2448,16 +2979,9 @@ void Table::do_clear(bool broken_reciprocal_backlinks)
     m_size = 0;
 
     discard_row_accessors();
+    adj_row_acc_clear();
 
-    {
-        LockGuard lock(m_accessor_mutex);
-
-        for (auto& view : m_views) {
-            view->adj_row_acc_clear();
-        }
-    }
-
-    bump_version();
+    bump_version_of_rows();
 }
 
 void Table::swap_rows(size_t row_ndx_1, size_t row_ndx_2)
@@ -2816,12 +3340,21 @@ Timestamp Table::get(size_t col_ndx, size_t ndx) const noexcept
 
 
 template <class ColType, class T>
-size_t Table::do_find_unique(ColType& col, size_t ndx, T&& value, bool& conflict)
-{
+size_t Table::do_find_unique(ColType& col, size_t col_ndx, size_t ndx, T&& value, bool& conflict)
+{
+    // Without a search index, the rows are looked up in the hash index, which
+    // follows the rows that are removed below
+    bool use_hash_index = !has_search_index(col_ndx);
+    auto find_first = [&](size_t begin) {
+        if (use_hash_index)
+            return get_hash_index(col_ndx)->find_first(col, value, begin); // Throws
+        return col.find_first(value, begin);
+    };
+
     size_t winner = size_t(-1);
 
     while (true) {
-        winner = col.find_first(value, winner + 1);
+        winner = find_first(winner + 1); // Throws
         if (winner == ndx)
             continue;
         if (winner == not_found)
@@ -2838,7 +3371,7 @@ size_t Table::do_find_unique(ColType& col, size_t ndx, T&& value, bool& conflict
     // Delete additional duplicates.
     size_t duplicate = winner;
     while (true) {
-        duplicate = col.find_first(value, duplicate + 1);
+        duplicate = find_first(duplicate + 1); // Throws
         if (duplicate == ndx)
             continue;
         if (duplicate == not_found)
@@ -2863,17 +3396,17 @@ size_t Table::do_find_unique(ColType& col, size_t ndx, T&& value, bool& conflict
 }
 
 template <class ColType>
-size_t Table::do_set_unique_null(ColType& col, size_t ndx, bool& conflict)
+size_t Table::do_set_unique_null(ColType& col, size_t col_ndx, size_t ndx, bool& conflict)
 {
-    ndx = do_find_unique(col, ndx, null{}, conflict);
+    ndx = do_find_unique(col, col_ndx, ndx, null{}, conflict); // Throws
     col.set_null(ndx);
     return ndx;
 }
 
 template <class ColType, class T>
-size_t Table::do_set_unique(ColType& col, size_t ndx, T&& value, bool& conflict)
+size_t Table::do_set_unique(ColType& col, size_t col_ndx, size_t ndx, T&& value, bool& conflict)
 {
-    ndx = do_find_unique(col, ndx, value, conflict);
+    ndx = do_find_unique(col, col_ndx, ndx, value, conflict); // Throws
     col.set(ndx, value);
     return ndx;
 }
@@ -2888,7 +3421,7 @@ size_t Table::set_int_unique(size_t col_ndx, size_t ndx, int_fast64_t value)
     REALM_ASSERT_3(col_ndx, <, get_column_count());
     REALM_ASSERT_3(ndx, <, m_size);
 
-    if (!has_search_index(col_ndx)) {
+    if (!has_search_index(col_ndx) && !has_hash_index(col_ndx)) {
         throw LogicError{LogicError::no_search_index};
     }
 
@@ -2902,13 +3435,17 @@ size_t Table::set_int_unique(size_t col_ndx, size_t ndx, int_fast64_t value)
 
     if (is_nullable(col_ndx)) {
         auto& col = get_column_int_null(col_ndx);
-        ndx = do_set_unique(col, ndx, value, conflict); // Throws
+        ndx = do_set_unique(col, col_ndx, ndx, value, conflict); // Throws
     }
     else {
         auto& col = get_column(col_ndx);
-        ndx = do_set_unique(col, ndx, value, conflict); // Throws
+        ndx = do_set_unique(col, col_ndx, ndx, value, conflict); // Throws
     }
 
+    // bump_version() does not tell the indexes of the table (see
+    // AccessorIndex) which row has changed
+    adj_row_acc_set_rows(ndx, 1);
+
     if (!conflict) {
         if (Replication* repl = get_repl())
             repl->set_int(this, col_ndx, ndx, value, _impl::instr_SetUnique); // Throws
@@ -2921,7 +3458,7 @@ void Table::set_int(size_t col_ndx, size_t ndx, int_fast64_t value, bool is_defa
 {
     REALM_ASSERT_3(col_ndx, <, get_column_count());
     REALM_ASSERT_3(ndx, <, m_size);
-    bump_version();
+    bump_version_of_row(ndx);
 
     if (is_nullable(col_ndx)) {
         auto& col = get_column_int_null(col_ndx);
@@ -2940,7 +3477,7 @@ void Table::add_int(size_t col_ndx, size_t ndx, int_fast64_t value)
 {
     REALM_ASSERT_3(col_ndx, <, get_column_count());
     REALM_ASSERT_3(ndx, <, m_size);
-    bump_version();
+    bump_version_of_row(ndx);
 
     auto add_wrap = [](int64_t a, int64_t b) -> int64_t {
         uint64_t ua = uint64_t(a);
@@ -2979,7 +3516,7 @@ void Table::set_timestamp(size_t col_ndx, size_t ndx, Timestamp value, bool is_d
     REALM_ASSERT_3(col_ndx, <, get_column_count());
     REALM_ASSERT_3(get_real_column_type(col_ndx), ==, col_type_Timestamp);
     REALM_ASSERT_3(ndx, <, m_size);
-    bump_version();
+    bump_version_of_row(ndx);
 
     if (!is_nullable(col_ndx) && value.is_null())
         throw LogicError(LogicError::column_not_nullable);
@@ -3008,7 +3545,7 @@ void Table::set_bool(size_t col_ndx, size_t ndx, bool value, bool is_default)
     REALM_ASSERT_3(col_ndx, <, get_column_count());
     REALM_ASSERT_3(get_real_column_type(col_ndx), ==, col_type_Bool);
     REALM_ASSERT_3(ndx, <, m_size);
-    bump_version();
+    bump_version_of_row(ndx);
 
     if (is_nullable(col_ndx)) {
         IntNullColumn& col = get_column_int_null(col_ndx);
@@ -3035,7 +3572,7 @@ void Table::set_olddatetime(size_t col_ndx, size_t ndx, OldDateTime value, bool
     REALM_ASSERT_3(col_ndx, <, get_column_count());
     REALM_ASSERT_3(get_real_column_type(col_ndx), ==, col_type_OldDateTime);
     REALM_ASSERT_3(ndx, <, m_size);
-    bump_version();
+    bump_version_of_row(ndx);
 
     if (is_nullable(col_ndx)) {
         IntNullColumn& col = get_column_int_null(col_ndx);
@@ -3062,7 +3599,7 @@ void Table::set_float(size_t col_ndx, size_t ndx, float value, bool is_default)
 {
     REALM_ASSERT_3(col_ndx, <, get_column_count());
     REALM_ASSERT_3(ndx, <, m_size);
-    bump_version();
+    bump_version_of_row(ndx);
 
     FloatColumn& col = get_column_float(col_ndx);
     col.set(ndx, value);
@@ -3082,7 +3619,7 @@ void Table::set_double(size_t col_ndx, size_t ndx, double value, bool is_default
 {
     REALM_ASSERT_3(col_ndx, <, get_column_count());
     REALM_ASSERT_3(ndx, <, m_size);
-    bump_version();
+    bump_version_of_row(ndx);
 
     DoubleColumn& col = get_column_double(col_ndx);
     col.set(ndx, value);
@@ -3116,7 +3653,7 @@ void Table::set_string(size_t col_ndx, size_t ndx, StringData value, bool is_def
     if (REALM_UNLIKELY(value.size() > max_string_size))
         throw LogicError(LogicError::string_too_big);
 
-    bump_version();
+    bump_version_of_row(ndx);
     ColumnBase& col = get_column_base(col_ndx);
     col.set_string(ndx, value); // Throws
 
@@ -3142,7 +3679,7 @@ size_t Table::set_string_unique(size_t col_ndx, size_t ndx, StringData value)
     if (!is_nullable(col_ndx) && value.is_null())
         throw LogicError(LogicError::column_not_nullable);
 
-    if (!has_search_index(col_ndx))
+    if (!has_search_index(col_ndx) && !has_hash_index(col_ndx))
         throw LogicError(LogicError::no_search_index);
 
     // FIXME: See the definition of check_lists_are_empty() for an explanation
@@ -3158,13 +3695,17 @@ size_t Table::set_string_unique(size_t col_ndx, size_t ndx, StringData value)
     // FIXME: String and StringEnum columns should have a common base class
     if (actual_type == ColumnType::col_type_String) {
         StringColumn& col = get_column_string(col_ndx);
-        ndx = do_set_unique(col, ndx, value, conflict); // Throws
+        ndx = do_set_unique(col, col_ndx, ndx, value, conflict); // Throws
     }
     else {
         StringEnumColumn& col = get_column_string_enum(col_ndx);
-        ndx = do_set_unique(col, ndx, value, conflict); // Throws
+        ndx = do_set_unique(col, col_ndx, ndx, value, conflict); // Throws
     }
 
+    // bump_version() does not tell the indexes of the table (see
+    // AccessorIndex) which row has changed
+    adj_row_acc_set_rows(ndx, 1);
+
     if (!conflict) {
         if (Replication* repl = get_repl())
             repl->set_string(this, col_ndx, ndx, value, _impl::instr_SetUnique); // Throws
@@ -3196,7 +3737,7 @@ void Table::insert_substring(size_t col_ndx, size_t row_ndx, size_t pos, StringD
     std::string copy_of_value = old_value;                 // Throws
     copy_of_value.insert(pos, value.data(), value.size()); // Throws
 
-    bump_version();
+    bump_version_of_row(row_ndx);
     ColumnBase& col = get_column_base(col_ndx);
     col.set_string(row_ndx, copy_of_value); // Throws
 
@@ -3226,7 +3767,7 @@ void Table::remove_substring(size_t col_ndx, size_t row_ndx, size_t pos, size_t
     std::string copy_of_value = old_value;    // Throws
     copy_of_value.erase(pos, substring_size); // Throws
 
-    bump_version();
+    bump_version_of_row(row_ndx);
     ColumnBase& col = get_column_base(col_ndx);
     col.set_string(row_ndx, copy_of_value); // Throws
 
@@ -3259,7 +3800,7 @@ void Table::set_binary(size_t col_ndx, size_t ndx, BinaryData value, bool is_def
         throw LogicError(LogicError::column_not_nullable);
     if (REALM_UNLIKELY(value.size() > ArrayBlob::max_binary_size))
         throw LogicError(LogicError::binary_too_big);
-    bump_version();
+    bump_version_of_row(ndx);
 
     // FIXME: Loophole: Assertion violation in Table::get_column_binary() on
     // column type mismatch.
@@ -3503,7 +4044,7 @@ void Table::set_null_unique(size_t col_ndx, size_t row_ndx)
     REALM_ASSERT_3(col_ndx, <, get_column_count());
     REALM_ASSERT_3(row_ndx, <, m_size);
 
-    if (!has_search_index(col_ndx)) {
+    if (!has_search_index(col_ndx) && !has_hash_index(col_ndx)) {
         throw LogicError{LogicError::no_search_index};
     }
 
@@ -3517,7 +4058,11 @@ void Table::set_null_unique(size_t col_ndx, size_t row_ndx)
 
     // Only valid for int columns; use `set_string_unique` to set null strings
     auto& col = get_column_int_null(col_ndx);
-    row_ndx = do_set_unique_null(col, row_ndx, conflict); // Throws
+    row_ndx = do_set_unique_null(col, col_ndx, row_ndx, conflict); // Throws
+
+    // bump_version() does not tell the indexes of the table (see
+    // AccessorIndex) which row has changed
+    adj_row_acc_set_rows(row_ndx, 1);
 
     if (!conflict) {
         if (Replication* repl = get_repl())
@@ -3534,7 +4079,7 @@ void Table::set_null(size_t col_ndx, size_t row_ndx, bool is_default)
     REALM_ASSERT_3(col_ndx, <, get_column_count());
     REALM_ASSERT_3(row_ndx, <, m_size);
 
-    bump_version();
+    bump_version_of_row(row_ndx);
     ColumnBase& col = get_column_base(col_ndx);
     col.set_null(row_ndx);
 
@@ -3550,6 +4095,9 @@ size_t Table::count_int(size_t col_ndx, int64_t value) const
     if (!m_columns.is_attached())
         return 0;
 
+    if (auto index = get_lookup_hash_index(col_ndx)) // Throws
+        return index->count(get_column_base(col_ndx), value);
+
     const IntegerColumn& col = get_column<IntegerColumn, col_type_Int>(col_ndx);
     return col.count(value);
 }
@@ -3576,6 +4124,9 @@ size_t Table::count_string(size_t col_ndx, StringData value) const
     if (!m_columns.is_attached())
         return 0;
 
+    if (auto index = get_lookup_hash_index(col_ndx)) // Throws
+        return index->count(get_column_base(col_ndx), value);
+
     ColumnType type = get_real_column_type(col_ndx);
     if (type == col_type_String) {
         const StringColumn& col = get_column_string(col_ndx);
@@ -3852,6 +4403,11 @@ size_t Table::find_first_link(size_t target_row_index) const
 
 size_t Table::find_first_int(size_t col_ndx, int64_t value) const
 {
+    if (m_columns.is_attached()) {
+        if (auto index = get_lookup_hash_index(col_ndx)) // Throws
+            return index->find_first(get_column_base(col_ndx), value);
+    }
+
     if (is_nullable(col_ndx))
         return find_first<util::Optional<int64_t>>(col_ndx, value);
     else
@@ -3882,6 +4438,9 @@ size_t Table::find_first_timestamp(size_t col_ndx, Timestamp value) const
     if (!m_columns.is_attached())
         return not_found;
 
+    if (auto index = get_lookup_hash_index(col_ndx)) // Throws
+        return index->find_first(get_column_base(col_ndx), value);
+
     const TimestampColumn& col = get_column_timestamp(col_ndx);
     return col.find<realm::Equal>(value, 0, col.size());
 }
@@ -3902,6 +4461,9 @@ size_t Table::find_first_string(size_t col_ndx, StringData value) const
     if (!m_columns.is_attached())
         return not_found;
 
+    if (auto index = get_lookup_hash_index(col_ndx)) // Throws
+        return index->find_first(get_column_base(col_ndx), value);
+
     ColumnType type = get_real_column_type(col_ndx);
     if (type == col_type_String) {
         const StringColumn& col = get_column_string(col_ndx);
@@ -4418,6 +4980,21 @@ ConstTableView Table::get_range_view(size_t begin, size_t end) const
     return const_cast<Table*>(this)->get_range_view(begin, end);
 }
 
+TableView Table::get_bitmap_view(const RowBitmap& rows)
+{
+    TableView ctv(*this);
+    if (m_columns.is_attached()) {
+        IntegerColumn& refs = ctv.m_row_indexes;
+        rows.for_each([&](size_t row) { refs.add(row); });
+    }
+    return ctv;
+}
+
+ConstTableView Table::get_bitmap_view(const RowBitmap& rows) const
+{
+    return const_cast<Table*>(this)->get_bitmap_view(rows);
+}
+
 TableView Table::get_backlink_view(size_t row_ndx, Table* src_table, size_t src_col_ndx)
 {
     REALM_ASSERT(&src_table->get_column_link_base(src_col_ndx).get_target_table() == this);
@@ -5529,13 +6106,7 @@ void Table::adj_acc_clear_root_table() noexcept
         }
     }
 
-    {
-        LockGuard lock(m_accessor_mutex);
-        // Adjust rows in tableviews after removal of all rows
-        for (auto& view : m_views) {
-            view->adj_row_acc_clear();
-        }
-    }
+    adj_row_acc_clear();
 }
 
 
@@ -5551,6 +6122,14 @@ void Table::adj_acc_clear_nonroot_table() noexcept
 }
 
 
+void Table::unshare_view_payloads()
+{
+    LockGuard lock(m_accessor_mutex);
+    for (auto& view : m_views)
+        view->unshare_payload(); // Throws
+}
+
+
 void Table::adj_row_acc_insert_rows(size_t row_ndx, size_t num_rows) noexcept
 {
     // This function must assume no more than minimal consistency of the
@@ -5568,6 +6147,8 @@ void Table::adj_row_acc_insert_rows(size_t row_ndx, size_t num_rows) noexcept
     for (auto& view : m_views) {
         view->adj_row_acc_insert_rows(row_ndx, num_rows);
     }
+
+    for_each_accessor_index([&](AccessorIndex& index) { index.adj_insert_rows(row_ndx, num_rows); });
 }
 
 
@@ -5596,6 +6177,8 @@ void Table::adj_row_acc_erase_row(size_t row_ndx) noexcept
     for (auto& view : m_views) {
         view->adj_row_acc_erase_row(row_ndx);
     }
+
+    for_each_accessor_index([&](AccessorIndex& index) { index.adj_erase_row(row_ndx); });
 }
 
 void Table::adj_row_acc_swap_rows(size_t row_ndx_1, size_t row_ndx_2) noexcept
@@ -5616,6 +6199,13 @@ void Table::adj_row_acc_swap_rows(size_t row_ndx_1, size_t row_ndx_2) noexcept
         }
         row = row->m_next;
     }
+
+    // The rows of views are not adjusted, so they must be found again
+    for (auto& view : m_views) {
+        view->discard_row_changes();
+    }
+
+    for_each_accessor_index([&](AccessorIndex& index) { index.adj_swap_rows(row_ndx_1, row_ndx_2); });
 }
 
 
@@ -5632,6 +6222,11 @@ void Table::adj_row_acc_merge_rows(size_t old_row_ndx, size_t new_row_ndx) noexc
             row->m_row_ndx = new_row_ndx;
         row = row->m_next;
     }
+
+    // The rows of views are not adjusted, so they must be found again
+    for (auto& view : m_views) {
+        view->discard_row_changes();
+    }
 }
 
 
@@ -5658,6 +6253,47 @@ void Table::adj_row_acc_move_over(size_t from_row_ndx, size_t to_row_ndx) noexce
     for (auto& view : m_views) {
         view->adj_row_acc_move_over(from_row_ndx, to_row_ndx);
     }
+
+    for_each_accessor_index([&](AccessorIndex& index) { index.adj_move_over(from_row_ndx, to_row_ndx); });
+}
+
+
+void Table::adj_row_acc_set_rows(size_t row_ndx, size_t num_rows) const noexcept
+{
+    // This function must assume no more than minimal consistency of the
+    // accessor hierarchy. This means in particular that it cannot access the
+    // underlying node structure. See AccessorConsistencyLevels.
+    LockGuard lock(m_accessor_mutex);
+    for (auto& view : m_views) {
+        view->adj_row_acc_set_rows(row_ndx, num_rows);
+    }
+
+    for_each_accessor_index([&](AccessorIndex& index) { index.adj_set_rows(row_ndx, num_rows); });
+}
+
+
+void Table::discard_view_row_changes() const noexcept
+{
+    LockGuard lock(m_accessor_mutex);
+    for (auto& view : m_views) {
+        view->discard_row_changes();
+    }
+}
+
+
+void Table::adj_row_acc_clear() noexcept
+{
+    // This function must assume no more than minimal consistency of the
+    // accessor hierarchy. This means in particular that it cannot access the
+    // underlying node structure. See AccessorConsistencyLevels.
+    LockGuard lock(m_accessor_mutex);
+
+    // Adjust rows in tableviews after removal of all rows
+    for (auto& view : m_views) {
+        view->adj_row_acc_clear();
+    }
+
+    for_each_accessor_index([](AccessorIndex& index) { index.adj_clear(); });
 }
 
 
@@ -5674,6 +6310,12 @@ void Table::adj_insert_column(size_t col_ndx)
         REALM_ASSERT_3(col_ndx, <=, m_cols.size());
         m_cols.insert(m_cols.begin() + col_ndx, nullptr); // Throws
     }
+
+    LockGuard lock(m_accessor_mutex);
+    discard_query_statistics(col_ndx);
+    if (col_ndx <= m_column_indexes.size() && !m_column_indexes.empty())
+        m_column_indexes.insert(m_column_indexes.begin() + col_ndx, ColumnIndexEntry()); // Throws
+    for_each_accessor_index([&](AccessorIndex& index) { index.adj_insert_column(col_ndx); });
 }
 
 
@@ -5691,6 +6333,18 @@ void Table::adj_erase_column(size_t col_ndx) noexcept
             delete col;
         m_cols.erase(m_cols.begin() + col_ndx);
     }
+
+    LockGuard lock(m_accessor_mutex);
+    discard_query_statistics(col_ndx);
+    if (col_ndx < m_column_indexes.size())
+        m_column_indexes.erase(m_column_indexes.begin() + col_ndx);
+    auto has_column = [=](const std::shared_ptr<CompositeIndex>& index) {
+        const std::vector<size_t>& col_ndxs = index->get_columns();
+        return std::find(col_ndxs.begin(), col_ndxs.end(), col_ndx) != col_ndxs.end();
+    };
+    m_composite_indexes.erase(std::remove_if(m_composite_indexes.begin(), m_composite_indexes.end(), has_column),
+                              m_composite_indexes.end());
+    for_each_accessor_index([&](AccessorIndex& index) { index.adj_erase_column(col_ndx); });
 }
 
 void Table::adj_move_column(size_t from, size_t to) noexcept
@@ -5718,6 +6372,18 @@ void Table::adj_move_column(size_t from, size_t to) noexcept
         }
         std::rotate(first, new_first, last);
     }
+
+    LockGuard lock(m_accessor_mutex);
+    discard_query_statistics(std::min(from, to), std::max(from, to) + 1);
+    if (from < m_column_indexes.size() && to < m_column_indexes.size()) {
+        auto first = m_column_indexes.begin() + std::min(from, to);
+        auto last = m_column_indexes.begin() + std::max(from, to) + 1;
+        if (from < to)
+            std::rotate(first, first + 1, last);
+        else
+            std::rotate(first, last - 1, last);
+    }
+    for_each_accessor_index([&](AccessorIndex& index) { index.adj_move_column(from, to); });
 }
 
 
@@ -5812,6 +6478,44 @@ void Table::refresh_accessor_tree()
 }
 
 
+double Table::get_query_match_dist(size_t col_ndx, std::type_index node_type, const std::string& description) const
+{
+    util::LockGuard lock(m_accessor_mutex);
+    auto i = m_query_match_dist.find(QueryStatKey(col_ndx, node_type, description)); // Throws
+    return i == m_query_match_dist.end() ? 0.0 : i->second;
+}
+
+
+void Table::record_query_match_dist(size_t col_ndx, std::type_index node_type, const std::string& description,
+                                    double dist) const
+{
+    util::LockGuard lock(m_accessor_mutex);
+    // Each value compared to adds a condition, so the statistics are started
+    // over rather than allowed to grow without bounds
+    const size_t max_conditions = 1000;
+    if (m_query_match_dist.size() >= max_conditions)
+        m_query_match_dist.clear();
+    auto i = m_query_match_dist.emplace(QueryStatKey(col_ndx, node_type, description), dist).first; // Throws
+    // Blend with earlier executions, so a single unusual query does not
+    // decide the plan of the next one
+    i->second = (i->second + dist) / 2;
+}
+
+
+void Table::discard_query_statistics(size_t col_ndx_begin, size_t col_ndx_end) noexcept
+{
+    for (auto i = m_query_match_dist.begin(); i != m_query_match_dist.end();) {
+        size_t col_ndx = std::get<0>(i->first);
+        if (col_ndx >= col_ndx_begin && col_ndx < col_ndx_end) {
+            i = m_query_match_dist.erase(i);
+        }
+        else {
+            ++i;
+        }
+    }
+}
+
+
 void Table::refresh_column_accessors(size_t col_ndx_begin)
 {
     // Index of column in Table::m_columns, which is not always equal to the
@@ -5910,6 +6614,8 @@ void Table::refresh_column_accessors(size_t col_ndx_begin)
         ColumnBase* first_col = m_cols[0];
         m_size = first_col->size();
     }
+
+    refresh_accessor_indexes();
 }
 
 
@@ -21,8 +21,11 @@
 
 #include <algorithm>
 #include <map>
+#include <string>
+#include <tuple>
 #include <utility>
 #include <typeinfo>
+#include <typeindex>
 #include <memory>
 
 #include <realm/util/features.h>
@@ -40,12 +43,19 @@ namespace realm {
 
 class BacklinkColumn;
 class BinaryColumy;
+class CompositeIndex;
 class ConstTableView;
 class Group;
 class LinkColumn;
 class LinkColumnBase;
 class LinkListColumn;
 class LinkView;
+class OrderedIndex;
+class HashIndex;
+class TrigramIndex;
+class FullTextIndex;
+class CaseFoldIndex;
+class RowBitmap;
 class SortDescriptor;
 class StringIndex;
 class TableView;
@@ -248,6 +258,220 @@ public:
 
     //@}
 
+    //@{
+
+    /// has_ordered_index() returns true if, and only if the specified column
+    /// has an ordered index. Rather than throwing, it returns false if the
+    /// specified index is out of range.
+    ///
+    /// add_ordered_index() adds an ordered index to the specified column, which
+    /// must be of type int, timestamp, float or double. Queries use the ordered
+    /// index to find the rows matching equality and range conditions (==, !=,
+    /// <, <=, >, >=) on the column without scanning it. It has no effect if an
+    /// ordered index has already been added to the specified column
+    /// (idempotency). Subtables with shared descriptors cannot have ordered
+    /// indexes.
+    ///
+    /// remove_ordered_index() removes the ordered index from the specified
+    /// column. It has no effect if the specified column has no ordered index.
+    ///
+    /// An ordered index is recorded in the Realm file as an attribute of its
+    /// column, and is replicated, like a search index. The sorted rows are not
+    /// stored, though. A table accessor sorts them when a query first needs
+    /// them, and from then on moves each inserted, removed or modified row to
+    /// its new place as the change happens. An ordered index follows its
+    /// column when columns are inserted, removed, or moved, and is removed
+    /// along with its column.
+    ///
+    /// \param column_ndx The index of a column of this table.
+
+    bool has_ordered_index(size_t column_ndx) const noexcept;
+    void add_ordered_index(size_t column_ndx);
+    void remove_ordered_index(size_t column_ndx);
+
+    //@}
+
+    //@{
+
+    /// has_hash_index() returns true if, and only if the specified column has
+    /// a hash index. Rather than throwing, it returns false if the specified
+    /// index is out of range.
+    ///
+    /// add_hash_index() adds a hash index to the specified column, which must
+    /// be of a type that supports a search index (see add_search_index()). A
+    /// hash index finds equal values in constant expected time, regardless of
+    /// their length, where a search index needs time proportional to the
+    /// length of the common prefix of the values. Queries use it for equality
+    /// conditions (==) on the column that they cannot look up in a search
+    /// index, and set_int_unique(), set_string_unique() and set_null_unique()
+    /// accept a column that has a hash index instead of a search index. It has
+    /// no effect if a hash index has already been added to the specified
+    /// column (idempotency). Subtables with shared descriptors cannot have
+    /// hash indexes.
+    ///
+    /// remove_hash_index() removes the hash index from the specified column.
+    /// It has no effect if the specified column has no hash index.
+    ///
+    /// Like an ordered index, a hash index is a column attribute, so it is
+    /// saved with the table and replicated, while the hash table itself lives
+    /// only in this table accessor. The hash table is built the first time a
+    /// query or a unique setter needs it, and each row is then moved between
+    /// buckets as it changes. find_first_int(), find_first_string(),
+    /// find_first_timestamp(), count_int() and count_string() use the hash
+    /// table when the column has no search index and the hash table can be
+    /// updated row by row, but never build it, so they do not pay for building
+    /// a hash table to answer a single lookup.
+    ///
+    /// \param column_ndx The index of a column of this table.
+
+    bool has_hash_index(size_t column_ndx) const noexcept;
+    void add_hash_index(size_t column_ndx);
+    void remove_hash_index(size_t column_ndx);
+
+    //@}
+
+    //@{
+
+    /// has_trigram_index() returns true if, and only if the specified column
+    /// has a trigram index. Rather than throwing, it returns false if the
+    /// specified index is out of range.
+    ///
+    /// add_trigram_index() adds a trigram index to the specified column, which
+    /// must be a string column. Queries use the trigram index to find the rows
+    /// that may match contains, begins with, ends with and like conditions,
+    /// case sensitive or not, and check only those rows. The index can only
+    /// narrow the search for patterns with at least three consecutive bytes
+    /// other than wildcards (and, for case insensitive conditions, other than
+    /// non-ASCII characters). It has no effect if a trigram index has already
+    /// been added to the specified column (idempotency). Subtables with
+    /// shared descriptors cannot have trigram indexes.
+    ///
+    /// remove_trigram_index() removes the trigram index from the specified
+    /// column. It has no effect if the specified column has no trigram index.
+    ///
+    /// Adding or removing a trigram index changes an attribute of the column
+    /// (see ColumnAttr), which other sessions see after they advance. The
+    /// lists of rows per trigram are derived from the column by the first
+    /// query that needs them. After that, setting a string moves its row
+    /// between the lists of the trigrams of the old and the new value, and
+    /// inserted, removed and moved rows are renumbered in the lists.
+    ///
+    /// \param column_ndx The index of a column of this table.
+
+    bool has_trigram_index(size_t column_ndx) const noexcept;
+    void add_trigram_index(size_t column_ndx);
+    void remove_trigram_index(size_t column_ndx);
+
+    //@}
+
+    //@{
+
+    /// has_fulltext_index() returns true if, and only if the specified column
+    /// has a full-text index. Rather than throwing, it returns false if the
+    /// specified index is out of range.
+    ///
+    /// add_fulltext_index() adds a full-text index to the specified column,
+    /// which must be a string column. The index lists the rows of every word
+    /// (see FullTextIndex::tokenize()) of the column, and queries use it to
+    /// find the rows that match Query::matches() conditions without reading
+    /// the strings. It has no effect if a full-text index has already been
+    /// added to the specified column (idempotency). Subtables with shared
+    /// descriptors cannot have full-text indexes.
+    ///
+    /// remove_fulltext_index() removes the full-text index from the specified
+    /// column. It has no effect if the specified column has no full-text
+    /// index.
+    ///
+    /// Only the fact that the column has a full-text index is written to the
+    /// file and the transaction log. The table accessor tokenizes the column
+    /// into lists of rows per word the first time a query needs them. From
+    /// then on, set_string() takes the row out of the lists of the words of
+    /// its old value and adds it to those of the new one, and rows that are
+    /// inserted, removed or moved (see move_last_over()) are renumbered in the
+    /// lists, so only the strings that change are tokenized again.
+    ///
+    /// \param column_ndx The index of a column of this table.
+
+    bool has_fulltext_index(size_t column_ndx) const noexcept;
+    void add_fulltext_index(size_t column_ndx);
+    void remove_fulltext_index(size_t column_ndx);
+
+    /// Returns the rows of this table whose values, in the specified string
+    /// column, contain at least one of the words of `terms`, ranked by the
+    /// number of distinct words they contain, most first, then by row index.
+    /// The specified column must have a full-text index.
+    std::vector<size_t> find_ranked_fulltext(size_t column_ndx, StringData terms) const;
+
+    //@}
+
+    //@{
+
+    /// has_case_fold_index() returns true if, and only if the specified column
+    /// has a case folded index. Rather than throwing, it returns false if the
+    /// specified index is out of range.
+    ///
+    /// add_case_fold_index() adds a case folded index to the specified column,
+    /// which must be a string column. The index keeps a copy of the column
+    /// mapped to lower case, sorted, so that case insensitive equal and begins
+    /// with conditions find their rows with a binary search, and case
+    /// insensitive contains and ends with conditions compare the mapped
+    /// values byte by byte. It has no effect if a case folded index has
+    /// already been added to the specified column (idempotency). Subtables
+    /// with shared descriptors cannot have case folded indexes.
+    ///
+    /// remove_case_fold_index() removes the case folded index from the
+    /// specified column. It has no effect if the specified column has no case
+    /// folded index.
+    ///
+    /// The folded copy is not part of the file; a case folded index reaches
+    /// the file and other sessions only as a column attribute. The copy is
+    /// made when a query first needs it. After that, each string setter folds
+    /// the new value of its row and moves the row to its new place in the
+    /// sorted order, and rows that are inserted, removed or moved keep their
+    /// folded values.
+    ///
+    /// \param column_ndx The index of a column of this table.
+
+    bool has_case_fold_index(size_t column_ndx) const noexcept;
+    void add_case_fold_index(size_t column_ndx);
+    void remove_case_fold_index(size_t column_ndx);
+
+    //@}
+
+    //@{
+
+    /// has_composite_index() returns true if, and only if this table has a
+    /// composite index over the specified columns, in the specified order.
+    ///
+    /// add_composite_index() adds a composite index over two or more columns,
+    /// each of type int, timestamp, float or double. Queries use the index to
+    /// find the rows matching equality conditions (==) on a prefix of its
+    /// columns, and, optionally, a range condition (==, <, <=, >, >=) on the
+    /// column that follows the prefix, without scanning. For example, an index
+    /// over columns `{a, b}` finds the rows where `a == x && b > y`, but not
+    /// the rows where `b > y`. It has no effect if the index already exists
+    /// (idempotency).
+    ///
+    /// remove_composite_index() removes the composite index over the specified
+    /// columns. It has no effect if there is no such index.
+    ///
+    /// The columns of each composite index are recorded in the spec of the
+    /// table, and adding or removing an index is replicated. The sorted rows
+    /// are kept in memory by the table accessor, which builds them the first
+    /// time a query needs them, and then moves each inserted, removed or
+    /// modified row to its place (see AccessorIndex). A composite index is
+    /// removed along with any of its columns. Composite indexes are not
+    /// available on subtables that share their descriptor with other
+    /// subtables.
+    ///
+    /// \param column_ndxs The indexes of distinct columns of this table.
+
+    bool has_composite_index(const std::vector<size_t>& column_ndxs) const noexcept;
+    void add_composite_index(const std::vector<size_t>& column_ndxs);
+    void remove_composite_index(const std::vector<size_t>& column_ndxs);
+
+    //@}
+
     //@{
     /// Get the dynamic type descriptor for this table.
     ///
@@ -454,6 +678,8 @@ public:
     /// the specified column, possibly different from \a row_ndx if a conflict
     /// occurred.  Users intending to implement primary keys must therefore
     /// manually check for duplicates if they want to raise an error instead.
+    /// The column must have a search index or a hash index, which is used to
+    /// find the conflicting rows.
     ///
     /// NOTE:  It is an error to call either function after adding elements to a
     /// linklist in the object. In general, calling set_int_unique() or
@@ -645,6 +871,11 @@ public:
     TableView get_range_view(size_t begin, size_t end);
     ConstTableView get_range_view(size_t begin, size_t end) const;
 
+    /// Returns a view of the rows in the specified bitmap, in row order. See
+    /// Query::find_all_bitmap().
+    TableView get_bitmap_view(const RowBitmap& rows);
+    ConstTableView get_bitmap_view(const RowBitmap& rows) const;
+
     TableView get_backlink_view(size_t row_ndx, Table* src_table, size_t src_col_ndx);
 
 
@@ -658,6 +889,7 @@ public:
     };
 
     // Simple pivot aggregate method. Experimental! Please do not document method publicly.
+    // See GroupBy for grouping by several keys of any type, with several aggregates.
     void aggregate(size_t group_by_column, size_t aggr_column, AggrType op, Table& result,
                    const IntegerColumn* viewrefs = nullptr) const;
 
@@ -941,6 +1173,34 @@ private:
     // Used for queries: Items are added with link() method during buildup of query
     mutable std::vector<size_t> m_link_chain;
 
+    // Average row distance between matches of query conditions, as learned by
+    // earlier queries. Conditions are identified by column index, node type
+    // and description (see ParentNode::describe()), which includes the value
+    // that the column is compared to, so `col > 5` and `col > 1000000000` are
+    // tracked separately. Access needs to be protected by m_accessor_mutex.
+    using QueryStatKey = std::tuple<size_t, std::type_index, std::string>;
+    mutable std::map<QueryStatKey, double> m_query_match_dist;
+
+    // The ordered, hash, trigram, full-text and case folded indexes of the
+    // columns of this table, see add_ordered_index(), add_hash_index(),
+    // add_trigram_index(), add_fulltext_index() and add_case_fold_index(). An
+    // index is null until it is needed. The vector is either empty, or has an
+    // entry for each column. Access needs to be protected by
+    // m_accessor_mutex.
+    struct ColumnIndexEntry {
+        std::shared_ptr<OrderedIndex> m_ordered_index;
+        std::shared_ptr<HashIndex> m_hash_index;
+        std::shared_ptr<TrigramIndex> m_trigram_index;
+        std::shared_ptr<FullTextIndex> m_fulltext_index;
+        std::shared_ptr<CaseFoldIndex> m_case_fold_index;
+    };
+    mutable std::vector<ColumnIndexEntry> m_column_indexes;
+
+    // The in-memory composite indexes of this table, one for each composite
+    // index in the spec that a query has needed (see add_composite_index()).
+    // Access needs to be protected by m_accessor_mutex.
+    mutable std::vector<std::shared_ptr<CompositeIndex>> m_composite_indexes;
+
     /// Used only in connection with Group::advance_transact() and
     /// Table::refresh_accessor_tree().
     mutable bool m_mark;
@@ -956,11 +1216,11 @@ private:
     void do_clear(bool broken_reciprocal_backlinks);
     size_t do_set_link(size_t col_ndx, size_t row_ndx, size_t target_row_ndx);
     template <class ColType, class T>
-    size_t do_find_unique(ColType& col, size_t ndx, T&& value, bool& conflict);
+    size_t do_find_unique(ColType& col, size_t col_ndx, size_t ndx, T&& value, bool& conflict);
     template <class ColType>
-    size_t do_set_unique_null(ColType& col, size_t ndx, bool& conflict);
+    size_t do_set_unique_null(ColType& col, size_t col_ndx, size_t ndx, bool& conflict);
     template <class ColType, class T>
-    size_t do_set_unique(ColType& column, size_t row_ndx, T&& value, bool& conflict);
+    size_t do_set_unique(ColType& column, size_t col_ndx, size_t row_ndx, T&& value, bool& conflict);
 
     void upgrade_file_format(size_t target_file_format_version);
 
@@ -977,8 +1237,23 @@ private:
     /// when a change is made to the table. When calling recursively (following links
     /// or going to the parent table), the parameter should be set to false to correctly
     /// prune traversal.
+    ///
+    /// The registered views forget the rows that they have been told are
+    /// changed, and bring themselves up to date by reexecuting the query (see
+    /// TableViewBase::sync_if_needed()).
     void bump_version(bool bump_global = true) const noexcept;
 
+    /// Same as bump_version(), for an operation that only changes values of
+    /// the specified row. The registered views are told that the row is
+    /// changed, so that they can bring themselves up to date by checking that
+    /// row only.
+    void bump_version_of_row(size_t row_ndx) const noexcept;
+
+    /// Same as bump_version(), for an operation that inserts, removes or
+    /// moves rows, of which the registered views are told by the row accessor
+    /// adjustments (see adj_row_acc_insert_rows()).
+    void bump_version_of_rows(bool bump_global = true) const noexcept;
+
     /// Disable copying assignment.
     ///
     /// It could easily be implemented by calling assign(), but the
@@ -1366,6 +1641,24 @@ private:
     /// Called by adj_acc_move_over() to adjust row accessors.
     void adj_row_acc_move_over(size_t from_row_ndx, size_t to_row_ndx) noexcept;
 
+    /// Tell the registered views that the values of the specified rows have
+    /// been changed, or that the rows have been appended.
+    void adj_row_acc_set_rows(size_t row_ndx, size_t num_rows) const noexcept;
+
+    /// Make the registered views forget the rows that they have been told are
+    /// changed, for a change that they cannot be told about row by row.
+    void discard_view_row_changes() const noexcept;
+
+    /// Tell the registered views and the in-memory indexes that all rows have
+    /// been removed.
+    void adj_row_acc_clear() noexcept;
+
+    /// Give every registered view a private copy of row indexes that it
+    /// shares with other views after handover. The row accessor adjustments
+    /// above cannot throw, so this must be done before a change that leads to
+    /// them is applied.
+    void unshare_view_payloads();
+
     void adj_insert_column(size_t col_ndx);
     void adj_erase_column(size_t col_ndx) noexcept;
     void adj_move_column(size_t col_ndx_1, size_t col_ndx_2) noexcept;
@@ -1418,6 +1711,53 @@ private:
 
     void refresh_column_accessors(size_t col_ndx_begin = 0);
 
+    // Query planner statistics, see ParentNode::load_statistics().
+    // get_query_match_dist() returns zero if nothing is known.
+    double get_query_match_dist(size_t col_ndx, std::type_index node_type, const std::string& description) const;
+    void record_query_match_dist(size_t col_ndx, std::type_index node_type, const std::string& description,
+                                 double dist) const;
+
+    // Forget the statistics of the columns in `[col_ndx_begin, col_ndx_end)`,
+    // when they have been moved, or been given or lost a search index.
+    // m_accessor_mutex must be locked by the caller.
+    void discard_query_statistics(size_t col_ndx_begin, size_t col_ndx_end = npos) noexcept;
+
+    // Add or remove an index that the table accessor keeps in memory (see
+    // AccessorIndex), as the column attribute `index_attr`, such as
+    // col_attr_OrderedIndexed, and replicate the change.
+    void add_accessor_index(size_t col_ndx, ColumnAttr index_attr);
+    void remove_accessor_index(size_t col_ndx, ColumnAttr index_attr);
+
+    // Drop the in-memory indexes of the columns that no longer have the
+    // attribute of their kind, and the composite indexes that are no longer in
+    // the spec, after the spec has been changed by another accessor. Called by
+    // refresh_column_accessors().
+    void refresh_accessor_indexes() noexcept;
+
+    // Calls `func` with each in-memory index of this table that exists.
+    // m_accessor_mutex must be locked by the caller.
+    template <class F>
+    void for_each_accessor_index(F func) const;
+
+    // These return the index of the specified kind of the specified column,
+    // brought up to date with the table, or null if the column has no such
+    // index.
+    std::shared_ptr<const OrderedIndex> get_ordered_index(size_t col_ndx) const;
+    std::shared_ptr<const HashIndex> get_hash_index(size_t col_ndx) const;
+    std::shared_ptr<const TrigramIndex> get_trigram_index(size_t col_ndx) const;
+    std::shared_ptr<const FullTextIndex> get_fulltext_index(size_t col_ndx) const;
+    std::shared_ptr<const CaseFoldIndex> get_case_fold_index(size_t col_ndx) const;
+
+    // Returns the hash index of the specified column if lookups of equal
+    // values should use it, that is, if the column has a hash index and no
+    // search index, and the hash index can be brought up to date without
+    // building it from scratch, otherwise null.
+    std::shared_ptr<const HashIndex> get_lookup_hash_index(size_t col_ndx) const;
+
+    // Returns the composite indexes of this table, brought up to date with
+    // the rows.
+    std::vector<std::shared_ptr<const CompositeIndex>> get_composite_indexes() const;
+
     // Look for link columns starting from col_ndx_begin.
     // If a link column is found, follow the link and update it's
     // backlink column accessor if it is in different table.
@@ -1495,6 +1835,18 @@ inline uint_fast64_t Table::get_version_counter() const noexcept
 }
 
 inline void Table::bump_version(bool bump_global) const noexcept
+{
+    discard_view_row_changes();
+    bump_version_of_rows(bump_global);
+}
+
+inline void Table::bump_version_of_row(size_t row_ndx) const noexcept
+{
+    adj_row_acc_set_rows(row_ndx, 1);
+    bump_version_of_rows();
+}
+
+inline void Table::bump_version_of_rows(bool bump_global) const noexcept
 {
     if (bump_global) {
         // This is only set on initial entry through an operation on the same
@@ -2314,6 +2666,53 @@ public:
         table.adj_acc_clear_root_table();
     }
 
+    static void unshare_view_payloads(Table& table)
+    {
+        table.unshare_view_payloads(); // Throws
+    }
+
+    static double get_query_match_dist(const Table& table, size_t col_ndx, std::type_index node_type,
+                                       const std::string& description)
+    {
+        return table.get_query_match_dist(col_ndx, node_type, description);
+    }
+
+    static void discard_query_statistics(Table& table, size_t col_ndx) noexcept
+    {
+        util::LockGuard lock(table.m_accessor_mutex);
+        table.discard_query_statistics(col_ndx, col_ndx + 1);
+    }
+
+    static std::shared_ptr<const OrderedIndex> get_ordered_index(const Table& table, size_t col_ndx)
+    {
+        return table.get_ordered_index(col_ndx); // Throws
+    }
+
+    static std::shared_ptr<const HashIndex> get_hash_index(const Table& table, size_t col_ndx)
+    {
+        return table.get_hash_index(col_ndx); // Throws
+    }
+
+    static std::shared_ptr<const TrigramIndex> get_trigram_index(const Table& table, size_t col_ndx)
+    {
+        return table.get_trigram_index(col_ndx); // Throws
+    }
+
+    static std::shared_ptr<const FullTextIndex> get_fulltext_index(const Table& table, size_t col_ndx)
+    {
+        return table.get_fulltext_index(col_ndx); // Throws
+    }
+
+    static std::shared_ptr<const CaseFoldIndex> get_case_fold_index(const Table& table, size_t col_ndx)
+    {
+        return table.get_case_fold_index(col_ndx); // Throws
+    }
+
+    static std::vector<std::shared_ptr<const CompositeIndex>> get_composite_indexes(const Table& table)
+    {
+        return table.get_composite_indexes(); // Throws
+    }
+
     static void adj_acc_clear_nonroot_table(Table& table) noexcept
     {
         table.adj_acc_clear_nonroot_table();
@@ -2407,6 +2806,16 @@ public:
         table.bump_version(bump_global);
     }
 
+    static void bump_version_of_rows(Table& table, bool bump_global = true) noexcept
+    {
+        table.bump_version_of_rows(bump_global);
+    }
+
+    static void adj_acc_set_row(Table& table, size_t row_ndx) noexcept
+    {
+        table.adj_row_acc_set_rows(row_ndx, 1);
+    }
+
     static bool is_cross_table_link_target(const Table& table)
     {
         return table.is_cross_table_link_target();
@@ -16,6 +16,7 @@
  *
  **************************************************************************/
 
+#include <algorithm>
 #include <unordered_set>
 
 #include <realm/table_view.hpp>
@@ -24,6 +25,7 @@
 #include <realm/impl/sequential_getter.hpp>
 #include <realm/index_string.hpp>
 #include <realm/query_conditions.hpp>
+#include <realm/query_engine.hpp>
 #include <realm/util/utf8.hpp>
 
 using namespace realm;
@@ -47,10 +49,12 @@ TableViewBase::TableViewBase(TableViewBase& src, HandoverPatch& patch, MutableSo
     }
 
     src.m_last_seen_version = util::none; // bring source out-of-sync, now that it has lost its data
+    src.discard_row_changes();             // and make it rerun its query
     m_last_seen_version = 0;
     m_start = src.m_start;
     m_end = src.m_end;
     m_limit = src.m_limit;
+    m_top_k = src.m_top_k;
 }
 
 TableViewBase::TableViewBase(const TableViewBase& src, HandoverPatch& patch, ConstSourcePayload mode)
@@ -75,6 +79,7 @@ TableViewBase::TableViewBase(const TableViewBase& src, HandoverPatch& patch, Con
     m_start = src.m_start;
     m_end = src.m_end;
     m_limit = src.m_limit;
+    m_top_k = src.m_top_k;
 }
 
 void TableViewBase::apply_patch(HandoverPatch& patch, Group& group)
@@ -575,7 +580,9 @@ uint_fast64_t TableViewBase::sync_if_needed() const
 {
     if (!is_in_sync()) {
         // FIXME: Is this a reasonable handling of constness?
-        const_cast<TableViewBase*>(this)->do_sync();
+        TableViewBase* self = const_cast<TableViewBase*>(this);
+        if (!self->do_sync_changed_rows())
+            self->do_sync();
     }
     return *m_last_seen_version;
 }
@@ -583,12 +590,23 @@ uint_fast64_t TableViewBase::sync_if_needed() const
 
 void TableViewBase::adj_row_acc_insert_rows(size_t row_ndx, size_t num_rows) noexcept
 {
+    // See Table::unshare_view_payloads()
+    REALM_ASSERT_DEBUG(!m_shared_payload);
     m_row_indexes.adjust_ge(int_fast64_t(row_ndx), num_rows);
+
+    if (m_row_changes_tracked) {
+        for (size_t& changed_row : m_changed_rows) {
+            if (changed_row >= row_ndx)
+                changed_row += num_rows;
+        }
+        adj_row_acc_set_rows(row_ndx, num_rows);
+    }
 }
 
 
 void TableViewBase::adj_row_acc_erase_row(size_t row_ndx) noexcept
 {
+    REALM_ASSERT_DEBUG(!m_shared_payload);
     size_t it = 0;
     for (;;) {
         it = m_row_indexes.find_first(row_ndx, it);
@@ -598,11 +616,34 @@ void TableViewBase::adj_row_acc_erase_row(size_t row_ndx) noexcept
         m_row_indexes.set(it, -1);
     }
     m_row_indexes.adjust_ge(int_fast64_t(row_ndx) + 1, -1);
+
+    if (m_row_changes_tracked) {
+        m_changed_rows.erase(std::remove(m_changed_rows.begin(), m_changed_rows.end(), row_ndx),
+                             m_changed_rows.end());
+        for (size_t& changed_row : m_changed_rows) {
+            if (changed_row > row_ndx)
+                --changed_row;
+        }
+    }
 }
 
 
 void TableViewBase::adj_row_acc_move_over(size_t from_row_ndx, size_t to_row_ndx) noexcept
 {
+    REALM_ASSERT_DEBUG(!m_shared_payload);
+
+    // Both rows are changed, as the row that is moved over is now somewhere
+    // else in the view, and unordered insertion leaves a new row behind. The
+    // row that is moved from may no longer exist.
+    if (m_row_changes_tracked) {
+        for (size_t& changed_row : m_changed_rows) {
+            if (changed_row == from_row_ndx)
+                changed_row = to_row_ndx;
+        }
+        adj_row_acc_set_rows(from_row_ndx, 1);
+        adj_row_acc_set_rows(to_row_ndx, 1);
+    }
+
     size_t it = 0;
     // kill any refs to the target row ndx
     for (;;) {
@@ -625,9 +666,47 @@ void TableViewBase::adj_row_acc_move_over(size_t from_row_ndx, size_t to_row_ndx
 
 void TableViewBase::adj_row_acc_clear() noexcept
 {
+    REALM_ASSERT_DEBUG(!m_shared_payload);
     m_num_detached_refs = m_row_indexes.size();
     for (size_t i = 0, num_rows = m_row_indexes.size(); i < num_rows; ++i)
         m_row_indexes.set(i, -1);
+    m_changed_rows.clear();
+}
+
+
+void TableViewBase::adj_row_acc_set_rows(size_t row_ndx, size_t num_rows) noexcept
+{
+    if (!m_row_changes_tracked)
+        return;
+
+    // Once more rows have changed than do_sync_changed_rows() would check one
+    // by one, the view will rerun its query anyway. The size of the table may
+    // not yet include the rows that are being inserted.
+    size_t max_changed_rows = std::max(m_table->size(), row_ndx + num_rows) / 4;
+    if (m_changed_rows.size() + num_rows > max_changed_rows) {
+        // Rows that are changed repeatedly are listed once. The list is left
+        // at most half full, so that it is not sorted again for every row.
+        std::sort(m_changed_rows.begin(), m_changed_rows.end());
+        m_changed_rows.erase(std::unique(m_changed_rows.begin(), m_changed_rows.end()), m_changed_rows.end());
+        if (m_changed_rows.size() + num_rows > max_changed_rows / 2) {
+            discard_row_changes();
+            return;
+        }
+    }
+    try {
+        for (size_t i = 0; i < num_rows; ++i)
+            m_changed_rows.push_back(row_ndx + i); // Throws
+    }
+    catch (...) {
+        discard_row_changes();
+    }
+}
+
+
+void TableViewBase::discard_row_changes() noexcept
+{
+    m_row_changes_tracked = false;
+    m_changed_rows.clear();
 }
 
 
@@ -643,6 +722,7 @@ void TableView::remove(size_t row_ndx, RemoveMode underlying_mode)
     size_t origin_row_ndx = size_t(m_row_indexes.get(row_ndx));
 
     // Update refs
+    unshare_payload();
     m_row_indexes.erase(row_ndx);
 
     // Delete row in origin table
@@ -675,8 +755,10 @@ void TableView::clear(RemoveMode underlying_mode)
     bool is_move_last_over = (underlying_mode == RemoveMode::unordered);
     tf::batch_erase_rows(*m_table, m_row_indexes, is_move_last_over); // Throws
 
+    unshare_payload(false);
     m_row_indexes.clear();
     m_num_detached_refs = 0;
+    discard_row_changes();
     tf::register_view(*m_table, this); // Throws
 
     // It is important to not accidentally bring us in sync, if we were
@@ -687,6 +769,7 @@ void TableView::clear(RemoveMode underlying_mode)
 
 void TableViewBase::sync_distinct_view(size_t column)
 {
+    unshare_payload(false);
     m_row_indexes.clear();
     m_num_detached_refs = 0;
     m_distinct_column_source = column;
@@ -724,7 +807,7 @@ void TableViewBase::sort(size_t column, bool ascending)
 void TableViewBase::sort(SortDescriptor order)
 {
     m_sorting_predicate = std::move(order);
-    do_sort(m_sorting_predicate, m_distinct_predicate);
+    do_sort(m_sorting_predicate, m_distinct_predicate, size_t(-1), m_query.m_thread_pool);
 }
 
 void TableViewBase::do_sync()
@@ -732,6 +815,9 @@ void TableViewBase::do_sync()
     // A TableView can be "born" from 4 different sources: LinkView, Table::get_distinct_view(),
     // Table::find_all() or Query. Here we sync with the respective source.
 
+    // All sources regenerate the payload from scratch
+    unshare_payload(false);
+
     if (m_linkview_source) {
         m_row_indexes.clear();
         for (size_t t = 0; t < m_linkview_source->size(); t++)
@@ -772,13 +858,104 @@ void TableViewBase::do_sync()
         // find_all needs to call size() on the tableview. But if we're
         // out of sync, size() will then call do_sync and we'll have an infinite regress
         // SO: fake that we're up to date BEFORE calling find_all.
-        m_query.find_all(*(const_cast<TableViewBase*>(this)), m_start, m_end, m_limit);
+        if (m_top_k != size_t(-1)) {
+            m_query.find_top_k(*this, m_sorting_predicate, m_top_k, m_start, m_end);
+        }
+        else {
+            m_query.find_all(*(const_cast<TableViewBase*>(this)), m_start, m_end, m_limit);
+        }
     }
     m_num_detached_refs = 0;
 
-    do_sort(m_sorting_predicate, m_distinct_predicate);
+    do_sort(m_sorting_predicate, m_distinct_predicate, size_t(-1), m_query.m_thread_pool);
 
     m_last_seen_version = outside_version();
+    m_changed_rows.clear();
+    m_row_changes_tracked = can_sync_changed_rows();
+}
+
+bool TableViewBase::can_sync_changed_rows() const
+{
+    if (!m_table || !m_query.m_table || m_query.m_view || m_linkview_source || m_linked_column ||
+        m_distinct_column_source != npos || m_distinct_predicate || m_start != 0 || m_end != size_t(-1) ||
+        m_limit != size_t(-1) || m_top_k != size_t(-1))
+        return false;
+
+    // Whether a row matches the query must depend on the values of the row
+    // only, so there must be no links from or to other rows, and no
+    // subtables, whose changes the view is not told about
+    const Spec& spec = _impl::TableFriend::get_spec(*m_table);
+    if (spec.get_column_count() != spec.get_public_column_count())
+        return false; // Backlinks
+    for (size_t i = 0; i < spec.get_column_count(); ++i) {
+        switch (spec.get_public_column_type(i)) {
+            case type_Table:
+            case type_Mixed:
+            case type_Link:
+            case type_LinkList:
+                return false;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+bool TableViewBase::do_sync_changed_rows(std::vector<size_t>* checked_rows)
+{
+    // The view may have had its duplicates removed since it started to track
+    // the changes
+    if (!m_row_changes_tracked || !can_sync_changed_rows())
+        return false;
+
+    std::vector<size_t>& changed_rows = m_changed_rows;
+    std::sort(changed_rows.begin(), changed_rows.end());
+    changed_rows.erase(std::unique(changed_rows.begin(), changed_rows.end()), changed_rows.end());
+
+    // Rows that were inserted and moved over, or unordered insertions that
+    // were rolled back, may no longer exist
+    size_t num_rows = m_table->size();
+    changed_rows.erase(std::lower_bound(changed_rows.begin(), changed_rows.end(), num_rows), changed_rows.end());
+
+    // Checking many rows one by one is slower than rerunning the query
+    if (changed_rows.size() > num_rows / 4)
+        return false;
+
+    // The rows of the view that are not changed, in view order
+    std::vector<size_t> rows;
+    rows.reserve(m_row_indexes.size() - m_num_detached_refs); // Throws
+    for (size_t i = 0; i < m_row_indexes.size(); ++i) {
+        int64_t row_ndx = m_row_indexes.get(i);
+        if (row_ndx != detached_ref && !std::binary_search(changed_rows.begin(), changed_rows.end(), size_t(row_ndx)))
+            rows.push_back(size_t(row_ndx));
+    }
+    size_t num_unchanged = rows.size();
+
+    // The changed rows that match, in row order
+    if (!m_query.has_conditions()) {
+        rows.insert(rows.end(), changed_rows.begin(), changed_rows.end()); // Throws
+    }
+    else if (!changed_rows.empty()) {
+        m_query.init(); // Throws
+        ParentNode* root = m_query.root_node();
+        for (size_t row_ndx : changed_rows) {
+            if (root->find_first(row_ndx, row_ndx + 1) == row_ndx)
+                rows.push_back(row_ndx); // Throws
+        }
+    }
+
+    unshare_payload(false);
+    m_row_indexes.clear();
+    for (size_t row_ndx : rows)
+        m_row_indexes.add(row_ndx);
+    do_merge_sorted(m_sorting_predicate, num_unchanged);
+
+    m_num_detached_refs = 0;
+    if (checked_rows)
+        checked_rows->swap(m_changed_rows);
+    m_changed_rows.clear();
+    m_last_seen_version = outside_version();
+    return true;
 }
 
 bool TableViewBase::is_in_table_order() const
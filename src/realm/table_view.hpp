@@ -285,6 +285,16 @@ public:
     //
     // This will make the TableView empty and in sync with the highest possible table version
     // if the TableView depends on an object (LinkView or row) that has been deleted.
+    //
+    // A view of the results of a query on a table whose rows are not linked to
+    // other tables, and which has no subtables, keeps track of the rows that
+    // are inserted or changed, by this or other transactions, between
+    // synchronizations, if the changes were made by setting values, inserting
+    // rows or removing them. It is then synchronized by checking only those
+    // rows against the query, and merging the matches into its rows, instead
+    // of rerunning the query. This requires the view to be sorted, if at all,
+    // by sort(), and to have been created without start, end, or limit, and
+    // not to be restricted by another view, or have its duplicates removed.
     uint_fast64_t sync_if_needed() const;
 
     // Set this undetached TableView to be a distinct view, and sync immediately.
@@ -305,6 +315,16 @@ public:
     void distinct(size_t column);
     void distinct(SortDescriptor columns);
 
+    // Set the thread pool of the query of this view (see
+    // Query::set_thread_pool()), which is also used to sort large views, and
+    // to remove their duplicates, in parallel. The pool must outlive every
+    // use of this view (and its copies) that syncs, sorts or removes
+    // duplicates.
+    void set_thread_pool(util::ThreadPool* pool) noexcept
+    {
+        m_query.set_thread_pool(pool);
+    }
+
     // Returns whether the rows are guaranteed to be in table order.
     // This is true only of unsorted TableViews created from either:
     // - Table::find_all()
@@ -327,6 +347,22 @@ protected:
 
     void do_sync();
 
+    // Synchronize the view by checking the rows in m_changed_rows against the
+    // query (see sync_if_needed()). Returns false, without changing the view,
+    // if the view cannot be synchronized in this way, or if it would not be
+    // faster than do_sync(). If `checked_rows` is specified, the rows that were
+    // checked are stored in it, in row order.
+    bool do_sync_changed_rows(std::vector<size_t>* checked_rows = nullptr);
+
+    // Whether do_sync_changed_rows() can be used for the next synchronization
+    // if the view is told about every change until then.
+    bool can_sync_changed_rows() const;
+
+    // Forget the rows in m_changed_rows, when the view cannot be told which
+    // rows are changed until the next synchronization, which then reruns the
+    // query.
+    void discard_row_changes() noexcept;
+
     // Null if, and only if, the view is detached.
     mutable TableRef m_table;
 
@@ -356,10 +392,20 @@ protected:
     size_t m_start;
     size_t m_end;
     size_t m_limit;
+    // If not size_t(-1), only this many rows are kept after sorting (see Query::find_top_k())
+    size_t m_top_k = size_t(-1);
 
     mutable util::Optional<uint_fast64_t> m_last_seen_version;
 
     size_t m_num_detached_refs = 0;
+
+    // If m_row_changes_tracked is true, the view has been told about every
+    // change of the rows of m_table since it was last in sync, and
+    // m_changed_rows holds the rows that have been inserted or whose values
+    // have been changed since then, possibly more than once.
+    std::vector<size_t> m_changed_rows;
+    bool m_row_changes_tracked = false;
+
     /// Construct null view (no memory allocated).
     TableViewBase();
 
@@ -419,6 +465,7 @@ private:
     friend class Table;
     friend class Query;
     friend class SharedGroup;
+    friend class MaterializedAggregate;
     template <class Tab, class View, class Impl>
     friend class BasicTableViewBase;
 
@@ -427,6 +474,7 @@ private:
     void adj_row_acc_erase_row(size_t row_ndx) noexcept;
     void adj_row_acc_move_over(size_t from_row_ndx, size_t to_row_ndx) noexcept;
     void adj_row_acc_clear() noexcept;
+    void adj_row_acc_set_rows(size_t row_ndx, size_t num_rows) noexcept;
 
     template <typename Tab>
     friend class BasicTableView;
@@ -773,8 +821,11 @@ inline TableViewBase::TableViewBase(const TableViewBase& tv)
     , m_start(tv.m_start)
     , m_end(tv.m_end)
     , m_limit(tv.m_limit)
+    , m_top_k(tv.m_top_k)
     , m_last_seen_version(tv.m_last_seen_version)
     , m_num_detached_refs(tv.m_num_detached_refs)
+    , m_changed_rows(tv.m_changed_rows)
+    , m_row_changes_tracked(tv.m_row_changes_tracked)
 {
     // FIXME: This code is unreasonably complicated because it uses `IntegerColumn` as
     // a free-standing container, and because `IntegerColumn` does not conform to the
@@ -801,12 +852,16 @@ inline TableViewBase::TableViewBase(TableViewBase&& tv) noexcept
     , m_start(tv.m_start)
     , m_end(tv.m_end)
     , m_limit(tv.m_limit)
+    , m_top_k(tv.m_top_k)
     ,
     // if we are created from a table view which is outdated, take care to use the outdated
     // version number so that we can later trigger a sync if needed.
     m_last_seen_version(tv.m_last_seen_version)
     , m_num_detached_refs(tv.m_num_detached_refs)
+    , m_changed_rows(std::move(tv.m_changed_rows))
+    , m_row_changes_tracked(tv.m_row_changes_tracked)
 {
+    m_shared_payload = std::move(tv.m_shared_payload);
     if (m_table)
         m_table->move_registered_view(&tv, this);
 }
@@ -817,7 +872,7 @@ inline TableViewBase::~TableViewBase() noexcept
         m_table->unregister_view(this);
         m_table = TableRef();
     }
-    m_row_indexes.destroy(); // Shallow
+    destroy_payload(); // Shallow
 }
 
 inline TableViewBase& TableViewBase::operator=(TableViewBase&& tv) noexcept
@@ -828,19 +883,27 @@ inline TableViewBase& TableViewBase::operator=(TableViewBase&& tv) noexcept
     if (m_table)
         m_table->move_registered_view(&tv, this);
 
+    if (m_shared_payload) {
+        m_row_indexes.detach();
+        m_shared_payload.reset();
+    }
     m_row_indexes.move_assign(tv.m_row_indexes);
+    m_shared_payload = std::move(tv.m_shared_payload);
     m_query = std::move(tv.m_query);
     m_num_detached_refs = tv.m_num_detached_refs;
     m_last_seen_version = tv.m_last_seen_version;
     m_start = tv.m_start;
     m_end = tv.m_end;
     m_limit = tv.m_limit;
+    m_top_k = tv.m_top_k;
     m_linked_column = tv.m_linked_column;
     m_linked_row = tv.m_linked_row;
     m_linkview_source = std::move(tv.m_linkview_source);
     m_distinct_predicate = std::move(tv.m_distinct_predicate);
     m_distinct_column_source = tv.m_distinct_column_source;
     m_sorting_predicate = std::move(tv.m_sorting_predicate);
+    m_changed_rows = std::move(tv.m_changed_rows);
+    m_row_changes_tracked = tv.m_row_changes_tracked;
 
     return *this;
 }
@@ -861,7 +924,7 @@ inline TableViewBase& TableViewBase::operator=(const TableViewBase& tv)
     Allocator& alloc = m_row_indexes.get_alloc();
     MemRef mem = tv.m_row_indexes.get_root_array()->clone_deep(alloc); // Throws
     _impl::DeepArrayRefDestroyGuard ref_guard(mem.get_ref(), alloc);
-    m_row_indexes.destroy();
+    destroy_payload();
     m_row_indexes.get_root_array()->init_from_mem(mem);
     ref_guard.release();
 
@@ -871,12 +934,15 @@ inline TableViewBase& TableViewBase::operator=(const TableViewBase& tv)
     m_start = tv.m_start;
     m_end = tv.m_end;
     m_limit = tv.m_limit;
+    m_top_k = tv.m_top_k;
     m_linked_column = tv.m_linked_column;
     m_linked_row = tv.m_linked_row;
     m_linkview_source = tv.m_linkview_source;
     m_distinct_predicate = tv.m_distinct_predicate;
     m_distinct_column_source = tv.m_distinct_column_source;
     m_sorting_predicate = tv.m_sorting_predicate;
+    m_changed_rows = tv.m_changed_rows;
+    m_row_changes_tracked = tv.m_row_changes_tracked;
 
     return *this;
 }
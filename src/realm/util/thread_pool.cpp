@@ -0,0 +1,216 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/util/thread_pool.hpp>
+
+using namespace realm;
+using namespace realm::util;
+
+namespace {
+
+// True while the current thread is executing a task of some pool
+REALM_THREAD_LOCAL bool t_in_task = false;
+
+} // anonymous namespace
+
+
+ThreadPool::ThreadPool(size_t num_workers)
+    : m_failed(false)
+{
+    for (size_t i = 0; i < num_workers + 1; ++i)
+        m_ranges.emplace_back(new Range); // Throws
+    try {
+        for (size_t i = 0; i < num_workers; ++i) {
+            size_t thread_ndx = i + 1;
+            m_workers.emplace_back(new Thread); // Throws
+            m_workers.back()->start([this, thread_ndx] { worker_loop(thread_ndx); }); // Throws
+        }
+    }
+    catch (...) {
+        {
+            LockGuard lock(m_mutex);
+            m_stop = true;
+        }
+        m_work_available.notify_all();
+        for (auto& worker : m_workers) {
+            if (worker->joinable())
+                worker->join();
+        }
+        throw;
+    }
+}
+
+
+ThreadPool::~ThreadPool() noexcept
+{
+    {
+        LockGuard lock(m_mutex);
+        m_stop = true;
+    }
+    m_work_available.notify_all();
+    for (auto& worker : m_workers)
+        worker->join();
+}
+
+
+void ThreadPool::run(size_t num_tasks, const Task& task)
+{
+    if (t_in_task || m_workers.empty() || num_tasks < 2) {
+        for (size_t i = 0; i < num_tasks; ++i)
+            task(i, 0); // Throws
+        return;
+    }
+
+    LockGuard run_lock(m_run_mutex);
+
+    // Hand out contiguous ranges of tasks. No worker is active at this point,
+    // so the ranges can be set without locking them.
+    size_t num_threads = m_ranges.size();
+    for (size_t i = 0; i < num_threads; ++i) {
+        m_ranges[i]->m_begin = num_tasks * i / num_threads;
+        m_ranges[i]->m_end = num_tasks * (i + 1) / num_threads;
+    }
+    m_failed = false;
+    {
+        LockGuard lock(m_mutex);
+        m_task = &task;
+        m_exception = nullptr;
+        m_num_busy_workers = m_workers.size();
+        ++m_generation;
+    }
+    m_work_available.notify_all();
+
+    participate(0, task);
+
+    std::exception_ptr exception;
+    {
+        LockGuard lock(m_mutex);
+        while (m_num_busy_workers != 0)
+            m_work_done.wait(lock);
+        m_task = nullptr;
+        exception = m_exception;
+        m_exception = nullptr;
+    }
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+
+void ThreadPool::worker_loop(size_t thread_ndx)
+{
+    uint_fast64_t generation = 0;
+    for (;;) {
+        const Task* task;
+        {
+            LockGuard lock(m_mutex);
+            while (!m_stop && m_generation == generation)
+                m_work_available.wait(lock);
+            if (m_stop)
+                return;
+            generation = m_generation;
+            task = m_task;
+        }
+
+        participate(thread_ndx, *task);
+
+        bool last;
+        {
+            LockGuard lock(m_mutex);
+            last = (--m_num_busy_workers == 0);
+        }
+        if (last)
+            m_work_done.notify_all();
+    }
+}
+
+
+void ThreadPool::participate(size_t thread_ndx, const Task& task)
+{
+    t_in_task = true;
+    size_t task_ndx;
+    while (take(thread_ndx, task_ndx) || steal(thread_ndx, task_ndx)) {
+        if (m_failed)
+            continue; // Drain the remaining tasks without executing them
+        try {
+            task(task_ndx, thread_ndx);
+        }
+        catch (...) {
+            LockGuard lock(m_mutex);
+            if (!m_exception)
+                m_exception = std::current_exception();
+            m_failed = true;
+        }
+    }
+    t_in_task = false;
+}
+
+
+bool ThreadPool::take(size_t thread_ndx, size_t& task_ndx)
+{
+    Range& range = *m_ranges[thread_ndx];
+    LockGuard lock(range.m_mutex);
+    if (range.m_begin == range.m_end)
+        return false;
+    task_ndx = range.m_begin++;
+    return true;
+}
+
+
+bool ThreadPool::steal(size_t thread_ndx, size_t& task_ndx)
+{
+    for (;;) {
+        // Pick the victim with the most remaining work. The victim may make
+        // progress before we get to lock its range again, so the choice is
+        // only a hint, and is verified below.
+        size_t victim = thread_ndx;
+        size_t max_remaining = 0;
+        for (size_t i = 0; i < m_ranges.size(); ++i) {
+            if (i == thread_ndx)
+                continue;
+            Range& range = *m_ranges[i];
+            LockGuard lock(range.m_mutex);
+            size_t remaining = range.m_end - range.m_begin;
+            if (remaining > max_remaining) {
+                max_remaining = remaining;
+                victim = i;
+            }
+        }
+        if (victim == thread_ndx)
+            return false;
+
+        size_t begin, end;
+        {
+            Range& range = *m_ranges[victim];
+            LockGuard lock(range.m_mutex);
+            size_t remaining = range.m_end - range.m_begin;
+            if (remaining == 0)
+                continue; // The victim finished its work meanwhile
+            end = range.m_end;
+            begin = end - (remaining + 1) / 2;
+            range.m_end = begin;
+        }
+
+        // Our own range is empty, so nobody will try to steal from it
+        Range& range = *m_ranges[thread_ndx];
+        LockGuard lock(range.m_mutex);
+        range.m_begin = begin + 1;
+        range.m_end = end;
+        task_ndx = begin;
+        return true;
+    }
+}
@@ -0,0 +1,117 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_UTIL_THREAD_POOL_HPP
+#define REALM_UTIL_THREAD_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <realm/util/thread.hpp>
+
+namespace realm {
+namespace util {
+
+
+/// A fixed set of worker threads that cooperate on loops of independent tasks.
+///
+/// Each participating thread is initially given a contiguous range of task
+/// indexes, and executes tasks from the front of that range. When a thread has
+/// exhausted its own range, it steals the back half of the largest remaining
+/// range of another thread. Tasks that are adjacent in index order (such as
+/// neighbouring leaves of a B+-tree) therefore tend to be executed by the same
+/// thread, while load is still balanced when tasks differ in cost.
+///
+/// The thread calling run() participates in the execution, so a pool with N
+/// worker threads executes tasks on N + 1 threads.
+class ThreadPool {
+public:
+    /// The function executed for each task. The first argument is the index
+    /// of the task. The second is the index of the executing thread, which is
+    /// less than get_num_threads(), and which is zero for the thread that
+    /// called run(). No two tasks are executed concurrently with the same
+    /// thread index, so it can be used to select per-thread state.
+    using Task = std::function<void(size_t task_ndx, size_t thread_ndx)>;
+
+    explicit ThreadPool(size_t num_workers);
+    ~ThreadPool() noexcept;
+
+    /// Returns the number of threads participating in run(), including the
+    /// calling thread.
+    size_t get_num_threads() const noexcept;
+
+    /// Execute the specified task for every task index in `[0, num_tasks)`,
+    /// and return when all of them have completed.
+    ///
+    /// Calls to run() from different threads are serialized. A call to run()
+    /// from within a task executes all the tasks of the nested loop on the
+    /// calling thread.
+    ///
+    /// If a task throws, tasks that have not yet been started are skipped, and
+    /// the first exception is rethrown from run() once all executing tasks have
+    /// completed.
+    void run(size_t num_tasks, const Task&);
+
+private:
+    struct Range {
+        Mutex m_mutex;
+        size_t m_begin = 0;
+        size_t m_end = 0;
+    };
+
+    std::vector<std::unique_ptr<Thread>> m_workers;
+    std::vector<std::unique_ptr<Range>> m_ranges; // One per participating thread
+
+    Mutex m_run_mutex; // Serializes calls to run()
+
+    // Protects the following members
+    Mutex m_mutex;
+    CondVar m_work_available;
+    CondVar m_work_done;
+    const Task* m_task = nullptr;
+    uint_fast64_t m_generation = 0;
+    size_t m_num_busy_workers = 0;
+    std::exception_ptr m_exception;
+    bool m_stop = false;
+
+    std::atomic<bool> m_failed;
+
+    void worker_loop(size_t thread_ndx);
+    void participate(size_t thread_ndx, const Task&);
+    bool take(size_t thread_ndx, size_t& task_ndx);
+    bool steal(size_t thread_ndx, size_t& task_ndx);
+};
+
+
+// Implementation:
+
+inline size_t ThreadPool::get_num_threads() const noexcept
+{
+    return m_ranges.size();
+}
+
+
+} // namespace util
+} // namespace realm
+
+#endif // REALM_UTIL_THREAD_POOL_HPP
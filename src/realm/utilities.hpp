@@ -151,6 +151,26 @@ inline int log2(size_t x)
 #endif
 }
 
+// Index of the lowest set bit. x must not be zero.
+inline size_t lowest_bit64(uint64_t x) noexcept
+{
+    REALM_ASSERT_DEBUG(x != 0);
+#if defined(__GNUC__)
+    return size_t(__builtin_ctzll(x));
+#elif defined(_WIN32) && defined(REALM_PTR_64)
+    unsigned long index = 0;
+    _BitScanForward64(&index, x);
+    return size_t(index);
+#else
+    size_t r = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        r++;
+    }
+    return r;
+#endif
+}
+
 // Implementation:
 
 // Safe cast from 64 to 32 bits on 32 bit architecture. Differs from to_ref() by not testing alignment and
@@ -16,10 +16,20 @@
  *
  **************************************************************************/
 
+#include <atomic>
+#include <cstring>
+#include <unordered_set>
+
 #include <realm/views.hpp>
 
+#include <realm/column_backlink.hpp>
 #include <realm/column_link.hpp>
+#include <realm/column_string.hpp>
+#include <realm/column_string_enum.hpp>
+#include <realm/column_timestamp.hpp>
 #include <realm/table.hpp>
+#include <realm/unicode.hpp>
+#include <realm/util/thread_pool.hpp>
 
 using namespace realm;
 
@@ -111,14 +121,52 @@ public:
                            [=](auto&& col) { return col.is_null[i.index_in_view]; });
     }
 
+    // Whether the values of all the columns were read ahead of the sort, so
+    // that comparing and hashing rows does not access the columns, which can
+    // then be done concurrently
+    bool has_keys() const
+    {
+        return std::all_of(m_columns.begin(), m_columns.end(),
+                           [](auto&& col) { return col.key_type != KeyType::other; });
+    }
+
+    // A hash of the values of the row, which is the same for rows that
+    // compare equal. Requires has_keys().
+    uint64_t hash(IndexPair i) const noexcept;
+
+    // Sort `v` in the same order as std::sort() with this sorter would, by
+    // radix sort. Returns false, leaving `v` unchanged, if the sort is not by
+    // a single integer column of the table itself, or if `v` is too small to
+    // gain from it.
+    bool radix_sort(std::vector<IndexPair>& v) const;
+
 private:
+    // The values of the sort columns, read once for every row of the view
+    // instead of being looked up in the column for every comparison. Values
+    // of columns of other types are compared in the column.
+    enum class KeyType { other, integer, floating, timestamp, string };
+
     struct SortColumn {
         std::vector<bool> is_null;
         std::vector<size_t> translated_row;
         const ColumnBase* column;
         bool ascending;
+
+        // Indexed by position in the view, like is_null and translated_row
+        KeyType key_type;
+        std::vector<bool> key_is_null;
+        std::vector<int64_t> int_keys;
+        std::vector<double> double_keys;
+        std::vector<Timestamp> timestamp_keys;
+        std::vector<StringData> string_keys;
+
+        // Same result as `column->compare_values()` on the rows at the
+        // specified positions in the view
+        int compare_keys(size_t i, size_t j) const noexcept;
     };
     std::vector<SortColumn> m_columns;
+
+    static void extract_keys(SortColumn&, IntegerColumn const& row_indexes);
 };
 
 SortDescriptor::Sorter::Sorter(std::vector<std::vector<const ColumnBase*>> const& columns,
@@ -129,33 +177,178 @@ SortDescriptor::Sorter::Sorter(std::vector<std::vector<const ColumnBase*>> const
 
     m_columns.reserve(columns.size());
     for (size_t i = 0; i < columns.size(); ++i) {
-        m_columns.push_back({{}, {}, columns[i].back(), ascending[i]});
+        m_columns.push_back({{}, {}, columns[i].back(), ascending[i], KeyType::other, {}, {}, {}, {}, {}});
         REALM_ASSERT_EX(!columns[i].empty(), i);
-        if (columns[i].size() == 1) { // no link chain
-            continue;
+        if (columns[i].size() > 1) {
+            auto& translated_rows = m_columns.back().translated_row;
+            auto& is_null = m_columns.back().is_null;
+            translated_rows.resize(num_rows);
+            is_null.resize(num_rows);
+
+            for (size_t row_ndx = 0; row_ndx < num_rows; row_ndx++) {
+                size_t translated_index = to_size_t(row_indexes.get(row_ndx));
+                for (size_t j = 0; j + 1 < columns[i].size(); ++j) {
+                    // type was checked when creating the SortDescriptor
+                    auto link_col = static_cast<const LinkColumn*>(columns[i][j]);
+                    if (link_col->is_null(translated_index)) {
+                        is_null[row_ndx] = true;
+                        break;
+                    }
+                    translated_index = link_col->get_link(translated_index);
+                }
+                translated_rows[row_ndx] = translated_index;
+            }
         }
+        extract_keys(m_columns.back(), row_indexes);
+    }
+}
 
-        auto& translated_rows = m_columns.back().translated_row;
-        auto& is_null = m_columns.back().is_null;
-        translated_rows.resize(num_rows);
-        is_null.resize(num_rows);
-
-        for (size_t row_ndx = 0; row_ndx < num_rows; row_ndx++) {
-            size_t translated_index = to_size_t(row_indexes.get(row_ndx));
-            for (size_t j = 0; j + 1 < columns[i].size(); ++j) {
-                // type was checked when creating the SortDescriptor
-                auto link_col = static_cast<const LinkColumn*>(columns[i][j]);
-                if (link_col->is_null(translated_index)) {
-                    is_null[row_ndx] = true;
-                    break;
-                }
-                translated_index = link_col->get_link(translated_index);
+void SortDescriptor::Sorter::extract_keys(SortColumn& col, IntegerColumn const& row_indexes)
+{
+    size_t num_rows = row_indexes.size();
+    auto for_each_row = [&](auto&& read) {
+        col.key_is_null.resize(num_rows);
+        for (size_t row_ndx = 0; row_ndx < num_rows; ++row_ndx) {
+            size_t row;
+            if (!col.translated_row.empty()) {
+                if (col.is_null[row_ndx])
+                    continue;
+                row = col.translated_row[row_ndx];
+            }
+            else {
+                int64_t ndx = row_indexes.get(row_ndx);
+                if (ndx == detached_ref)
+                    continue;
+                row = to_size_t(ndx);
             }
-            translated_rows[row_ndx] = translated_index;
+            if (col.column->is_null(row))
+                col.key_is_null[row_ndx] = true;
+            else
+                read(row_ndx, row);
         }
+    };
+
+    // The values are read like the compare_values() of the column reads them.
+    // String enum and backlink columns are integer columns that compare
+    // differently.
+    if (auto enum_col = dynamic_cast<const StringEnumColumn*>(col.column)) {
+        col.key_type = KeyType::string;
+        col.string_keys.resize(num_rows);
+        for_each_row([&](size_t row_ndx, size_t row) { col.string_keys[row_ndx] = enum_col->get(row); });
+    }
+    else if (dynamic_cast<const BacklinkColumn*>(col.column)) {
+        return;
+    }
+    else if (auto int_col = dynamic_cast<const IntegerColumn*>(col.column)) {
+        col.key_type = KeyType::integer;
+        col.int_keys.resize(num_rows);
+        for_each_row([&](size_t row_ndx, size_t row) { col.int_keys[row_ndx] = int_col->get(row); });
+    }
+    else if (auto int_null_col = dynamic_cast<const IntNullColumn*>(col.column)) {
+        col.key_type = KeyType::integer;
+        col.int_keys.resize(num_rows);
+        for_each_row([&](size_t row_ndx, size_t row) { col.int_keys[row_ndx] = *int_null_col->get(row); });
+    }
+    else if (auto float_col = dynamic_cast<const FloatColumn*>(col.column)) {
+        col.key_type = KeyType::floating;
+        col.double_keys.resize(num_rows);
+        for_each_row([&](size_t row_ndx, size_t row) { col.double_keys[row_ndx] = float_col->get(row); });
+    }
+    else if (auto double_col = dynamic_cast<const DoubleColumn*>(col.column)) {
+        col.key_type = KeyType::floating;
+        col.double_keys.resize(num_rows);
+        for_each_row([&](size_t row_ndx, size_t row) { col.double_keys[row_ndx] = double_col->get(row); });
+    }
+    else if (auto timestamp_col = dynamic_cast<const TimestampColumn*>(col.column)) {
+        col.key_type = KeyType::timestamp;
+        col.timestamp_keys.resize(num_rows);
+        for_each_row([&](size_t row_ndx, size_t row) { col.timestamp_keys[row_ndx] = timestamp_col->get(row); });
+    }
+    else if (auto string_col = dynamic_cast<const StringColumn*>(col.column)) {
+        col.key_type = KeyType::string;
+        col.string_keys.resize(num_rows);
+        for_each_row([&](size_t row_ndx, size_t row) { col.string_keys[row_ndx] = string_col->get(row); });
     }
 }
 
+int SortDescriptor::Sorter::SortColumn::compare_keys(size_t i, size_t j) const noexcept
+{
+    bool v1 = !key_is_null[i];
+    bool v2 = !key_is_null[j];
+    if (!v1 || !v2)
+        return v1 == v2 ? 0 : v1 < v2 ? 1 : -1;
+
+    switch (key_type) {
+        case KeyType::integer: {
+            int64_t a = int_keys[i], b = int_keys[j];
+            return a == b ? 0 : a < b ? 1 : -1;
+        }
+        case KeyType::floating: {
+            double a = double_keys[i], b = double_keys[j];
+            return a == b ? 0 : a < b ? 1 : -1;
+        }
+        case KeyType::timestamp: {
+            const Timestamp& a = timestamp_keys[i];
+            const Timestamp& b = timestamp_keys[j];
+            return a == b ? 0 : a < b ? 1 : -1;
+        }
+        case KeyType::string: {
+            StringData a = string_keys[i], b = string_keys[j];
+            return a == b ? 0 : utf8_compare(a, b) ? 1 : -1;
+        }
+        case KeyType::other:
+            break;
+    }
+    REALM_UNREACHABLE();
+}
+
+uint64_t SortDescriptor::Sorter::hash(IndexPair i) const noexcept
+{
+    size_t ndx = i.index_in_view;
+    uint64_t h = 14695981039346656037ULL;
+    auto combine = [&](uint64_t v) {
+        h ^= v;
+        h *= 1099511628211ULL;
+    };
+    for (auto& col : m_columns) {
+        if (!col.translated_row.empty() && col.is_null[ndx]) {
+            combine(1);
+            continue;
+        }
+        if (col.key_is_null[ndx]) {
+            combine(2);
+            continue;
+        }
+        switch (col.key_type) {
+            case KeyType::integer:
+                combine(uint64_t(col.int_keys[ndx]));
+                break;
+            case KeyType::floating: {
+                // Zero and negative zero are equal
+                double d = col.double_keys[ndx] == 0 ? 0 : col.double_keys[ndx];
+                uint64_t bits;
+                std::memcpy(&bits, &d, sizeof bits);
+                combine(bits);
+                break;
+            }
+            case KeyType::timestamp:
+                combine(uint64_t(col.timestamp_keys[ndx].get_seconds()));
+                combine(uint64_t(col.timestamp_keys[ndx].get_nanoseconds()));
+                break;
+            case KeyType::string: {
+                StringData str = col.string_keys[ndx];
+                for (size_t j = 0; j < str.size(); ++j)
+                    combine(static_cast<unsigned char>(str[j]));
+                combine(str.size());
+                break;
+            }
+            case KeyType::other:
+                REALM_UNREACHABLE();
+        }
+    }
+    return h;
+}
+
 SortDescriptor::Sorter SortDescriptor::sorter(IntegerColumn const& row_indexes) const
 {
     return Sorter(m_columns, m_ascending, row_indexes);
@@ -183,15 +376,143 @@ bool SortDescriptor::Sorter::operator()(IndexPair i, IndexPair j, bool total_ord
             index_j = m_columns[t].translated_row[j.index_in_view];
         }
 
-        if (int c = m_columns[t].column->compare_values(index_i, index_j))
+        int c;
+        if (m_columns[t].key_type != KeyType::other)
+            c = m_columns[t].compare_keys(i.index_in_view, j.index_in_view);
+        else
+            c = m_columns[t].column->compare_values(index_i, index_j);
+        if (c)
             return m_columns[t].ascending ? c > 0 : c < 0;
     }
     // make sort stable by using original index as final comparison
     return total_ordering ? i.index_in_view < j.index_in_view : 0;
 }
 
-void RowIndexes::do_sort(const SortDescriptor& order, const SortDescriptor& distinct)
+bool SortDescriptor::Sorter::radix_sort(std::vector<IndexPair>& v) const
+{
+    // Below this size, std::sort() is faster
+    const size_t min_size = 1024;
+    if (m_columns.size() != 1 || m_columns[0].key_type != KeyType::integer ||
+        !m_columns[0].translated_row.empty() || v.size() < min_size)
+        return false;
+    const SortColumn& col = m_columns[0];
+
+    // Rows that compare equal stay in view order
+    auto by_view = [](IndexPair a, IndexPair b) { return a.index_in_view < b.index_in_view; };
+    if (!std::is_sorted(v.begin(), v.end(), by_view))
+        std::sort(v.begin(), v.end(), by_view);
+
+    // Nulls are first when ascending, and last when descending
+    auto nulls_end = std::stable_partition(v.begin(), v.end(), [&](IndexPair p) {
+        return col.key_is_null[p.index_in_view] == col.ascending;
+    });
+    auto begin = col.ascending ? nulls_end : v.begin();
+    auto end = col.ascending ? v.end() : nulls_end;
+    size_t n = size_t(end - begin);
+
+    // Map the values to unsigned keys in the order of the sort
+    std::vector<std::pair<uint64_t, IndexPair>> keys(n), buffer(n);
+    for (size_t i = 0; i < n; ++i) {
+        IndexPair p = begin[i];
+        uint64_t key = uint64_t(col.int_keys[p.index_in_view]) ^ (uint64_t(1) << 63);
+        keys[i] = {col.ascending ? key : ~key, p};
+    }
+
+    // Least significant byte first, skipping bytes that are the same in all
+    // keys
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t counts[256] = {};
+        for (auto& key : keys)
+            ++counts[(key.first >> shift) & 0xFF];
+        if (counts[(keys[0].first >> shift) & 0xFF] == n)
+            continue;
+        size_t offset = 0;
+        for (size_t& count : counts) {
+            size_t c = count;
+            count = offset;
+            offset += c;
+        }
+        for (auto& key : keys)
+            buffer[counts[(key.first >> shift) & 0xFF]++] = key;
+        keys.swap(buffer);
+    }
+
+    for (size_t i = 0; i < n; ++i)
+        begin[i] = keys[i].second;
+    return true;
+}
+
+namespace {
+
+// Sort `v` like std::sort() with `less` would, by sorting a part of it on
+// each thread of `pool`, and merging the sorted parts pairwise
+template <class Less>
+void parallel_sort(util::ThreadPool& pool, std::vector<IndexPair>& v, const Less& less)
+{
+    size_t num_parts = pool.get_num_threads();
+    size_t part_size = (v.size() + num_parts - 1) / num_parts;
+    pool.run(num_parts, [&](size_t part, size_t) {
+        size_t begin = std::min(part * part_size, v.size());
+        size_t end = std::min(begin + part_size, v.size());
+        std::sort(v.begin() + begin, v.begin() + end, std::ref(less));
+    });
+
+    std::vector<IndexPair> buffer(v.size());
+    for (size_t width = part_size; width < v.size(); width *= 2) {
+        size_t num_merges = (v.size() + 2 * width - 1) / (2 * width);
+        pool.run(num_merges, [&](size_t merge, size_t) {
+            size_t begin = merge * 2 * width;
+            size_t middle = std::min(begin + width, v.size());
+            size_t end = std::min(begin + 2 * width, v.size());
+            std::merge(v.begin() + begin, v.begin() + middle, v.begin() + middle, v.begin() + end,
+                       buffer.begin() + begin, std::ref(less));
+        });
+        v.swap(buffer);
+    }
+}
+
+// Remove the rows of `v`, which is in view order, that compare equal to an
+// earlier row, by hashing the rows into a partition per thread of `pool`,
+// and removing the duplicates of each partition on its own thread
+void parallel_distinct(util::ThreadPool& pool, std::vector<IndexPair>& v, const SortDescriptor::Sorter& sorter)
+{
+    size_t num_threads = pool.get_num_threads();
+    size_t part_size = (v.size() + num_threads - 1) / num_threads;
+    std::vector<uint64_t> hashes(v.size());
+    pool.run(num_threads, [&](size_t part, size_t) {
+        size_t end = std::min((part + 1) * part_size, v.size());
+        for (size_t i = part * part_size; i < end; ++i)
+            hashes[i] = sorter.hash(v[i]);
+    });
+
+    // Positions in `v` of the rows of each partition, in view order
+    std::vector<std::vector<size_t>> partitions(num_threads);
+    for (size_t i = 0; i < v.size(); ++i)
+        partitions[hashes[i] % num_threads].push_back(i);
+
+    std::vector<char> keep(v.size());
+    pool.run(num_threads, [&](size_t part, size_t) {
+        auto hash = [&](size_t i) { return size_t(hashes[i]); };
+        auto equal = [&](size_t i, size_t j) { return !sorter(v[i], v[j], false) && !sorter(v[j], v[i], false); };
+        std::unordered_set<size_t, decltype(hash), decltype(equal)> seen(partitions[part].size(), hash, equal);
+        for (size_t i : partitions[part])
+            keep[i] = seen.insert(i).second;
+    });
+
+    size_t n = 0;
+    for (size_t i = 0; i < v.size(); ++i) {
+        if (keep[i])
+            v[n++] = v[i];
+    }
+    v.resize(n);
+}
+
+} // anonymous namespace
+
+void RowIndexes::do_sort(const SortDescriptor& order, const SortDescriptor& distinct, size_t limit,
+                         util::ThreadPool* pool)
 {
+    REALM_ASSERT_DEBUG(order || limit == size_t(-1));
     if (!order && !distinct)
         return;
     size_t sz = size();
@@ -215,6 +536,10 @@ void RowIndexes::do_sort(const SortDescriptor& order, const SortDescriptor& dist
             ++detached_ref_count;
     }
 
+    // Sorts and distincts of large views with no limit are done in parallel
+    bool parallel = pool && pool->get_num_threads() > 1 && v.size() >= parallel_sort_threshold &&
+                    limit == size_t(-1);
+
     if (distinct) {
         auto sorting_predicate = distinct.sorter(m_row_indexes);
 
@@ -225,36 +550,95 @@ void RowIndexes::do_sort(const SortDescriptor& order, const SortDescriptor& dist
                     v.end());
         }
 
-        // Sort by the columns to distinct on
-        std::sort(v.begin(), v.end(), std::ref(sorting_predicate));
-
-        // Remove all duplicates
-        v.erase(std::unique(v.begin(), v.end(),
-                            [&](auto&& a, auto&& b) {
-                                // "not less than" is "equal" since they're sorted
-                                return !sorting_predicate(a, b, false);
-                            }),
-                v.end());
+        if (parallel && sorting_predicate.has_keys()) {
+            // The rows are still in view order, and like below, the first of
+            // the rows that compare equal is kept
+            parallel_distinct(*pool, v, sorting_predicate);
+        }
+        else {
+            // Sort by the columns to distinct on
+            std::sort(v.begin(), v.end(), std::ref(sorting_predicate));
+
+            // Remove all duplicates
+            v.erase(std::unique(v.begin(), v.end(),
+                                [&](auto&& a, auto&& b) {
+                                    // "not less than" is "equal" since they're sorted
+                                    return !sorting_predicate(a, b, false);
+                                }),
+                    v.end());
 
-        // Restore the original order unless we're just going to sort it again anyway
-        if (!order) {
-            std::sort(v.begin(), v.end(), [](auto a, auto b) { return a.index_in_view < b.index_in_view; });
+            // Restore the original order unless we're just going to sort it again anyway
+            if (!order) {
+                std::sort(v.begin(), v.end(), [](auto a, auto b) { return a.index_in_view < b.index_in_view; });
+            }
         }
     }
 
     if (order) {
         auto sorting_predicate = order.sorter(m_row_indexes);
-        std::sort(v.begin(), v.end(), std::ref(sorting_predicate));
+        if (limit < v.size()) {
+            std::partial_sort(v.begin(), v.begin() + limit, v.end(), std::ref(sorting_predicate));
+            v.resize(limit);
+        }
+        else if (!sorting_predicate.radix_sort(v)) {
+            if (parallel && sorting_predicate.has_keys())
+                parallel_sort(*pool, v, sorting_predicate);
+            else
+                std::sort(v.begin(), v.end(), std::ref(sorting_predicate));
+        }
     }
 
     // Apply the results
+    unshare_payload(false);
     m_row_indexes.clear();
     for (auto& pair : v)
         m_row_indexes.add(pair.index_in_column);
+    // Detached refs are last, so they are the first to go if there is a limit
+    detached_ref_count = std::min(detached_ref_count, limit - v.size());
     for (size_t t = 0; t < detached_ref_count; ++t)
         m_row_indexes.add(-1);
 }
 
+void RowIndexes::do_merge_sorted(const SortDescriptor& order, size_t num_sorted)
+{
+    size_t sz = size();
+    std::vector<IndexPair> v;
+    v.reserve(sz);
+    for (size_t t = 0; t < sz; t++) {
+        int64_t ndx = m_row_indexes.get(t);
+        REALM_ASSERT_DEBUG(ndx != detached_ref);
+        v.push_back(IndexPair{static_cast<size_t>(ndx), t});
+    }
+
+    auto merge = [&](auto less) {
+        auto mid = v.begin() + num_sorted;
+        std::sort(mid, v.end(), less);
+        // The rows may have been sorted by other columns before, so that
+        // rows that compare equal are not in row order
+        if (!std::is_sorted(v.begin(), mid, less))
+            std::sort(v.begin(), mid, less);
+        std::inplace_merge(v.begin(), mid, v.end(), less);
+    };
+    if (order) {
+        auto sorting_predicate = order.sorter(m_row_indexes);
+        merge([&](IndexPair a, IndexPair b) {
+            if (sorting_predicate(a, b, false))
+                return true;
+            if (sorting_predicate(b, a, false))
+                return false;
+            return a.index_in_column < b.index_in_column;
+        });
+    }
+    else {
+        merge([](IndexPair a, IndexPair b) { return a.index_in_column < b.index_in_column; });
+    }
+
+    unshare_payload(false);
+    m_row_indexes.clear();
+    for (auto& pair : v)
+        m_row_indexes.add(pair.index_in_column);
+}
+
 RowIndexes::RowIndexes(IntegerColumn::unattached_root_tag urt, realm::Allocator& alloc)
     : m_row_indexes(urt, alloc)
 #ifdef REALM_COOKIE_CHECK
@@ -285,6 +669,14 @@ RowIndexes::RowIndexes(const RowIndexes& source, ConstSourcePayload mode)
         MemRef mem = source.m_row_indexes.clone_deep(Allocator::get_default());
         m_row_indexes.init_from_mem(Allocator::get_default(), mem);
     }
+    else if (mode == ConstSourcePayload::Share && source.m_row_indexes.is_attached()) {
+        // Both accessors refer to the same memory from now on. Ownership of it
+        // is transferred from the source column to the shared payload.
+        if (!source.m_shared_payload)
+            source.m_shared_payload = std::make_shared<SharedPayload>(source.m_row_indexes.get_ref()); // Throws
+        m_shared_payload = source.m_shared_payload;
+        m_row_indexes.init_from_mem(Allocator::get_default(), source.m_row_indexes.get_mem());
+    }
 }
 
 RowIndexes::RowIndexes(RowIndexes& source, MutableSourcePayload)
@@ -301,6 +693,62 @@ RowIndexes::RowIndexes(RowIndexes& source, MutableSourcePayload)
     if (source.m_row_indexes.is_attached()) {
         m_row_indexes.detach();
         m_row_indexes.init_from_mem(Allocator::get_default(), source.m_row_indexes.get_mem());
+        m_shared_payload = std::move(source.m_shared_payload);
         source.m_row_indexes.init_from_ref(Allocator::get_default(), IntegerColumn::create(Allocator::get_default()));
     }
 }
+
+struct RowIndexes::SharedPayload {
+    SharedPayload(ref_type ref) noexcept
+        : m_ref(ref)
+    {
+    }
+
+    ~SharedPayload() noexcept
+    {
+        if (m_ref)
+            Array::destroy_deep(m_ref, Allocator::get_default());
+    }
+
+    ref_type m_ref;
+};
+
+void RowIndexes::unshare_payload(bool keep_contents)
+{
+    if (!m_shared_payload)
+        return;
+
+    Allocator& alloc = Allocator::get_default();
+    if (m_shared_payload.use_count() == 1) {
+        // No other accessor refers to the payload anymore, so it can be taken
+        // back instead of being copied. use_count() is a relaxed load, so an
+        // acquire fence is needed to order our subsequent writes to the
+        // memory after the reads that other threads did through their
+        // accessors before they released their references (the release is
+        // an acq_rel decrement).
+        std::atomic_thread_fence(std::memory_order_acquire);
+        m_shared_payload->m_ref = 0;
+    }
+    else if (keep_contents) {
+        MemRef mem = m_row_indexes.clone_deep(alloc); // Throws
+        m_row_indexes.detach();
+        m_row_indexes.init_from_mem(alloc, mem);
+    }
+    else {
+        ref_type ref = IntegerColumn::create(alloc); // Throws
+        m_row_indexes.detach();
+        m_row_indexes.init_from_ref(alloc, ref);
+    }
+    m_shared_payload.reset();
+}
+
+void RowIndexes::destroy_payload() noexcept
+{
+    if (m_shared_payload) {
+        m_row_indexes.detach();
+        m_shared_payload.reset();
+    }
+    else {
+        m_row_indexes.destroy();
+    }
+}
@@ -19,11 +19,17 @@
 #ifndef REALM_VIEWS_HPP
 #define REALM_VIEWS_HPP
 
+#include <memory>
+
 #include <realm/column.hpp>
 #include <realm/handover_defs.hpp>
 
 namespace realm {
 
+namespace util {
+class ThreadPool;
+}
+
 const int64_t detached_ref = -1;
 
 class RowIndexes;
@@ -63,6 +69,17 @@ public:
     class Sorter;
     Sorter sorter(IntegerColumn const& row_indexes) const;
 
+    // If this descriptor sorts by a single column of the table itself, that
+    // is, not through links, returns that column, and sets `ascending`.
+    // Otherwise returns null.
+    const ColumnBase* get_single_column(bool& ascending) const noexcept
+    {
+        if (m_columns.size() != 1 || m_columns[0].size() != 1)
+            return nullptr;
+        ascending = m_ascending[0];
+        return m_columns[0][0];
+    }
+
 private:
     std::vector<std::vector<const ColumnBase*>> m_columns;
     std::vector<bool> m_ascending;
@@ -106,8 +123,39 @@ public:
 
     IntegerColumn m_row_indexes;
 
+    // The number of rows from which views are sorted in parallel, if they
+    // have a thread pool
+    static const size_t parallel_sort_threshold = 65536;
+
 protected:
-    void do_sort(const SortDescriptor& sorting_predicate, const SortDescriptor& distinct_columns);
+    // If `limit` is less than the number of rows, only the first `limit` rows
+    // according to `sorting_predicate` are kept. This requires a sorting
+    // predicate.
+    //
+    // If `pool` is not null, and there are at least `parallel_sort_threshold`
+    // rows, the rows are sorted and their duplicates removed on the threads
+    // of the pool, unless a limit is specified, or a column is of a type
+    // whose values are not read ahead of the sort (binary and mixed). The
+    // result is the same as that of a serial sort.
+    void do_sort(const SortDescriptor& sorting_predicate, const SortDescriptor& distinct_columns,
+                 size_t limit = size_t(-1), util::ThreadPool* pool = nullptr);
+
+    // Merge the rows from position `num_sorted` on into the rows before them,
+    // which are sorted according to `sorting_predicate`, or are in row order
+    // if it is empty, so that the result is the same as that of do_sort() of
+    // the rows in row order. There must be no detached refs.
+    void do_merge_sorted(const SortDescriptor& sorting_predicate, size_t num_sorted);
+
+    // After handover with ConstSourcePayload::Share, the memory of m_row_indexes
+    // is shared with other RowIndexes instances, and is owned by m_shared_payload
+    // rather than by m_row_indexes. unshare_payload() must be called before
+    // m_row_indexes is modified. If `keep_contents` is false, the caller is
+    // about to clear m_row_indexes, so the contents need not be copied.
+    struct SharedPayload;
+    void unshare_payload(bool keep_contents = true);
+    void destroy_payload() noexcept;
+
+    mutable std::shared_ptr<SharedPayload> m_shared_payload;
 
     static const uint64_t cookie_expected = 0x7765697677777777ull; // 0x77656976 = 'view'; 0x77777777 = '7777' = alive
     uint64_t m_debug_cookie;
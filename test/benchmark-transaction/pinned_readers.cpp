@@ -0,0 +1,165 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+// Stress test of read lock acquisition under bursty load. A writer commits
+// continuously while a number of reader threads start read transactions and
+// pin versions, each keeping a bounded window of pinned versions alive. This
+// keeps many ringbuffer entries occupied, forcing the ringbuffer to grow, and
+// reports the average and worst case latency of begin_read().
+
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <realm/util/file.hpp>
+#include <realm/group_shared.hpp>
+
+#include "../util/timer.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+
+
+namespace {
+
+std::atomic<bool> runnable(true);
+
+std::mutex stats_mutex;
+long total_reads = 0;
+double total_read_time = 0;
+double max_read_time = 0;
+
+void usage()
+{
+    std::cout << "Usage:" << std::endl;
+    std::cout << " -h   : this text" << std::endl;
+    std::cout << " -r   : number of readers (default 8)" << std::endl;
+    std::cout << " -p   : number of versions pinned per reader (default 64)" << std::endl;
+    std::cout << " -t   : duration in seconds (default 10)" << std::endl;
+    std::cout << " -f   : database file (default pinned_readers.realm)" << std::endl;
+    exit(-1);
+}
+
+void writer(std::string path)
+{
+    SharedGroup sg(path);
+    while (runnable) {
+        WriteTransaction wt(sg);
+        TableRef table = wt.get_table("test");
+        table->set_int(0, size_t(random()) % table->size(), random());
+        wt.commit();
+    }
+}
+
+void reader(std::string path, size_t max_pinned)
+{
+    SharedGroup sg(path);
+    std::deque<SharedGroup::VersionID> pinned;
+    long reads = 0;
+    double read_time = 0, max_time = 0;
+    while (runnable) {
+        Timer timer;
+        sg.begin_read();
+        double t = timer.get_elapsed_time();
+        read_time += t;
+        max_time = std::max(max_time, t);
+        ++reads;
+
+        pinned.push_back(sg.pin_version());
+        sg.end_read();
+        if (pinned.size() > max_pinned) {
+            sg.unpin_version(pinned.front());
+            pinned.pop_front();
+        }
+    }
+    for (auto version : pinned)
+        sg.unpin_version(version);
+
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    total_reads += reads;
+    total_read_time += read_time;
+    max_read_time = std::max(max_read_time, max_time);
+}
+
+} // anonymous namespace
+
+
+int main(int argc, char* argv[])
+{
+    int n_readers = 8;
+    size_t n_pinned = 64;
+    unsigned int duration = 10;
+    std::string path = "pinned_readers.realm";
+
+    int c;
+    while ((c = getopt(argc, argv, "hr:p:t:f:")) != EOF) {
+        switch (c) {
+            case 'r':
+                n_readers = atoi(optarg);
+                break;
+            case 'p':
+                n_pinned = size_t(atoi(optarg));
+                break;
+            case 't':
+                duration = unsigned(atoi(optarg));
+                break;
+            case 'f':
+                path = optarg;
+                break;
+            default:
+                usage();
+        }
+    }
+
+    util::File::try_remove(path);
+    util::File::try_remove(path + ".lock");
+    {
+        SharedGroup sg(path);
+        WriteTransaction wt(sg);
+        TableRef table = wt.add_table("test");
+        table->add_column(type_Int, "x");
+        table->add_empty_row(1000);
+        wt.commit();
+    }
+
+    std::vector<std::thread> threads;
+    threads.emplace_back(writer, path);
+    for (int i = 0; i < n_readers; ++i)
+        threads.emplace_back(reader, path, n_pinned);
+    sleep(duration);
+    runnable = false;
+    for (auto& thread : threads)
+        thread.join();
+
+    SharedGroup sg(path);
+    std::cout << "readers: " << n_readers << ", pinned per reader: " << n_pinned << std::endl;
+    std::cout << "read transactions: " << total_reads << std::endl;
+    std::cout << "average begin_read(): " << Timer::format(total_read_time / std::max(total_reads, 1L)) << std::endl;
+    std::cout << "worst begin_read(): " << Timer::format(max_read_time) << std::endl;
+    std::cout << "versions at exit: " << sg.get_number_of_versions() << std::endl;
+
+    util::File::try_remove(path);
+    util::File::try_remove(path + ".lock");
+}
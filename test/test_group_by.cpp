@@ -0,0 +1,255 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_GROUP_BY
+
+#include <map>
+#include <string>
+#include <tuple>
+
+#include <realm/group.hpp>
+#include <realm/group_by.hpp>
+#include <realm/query.hpp>
+#include <realm/table.hpp>
+
+#include "util/check_logic_error.hpp"
+
+#include "test.hpp"
+
+using namespace realm;
+
+
+TEST(GroupBy_MultipleKeysAndAggregates)
+{
+    Table table;
+    table.add_column(type_String, "name");
+    table.add_column(type_Int, "size", true);
+    table.add_column(type_Int, "ints", true);
+    table.add_column(type_Double, "doubles");
+    const char* names[] = {"alpha", "beta", "gamma"};
+    const size_t num_rows = 300;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_string(0, i, names[i % 3]);
+        if (i % 5 == 0) {
+            table.set_null(1, i);
+        }
+        else {
+            table.set_int(1, i, int64_t(i % 4));
+        }
+        if (i % 7 == 0) {
+            table.set_null(2, i);
+        }
+        else {
+            table.set_int(2, i, int64_t(i % 11) - 5);
+        }
+        table.set_double(3, i, double(i % 13) / 2);
+    }
+
+    // The groups as computed row by row
+    using Key = std::tuple<std::string, bool, int64_t>;
+    struct Expected {
+        size_t first_row, count = 0, num_ints = 0;
+        int64_t sum = 0, min = 0, max = 0;
+        double double_sum = 0, double_max = 0;
+    };
+    auto get_key = [&](size_t row_ndx) {
+        bool is_null = table.is_null(1, row_ndx);
+        return Key(table.get_string(0, row_ndx), is_null, is_null ? 0 : table.get_int(1, row_ndx));
+    };
+    auto check = [&](GroupBy& group_by, Query* query) {
+        std::map<Key, Expected> expected;
+        for (size_t i = 0; i < table.size(); ++i) {
+            if (query && query->find(i) != i)
+                continue;
+            Key key = get_key(i);
+            Expected& e = expected[key];
+            if (e.count++ == 0) {
+                e.first_row = i;
+                e.double_max = table.get_double(3, i);
+            }
+            e.double_sum += table.get_double(3, i);
+            e.double_max = std::max(e.double_max, table.get_double(3, i));
+            if (!table.is_null(2, i)) {
+                int64_t value = table.get_int(2, i);
+                e.min = e.num_ints == 0 ? value : std::min(e.min, value);
+                e.max = e.num_ints == 0 ? value : std::max(e.max, value);
+                e.sum += value;
+                ++e.num_ints;
+            }
+        }
+
+        CHECK_EQUAL(expected.size(), group_by.size());
+        for (size_t g = 0; g < group_by.size(); ++g) {
+            const Expected& e = expected[get_key(group_by.get_row(g))];
+            CHECK_EQUAL(e.first_row, group_by.get_row(g));
+            if (g > 0)
+                CHECK_LESS(group_by.get_row(g - 1), group_by.get_row(g));
+            CHECK_EQUAL(e.count, group_by.get_count(g));
+            CHECK_EQUAL(int64_t(e.count), group_by.get_int(g, 0));
+            CHECK_EQUAL(e.sum, group_by.get_int(g, 1));
+            CHECK_EQUAL(e.num_ints, group_by.get_value_count(g, 1));
+            CHECK_EQUAL(e.min, group_by.get_int(g, 2));
+            CHECK_EQUAL(e.max, group_by.get_int(g, 3));
+            CHECK_EQUAL(e.num_ints == 0 ? 0 : double(e.sum) / e.num_ints, group_by.get_double(g, 4));
+            CHECK_EQUAL(e.double_sum, group_by.get_double(g, 5));
+            CHECK_EQUAL(e.double_max, group_by.get_double(g, 6));
+        }
+    };
+
+    GroupBy group_by(table);
+    CHECK_EQUAL(0, group_by.add_key(0));
+    CHECK_EQUAL(1, group_by.add_key(1));
+    group_by.add_aggregate(Table::aggr_count, 0);
+    group_by.add_aggregate(Table::aggr_sum, 2);
+    group_by.add_aggregate(Table::aggr_min, 2);
+    group_by.add_aggregate(Table::aggr_max, 2);
+    group_by.add_aggregate(Table::aggr_avg, 2);
+    group_by.add_aggregate(Table::aggr_sum, 3);
+    CHECK_EQUAL(6, group_by.add_aggregate(Table::aggr_max, 3));
+    group_by.run();
+    CHECK_EQUAL(15, group_by.size());
+    check(group_by, nullptr);
+
+    // Only the rows that match a query
+    Query query = table.where().greater(3, 2.0);
+    group_by.run(query);
+    check(group_by, &query);
+
+    // Only columns of single values can be keys, and only numeric columns
+    // can be aggregated
+    table.add_column(type_Table, "subtable");
+    CHECK_LOGIC_ERROR(group_by.add_key(4), LogicError::type_mismatch);
+    CHECK_LOGIC_ERROR(group_by.add_key(5), LogicError::column_index_out_of_range);
+    CHECK_LOGIC_ERROR(group_by.add_key(0, {1}), LogicError::type_mismatch);
+    CHECK_LOGIC_ERROR(group_by.add_aggregate(Table::aggr_sum, 0), LogicError::type_mismatch);
+    Table other;
+    Query other_query = other.where();
+    CHECK_LOGIC_ERROR(group_by.run(other_query), LogicError::illegal_combination);
+}
+
+
+TEST(GroupBy_StringEnum)
+{
+    Table table;
+    table.add_column(type_String, "strings", true);
+    table.add_column(type_Int, "ints");
+    const char* values[] = {"a", "b", nullptr, "", "c"};
+    table.add_empty_row(1000);
+    for (size_t i = 0; i < 1000; ++i) {
+        table.set_string(0, i, values[i * i % 5]);
+        table.set_int(1, i, int64_t(i));
+    }
+
+    GroupBy hashed(table);
+    hashed.add_key(0);
+    hashed.add_aggregate(Table::aggr_sum, 1);
+    hashed.run();
+
+    // Grouping by the positions of the distinct values gives the same result
+    table.optimize();
+    CHECK_EQUAL(col_type_StringEnum, _impl::TableFriend::get_spec(table).get_column_type(0));
+    GroupBy enumerated(table);
+    enumerated.add_key(0);
+    enumerated.add_aggregate(Table::aggr_sum, 1);
+    enumerated.run();
+
+    CHECK_EQUAL(3, hashed.size());
+    CHECK_EQUAL(hashed.size(), enumerated.size());
+    for (size_t g = 0; g < hashed.size(); ++g) {
+        CHECK_EQUAL(hashed.get_row(g), enumerated.get_row(g));
+        CHECK_EQUAL(hashed.get_count(g), enumerated.get_count(g));
+        CHECK_EQUAL(hashed.get_int(g, 0), enumerated.get_int(g, 0));
+    }
+
+    // Null and the empty string are different keys
+    table.set_string(0, 1, "");
+    table.set_null(0, 2);
+    enumerated.run();
+    CHECK_EQUAL(5, enumerated.size());
+    CHECK_EQUAL(1, enumerated.get_count(1));
+    CHECK_EQUAL(1, enumerated.get_count(2));
+}
+
+
+TEST(GroupBy_LinksAndOtherTypes)
+{
+    Group group;
+    TableRef countries = group.add_table("countries");
+    countries->add_column(type_String, "name");
+    countries->add_empty_row(2);
+    countries->set_string(0, 0, "Denmark");
+    countries->set_string(0, 1, "Norway");
+
+    TableRef cities = group.add_table("cities");
+    cities->add_column_link(type_Link, "country", *countries);
+    cities->add_column(type_Float, "temperature", true);
+    cities->add_column(type_Binary, "code", true);
+    cities->add_column(type_Timestamp, "founded");
+    cities->add_column(type_Double, "population");
+    cities->add_empty_row(6);
+    const char codes[] = "aabbcc";
+    for (size_t i = 0; i < 6; ++i) {
+        if (i != 5)
+            cities->set_link(0, i, i % 2);
+        cities->set_float(1, i, i < 2 ? 0.5f : -1.5f);
+        cities->set_binary(2, i, i == 4 ? BinaryData() : BinaryData(codes + i, 1));
+        cities->set_timestamp(3, i, Timestamp(int64_t(i / 3), 0));
+        cities->set_double(4, i, double(i + 1));
+    }
+    cities->set_null(1, 3);
+    cities->set_float(1, 4, -0.0f);
+    cities->set_float(1, 5, 0.0f);
+
+    // A null link gives a null key
+    GroupBy by_country(*cities);
+    by_country.add_key(0, {0});
+    by_country.add_aggregate(Table::aggr_sum, 4);
+    by_country.run();
+    CHECK_EQUAL(3, by_country.size());
+    CHECK_EQUAL(9, by_country.get_int(0, 0));
+    CHECK_EQUAL(6, by_country.get_int(1, 0));
+    CHECK_EQUAL(6, by_country.get_int(2, 0));
+    CHECK_EQUAL(5, by_country.get_row(2));
+
+    // Zero and negative zero are the same key, and null is a key of its own
+    GroupBy by_temperature(*cities);
+    by_temperature.add_key(1);
+    by_temperature.add_aggregate(Table::aggr_count, 0);
+    by_temperature.run();
+    CHECK_EQUAL(4, by_temperature.size());
+    CHECK_EQUAL(2, by_temperature.get_count(0));
+    CHECK_EQUAL(1, by_temperature.get_count(1));
+    CHECK_EQUAL(1, by_temperature.get_count(2));
+    CHECK_EQUAL(2, by_temperature.get_count(3));
+
+    GroupBy by_code_and_date(*cities);
+    by_code_and_date.add_key(2);
+    by_code_and_date.add_key(3);
+    by_code_and_date.add_aggregate(Table::aggr_max, 4);
+    by_code_and_date.run();
+    CHECK_EQUAL(5, by_code_and_date.size());
+    CHECK_EQUAL(2, by_code_and_date.get_count(0));
+    CHECK_EQUAL(2, by_code_and_date.get_double(0, 0));
+    CHECK_EQUAL(1, by_code_and_date.get_count(1));
+    CHECK_EQUAL(1, by_code_and_date.get_count(2));
+    CHECK_EQUAL(4, by_code_and_date.get_row(3));
+}
+
+#endif // TEST_GROUP_BY
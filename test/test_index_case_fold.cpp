@@ -0,0 +1,286 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_CASE_FOLD
+
+#include <string>
+#include <vector>
+
+#include <realm/group_shared.hpp>
+#include <realm/history.hpp>
+#include <realm/index_case_fold.hpp>
+#include <realm/lang_bind_helper.hpp>
+#include <realm/table.hpp>
+
+#include "util/check_logic_error.hpp"
+
+#include "test.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+using unit_test::TestContext;
+
+
+namespace {
+
+// Check the case folded index of column 0 against the values of the column,
+// and the rows that it finds for `folded`, which must be in lower case
+void check_case_fold_index(TestContext& test_context, const Table& table, const std::string& folded)
+{
+    auto index = _impl::TableFriend::get_case_fold_index(table, 0);
+    CHECK(index);
+    if (!index)
+        return;
+
+    std::vector<size_t> equal, prefix;
+    for (size_t i = 0; i < table.size(); ++i) {
+        StringData value = table.get_string(0, i);
+        if (value.is_null()) {
+            CHECK(index->get(i).is_null());
+            continue;
+        }
+        std::string expected = CaseFoldIndex::fold(value);
+        CHECK_EQUAL(StringData(expected), index->get(i));
+        if (expected == folded)
+            equal.push_back(i);
+        if (StringData(expected).begins_with(folded))
+            prefix.push_back(i);
+    }
+    std::vector<size_t> rows;
+    index->find_equal(folded, rows);
+    CHECK(rows == equal);
+    rows.clear();
+    index->find_prefix(folded, rows);
+    CHECK(rows == prefix);
+}
+
+} // anonymous namespace
+
+
+TEST(CaseFoldIndex_Find)
+{
+    Table table;
+    table.add_column(type_String, "strings", true);
+    const char* values[] = {"Apple", "apricot", nullptr, "APPLE", "", "applesauce", "banana", "app"};
+    table.add_empty_row(8);
+    for (size_t i = 0; i < 8; ++i)
+        table.set_string(0, i, values[i]);
+
+    table.add_case_fold_index(0);
+    const CaseFoldIndex& index = *_impl::TableFriend::get_case_fold_index(table, 0);
+
+    // The folded copy of the column
+    CHECK_EQUAL("apple", index.get(0));
+    CHECK_EQUAL("apple", index.get(3));
+    CHECK(index.get(2).is_null());
+    CHECK(!index.get(4).is_null());
+    CHECK_EQUAL("", index.get(4));
+
+    std::vector<size_t> rows;
+    index.find_equal("apple", rows);
+    CHECK(rows == std::vector<size_t>({0, 3}));
+    rows.clear();
+    index.find_equal("", rows);
+    CHECK(rows == std::vector<size_t>({4}));
+    rows.clear();
+    index.find_equal("appl", rows);
+    CHECK(rows.empty());
+
+    index.find_prefix("app", rows);
+    CHECK(rows == std::vector<size_t>({0, 3, 5, 7}));
+    rows.clear();
+    index.find_prefix("ap", rows);
+    CHECK(rows == std::vector<size_t>({0, 1, 3, 5, 7}));
+    rows.clear();
+    index.find_prefix("", rows);
+    CHECK_EQUAL(7, rows.size());
+    rows.clear();
+    index.find_prefix("bananas", rows);
+    CHECK(rows.empty());
+
+    // Only ASCII letters are mapped in values that are not valid UTF-8
+    CHECK_EQUAL("a\xff" "b", CaseFoldIndex::fold("A\xff" "B"));
+}
+
+
+TEST(CaseFoldIndex_Table)
+{
+    Table table;
+    table.add_column(type_String, "strings");
+    table.add_column(type_Int, "ints");
+
+    CHECK(!table.has_case_fold_index(0));
+    CHECK_LOGIC_ERROR(table.add_case_fold_index(1), LogicError::illegal_combination);
+    CHECK_LOGIC_ERROR(table.add_case_fold_index(2), LogicError::column_index_out_of_range);
+
+    table.add_case_fold_index(0);
+    table.add_fulltext_index(0);
+    CHECK(table.has_case_fold_index(0));
+    CHECK(!table.has_case_fold_index(1));
+
+    // The indexes follow their columns
+    table.insert_column(0, type_Bool, "bools");
+    CHECK(!table.has_case_fold_index(0));
+    CHECK(table.has_case_fold_index(1));
+    table.remove_case_fold_index(1);
+    CHECK(!table.has_case_fold_index(1));
+    CHECK(table.has_fulltext_index(1));
+
+    // A case folded index is not allowed in a subtable with a shared
+    // descriptor
+    Table parent;
+    parent.add_column(type_Table, "sub");
+    parent.get_subdescriptor(0)->add_column(type_String, "strings");
+    parent.add_empty_row();
+    TableRef subtable = parent.get_subtable(0, 0);
+    CHECK_LOGIC_ERROR(subtable->add_case_fold_index(0), LogicError::wrong_kind_of_table);
+    CHECK(!subtable->has_case_fold_index(0));
+}
+
+
+TEST(CaseFoldIndex_RowChanges)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    const char* letters[] = {"a", "B", "\xc3\x86", "\xc3\xa6"}; // Latin capital and small letter AE
+    auto random_string = [&] {
+        std::string value;
+        size_t size = random.draw_int_max(3);
+        for (size_t i = 0; i < size; ++i)
+            value += letters[random.draw_int_mod(4)];
+        return value;
+    };
+
+    Table table;
+    auto set_random_string = [&](size_t row_ndx) {
+        std::string value = random_string();
+        table.set_string(0, row_ndx, value);
+    };
+    table.add_column(type_String, "strings", true);
+    table.add_case_fold_index(0);
+    table.add_empty_row(100);
+    for (size_t i = 0; i < 100; ++i)
+        set_random_string(i);
+    check_case_fold_index(test_context, table, "ab");
+
+    // The index follows the rows as they are inserted, removed, moved, and
+    // modified
+    for (int i = 0; i < 1000; ++i) {
+        size_t num_rows = table.size();
+        switch (random.draw_int_mod(7)) {
+            case 0: {
+                size_t row_ndx = random.draw_int_max(num_rows);
+                table.insert_empty_row(row_ndx);
+                set_random_string(row_ndx);
+                break;
+            }
+            case 1:
+                table.add_empty_row();
+                break;
+            case 2:
+                if (num_rows > 0)
+                    set_random_string(random.draw_int_mod(num_rows));
+                break;
+            case 3:
+                if (num_rows > 0)
+                    table.set_null(0, random.draw_int_mod(num_rows));
+                break;
+            case 4:
+                if (num_rows > 0)
+                    table.move_last_over(random.draw_int_mod(num_rows));
+                break;
+            case 5:
+                if (num_rows > 0)
+                    table.remove(random.draw_int_mod(num_rows));
+                break;
+            case 6:
+                if (num_rows > 1)
+                    table.swap_rows(random.draw_int_mod(num_rows), random.draw_int_mod(num_rows));
+                break;
+        }
+        if (random.draw_int_mod(4) == 0) {
+            std::string value = random_string();
+            check_case_fold_index(test_context, table, CaseFoldIndex::fold(value));
+        }
+    }
+    check_case_fold_index(test_context, table, "ab");
+    check_case_fold_index(test_context, table, "");
+
+    table.clear();
+    check_case_fold_index(test_context, table, "a");
+    table.add_empty_row(3);
+    table.set_string(0, 1, "A\xc3\x86");
+    check_case_fold_index(test_context, table, "a");
+}
+
+
+TEST(CaseFoldIndex_AdvanceRead)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+    Group& group = const_cast<Group&>(sg.begin_read());
+
+    std::unique_ptr<Replication> hist_w(make_in_realm_history(path));
+    SharedGroup sg_w(*hist_w, SharedGroupOptions(crypt_key()));
+    Group& group_w = const_cast<Group&>(sg_w.begin_read());
+
+    // The index is recorded in the file, and replicated
+    LangBindHelper::promote_to_write(sg_w);
+    TableRef table_w = group_w.add_table("table");
+    table_w->add_column(type_String, "strings", true);
+    table_w->add_empty_row(10);
+    for (size_t i = 0; i < 10; ++i)
+        table_w->set_string(0, i, i % 3 == 0 ? "Apple" : "BANANA");
+    table_w->add_case_fold_index(0);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+
+    LangBindHelper::advance_read(sg);
+    ConstTableRef table = group.get_table("table");
+    CHECK(table->has_case_fold_index(0));
+    check_case_fold_index(test_context, *table, "apple");
+
+    // The index of the reading accessor follows the changes of other
+    // transactions, and of transactions that are rolled back
+    LangBindHelper::promote_to_write(sg_w);
+    table_w->set_string(0, 1, "APPLESAUCE");
+    table_w->move_last_over(3);
+    table_w->insert_empty_row(2);
+    table_w->set_null(0, 5);
+    table_w->swap_rows(1, 6);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+    LangBindHelper::advance_read(sg);
+    check_case_fold_index(test_context, *table, "apple");
+    check_case_fold_index(test_context, *table, "banana");
+
+    LangBindHelper::promote_to_write(sg);
+    group.get_table("table")->set_string(0, 4, "apricot");
+    group.get_table("table")->add_empty_row();
+    check_case_fold_index(test_context, *table, "ap");
+    LangBindHelper::rollback_and_continue_as_read(sg);
+    check_case_fold_index(test_context, *table, "ap");
+
+    LangBindHelper::promote_to_write(sg_w);
+    table_w->remove_case_fold_index(0);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+    LangBindHelper::advance_read(sg);
+    CHECK(!table->has_case_fold_index(0));
+    CHECK(!_impl::TableFriend::get_case_fold_index(*table, 0));
+}
+
+#endif // TEST_INDEX_CASE_FOLD
@@ -0,0 +1,303 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_FULLTEXT
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <realm/group_shared.hpp>
+#include <realm/history.hpp>
+#include <realm/index_fulltext.hpp>
+#include <realm/lang_bind_helper.hpp>
+#include <realm/table.hpp>
+
+#include "util/check_logic_error.hpp"
+
+#include "test.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+using unit_test::TestContext;
+
+
+namespace {
+
+// Check the rows that the full-text index of column 0 finds for `words`,
+// which must be sorted and distinct, against the values of the column
+void check_fulltext_index(TestContext& test_context, const Table& table, const std::vector<std::string>& words)
+{
+    auto index = _impl::TableFriend::get_fulltext_index(table, 0);
+    CHECK(index);
+    if (!index)
+        return;
+
+    std::vector<size_t> expected;
+    std::vector<std::string> row_words;
+    for (size_t i = 0; i < table.size(); ++i) {
+        row_words.clear();
+        FullTextIndex::tokenize(table.get_string(0, i), row_words);
+        if (std::includes(row_words.begin(), row_words.end(), words.begin(), words.end()))
+            expected.push_back(i);
+    }
+    std::vector<size_t> rows;
+    index->find_all(words, rows);
+    CHECK(rows == expected);
+}
+
+} // anonymous namespace
+
+
+TEST(FullTextIndex_Tokenize)
+{
+    std::vector<std::string> words;
+    FullTextIndex::tokenize("The quick, brown FOX -- the 2nd fox!", words);
+    CHECK(words == std::vector<std::string>({"2nd", "brown", "fox", "quick", "the"}));
+
+    // Non-ASCII characters are part of words
+    words.clear();
+    FullTextIndex::tokenize("\xc3\xa6" "ble-X \xc3\xa6" "BLE", words);
+    CHECK(words == std::vector<std::string>({"x", "\xc3\xa6" "ble"}));
+
+    // Words are appended, and only made distinct within the text
+    FullTextIndex::tokenize("x", words);
+    CHECK(words == std::vector<std::string>({"x", "\xc3\xa6" "ble", "x"}));
+    FullTextIndex::tokenize(StringData(), words);
+    FullTextIndex::tokenize(" ,.", words);
+    CHECK_EQUAL(3, words.size());
+}
+
+
+TEST(FullTextIndex_Find)
+{
+    Table table;
+    table.add_column(type_String, "text", true);
+    const char* values[] = {"red apple", "Green apple", "red pepper", nullptr, "", "apple red, apple green"};
+    table.add_empty_row(6);
+    for (size_t i = 0; i < 6; ++i)
+        table.set_string(0, i, values[i]);
+
+    table.add_fulltext_index(0);
+    const FullTextIndex& index = *_impl::TableFriend::get_fulltext_index(table, 0);
+    CHECK_EQUAL(4, index.size());
+
+    std::vector<size_t> rows;
+    index.find_all({"apple"}, rows);
+    CHECK(rows == std::vector<size_t>({0, 1, 5}));
+    rows.clear();
+    index.find_all({"green", "apple"}, rows);
+    CHECK(rows == std::vector<size_t>({1, 5}));
+    rows.clear();
+    index.find_all({"red", "banana"}, rows);
+    CHECK(rows.empty());
+    index.find_all({}, rows);
+    CHECK_EQUAL(6, rows.size());
+
+    // Rows with more of the words come first
+    rows.clear();
+    index.find_ranked({"red", "green", "apple", "red"}, rows);
+    CHECK(rows == std::vector<size_t>({5, 0, 1, 2}));
+    rows.clear();
+    index.find_ranked({"banana"}, rows);
+    CHECK(rows.empty());
+}
+
+
+TEST(FullTextIndex_Table)
+{
+    Table table;
+    table.add_column(type_String, "text");
+    table.add_column(type_Int, "ints");
+
+    CHECK(!table.has_fulltext_index(0));
+    CHECK_LOGIC_ERROR(table.add_fulltext_index(1), LogicError::illegal_combination);
+    CHECK_LOGIC_ERROR(table.add_fulltext_index(2), LogicError::column_index_out_of_range);
+    CHECK_LOGIC_ERROR(table.find_ranked_fulltext(0, "word"), LogicError::no_search_index);
+
+    table.add_fulltext_index(0);
+    table.add_trigram_index(0);
+    CHECK(table.has_fulltext_index(0));
+    CHECK(!table.has_fulltext_index(1));
+
+    table.add_empty_row(3);
+    table.set_string(0, 0, "one two");
+    table.set_string(0, 1, "two three");
+    table.set_string(0, 2, "three two one");
+    CHECK(table.find_ranked_fulltext(0, "ONE two") == std::vector<size_t>({0, 2, 1}));
+
+    // The index follows the rows that are modified
+    table.set_string(0, 1, "one");
+    CHECK(table.find_ranked_fulltext(0, "one two") == std::vector<size_t>({0, 2, 1}));
+    table.move_last_over(0);
+    CHECK(table.find_ranked_fulltext(0, "three") == std::vector<size_t>({0}));
+
+    // The indexes follow their columns
+    table.insert_column(0, type_Bool, "bools");
+    CHECK(!table.has_fulltext_index(0));
+    CHECK(table.has_fulltext_index(1));
+    table.remove_fulltext_index(1);
+    CHECK(!table.has_fulltext_index(1));
+    CHECK(table.has_trigram_index(1));
+
+    // A full-text index is not allowed in a subtable with a shared descriptor
+    Table parent;
+    parent.add_column(type_Table, "sub");
+    parent.get_subdescriptor(0)->add_column(type_String, "text");
+    parent.add_empty_row();
+    TableRef subtable = parent.get_subtable(0, 0);
+    CHECK_LOGIC_ERROR(subtable->add_fulltext_index(0), LogicError::wrong_kind_of_table);
+    CHECK(!subtable->has_fulltext_index(0));
+}
+
+
+TEST(FullTextIndex_RowChanges)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    const char* words[] = {"red", "Green", "BLUE", "apple", "pepper"};
+    auto random_words = [&] {
+        std::string text = words[random.draw_int_mod(5)];
+        if (random.draw_int_mod(2) == 0)
+            text += std::string(" ") + words[random.draw_int_mod(5)];
+        std::vector<std::string> result;
+        FullTextIndex::tokenize(text, result);
+        return result;
+    };
+
+    Table table;
+    auto set_random_text = [&](size_t row_ndx) {
+        std::string text;
+        size_t num_words = random.draw_int_max(4);
+        for (size_t i = 0; i < num_words; ++i)
+            text += std::string(words[random.draw_int_mod(5)]) + ", ";
+        table.set_string(0, row_ndx, text);
+    };
+    table.add_column(type_String, "text", true);
+    table.add_fulltext_index(0);
+    table.add_empty_row(100);
+    for (size_t i = 0; i < 100; ++i)
+        set_random_text(i);
+    check_fulltext_index(test_context, table, {"apple", "red"});
+
+    // The index follows the rows as they are inserted, removed, moved, and
+    // modified
+    for (int i = 0; i < 1000; ++i) {
+        size_t num_rows = table.size();
+        switch (random.draw_int_mod(7)) {
+            case 0: {
+                size_t row_ndx = random.draw_int_max(num_rows);
+                table.insert_empty_row(row_ndx);
+                set_random_text(row_ndx);
+                break;
+            }
+            case 1:
+                table.add_empty_row();
+                break;
+            case 2:
+                if (num_rows > 0)
+                    set_random_text(random.draw_int_mod(num_rows));
+                break;
+            case 3:
+                if (num_rows > 0)
+                    table.set_null(0, random.draw_int_mod(num_rows));
+                break;
+            case 4:
+                if (num_rows > 0)
+                    table.move_last_over(random.draw_int_mod(num_rows));
+                break;
+            case 5:
+                if (num_rows > 0)
+                    table.remove(random.draw_int_mod(num_rows));
+                break;
+            case 6:
+                if (num_rows > 1)
+                    table.swap_rows(random.draw_int_mod(num_rows), random.draw_int_mod(num_rows));
+                break;
+        }
+        if (random.draw_int_mod(4) == 0)
+            check_fulltext_index(test_context, table, random_words());
+    }
+    check_fulltext_index(test_context, table, {"apple", "red"});
+    check_fulltext_index(test_context, table, {});
+
+    table.clear();
+    check_fulltext_index(test_context, table, {"red"});
+    table.add_empty_row(3);
+    table.set_string(0, 1, "Red pepper");
+    check_fulltext_index(test_context, table, {"red"});
+    check_fulltext_index(test_context, table, {});
+}
+
+
+TEST(FullTextIndex_AdvanceRead)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+    Group& group = const_cast<Group&>(sg.begin_read());
+
+    std::unique_ptr<Replication> hist_w(make_in_realm_history(path));
+    SharedGroup sg_w(*hist_w, SharedGroupOptions(crypt_key()));
+    Group& group_w = const_cast<Group&>(sg_w.begin_read());
+
+    // The index is recorded in the file, and replicated
+    LangBindHelper::promote_to_write(sg_w);
+    TableRef table_w = group_w.add_table("table");
+    table_w->add_column(type_String, "text", true);
+    table_w->add_empty_row(10);
+    for (size_t i = 0; i < 10; ++i)
+        table_w->set_string(0, i, i % 3 == 0 ? "red apple" : "green pepper");
+    table_w->add_fulltext_index(0);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+
+    LangBindHelper::advance_read(sg);
+    ConstTableRef table = group.get_table("table");
+    CHECK(table->has_fulltext_index(0));
+    check_fulltext_index(test_context, *table, {"apple"});
+
+    // The index of the reading accessor follows the changes of other
+    // transactions, and of transactions that are rolled back
+    LangBindHelper::promote_to_write(sg_w);
+    table_w->set_string(0, 1, "Red Pepper");
+    table_w->move_last_over(3);
+    table_w->insert_empty_row(2);
+    table_w->set_null(0, 5);
+    table_w->swap_rows(1, 6);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+    LangBindHelper::advance_read(sg);
+    check_fulltext_index(test_context, *table, {"red"});
+    check_fulltext_index(test_context, *table, {"green", "pepper"});
+
+    LangBindHelper::promote_to_write(sg);
+    group.get_table("table")->set_string(0, 4, "blue apple");
+    group.get_table("table")->add_empty_row();
+    check_fulltext_index(test_context, *table, {"apple"});
+    LangBindHelper::rollback_and_continue_as_read(sg);
+    check_fulltext_index(test_context, *table, {"apple"});
+    check_fulltext_index(test_context, *table, {"blue"});
+
+    LangBindHelper::promote_to_write(sg_w);
+    table_w->remove_fulltext_index(0);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+    LangBindHelper::advance_read(sg);
+    CHECK(!table->has_fulltext_index(0));
+    CHECK(!_impl::TableFriend::get_fulltext_index(*table, 0));
+}
+
+#endif // TEST_INDEX_FULLTEXT
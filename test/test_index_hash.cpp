@@ -0,0 +1,388 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_HASH
+
+#include <string>
+#include <vector>
+
+#include <realm/column.hpp>
+#include <realm/group_shared.hpp>
+#include <realm/history.hpp>
+#include <realm/index_hash.hpp>
+#include <realm/lang_bind_helper.hpp>
+#include <realm/table.hpp>
+
+#include "util/check_logic_error.hpp"
+
+#include "test.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+using unit_test::TestContext;
+
+
+namespace {
+
+// Check the hash index of column 0, which is a nullable int column, against
+// the values of the column
+void check_hash_index(TestContext& test_context, const Table& table, util::Optional<int64_t> value)
+{
+    auto index = _impl::TableFriend::get_hash_index(table, 0);
+    CHECK(index);
+    if (!index)
+        return;
+
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < table.size(); ++i) {
+        if (value ? !table.is_null(0, i) && table.get_int(0, i) == *value : table.is_null(0, i))
+            expected.push_back(i);
+    }
+    const ColumnBase& column = _impl::TableFriend::get_column(table, 0);
+    std::vector<size_t> rows;
+    index->find_all(column, value, rows);
+    CHECK(rows == expected);
+    CHECK_EQUAL(expected.size(), index->count(column, value));
+    CHECK_EQUAL(expected.empty() ? not_found : expected[0], index->find_first(column, value));
+}
+
+} // anonymous namespace
+
+
+TEST(HashIndex_String)
+{
+    Table table;
+    table.add_column(type_String, "strings", true);
+    std::string long_prefix(300, 'x');
+    std::string a = long_prefix + "a";
+    std::string b = long_prefix + "b";
+    const char* values[] = {a.c_str(), "", b.c_str(), a.c_str(), nullptr, "", a.c_str()};
+    table.add_empty_row(7);
+    for (size_t i = 0; i < 7; ++i)
+        table.set_string(0, i, values[i]);
+
+    table.add_hash_index(0);
+    const HashIndex& index = *_impl::TableFriend::get_hash_index(table, 0);
+    const ColumnBase& column = _impl::TableFriend::get_column(table, 0);
+
+    // Rows are listed in row order
+    std::vector<size_t> rows;
+    index.find_all(column, StringData(a), rows);
+    CHECK(rows == std::vector<size_t>({0, 3, 6}));
+    CHECK_EQUAL(3, index.count(column, StringData(a)));
+    CHECK_EQUAL(2, index.find_first(column, StringData(b)));
+    CHECK_EQUAL(not_found, index.find_first(column, StringData(long_prefix)));
+    CHECK_EQUAL(3, index.find_first(column, StringData(a), 1));
+    CHECK_EQUAL(not_found, index.find_first(column, StringData(b), 3));
+
+    // Null and the empty string are different values
+    rows.clear();
+    index.find_all(column, StringData(""), rows);
+    CHECK(rows == std::vector<size_t>({1, 5}));
+    CHECK_EQUAL(4, index.find_first(column, realm::null()));
+    CHECK_EQUAL(1, index.count(column, realm::null()));
+    CHECK_NOT_EQUAL(HashIndex::hash(StringData("")), HashIndex::hash(realm::null()));
+}
+
+
+TEST(HashIndex_IntAndTimestamp)
+{
+    Table table;
+    table.add_column(type_Int, "ints", true);
+    table.add_column(type_Timestamp, "dates", true);
+    const size_t num_rows = 1000;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        if (i % 10 == 0) {
+            table.set_null(0, i);
+            table.set_null(1, i);
+            continue;
+        }
+        table.set_int(0, i, int64_t(i % 37) - 18);
+        table.set_timestamp(1, i, Timestamp(int64_t(i % 37) - 18, int32_t(i % 2)));
+    }
+
+    table.add_hash_index(0);
+    table.add_hash_index(1);
+    const HashIndex& ints = *_impl::TableFriend::get_hash_index(table, 0);
+    const HashIndex& dates = *_impl::TableFriend::get_hash_index(table, 1);
+    const ColumnBase& int_column = _impl::TableFriend::get_column(table, 0);
+    const ColumnBase& date_column = _impl::TableFriend::get_column(table, 1);
+    for (int64_t value = -20; value <= 20; ++value) {
+        std::vector<size_t> expected;
+        for (size_t i = 0; i < num_rows; ++i) {
+            if (i % 10 != 0 && int64_t(i % 37) - 18 == value)
+                expected.push_back(i);
+        }
+        std::vector<size_t> rows;
+        ints.find_all(int_column, value, rows);
+        CHECK(rows == expected);
+        CHECK_EQUAL(expected.size(), ints.count(int_column, value));
+
+        Timestamp date(value, 1);
+        size_t first = not_found;
+        for (size_t i : expected) {
+            if (i % 2 == 1) {
+                first = i;
+                break;
+            }
+        }
+        CHECK_EQUAL(first, dates.find_first(date_column, date));
+    }
+    CHECK_EQUAL(num_rows / 10, ints.count(int_column, util::Optional<int64_t>()));
+    CHECK_EQUAL(num_rows / 10, dates.count(date_column, Timestamp()));
+}
+
+
+TEST(HashIndex_Table)
+{
+    Table table;
+    table.add_column(type_String, "strings");
+    table.add_column(type_Double, "doubles");
+    table.add_column(type_Int, "ints");
+
+    CHECK(!table.has_hash_index(0));
+    CHECK_LOGIC_ERROR(table.add_hash_index(1), LogicError::illegal_combination);
+    CHECK_LOGIC_ERROR(table.add_hash_index(3), LogicError::column_index_out_of_range);
+
+    table.add_hash_index(0);
+    table.add_hash_index(2);
+    table.add_ordered_index(2);
+    CHECK(table.has_hash_index(0));
+    CHECK(!table.has_hash_index(1));
+    CHECK(table.has_hash_index(2));
+
+    // Hash and ordered indexes are added and removed independently
+    table.remove_ordered_index(2);
+    CHECK(table.has_hash_index(2));
+    table.add_ordered_index(2);
+    table.remove_hash_index(2);
+    CHECK(!table.has_hash_index(2));
+    CHECK(table.has_ordered_index(2));
+    table.add_hash_index(2);
+
+    // The indexes follow their columns
+    table.insert_column(0, type_Bool, "bools");
+    CHECK(!table.has_hash_index(0));
+    CHECK(table.has_hash_index(1));
+    CHECK(table.has_hash_index(3));
+
+    table.remove_column(1);
+    CHECK(!table.has_hash_index(0));
+    CHECK(!table.has_hash_index(1));
+    CHECK(table.has_hash_index(2));
+    CHECK(table.has_ordered_index(2));
+
+    // A hash index is not allowed in a subtable with a shared descriptor
+    Table parent;
+    parent.add_column(type_Table, "sub");
+    parent.get_subdescriptor(0)->add_column(type_Int, "ints");
+    parent.add_empty_row();
+    TableRef subtable = parent.get_subtable(0, 0);
+    CHECK_LOGIC_ERROR(subtable->add_hash_index(0), LogicError::wrong_kind_of_table);
+    CHECK(!subtable->has_hash_index(0));
+}
+
+
+TEST(HashIndex_RowChanges)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Table table;
+    table.add_column(type_Int, "ints", true);
+    table.add_hash_index(0);
+    table.add_empty_row(100);
+    for (size_t i = 0; i < 100; ++i)
+        table.set_int(0, i, random.draw_int<int64_t>(0, 20));
+    check_hash_index(test_context, table, 10);
+
+    // The index follows the rows as they are inserted, removed, moved, and
+    // modified, and its hash table grows as rows are added
+    for (int i = 0; i < 2000; ++i) {
+        size_t num_rows = table.size();
+        switch (random.draw_int_mod(7)) {
+            case 0: {
+                size_t row_ndx = random.draw_int_max(num_rows);
+                table.insert_empty_row(row_ndx);
+                table.set_int(0, row_ndx, random.draw_int<int64_t>(0, 20));
+                break;
+            }
+            case 1:
+                table.add_empty_row();
+                break;
+            case 2:
+                if (num_rows > 0)
+                    table.set_int(0, random.draw_int_mod(num_rows), random.draw_int<int64_t>(0, 20));
+                break;
+            case 3:
+                if (num_rows > 0)
+                    table.set_null(0, random.draw_int_mod(num_rows));
+                break;
+            case 4:
+                if (num_rows > 0)
+                    table.move_last_over(random.draw_int_mod(num_rows));
+                break;
+            case 5:
+                if (num_rows > 0)
+                    table.remove(random.draw_int_mod(num_rows));
+                break;
+            case 6:
+                if (num_rows > 1)
+                    table.swap_rows(random.draw_int_mod(num_rows), random.draw_int_mod(num_rows));
+                break;
+        }
+        if (random.draw_int_mod(4) == 0)
+            check_hash_index(test_context, table, random.draw_int<int64_t>(0, 21));
+    }
+    check_hash_index(test_context, table, 10);
+    check_hash_index(test_context, table, util::none);
+
+    table.clear();
+    check_hash_index(test_context, table, 0);
+    table.add_empty_row(3);
+    table.set_int(0, 1, 5);
+    check_hash_index(test_context, table, 5);
+    check_hash_index(test_context, table, util::none);
+}
+
+
+TEST(HashIndex_FindFirst)
+{
+    Table table;
+    table.add_column(type_Int, "ints");
+    table.add_hash_index(0);
+    table.add_empty_row(10);
+    for (size_t i = 0; i < 10; ++i)
+        table.set_int(0, i, int64_t(i % 4));
+
+    // Table::find_first_int() and Table::count_int() do not build the index,
+    // but use it once it has been built
+    CHECK_EQUAL(2, table.find_first_int(0, 2));
+    CHECK_EQUAL(3, table.count_int(0, 1));
+    CHECK(_impl::TableFriend::get_hash_index(table, 0));
+    table.set_int(0, 1, 2);
+    table.insert_empty_row(0);
+    CHECK_EQUAL(2, table.find_first_int(0, 2));
+    CHECK_EQUAL(3, table.count_int(0, 2));
+    CHECK_EQUAL(2, table.count_int(0, 1));
+    CHECK_EQUAL(0, table.find_first_int(0, 0));
+    table.move_last_over(3);
+    CHECK_EQUAL(not_found, table.find_first_int(0, 7));
+    CHECK_EQUAL(2, table.count_int(0, 2));
+    table.clear();
+    CHECK_EQUAL(not_found, table.find_first_int(0, 2));
+    CHECK_EQUAL(0, table.count_int(0, 2));
+}
+
+
+TEST(HashIndex_SetUnique)
+{
+    Table table;
+    table.add_column(type_Int, "ints", true);
+    table.add_column(type_String, "strings", true);
+    table.add_column(type_Int, "values");
+    table.add_empty_row(6);
+    CHECK_LOGIC_ERROR(table.set_int_unique(0, 0, 1), LogicError::no_search_index);
+
+    // A hash index finds the rows that conflict with a unique value, like a
+    // search index does
+    table.add_hash_index(0);
+    table.add_hash_index(1);
+    for (size_t i = 0; i < 6; ++i) {
+        table.set_int(0, i, int64_t(i % 3));
+        table.set_string(1, i, i % 2 == 0 ? "a" : "b");
+        table.set_int(2, i, int64_t(i));
+    }
+    table.set_int_unique(0, 5, 1);
+    CHECK_EQUAL(4, table.size());
+    CHECK_EQUAL(2, table.count_int(0, 0));
+    CHECK_EQUAL(1, table.count_int(0, 1));
+    CHECK_EQUAL(1, table.count_int(0, 2));
+    check_hash_index(test_context, table, 1);
+
+    table.set_string_unique(1, 0, "b");
+    CHECK_EQUAL(2, table.size());
+    CHECK_EQUAL(1, table.count_string(1, "a"));
+    CHECK_EQUAL(1, table.count_string(1, "b"));
+    check_hash_index(test_context, table, 2);
+
+    table.add_empty_row(2);
+    table.set_null_unique(1, 2);
+    CHECK_EQUAL(3, table.size());
+    CHECK_EQUAL(1, table.count_string(1, realm::null()));
+    check_hash_index(test_context, table, util::none);
+}
+
+
+TEST(HashIndex_AdvanceRead)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+    Group& group = const_cast<Group&>(sg.begin_read());
+
+    std::unique_ptr<Replication> hist_w(make_in_realm_history(path));
+    SharedGroup sg_w(*hist_w, SharedGroupOptions(crypt_key()));
+    Group& group_w = const_cast<Group&>(sg_w.begin_read());
+
+    // The index is recorded in the file, and replicated
+    LangBindHelper::promote_to_write(sg_w);
+    TableRef table_w = group_w.add_table("table");
+    table_w->add_column(type_Int, "ints", true);
+    table_w->add_empty_row(10);
+    for (size_t i = 0; i < 10; ++i)
+        table_w->set_int(0, i, int64_t(i % 3));
+    table_w->add_hash_index(0);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+
+    LangBindHelper::advance_read(sg);
+    ConstTableRef table = group.get_table("table");
+    CHECK(table->has_hash_index(0));
+    check_hash_index(test_context, *table, 2);
+
+    // The index of the reading accessor follows the changes of other
+    // transactions, and of transactions that are rolled back
+    LangBindHelper::promote_to_write(sg_w);
+    table_w->set_int(0, 0, 7);
+    table_w->move_last_over(3);
+    table_w->insert_empty_row(2);
+    table_w->set_null(0, 5);
+    table_w->swap_rows(1, 6);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+    LangBindHelper::advance_read(sg);
+    check_hash_index(test_context, *table, 2);
+    check_hash_index(test_context, *table, 7);
+    check_hash_index(test_context, *table, util::none);
+
+    LangBindHelper::promote_to_write(sg);
+    group.get_table("table")->set_int(0, 4, -1);
+    group.get_table("table")->add_empty_row();
+    check_hash_index(test_context, *table, -1);
+    LangBindHelper::rollback_and_continue_as_read(sg);
+    check_hash_index(test_context, *table, -1);
+    check_hash_index(test_context, *table, util::none);
+
+    LangBindHelper::promote_to_write(sg_w);
+    table_w->remove_hash_index(0);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+    LangBindHelper::advance_read(sg);
+    CHECK(!table->has_hash_index(0));
+    CHECK(!_impl::TableFriend::get_hash_index(*table, 0));
+}
+
+#endif // TEST_INDEX_HASH
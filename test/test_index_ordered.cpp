@@ -0,0 +1,649 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_ORDERED
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include <realm/group_shared.hpp>
+#include <realm/history.hpp>
+#include <realm/index_ordered.hpp>
+#include <realm/lang_bind_helper.hpp>
+#include <realm/table.hpp>
+
+#include "util/check_logic_error.hpp"
+
+#include "test.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+using unit_test::TestContext;
+
+
+namespace {
+
+// Check the ordered index of column 0 against the values of the column
+void check_ordered_index(TestContext& test_context, const Table& table, int64_t value)
+{
+    auto index = _impl::TableFriend::get_ordered_index(table, 0);
+    CHECK(index);
+    if (!index)
+        return;
+
+    std::vector<size_t> expected(table.size());
+    std::iota(expected.begin(), expected.end(), 0);
+    std::stable_sort(expected.begin(), expected.end(), [&](size_t a, size_t b) {
+        if (table.is_null(0, a) || table.is_null(0, b))
+            return table.is_null(0, a) && !table.is_null(0, b);
+        return table.get_int(0, a) < table.get_int(0, b);
+    });
+    std::vector<size_t> rows;
+    CHECK(index->get_sorted_rows(true, rows));
+    CHECK(rows == expected);
+
+    expected.clear();
+    for (size_t i = 0; i < table.size(); ++i) {
+        if (!table.is_null(0, i) && table.get_int(0, i) < value)
+            expected.push_back(i);
+    }
+    rows.clear();
+    CHECK(index->find<Less>(value, rows));
+    std::sort(rows.begin(), rows.end());
+    CHECK(rows == expected);
+}
+
+// Check the composite index of columns 0 and 1, which are nullable int
+// columns, against the values of the columns
+void check_composite_index(TestContext& test_context, const Table& table, int64_t value_0, int64_t value_1)
+{
+    auto indexes = _impl::TableFriend::get_composite_indexes(table);
+    CHECK_EQUAL(1, indexes.size());
+    if (indexes.size() != 1)
+        return;
+    CHECK(indexes[0]->get_columns() == std::vector<size_t>({0, 1}));
+
+    OrderedIndex::KeyRange equal_0, greater_1;
+    OrderedIndex::get_range<Equal>(value_0, equal_0);
+    OrderedIndex::get_range<Greater>(value_1, greater_1);
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < table.size(); ++i) {
+        if (!table.is_null(0, i) && table.get_int(0, i) == value_0 && !table.is_null(1, i) &&
+            table.get_int(1, i) > value_1)
+            expected.push_back(i);
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+                     [&](size_t a, size_t b) { return table.get_int(1, a) < table.get_int(1, b); });
+    std::vector<size_t> rows;
+    indexes[0]->find({equal_0, greater_1}, rows);
+    CHECK(rows == expected);
+}
+
+} // anonymous namespace
+
+
+TEST(OrderedIndex_Int)
+{
+    Table table;
+    table.add_column(type_Int, "ints", true);
+    table.add_empty_row(7);
+    int_fast64_t values[] = {5, -3, 5, 0, 10, 5};
+    for (size_t i = 0; i < 6; ++i)
+        table.set_int(0, i, values[i]);
+    table.set_null(0, 6);
+
+    table.add_ordered_index(0);
+    auto index = _impl::TableFriend::get_ordered_index(table, 0);
+    CHECK_EQUAL(6, index->size());
+
+    // Rows are listed in the order of their values, and rows with equal values
+    // in row order
+    std::vector<size_t> rows;
+    CHECK(index->find<Equal>(int64_t(5), rows));
+    CHECK(rows == std::vector<size_t>({0, 2, 5}));
+
+    rows.clear();
+    CHECK(index->find<Less>(int64_t(5), rows));
+    CHECK(rows == std::vector<size_t>({1, 3}));
+
+    rows.clear();
+    CHECK(index->find<LessEqual>(int64_t(5), rows));
+    CHECK(rows == std::vector<size_t>({1, 3, 0, 2, 5}));
+
+    rows.clear();
+    CHECK(index->find<Greater>(int64_t(5), rows));
+    CHECK(rows == std::vector<size_t>({4}));
+
+    rows.clear();
+    CHECK(index->find<GreaterEqual>(int64_t(6), rows));
+    CHECK(rows == std::vector<size_t>({4}));
+
+    // Null is not equal to any value
+    rows.clear();
+    CHECK(index->find<NotEqual>(int64_t(5), rows));
+    CHECK(rows == std::vector<size_t>({6, 1, 3, 4}));
+
+    // Null values and unsupported conditions are left to the query engine
+    rows.clear();
+    CHECK(!index->find<Equal>(util::Optional<int64_t>(), rows));
+    CHECK(!index->find<BeginsWith>(int64_t(5), rows));
+    CHECK(rows.empty());
+
+    rows.clear();
+    CHECK(index->get_sorted_rows(true, rows));
+    CHECK(rows == std::vector<size_t>({6, 1, 3, 0, 2, 5, 4}));
+
+    rows.clear();
+    CHECK(index->get_sorted_rows(false, rows));
+    CHECK(rows == std::vector<size_t>({4, 0, 2, 5, 3, 1, 6}));
+}
+
+
+TEST(OrderedIndex_Timestamp)
+{
+    Table table;
+    table.add_column(type_Timestamp, "dates", true);
+    table.add_empty_row(4);
+    table.set_timestamp(0, 0, Timestamp(10, 500));
+    table.set_timestamp(0, 1, Timestamp(-5, 0));
+    table.set_timestamp(0, 2, Timestamp(10, 100));
+    table.set_timestamp(0, 3, Timestamp());
+
+    table.add_ordered_index(0);
+    auto index = _impl::TableFriend::get_ordered_index(table, 0);
+    CHECK_EQUAL(3, index->size());
+
+    std::vector<size_t> rows;
+    CHECK(index->find<Greater>(Timestamp(10, 100), rows));
+    CHECK(rows == std::vector<size_t>({0}));
+
+    rows.clear();
+    CHECK(index->find<Less>(Timestamp(10, 500), rows));
+    CHECK(rows == std::vector<size_t>({1, 2}));
+
+    rows.clear();
+    CHECK(!index->find<Equal>(Timestamp(), rows));
+
+    rows.clear();
+    CHECK(index->get_sorted_rows(true, rows));
+    CHECK(rows == std::vector<size_t>({3, 1, 2, 0}));
+}
+
+
+TEST(OrderedIndex_Double)
+{
+    Table table;
+    table.add_column(type_Double, "doubles");
+    table.add_empty_row(6);
+    double values[] = {1.5, -0.0, -2.25, 0.0, 1e300, -1e-300};
+    for (size_t i = 0; i < 6; ++i)
+        table.set_double(0, i, values[i]);
+
+    table.add_ordered_index(0);
+    auto index = _impl::TableFriend::get_ordered_index(table, 0);
+
+    // Zero and negative zero are equal
+    std::vector<size_t> rows;
+    CHECK(index->find<Equal>(0.0, rows));
+    CHECK(rows == std::vector<size_t>({1, 3}));
+
+    rows.clear();
+    CHECK(index->find<Less>(0.0, rows));
+    CHECK(rows == std::vector<size_t>({2, 5}));
+
+    rows.clear();
+    CHECK(index->find<GreaterEqual>(-0.0, rows));
+    CHECK(rows == std::vector<size_t>({1, 3, 0, 4}));
+
+    rows.clear();
+    CHECK(!index->find<Less>(std::numeric_limits<double>::quiet_NaN(), rows));
+
+    rows.clear();
+    CHECK(index->get_sorted_rows(true, rows));
+    CHECK(rows == std::vector<size_t>({2, 5, 1, 3, 0, 4}));
+
+    // NaN matches no range condition, but has no place in the sort order
+    table.set_double(0, 0, std::numeric_limits<double>::quiet_NaN());
+    auto index_2 = _impl::TableFriend::get_ordered_index(table, 0);
+    CHECK_EQUAL(5, index_2->size());
+
+    rows.clear();
+    CHECK(index_2->find<Greater>(1.0, rows));
+    CHECK(rows == std::vector<size_t>({4}));
+
+    rows.clear();
+    CHECK(!index_2->find<NotEqual>(1.0, rows));
+    CHECK(!index_2->get_sorted_rows(true, rows));
+    CHECK(rows.empty());
+}
+
+
+TEST(OrderedIndex_Table)
+{
+    Table table;
+    table.add_column(type_Int, "ints");
+    table.add_column(type_String, "strings");
+    table.add_column(type_Float, "floats");
+
+    CHECK(!table.has_ordered_index(0));
+    CHECK_LOGIC_ERROR(table.add_ordered_index(1), LogicError::illegal_combination);
+    CHECK_LOGIC_ERROR(table.add_ordered_index(3), LogicError::column_index_out_of_range);
+
+    table.add_ordered_index(0);
+    table.add_ordered_index(2);
+    CHECK(table.has_ordered_index(0));
+    CHECK(!table.has_ordered_index(1));
+    CHECK(table.has_ordered_index(2));
+    CHECK(!table.has_ordered_index(3));
+
+    // The indexes follow their columns
+    table.insert_column(0, type_Bool, "bools");
+    CHECK(!table.has_ordered_index(0));
+    CHECK(table.has_ordered_index(1));
+    CHECK(table.has_ordered_index(3));
+
+    table.remove_column(1);
+    CHECK(!table.has_ordered_index(0));
+    CHECK(!table.has_ordered_index(1));
+    CHECK(table.has_ordered_index(2));
+
+    table.remove_ordered_index(2);
+    CHECK(!table.has_ordered_index(2));
+
+    // Subtables that share their descriptor cannot have ordered indexes
+    Table parent;
+    parent.add_column(type_Table, "sub");
+    parent.get_subdescriptor(0)->add_column(type_Int, "ints");
+    parent.add_empty_row();
+    TableRef subtable = parent.get_subtable(0, 0);
+    CHECK_LOGIC_ERROR(subtable->add_ordered_index(0), LogicError::wrong_kind_of_table);
+}
+
+
+TEST(OrderedIndex_RowChanges)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Table table;
+    table.add_column(type_Int, "ints", true);
+    table.add_ordered_index(0);
+    table.add_empty_row(100);
+    for (size_t i = 0; i < 100; ++i)
+        table.set_int(0, i, random.draw_int<int64_t>(0, 20));
+    check_ordered_index(test_context, table, 10);
+
+    // The index follows the rows as they are inserted, removed, moved, and
+    // modified
+    for (int i = 0; i < 1000; ++i) {
+        size_t num_rows = table.size();
+        switch (random.draw_int_mod(7)) {
+            case 0: {
+                size_t row_ndx = random.draw_int_max(num_rows);
+                table.insert_empty_row(row_ndx);
+                table.set_int(0, row_ndx, random.draw_int<int64_t>(0, 20));
+                break;
+            }
+            case 1:
+                table.add_empty_row();
+                break;
+            case 2:
+                if (num_rows > 0)
+                    table.set_int(0, random.draw_int_mod(num_rows), random.draw_int<int64_t>(0, 20));
+                break;
+            case 3:
+                if (num_rows > 0)
+                    table.set_null(0, random.draw_int_mod(num_rows));
+                break;
+            case 4:
+                if (num_rows > 0)
+                    table.move_last_over(random.draw_int_mod(num_rows));
+                break;
+            case 5:
+                if (num_rows > 0)
+                    table.remove(random.draw_int_mod(num_rows));
+                break;
+            case 6:
+                if (num_rows > 1)
+                    table.swap_rows(random.draw_int_mod(num_rows), random.draw_int_mod(num_rows));
+                break;
+        }
+        if (random.draw_int_mod(4) == 0)
+            check_ordered_index(test_context, table, random.draw_int<int64_t>(0, 21));
+    }
+    check_ordered_index(test_context, table, 10);
+
+    table.clear();
+    check_ordered_index(test_context, table, 10);
+    table.add_empty_row(3);
+    table.set_int(0, 1, 5);
+    check_ordered_index(test_context, table, 10);
+}
+
+
+TEST(OrderedIndex_AdvanceRead)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+    Group& group = const_cast<Group&>(sg.begin_read());
+
+    std::unique_ptr<Replication> hist_w(make_in_realm_history(path));
+    SharedGroup sg_w(*hist_w, SharedGroupOptions(crypt_key()));
+    Group& group_w = const_cast<Group&>(sg_w.begin_read());
+
+    // The index is recorded in the file, and replicated
+    LangBindHelper::promote_to_write(sg_w);
+    TableRef table_w = group_w.add_table("table");
+    table_w->add_column(type_Int, "ints", true);
+    table_w->add_empty_row(10);
+    for (size_t i = 0; i < 10; ++i)
+        table_w->set_int(0, i, int64_t(i % 3));
+    table_w->add_ordered_index(0);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+
+    LangBindHelper::advance_read(sg);
+    ConstTableRef table = group.get_table("table");
+    CHECK(table->has_ordered_index(0));
+    check_ordered_index(test_context, *table, 2);
+
+    // The index of the reading accessor follows the changes of other
+    // transactions, and of transactions that are rolled back
+    LangBindHelper::promote_to_write(sg_w);
+    table_w->set_int(0, 0, 7);
+    table_w->move_last_over(3);
+    table_w->insert_empty_row(2);
+    table_w->set_null(0, 5);
+    table_w->swap_rows(1, 6);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+    LangBindHelper::advance_read(sg);
+    check_ordered_index(test_context, *table, 2);
+    check_ordered_index(test_context, *table, 8);
+
+    LangBindHelper::promote_to_write(sg);
+    group.get_table("table")->set_int(0, 4, -1);
+    group.get_table("table")->add_empty_row();
+    check_ordered_index(test_context, *table, 0);
+    LangBindHelper::rollback_and_continue_as_read(sg);
+    check_ordered_index(test_context, *table, 0);
+
+    LangBindHelper::promote_to_write(sg_w);
+    table_w->remove_ordered_index(0);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+    LangBindHelper::advance_read(sg);
+    CHECK(!table->has_ordered_index(0));
+    CHECK(!_impl::TableFriend::get_ordered_index(*table, 0));
+}
+
+TEST(CompositeIndex_Find)
+{
+    Table table;
+    table.add_column(type_Int, "tenant", true);
+    table.add_column(type_Timestamp, "created");
+    table.add_column(type_Double, "amount");
+    table.add_empty_row(8);
+    int_fast64_t tenants[] = {2, 1, 2, 1, 2, 2, 1, 3};
+    for (size_t i = 0; i < 8; ++i) {
+        table.set_int(0, i, tenants[i]);
+        table.set_timestamp(1, i, Timestamp(int64_t(10 - i), 0));
+        table.set_double(2, i, i % 2 == 0 ? 1.5 : 2.5);
+    }
+    table.set_null(0, 7);
+    table.set_double(2, 4, std::numeric_limits<double>::quiet_NaN());
+
+    table.add_composite_index({0, 1, 2});
+    auto indexes = _impl::TableFriend::get_composite_indexes(table);
+    CHECK_EQUAL(1, indexes.size());
+    const CompositeIndex& index = *indexes[0];
+    CHECK_EQUAL(8, index.size());
+    CHECK(index.get_columns() == std::vector<size_t>({0, 1, 2}));
+
+    using KeyRange = OrderedIndex::KeyRange;
+    KeyRange tenant_2, created_before_8, amount_1_5;
+    CHECK(OrderedIndex::get_range<Equal>(int64_t(2), tenant_2));
+    CHECK(tenant_2.is_single());
+    CHECK(OrderedIndex::get_range<Less>(Timestamp(8, 0), created_before_8));
+    CHECK(!created_before_8.is_single());
+    CHECK(OrderedIndex::get_range<Equal>(1.5, amount_1_5));
+    CHECK(!OrderedIndex::get_range<NotEqual>(int64_t(2), tenant_2));
+
+    // Rows are appended in the order of their values
+    std::vector<size_t> rows;
+    index.find({tenant_2}, rows);
+    CHECK(rows == std::vector<size_t>({5, 4, 2, 0}));
+
+    rows.clear();
+    index.find({tenant_2, created_before_8}, rows);
+    CHECK(rows == std::vector<size_t>({5, 4}));
+
+    // NaN matches no condition
+    KeyRange created_6;
+    CHECK(OrderedIndex::get_range<Equal>(Timestamp(6, 0), created_6));
+    rows.clear();
+    index.find({tenant_2, created_6, amount_1_5}, rows);
+    CHECK(rows.empty());
+
+    KeyRange created_8;
+    CHECK(OrderedIndex::get_range<Equal>(Timestamp(8, 0), created_8));
+    rows.clear();
+    index.find({tenant_2, created_8, amount_1_5}, rows);
+    CHECK(rows == std::vector<size_t>({2}));
+
+    // Null matches no condition
+    KeyRange tenant_above_1;
+    CHECK(OrderedIndex::get_range<Greater>(int64_t(1), tenant_above_1));
+    rows.clear();
+    index.find({tenant_above_1}, rows);
+    CHECK(rows == std::vector<size_t>({5, 4, 2, 0}));
+}
+
+
+TEST(CompositeIndex_Table)
+{
+    Table table;
+    table.add_column(type_Int, "a");
+    table.add_column(type_String, "b");
+    table.add_column(type_Timestamp, "c");
+    table.add_column(type_Float, "d");
+
+    CHECK_LOGIC_ERROR(table.add_composite_index({0}), LogicError::illegal_combination);
+    CHECK_LOGIC_ERROR(table.add_composite_index({0, 1}), LogicError::illegal_combination);
+    CHECK_LOGIC_ERROR(table.add_composite_index({0, 0}), LogicError::illegal_combination);
+    CHECK_LOGIC_ERROR(table.add_composite_index({0, 4}), LogicError::column_index_out_of_range);
+
+    table.add_composite_index({0, 2});
+    table.add_composite_index({3, 0});
+    table.add_composite_index({3, 0});
+    CHECK(table.has_composite_index({0, 2}));
+    CHECK(!table.has_composite_index({2, 0}));
+    CHECK(table.has_composite_index({3, 0}));
+
+    // The indexes follow their columns, and are dropped with them
+    table.insert_column(1, type_Bool, "e");
+    CHECK(table.has_composite_index({0, 3}));
+    CHECK(table.has_composite_index({4, 0}));
+
+    _impl::TableFriend::move_column(*table.get_descriptor(), 4, 1);
+    CHECK(table.has_composite_index({1, 0}));
+    CHECK(table.has_composite_index({0, 4}));
+    _impl::TableFriend::move_column(*table.get_descriptor(), 1, 4);
+
+    table.remove_column(3);
+    CHECK(!table.has_composite_index({0, 3}));
+    CHECK(table.has_composite_index({3, 0}));
+    CHECK_EQUAL(1, _impl::TableFriend::get_composite_indexes(table).size());
+
+    table.remove_composite_index({3, 0});
+    CHECK(!table.has_composite_index({3, 0}));
+    CHECK(_impl::TableFriend::get_composite_indexes(table).empty());
+
+    Table parent;
+    DescriptorRef subdesc;
+    parent.add_column(type_Table, "sub", &subdesc);
+    subdesc->add_column(type_Int, "a");
+    subdesc->add_column(type_Int, "b");
+    parent.add_empty_row();
+    TableRef subtable = parent.get_subtable(0, 0);
+    CHECK_LOGIC_ERROR(subtable->add_composite_index({0, 1}), LogicError::wrong_kind_of_table);
+}
+
+
+TEST(CompositeIndex_RowChanges)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Table table;
+    table.add_column(type_Int, "a", true);
+    table.add_column(type_Int, "b", true);
+    table.add_composite_index({0, 1});
+    table.add_empty_row(100);
+    for (size_t i = 0; i < 100; ++i) {
+        table.set_int(0, i, random.draw_int<int64_t>(0, 3));
+        table.set_int(1, i, random.draw_int<int64_t>(0, 20));
+    }
+    check_composite_index(test_context, table, 1, 10);
+
+    // The index follows the rows as they are inserted, removed, moved, and
+    // modified
+    for (int i = 0; i < 1000; ++i) {
+        size_t num_rows = table.size();
+        switch (random.draw_int_mod(6)) {
+            case 0: {
+                size_t row_ndx = random.draw_int_max(num_rows);
+                table.insert_empty_row(row_ndx);
+                table.set_int(0, row_ndx, random.draw_int<int64_t>(0, 3));
+                table.set_int(1, row_ndx, random.draw_int<int64_t>(0, 20));
+                break;
+            }
+            case 1:
+                if (num_rows > 0)
+                    table.set_int(random.draw_int_mod(2), random.draw_int_mod(num_rows),
+                                  random.draw_int<int64_t>(0, 20));
+                break;
+            case 2:
+                if (num_rows > 0)
+                    table.set_null(random.draw_int_mod(2), random.draw_int_mod(num_rows));
+                break;
+            case 3:
+                if (num_rows > 0)
+                    table.move_last_over(random.draw_int_mod(num_rows));
+                break;
+            case 4:
+                if (num_rows > 0)
+                    table.remove(random.draw_int_mod(num_rows));
+                break;
+            case 5:
+                if (num_rows > 1)
+                    table.swap_rows(random.draw_int_mod(num_rows), random.draw_int_mod(num_rows));
+                break;
+        }
+        if (random.draw_int_mod(4) == 0)
+            check_composite_index(test_context, table, random.draw_int<int64_t>(0, 3),
+                                  random.draw_int<int64_t>(0, 20));
+    }
+    check_composite_index(test_context, table, 1, 10);
+
+    table.clear();
+    check_composite_index(test_context, table, 1, 10);
+}
+
+
+TEST(CompositeIndex_AdvanceRead)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    {
+        std::unique_ptr<Replication> hist(make_in_realm_history(path));
+        SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+        Group& group = const_cast<Group&>(sg.begin_read());
+
+        std::unique_ptr<Replication> hist_w(make_in_realm_history(path));
+        SharedGroup sg_w(*hist_w, SharedGroupOptions(crypt_key()));
+        Group& group_w = const_cast<Group&>(sg_w.begin_read());
+
+        // The index is recorded in the spec, and replicated
+        LangBindHelper::promote_to_write(sg_w);
+        TableRef table_w = group_w.add_table("table");
+        table_w->add_column(type_Int, "a", true);
+        table_w->add_column(type_Int, "b", true);
+        table_w->add_empty_row(10);
+        for (size_t i = 0; i < 10; ++i) {
+            table_w->set_int(0, i, int64_t(i % 2));
+            table_w->set_int(1, i, int64_t(i % 3));
+        }
+        table_w->add_composite_index({0, 1});
+        LangBindHelper::commit_and_continue_as_read(sg_w);
+
+        LangBindHelper::advance_read(sg);
+        ConstTableRef table = group.get_table("table");
+        CHECK(table->has_composite_index({0, 1}));
+        check_composite_index(test_context, *table, 1, 0);
+
+        // The index of the reading accessor follows the changes of other
+        // transactions, and of transactions that are rolled back
+        LangBindHelper::promote_to_write(sg_w);
+        table_w->set_int(0, 0, 1);
+        table_w->move_last_over(3);
+        table_w->insert_empty_row(2);
+        table_w->set_null(1, 5);
+        table_w->swap_rows(1, 6);
+        LangBindHelper::commit_and_continue_as_read(sg_w);
+        LangBindHelper::advance_read(sg);
+        check_composite_index(test_context, *table, 1, 0);
+        check_composite_index(test_context, *table, 0, 1);
+
+        LangBindHelper::promote_to_write(sg);
+        group.get_table("table")->set_int(1, 4, 5);
+        group.get_table("table")->add_empty_row();
+        check_composite_index(test_context, *table, 0, 1);
+        LangBindHelper::rollback_and_continue_as_read(sg);
+        check_composite_index(test_context, *table, 0, 1);
+
+        // Inserting a column renumbers the columns of the index
+        LangBindHelper::promote_to_write(sg_w);
+        table_w->insert_column(0, type_String, "c");
+        LangBindHelper::commit_and_continue_as_read(sg_w);
+        LangBindHelper::advance_read(sg);
+        CHECK(table->has_composite_index({1, 2}));
+        CHECK_EQUAL(1, _impl::TableFriend::get_composite_indexes(*table).size());
+        LangBindHelper::promote_to_write(sg_w);
+        table_w->remove_column(0);
+        LangBindHelper::commit_and_continue_as_read(sg_w);
+        LangBindHelper::advance_read(sg);
+        check_composite_index(test_context, *table, 1, 0);
+    }
+
+    // The index is still there when the file is opened again
+    {
+        std::unique_ptr<Replication> hist(make_in_realm_history(path));
+        SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+        Group& group = const_cast<Group&>(sg.begin_read());
+        ConstTableRef table = group.get_table("table");
+        CHECK(table->has_composite_index({0, 1}));
+        check_composite_index(test_context, *table, 1, 0);
+
+        LangBindHelper::promote_to_write(sg);
+        TableRef table_w = group.get_table("table");
+        table_w->remove_composite_index({0, 1});
+        LangBindHelper::commit_and_continue_as_read(sg);
+        CHECK(!table->has_composite_index({0, 1}));
+        CHECK(_impl::TableFriend::get_composite_indexes(*table).empty());
+    }
+}
+
+#endif // TEST_INDEX_ORDERED
@@ -1429,6 +1429,145 @@ TEST(StringIndex_Deny_Duplicates)
 }
 
 
+// An index built from an existing column must find the same rows as one that
+// was built by inserting the rows one by one
+TEST(StringIndex_Populate)
+{
+    Random random(random_int<unsigned long>());
+    std::string long_prefix(StringIndex::s_max_offset + 50, 'a');
+    std::vector<std::string> values = {"", "a", "ab", "abc", "abcd", "abcde", long_prefix, long_prefix + "x"};
+
+    ref_type ref = StringColumn::create(Allocator::get_default());
+    StringColumn col(Allocator::get_default(), ref, true);
+    ref_type ref_2 = StringColumn::create(Allocator::get_default());
+    StringColumn col_2(Allocator::get_default(), ref_2, true);
+    col_2.create_search_index();
+
+    // Nulls, duplicates, values with a common prefix longer than
+    // StringIndex::s_max_offset, and more distinct values than fit in a node
+    size_t num_rows = 3 * REALM_MAX_BPNODE_SIZE + 100;
+    for (size_t i = 0; i < num_rows; ++i) {
+        std::string str;
+        StringData value; // Null
+        switch (random.draw_int_mod(4)) {
+            case 0:
+                break;
+            case 1:
+                str = values[random.draw_int_mod(values.size())];
+                value = str;
+                break;
+            case 2:
+                str = long_prefix + util::to_string(random.draw_int_mod(num_rows));
+                value = str;
+                break;
+            default:
+                str = util::to_string(i);
+                value = str;
+        }
+        col.add(value);
+        col_2.add(value);
+    }
+    const StringIndex& ndx = *col.create_search_index();
+    ndx.verify();
+
+    ref_type results_ref = IntegerColumn::create(Allocator::get_default());
+    IntegerColumn results(Allocator::get_default(), results_ref);
+    ref_type results_ref_2 = IntegerColumn::create(Allocator::get_default());
+    IntegerColumn results_2(Allocator::get_default(), results_ref_2);
+    auto check_rows = [&] {
+        for (size_t i = 0; i < col.size(); ++i) {
+            StringData value = col.get(i);
+            CHECK_EQUAL(col.count(value), col_2.count(value));
+            CHECK_EQUAL(col.find_first(value), col_2.find_first(value));
+            results.clear();
+            results_2.clear();
+            col.find_all(results, value);
+            col_2.find_all(results_2, value);
+            if (CHECK_EQUAL(results.size(), results_2.size())) {
+                for (size_t j = 0; j < results.size(); ++j)
+                    CHECK_EQUAL(results.get(j), results_2.get(j));
+            }
+        }
+    };
+    check_rows();
+
+    // The index can be modified like any other
+    std::string long_prefix_x = long_prefix + "x";
+    for (StringColumn* c : {&col, &col_2}) {
+        c->insert(0, long_prefix_x);
+        c->set(5, "abc");
+        c->erase(10);
+        c->add(StringData());
+    }
+    ndx.verify();
+    check_rows();
+
+    results.destroy();
+    results_2.destroy();
+    col.destroy();
+    col_2.destroy();
+}
+
+
+TEST(StringIndex_Populate_Int)
+{
+    ref_type ref = IntNullColumn::create(Allocator::get_default());
+    IntNullColumn col(Allocator::get_default(), ref);
+    size_t num_rows = 2 * REALM_MAX_BPNODE_SIZE + 10;
+    for (size_t i = 0; i < num_rows; ++i) {
+        if (i % 7 == 0)
+            col.add(util::none);
+        else
+            col.add(int64_t(i % 3 == 0 ? -5 : i));
+    }
+    const StringIndex& ndx = *col.create_search_index();
+    ndx.verify();
+
+    CHECK_EQUAL(ndx.count(util::Optional<int64_t>()), (num_rows + 6) / 7);
+    CHECK_EQUAL(ndx.find_first(int64_t(-5)), 3);
+    CHECK_EQUAL(ndx.find_first(int64_t(3)), not_found);
+
+    ref_type results_ref = IntegerColumn::create(Allocator::get_default());
+    IntegerColumn results(Allocator::get_default(), results_ref);
+    ndx.find_all(results, int64_t(-5));
+    size_t expected = 0;
+    for (size_t i = 0; i < num_rows; ++i) {
+        if (i % 7 != 0 && i % 3 == 0) {
+            CHECK_EQUAL(results.get(expected), i);
+            ++expected;
+        }
+    }
+    CHECK_EQUAL(results.size(), expected);
+
+    results.destroy();
+    col.destroy();
+}
+
+
+// Duplicate values are detected before anything is added to the index
+TEST(StringIndex_Populate_DenyDuplicates)
+{
+    ref_type ref = StringColumn::create(Allocator::get_default());
+    StringColumn col(Allocator::get_default(), ref, true);
+    col.add("foo");
+    col.add("bar");
+    col.add("foo");
+
+    StringIndex ndx(&col, Allocator::get_default());
+    ndx.set_allow_duplicate_values(false);
+    CHECK_THROW(ndx.populate(), LogicError);
+    CHECK(ndx.is_empty());
+
+    col.set(2, "baz");
+    ndx.populate();
+    CHECK_EQUAL(ndx.find_first(StringData("baz")), 2);
+    CHECK_EQUAL(ndx.count(StringData("foo")), 1);
+
+    ndx.destroy();
+    col.destroy();
+}
+
+
 TEST(StringIndex_MaxBytes)
 {
     std::string std_max(StringIndex::s_max_offset, 'a');
@@ -0,0 +1,286 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_TRIGRAM
+
+#include <string>
+#include <vector>
+
+#include <realm/group_shared.hpp>
+#include <realm/history.hpp>
+#include <realm/index_trigram.hpp>
+#include <realm/lang_bind_helper.hpp>
+#include <realm/table.hpp>
+
+#include "util/check_logic_error.hpp"
+
+#include "test.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+using unit_test::TestContext;
+
+
+namespace {
+
+// Check the candidates of the trigram index of column 0 for `trigram`, which
+// is three lower case ASCII letters, against the values of the column
+void check_trigram_index(TestContext& test_context, const Table& table, const std::string& trigram)
+{
+    auto index = _impl::TableFriend::get_trigram_index(table, 0);
+    CHECK(index);
+    if (!index)
+        return;
+
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < table.size(); ++i) {
+        std::string value = table.get_string(0, i);
+        for (char& c : value) {
+            if (c >= 'A' && c <= 'Z')
+                c += 'a' - 'A';
+        }
+        if (value.find(trigram) != std::string::npos)
+            expected.push_back(i);
+    }
+    std::vector<size_t> rows;
+    CHECK(index->find_candidates({StringData(trigram)}, rows));
+    CHECK(rows == expected);
+}
+
+} // anonymous namespace
+
+
+TEST(TrigramIndex_Candidates)
+{
+    Table table;
+    table.add_column(type_String, "strings", true);
+    const char* values[] = {"foobar", "barfoo", "FOOBAZ", nullptr, "", "fo", "oof rab", "foo bar"};
+    table.add_empty_row(8);
+    for (size_t i = 0; i < 8; ++i)
+        table.set_string(0, i, values[i]);
+
+    table.add_trigram_index(0);
+    const TrigramIndex& index = *_impl::TableFriend::get_trigram_index(table, 0);
+
+    // Candidates have every trigram of every substring, ignoring the case of
+    // ASCII letters
+    std::vector<size_t> rows;
+    CHECK(index.find_candidates({StringData("foo")}, rows));
+    CHECK(rows == std::vector<size_t>({0, 1, 2, 7}));
+    rows.clear();
+    CHECK(index.find_candidates({StringData("OBA")}, rows));
+    CHECK(rows == std::vector<size_t>({0, 2}));
+    rows.clear();
+    CHECK(index.find_candidates({StringData("foo"), StringData("bar")}, rows));
+    CHECK(rows == std::vector<size_t>({0, 1, 7}));
+
+    // A substring without any matching row
+    rows.clear();
+    CHECK(index.find_candidates({StringData("foo"), StringData("xyz")}, rows));
+    CHECK(rows.empty());
+
+    // Substrings shorter than three bytes do not narrow the search
+    CHECK(!index.find_candidates({StringData("fo"), StringData("")}, rows));
+    CHECK(!index.find_candidates({}, rows));
+    CHECK(rows.empty());
+    CHECK(index.find_candidates({StringData("fo"), StringData("rab")}, rows));
+    CHECK(rows == std::vector<size_t>({6}));
+}
+
+
+TEST(TrigramIndex_Table)
+{
+    Table table;
+    table.add_column(type_String, "strings");
+    table.add_column(type_Int, "ints");
+    table.add_column(type_String, "other");
+
+    CHECK(!table.has_trigram_index(0));
+    CHECK_LOGIC_ERROR(table.add_trigram_index(1), LogicError::illegal_combination);
+    CHECK_LOGIC_ERROR(table.add_trigram_index(3), LogicError::column_index_out_of_range);
+
+    table.add_trigram_index(0);
+    table.add_trigram_index(2);
+    table.add_hash_index(2);
+    CHECK(table.has_trigram_index(0));
+    CHECK(!table.has_trigram_index(1));
+    CHECK(table.has_trigram_index(2));
+
+    // Trigram and hash indexes are added and removed independently
+    table.remove_trigram_index(2);
+    CHECK(!table.has_trigram_index(2));
+    CHECK(table.has_hash_index(2));
+    table.add_trigram_index(2);
+
+    // The indexes follow their columns
+    table.insert_column(0, type_Bool, "bools");
+    CHECK(!table.has_trigram_index(0));
+    CHECK(table.has_trigram_index(1));
+    CHECK(table.has_trigram_index(3));
+
+    table.remove_column(1);
+    CHECK(!table.has_trigram_index(0));
+    CHECK(!table.has_trigram_index(1));
+    CHECK(table.has_trigram_index(2));
+    CHECK(table.has_hash_index(2));
+
+    // A trigram index is not allowed in a subtable with a shared descriptor
+    Table parent;
+    parent.add_column(type_Table, "sub");
+    parent.get_subdescriptor(0)->add_column(type_String, "strings");
+    parent.add_empty_row();
+    TableRef subtable = parent.get_subtable(0, 0);
+    CHECK_LOGIC_ERROR(subtable->add_trigram_index(0), LogicError::wrong_kind_of_table);
+    CHECK(!subtable->has_trigram_index(0));
+}
+
+
+TEST(TrigramIndex_RowChanges)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    auto random_string = [&] {
+        std::string value;
+        size_t size = random.draw_int_max(6);
+        for (size_t i = 0; i < size; ++i)
+            value += "abAB"[random.draw_int_mod(4)];
+        return value;
+    };
+    auto random_trigram = [&] {
+        std::string trigram;
+        for (int i = 0; i < 3; ++i)
+            trigram += "ab"[random.draw_int_mod(2)];
+        return trigram;
+    };
+
+    Table table;
+    auto set_random_string = [&](size_t row_ndx) {
+        std::string value = random_string();
+        table.set_string(0, row_ndx, value);
+    };
+    table.add_column(type_String, "strings", true);
+    table.add_trigram_index(0);
+    table.add_empty_row(100);
+    for (size_t i = 0; i < 100; ++i)
+        set_random_string(i);
+    check_trigram_index(test_context, table, "aba");
+
+    // The index follows the rows as they are inserted, removed, moved, and
+    // modified
+    for (int i = 0; i < 1000; ++i) {
+        size_t num_rows = table.size();
+        switch (random.draw_int_mod(7)) {
+            case 0: {
+                size_t row_ndx = random.draw_int_max(num_rows);
+                table.insert_empty_row(row_ndx);
+                set_random_string(row_ndx);
+                break;
+            }
+            case 1:
+                table.add_empty_row();
+                break;
+            case 2:
+                if (num_rows > 0)
+                    set_random_string(random.draw_int_mod(num_rows));
+                break;
+            case 3:
+                if (num_rows > 0)
+                    table.set_null(0, random.draw_int_mod(num_rows));
+                break;
+            case 4:
+                if (num_rows > 0)
+                    table.move_last_over(random.draw_int_mod(num_rows));
+                break;
+            case 5:
+                if (num_rows > 0)
+                    table.remove(random.draw_int_mod(num_rows));
+                break;
+            case 6:
+                if (num_rows > 1)
+                    table.swap_rows(random.draw_int_mod(num_rows), random.draw_int_mod(num_rows));
+                break;
+        }
+        if (random.draw_int_mod(4) == 0)
+            check_trigram_index(test_context, table, random_trigram());
+    }
+    check_trigram_index(test_context, table, "aba");
+
+    table.clear();
+    check_trigram_index(test_context, table, "aba");
+    table.add_empty_row(3);
+    table.set_string(0, 1, "xAbAx");
+    check_trigram_index(test_context, table, "aba");
+}
+
+
+TEST(TrigramIndex_AdvanceRead)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+    Group& group = const_cast<Group&>(sg.begin_read());
+
+    std::unique_ptr<Replication> hist_w(make_in_realm_history(path));
+    SharedGroup sg_w(*hist_w, SharedGroupOptions(crypt_key()));
+    Group& group_w = const_cast<Group&>(sg_w.begin_read());
+
+    // The index is recorded in the file, and replicated
+    LangBindHelper::promote_to_write(sg_w);
+    TableRef table_w = group_w.add_table("table");
+    table_w->add_column(type_String, "strings", true);
+    table_w->add_empty_row(10);
+    for (size_t i = 0; i < 10; ++i)
+        table_w->set_string(0, i, i % 3 == 0 ? "foobar" : "barbaz");
+    table_w->add_trigram_index(0);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+
+    LangBindHelper::advance_read(sg);
+    ConstTableRef table = group.get_table("table");
+    CHECK(table->has_trigram_index(0));
+    check_trigram_index(test_context, *table, "foo");
+
+    // The index of the reading accessor follows the changes of other
+    // transactions, and of transactions that are rolled back
+    LangBindHelper::promote_to_write(sg_w);
+    table_w->set_string(0, 1, "FOOD");
+    table_w->move_last_over(3);
+    table_w->insert_empty_row(2);
+    table_w->set_null(0, 5);
+    table_w->swap_rows(1, 6);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+    LangBindHelper::advance_read(sg);
+    check_trigram_index(test_context, *table, "foo");
+    check_trigram_index(test_context, *table, "baz");
+
+    LangBindHelper::promote_to_write(sg);
+    group.get_table("table")->set_string(0, 4, "food");
+    group.get_table("table")->add_empty_row();
+    check_trigram_index(test_context, *table, "ood");
+    LangBindHelper::rollback_and_continue_as_read(sg);
+    check_trigram_index(test_context, *table, "ood");
+    check_trigram_index(test_context, *table, "foo");
+
+    LangBindHelper::promote_to_write(sg_w);
+    table_w->remove_trigram_index(0);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+    LangBindHelper::advance_read(sg);
+    CHECK(!table->has_trigram_index(0));
+    CHECK(!_impl::TableFriend::get_trigram_index(*table, 0));
+}
+
+#endif // TEST_INDEX_TRIGRAM
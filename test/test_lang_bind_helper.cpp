@@ -7718,6 +7718,22 @@ public:
     {
         return false;
     }
+    bool add_accessor_index(size_t, ColumnAttr)
+    {
+        return false;
+    }
+    bool remove_accessor_index(size_t, ColumnAttr)
+    {
+        return false;
+    }
+    bool add_composite_index(const std::vector<size_t>&)
+    {
+        return false;
+    }
+    bool remove_composite_index(const std::vector<size_t>&)
+    {
+        return false;
+    }
     bool add_primary_key(size_t)
     {
         return false;
@@ -10726,6 +10742,154 @@ TEST(LangBindHelper_HandoverDistinctView)
 }
 
 
+TEST(LangBindHelper_AdvanceReadTransact_SyncChangedRows)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+    Group& group = const_cast<Group&>(sg.begin_read());
+
+    std::unique_ptr<Replication> hist_w(make_in_realm_history(path));
+    SharedGroup sg_w(*hist_w, SharedGroupOptions(crypt_key()));
+    Group& group_w = const_cast<Group&>(sg_w.begin_read());
+
+    LangBindHelper::promote_to_write(sg_w);
+    TableRef table_w = group_w.add_table("table");
+    table_w->add_column(type_Int, "int");
+    table_w->add_empty_row(100);
+    for (size_t i = 0; i < 100; ++i)
+        table_w->set_int(0, i, int64_t(i * 7 % 100));
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+
+    LangBindHelper::advance_read(sg);
+    TableRef table = group.get_table("table");
+    TableView unsorted = table->where().less(0, 50).find_all();
+    TableView sorted = table->where().less(0, 50).find_all();
+    sorted.sort(0, false);
+    auto check = [&] {
+        unsorted.sync_if_needed();
+        sorted.sync_if_needed();
+        TableView expected = table->where().less(0, 50).find_all();
+        CHECK_EQUAL(expected.size(), unsorted.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+            CHECK_EQUAL(expected.get_source_ndx(i), unsorted.get_source_ndx(i));
+        expected.sort(0, false);
+        CHECK_EQUAL(expected.size(), sorted.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+            CHECK_EQUAL(expected.get_source_ndx(i), sorted.get_source_ndx(i));
+    };
+
+    // The views are told about the changes by the transaction logs
+    LangBindHelper::promote_to_write(sg_w);
+    table_w->set_int(0, 3, 1);
+    table_w->set_int(0, 4, 99);
+    table_w->insert_empty_row(10);
+    table_w->add_empty_row();
+    table_w->remove(20);
+    table_w->move_last_over(30);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+    LangBindHelper::advance_read(sg);
+    check();
+
+    // And about the changes that are rolled back
+    LangBindHelper::promote_to_write(sg);
+    table->set_int(0, 5, 98);
+    table->insert_empty_row(0);
+    table->move_last_over(40);
+    check();
+    LangBindHelper::rollback_and_continue_as_read(sg);
+    check();
+
+    // A change of the schema makes the views rerun their queries
+    LangBindHelper::promote_to_write(sg_w);
+    table_w->add_column(type_String, "string");
+    table_w->set_int(0, 6, 2);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+    LangBindHelper::advance_read(sg);
+    check();
+}
+
+
+TEST(LangBindHelper_HandoverSharedPayload)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+    sg.begin_read();
+
+    std::unique_ptr<Replication> hist_w(make_in_realm_history(path));
+    SharedGroup sg_w(*hist_w, SharedGroupOptions(crypt_key()));
+    Group& group_w = const_cast<Group&>(sg_w.begin_read());
+
+    LangBindHelper::promote_to_write(sg_w);
+    TableRef table = group_w.add_table("table");
+    table->add_column(type_Int, "first");
+    table->add_empty_row(100);
+    for (size_t i = 0; i < 100; ++i)
+        table->set_int(0, i, 100 - i);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+    SharedGroup::VersionID vid = sg_w.get_version_of_current_transaction();
+
+    std::unique_ptr<SharedGroup::Handover<TableView>> handover1;
+    std::unique_ptr<SharedGroup::Handover<TableView>> handover2;
+    std::unique_ptr<TableView> tv1;
+    std::unique_ptr<TableView> tv2;
+    {
+        TableView tv = table->where().greater(0, 50).find_all();
+        CHECK_EQUAL(tv.size(), 50);
+        handover1 = sg_w.export_for_handover(tv, ConstSourcePayload::Share);
+        handover2 = sg_w.export_for_handover(tv, ConstSourcePayload::Share);
+        CHECK(tv.is_in_sync());
+        CHECK_EQUAL(tv.size(), 50);
+
+        LangBindHelper::advance_read(sg, vid);
+        tv1 = sg.import_from_handover(move(handover1));
+        tv2 = sg.import_from_handover(move(handover2));
+        CHECK(tv1->is_in_sync());
+        CHECK_EQUAL(tv1->size(), 50);
+        CHECK_EQUAL(tv2->size(), 50);
+
+        // Sorting the source must not affect the accessors sharing its payload
+        tv.sort(0);
+        CHECK_EQUAL(tv.get_int(0, 0), 51);
+        CHECK_EQUAL(tv1->get_int(0, 0), 100);
+        CHECK_EQUAL(tv2->get_int(0, 0), 100);
+    }
+
+    // The shared payload must survive the destruction of the source
+    for (size_t i = 0; i < 50; ++i) {
+        CHECK_EQUAL(tv1->get_source_ndx(i), i);
+        CHECK_EQUAL(tv2->get_source_ndx(i), i);
+    }
+
+    // Changes to the underlying table are reflected by each accessor independently
+    LangBindHelper::promote_to_write(sg_w);
+    table->remove(0);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+    LangBindHelper::advance_read(sg);
+    CHECK_EQUAL(tv1->size(), 50);
+    CHECK(!tv1->is_row_attached(0));
+    CHECK_EQUAL(tv1->get_source_ndx(1), 0);
+    CHECK_EQUAL(tv2->num_attached_rows(), 49);
+    tv2->sync_if_needed();
+    CHECK_EQUAL(tv2->size(), 49);
+    CHECK_EQUAL(tv1->size(), 50);
+
+    // A view still sharing its payload is given a private copy before it is
+    // adjusted, both by local changes and by rollback
+    {
+        TableView tv = table->where().greater(0, 50).find_all();
+        auto handover = sg_w.export_for_handover(tv, ConstSourcePayload::Share);
+        LangBindHelper::promote_to_write(sg_w);
+        table->insert_empty_row(0);
+        CHECK_EQUAL(tv.size(), 49);
+        CHECK_EQUAL(tv.get_source_ndx(0), 1);
+        LangBindHelper::rollback_and_continue_as_read(sg_w);
+        CHECK_EQUAL(tv.get_source_ndx(0), 0);
+    }
+}
+
+
 TEST(LangBindHelper_HandoverWithReverseDependency)
 {
     // FIXME: This testcase is wrong!
@@ -0,0 +1,227 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_MATERIALIZED_AGGREGATE
+
+#include <memory>
+
+#include <realm/group_shared.hpp>
+#include <realm/history.hpp>
+#include <realm/lang_bind_helper.hpp>
+#include <realm/materialized_aggregate.hpp>
+#include <realm/table.hpp>
+
+#include "util/check_logic_error.hpp"
+
+#include "test.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+
+
+TEST(MaterializedAggregate_Int)
+{
+    Table table;
+    table.add_column(type_Int, "ints", true);
+    table.add_column(type_Bool, "bools");
+    table.add_empty_row(200);
+    for (size_t i = 0; i < 200; ++i) {
+        table.set_int(0, i, int64_t(i * 37 % 101) - 50);
+        table.set_bool(1, i, i % 3 != 0);
+    }
+
+    Query query = table.where().equal(1, true);
+    MaterializedAggregate count(query, Table::aggr_count, 0);
+    MaterializedAggregate sum(query, Table::aggr_sum, 0);
+    MaterializedAggregate avg(query, Table::aggr_avg, 0);
+    MaterializedAggregate min(query, Table::aggr_min, 0);
+    MaterializedAggregate max(query, Table::aggr_max, 0);
+    auto check = [&] {
+        Query expected = table.where().equal(1, true);
+        CHECK_EQUAL(int64_t(expected.count()), count.get_int());
+        CHECK_EQUAL(expected.count(), count.get_value_count());
+        size_t num_values = 0;
+        CHECK_EQUAL(expected.sum_int(0), sum.get_int());
+        CHECK_EQUAL(expected.average_int(0, &num_values), avg.get_double());
+        CHECK_EQUAL(num_values, avg.get_value_count());
+        if (num_values > 0) {
+            CHECK_EQUAL(expected.minimum_int(0), min.get_int());
+            CHECK_EQUAL(expected.maximum_int(0), max.get_int());
+        }
+        CHECK_EQUAL(num_values, max.get_value_count());
+    };
+    check();
+
+    Random random(random_int<unsigned long>());
+    for (int iter = 0; iter < 300; ++iter) {
+        size_t size = table.size();
+        switch (random.draw_int_mod(8)) {
+            case 0:
+            case 1:
+                table.set_int(0, random.draw_int_mod(size), random.draw_int<int64_t>(-60, 60));
+                break;
+            case 2:
+                table.set_bool(1, random.draw_int_mod(size), random.draw_bool());
+                break;
+            case 3:
+                table.set_null(0, random.draw_int_mod(size));
+                break;
+            case 4: {
+                size_t row_ndx = random.draw_int_mod(size + 1);
+                table.insert_empty_row(row_ndx);
+                table.set_int(0, row_ndx, random.draw_int<int64_t>(-60, 60));
+                table.set_bool(1, row_ndx, true);
+                break;
+            }
+            case 5:
+                table.remove(random.draw_int_mod(size));
+                break;
+            case 6:
+                table.move_last_over(random.draw_int_mod(size));
+                break;
+            case 7:
+                // The current maximum leaves the query
+                for (size_t i = 0; i < size; ++i) {
+                    if (table.get_bool(1, i) && !table.is_null(0, i) && table.get_int(0, i) == max.get_int()) {
+                        table.set_bool(1, i, false);
+                        break;
+                    }
+                }
+                break;
+        }
+        if (random.draw_int_mod(3) == 0)
+            check();
+    }
+    check();
+
+    table.clear();
+    check();
+    CHECK_EQUAL(0, max.get_int());
+    table.add_empty_row(3);
+    table.set_bool(1, 1, true);
+    table.set_int(0, 1, 5);
+    check();
+    CHECK_EQUAL(5, min.get_int());
+}
+
+
+TEST(MaterializedAggregate_Double)
+{
+    Table table;
+    table.add_column(type_Double, "doubles");
+    table.add_column(type_Float, "floats", true);
+    table.add_empty_row(100);
+    for (size_t i = 0; i < 100; ++i) {
+        table.set_double(0, i, double(i % 13));
+        table.set_float(1, i, float(i % 7) / 2);
+    }
+
+    // Values that are small whole numbers and halves are added and subtracted
+    // exactly
+    Query query = table.where().greater(0, 3.0);
+    MaterializedAggregate sum(query, Table::aggr_sum, 1);
+    MaterializedAggregate max(query, Table::aggr_max, 1);
+    MaterializedAggregate min(query, Table::aggr_min, 0);
+    auto check = [&] {
+        Query expected = table.where().greater(0, 3.0);
+        size_t num_values = 0;
+        CHECK_EQUAL(expected.sum_float(1, &num_values), sum.get_double());
+        CHECK_EQUAL(num_values, sum.get_value_count());
+        CHECK_EQUAL(expected.maximum_float(1), max.get_double());
+        CHECK_EQUAL(expected.minimum_double(0), min.get_double());
+    };
+    check();
+
+    table.set_double(0, 5, 100);
+    table.set_float(1, 6, 50);
+    check();
+    table.set_null(1, 6);
+    table.set_double(0, 4, 4);
+    check();
+    table.remove(0);
+    table.move_last_over(10);
+    table.insert_empty_row(20);
+    table.set_double(0, 20, 3.5);
+    table.set_float(1, 20, 0.5);
+    check();
+    CHECK_EQUAL(3.5, min.get_double());
+
+    // Only int, float and double columns can be aggregated
+    table.add_column(type_String, "strings");
+    CHECK_LOGIC_ERROR(MaterializedAggregate(query, Table::aggr_sum, 2), LogicError::type_mismatch);
+    CHECK_LOGIC_ERROR(MaterializedAggregate(query, Table::aggr_sum, 3), LogicError::column_index_out_of_range);
+    MaterializedAggregate count(query, Table::aggr_count, 2);
+    CHECK_EQUAL(int64_t(query.count()), count.get_int());
+}
+
+
+TEST(MaterializedAggregate_AdvanceRead)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+    Group& group = const_cast<Group&>(sg.begin_read());
+
+    std::unique_ptr<Replication> hist_w(make_in_realm_history(path));
+    SharedGroup sg_w(*hist_w, SharedGroupOptions(crypt_key()));
+    Group& group_w = const_cast<Group&>(sg_w.begin_read());
+
+    LangBindHelper::promote_to_write(sg_w);
+    TableRef table_w = group_w.add_table("table");
+    table_w->add_column(type_Int, "int");
+    table_w->add_empty_row(100);
+    for (size_t i = 0; i < 100; ++i)
+        table_w->set_int(0, i, int64_t(i * 7 % 100));
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+
+    LangBindHelper::advance_read(sg);
+    TableRef table = group.get_table("table");
+    Query query = table->where().less(0, 50);
+    MaterializedAggregate sum(query, Table::aggr_sum, 0);
+    MaterializedAggregate max(query, Table::aggr_max, 0);
+    auto check = [&] {
+        Query expected = table->where().less(0, 50);
+        CHECK_EQUAL(expected.sum_int(0), sum.get_int());
+        CHECK_EQUAL(expected.maximum_int(0), max.get_int());
+    };
+    check();
+
+    // The aggregates are told about the changes by the transaction logs
+    LangBindHelper::promote_to_write(sg_w);
+    table_w->set_int(0, 7, 49);
+    table_w->set_int(0, 70, 100);
+    table_w->insert_empty_row(10);
+    table_w->remove(20);
+    table_w->move_last_over(30);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+    LangBindHelper::advance_read(sg);
+    CHECK(!sum.is_in_sync());
+    check();
+    CHECK(sum.is_in_sync());
+
+    // And about the changes that are rolled back
+    LangBindHelper::promote_to_write(sg);
+    table->set_int(0, 5, 10);
+    table->remove(0);
+    check();
+    LangBindHelper::rollback_and_continue_as_read(sg);
+    check();
+}
+
+#endif // TEST_MATERIALIZED_AGGREGATE
@@ -20,8 +20,10 @@
 #ifdef TEST_QUERY
 
 #include <cstdlib> // itoa()
+#include <functional>
 #include <initializer_list>
 #include <limits>
+#include <sstream>
 #include <vector>
 
 #include <realm.hpp>
@@ -29,6 +31,7 @@
 #include <realm/column.hpp>
 #include <realm/history.hpp>
 #include <realm/query_engine.hpp>
+#include <realm/util/thread_pool.hpp>
 
 #include "test.hpp"
 
@@ -1663,6 +1666,78 @@ TEST(Query_Expressions0)
     CHECK_EQUAL(match, not_found);
 }
 
+TEST(Query_ExpressionsBatch)
+{
+    // Expressions on numeric columns without links and nulls are evaluated in batches that cross leaf
+    // boundaries. Verify the results against a row by row evaluation.
+    Table table;
+    table.add_column(type_Int, "int");
+    table.add_column(type_Float, "float");
+    table.add_column(type_Double, "double");
+    table.add_column(type_Int, "nullable", true);
+
+    const size_t num_rows = 3 * REALM_MAX_BPNODE_SIZE + 123;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_int(0, i, int64_t(i * 7919 % 1000) - 300);
+        table.set_float(1, i, float(i % 13));
+        table.set_double(2, i, double(i % 77) / 3);
+        if (i % 5 != 0)
+            table.set_int(3, i, i % 7);
+    }
+
+    Columns<Int> ints = table.column<Int>(0);
+    Columns<Float> floats = table.column<Float>(1);
+    Columns<Double> doubles = table.column<Double>(2);
+    Columns<Int> nullables = table.column<Int>(3);
+
+    auto check = [&](Query q, std::function<bool(size_t)> expected) {
+        TableView tv = q.find_all();
+        size_t n = 0;
+        for (size_t i = 0; i < num_rows; ++i) {
+            if (expected(i)) {
+                if (n < tv.size())
+                    CHECK_EQUAL(i, tv.get_source_ndx(n));
+                ++n;
+            }
+        }
+        CHECK_EQUAL(n, tv.size());
+        CHECK_EQUAL(n, q.count());
+
+        // Start and end in the middle of leaves
+        size_t begin = REALM_MAX_BPNODE_SIZE / 2, end = num_rows - REALM_MAX_BPNODE_SIZE / 3;
+        size_t m = 0;
+        for (size_t i = begin; i < end; ++i) {
+            if (expected(i))
+                ++m;
+        }
+        CHECK_EQUAL(m, q.count(begin, end));
+    };
+
+    auto get_int = [&](size_t i) { return table.get_int(0, i); };
+    auto get_float = [&](size_t i) { return table.get_float(1, i); };
+    auto get_double = [&](size_t i) { return table.get_double(2, i); };
+
+    // Sparse and dense matches
+    check(ints == 5, [&](size_t i) { return get_int(i) == 5; });
+    check(ints != 5, [&](size_t i) { return get_int(i) != 5; });
+    check(ints + ints == 64, [&](size_t i) { return get_int(i) + get_int(i) == 64; });
+
+    // Mixed types and constants on either side
+    check(ints * 2 + doubles > floats, [&](size_t i) { return get_int(i) * 2 + get_double(i) > get_float(i); });
+    check(floats / 2 <= ints, [&](size_t i) { return get_float(i) / 2 <= get_int(i); });
+    check(100 - ints >= doubles * floats,
+          [&](size_t i) { return 100 - get_int(i) >= get_double(i) * get_float(i); });
+    check(power(ints) < 1000, [&](size_t i) { return get_int(i) * get_int(i) < 1000; });
+    check(ints - 3 < 7.5, [&](size_t i) { return get_int(i) - 3 < 7.5; });
+
+    // Nullable columns are not evaluated in batches, but must still combine with batch evaluated operands
+    check(ints + nullables == 5,
+          [&](size_t i) { return !table.is_null(3, i) && get_int(i) + table.get_int(3, i) == 5; });
+    check((ints > 600) && (nullables == 3),
+          [&](size_t i) { return get_int(i) > 600 && !table.is_null(3, i) && table.get_int(3, i) == 3; });
+}
+
 TEST(Query_LimitUntyped2)
 {
     Table table;
@@ -9925,4 +10000,1123 @@ TEST(Query_ArrayLeafRelocate)
     }
 }
 
+TEST(Query_ThreadPool)
+{
+    Table table;
+    table.add_column(type_Int, "int");
+    table.add_column(type_Double, "double");
+    table.add_column(type_String, "string");
+
+    const size_t num_rows = 10 * REALM_MAX_BPNODE_SIZE + 17;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_int(0, i, int64_t(i * 7919 % 1000) - 500);
+        table.set_double(1, i, double(i % 113) / 4);
+        table.set_string(2, i, i % 3 == 0 ? "foo" : "bar");
+    }
+
+    util::ThreadPool pool(3);
+    CHECK_EQUAL(4, pool.get_num_threads());
+
+    auto check = [&](Query serial) {
+        Query parallel = serial;
+        parallel.set_thread_pool(&pool);
+
+        TableView tv1 = serial.find_all();
+        TableView tv2 = parallel.find_all();
+        CHECK_EQUAL(tv1.size(), tv2.size());
+        for (size_t i = 0; i < std::min(tv1.size(), tv2.size()); ++i)
+            CHECK_EQUAL(tv1.get_source_ndx(i), tv2.get_source_ndx(i));
+
+        CHECK_EQUAL(serial.count(), parallel.count());
+        CHECK_EQUAL(serial.sum_int(0), parallel.sum_int(0));
+        CHECK_EQUAL(serial.average_int(0), parallel.average_int(0));
+
+        size_t count1 = 0, count2 = 0, ndx1 = npos, ndx2 = npos;
+        CHECK_EQUAL(serial.maximum_int(0, &count1, 0, npos, npos, &ndx1),
+                    parallel.maximum_int(0, &count2, 0, npos, npos, &ndx2));
+        CHECK_EQUAL(count1, count2);
+        CHECK_EQUAL(ndx1, ndx2);
+
+        CHECK_EQUAL(serial.minimum_double(1, &count1, 0, npos, npos, &ndx1),
+                    parallel.minimum_double(1, &count2, 0, npos, npos, &ndx2));
+        CHECK_EQUAL(count1, count2);
+        CHECK_EQUAL(ndx1, ndx2);
+
+        // Restricted queries are executed serially
+        CHECK_EQUAL(serial.count(5, num_rows - 5, 100), parallel.count(5, num_rows - 5, 100));
+        CHECK_EQUAL(serial.find_all(0, npos, 10).size(), parallel.find_all(0, npos, 10).size());
+    };
+
+    check(table.where().greater(0, 100));
+    check(table.where().equal(2, "foo").less(1, 10.0));
+    check(table.where().group().equal(2, "foo").Or().less(0, -400).end_group());
+    check(table.column<Int>(0) > table.column<Double>(1));
+    check(table.where().equal(0, 12345)); // No matches
+}
+
+
+TEST(Query_ThreadPoolLinkList)
+{
+    // Conditions through link lists instantiate link list accessors, which
+    // are shared by all copies of the query, so they are evaluated serially
+    Group group;
+    TableRef target = group.add_table("target");
+    TableRef origin = group.add_table("origin");
+    target->add_column(type_Int, "value");
+    origin->add_column_link(type_LinkList, "links", *target);
+    origin->add_column(type_Int, "int");
+
+    target->add_empty_row(10);
+    for (size_t i = 0; i < 10; ++i)
+        target->set_int(0, i, i);
+
+    const size_t num_rows = 4 * REALM_MAX_BPNODE_SIZE + 17;
+    origin->add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        origin->set_int(1, i, i % 7);
+        LinkViewRef links = origin->get_linklist(0, i);
+        for (size_t j = 0; j < i % 3; ++j)
+            links->add((i + j) % 10);
+    }
+
+    util::ThreadPool pool(3);
+
+    auto check = [&](Query serial) {
+        Query parallel = serial;
+        parallel.set_thread_pool(&pool);
+
+        TableView tv1 = serial.find_all();
+        TableView tv2 = parallel.find_all();
+        CHECK_EQUAL(tv1.size(), tv2.size());
+        for (size_t i = 0; i < std::min(tv1.size(), tv2.size()); ++i)
+            CHECK_EQUAL(tv1.get_source_ndx(i), tv2.get_source_ndx(i));
+        CHECK_EQUAL(serial.count(), parallel.count());
+        CHECK_EQUAL(serial.sum_int(1), parallel.sum_int(1));
+    };
+
+    check(origin->link(0).column<Int>(0) > 5);
+    check(origin->column<Link>(0).count() == 2);
+    check(origin->where().links_to(0, target->get(3)).greater(1, 2));
+    check(origin->where().greater(1, 2).Or().links_to(0, target->get(4)));
+}
+
+TEST(Query_FindAllBitmap)
+{
+    Table table;
+    table.add_column(type_Int, "int");
+    table.add_column(type_String, "string");
+
+    const size_t num_rows = 10 * REALM_MAX_BPNODE_SIZE + 17;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_int(0, i, int64_t(i * 7919 % 1000));
+        table.set_string(1, i, i % 3 == 0 ? "foo" : "bar");
+    }
+
+    util::ThreadPool pool(2);
+
+    auto check = [&](Query q) {
+        TableView tv = q.find_all();
+        RowBitmap bitmap = q.find_all_bitmap();
+        CHECK_EQUAL(tv.size(), bitmap.size());
+        for (size_t i = 0; i < tv.size(); ++i)
+            CHECK(bitmap.contains(tv.get_source_ndx(i)));
+
+        TableView tv2 = table.get_bitmap_view(bitmap);
+        CHECK_EQUAL(tv.size(), tv2.size());
+        for (size_t i = 0; i < std::min(tv.size(), tv2.size()); ++i)
+            CHECK_EQUAL(tv.get_source_ndx(i), tv2.get_source_ndx(i));
+
+        CHECK_EQUAL(q.find_all(5, num_rows - 5, 100).size(), q.find_all_bitmap(5, num_rows - 5, 100).size());
+
+        Query parallel = q;
+        parallel.set_thread_pool(&pool);
+        CHECK(parallel.find_all_bitmap() == bitmap);
+    };
+
+    check(table.where());
+    check(table.where().less(0, 900));
+    check(table.where().equal(1, "foo").greater(0, 500));
+    check(table.column<Int>(0) > 990);
+    check(table.where().equal(0, 12345)); // No matches
+
+    // Restricted by a view
+    TableView view = table.where().less(0, 500).find_all();
+    Query q = table.where(&view).equal(1, "bar");
+    RowBitmap bitmap = q.find_all_bitmap();
+    CHECK_EQUAL(q.count(), bitmap.size());
+}
+
+TEST(Query_BitmapEvaluation)
+{
+    // Conditions that match most rows make aggregate_internal() combine them
+    // as bitmaps. The results must be the same as row by row evaluation.
+    Table table;
+    table.add_column(type_Int, "a");
+    table.add_column(type_Int, "b");
+    table.add_column(type_Double, "c");
+    table.add_column(type_Int, "d", true);
+
+    const size_t num_rows = 3 * REALM_MAX_BPNODE_SIZE + 17;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_int(0, i, int64_t(i % 10));
+        table.set_int(1, i, int64_t(i * 7919 % 100));
+        table.set_double(2, i, double(i % 7) / 7);
+        if (i % 5 != 0)
+            table.set_int(3, i, int64_t(i % 3));
+    }
+
+    auto check = [&](Query q, std::function<bool(size_t)> pred) {
+        size_t count = 0;
+        int64_t sum = 0;
+        size_t first = not_found;
+        for (size_t i = 0; i < num_rows; ++i) {
+            if (pred(i)) {
+                ++count;
+                sum += table.get_int(1, i);
+                if (first == not_found)
+                    first = i;
+            }
+        }
+        CHECK_EQUAL(count, q.count());
+        CHECK_EQUAL(sum, q.sum_int(1));
+        CHECK_EQUAL(first, q.find());
+
+        TableView tv = q.find_all();
+        CHECK_EQUAL(count, tv.size());
+        bool all_match = true;
+        for (size_t i = 0; i < tv.size(); ++i)
+            all_match = all_match && pred(tv.get_source_ndx(i));
+        CHECK(all_match);
+        CHECK_EQUAL(std::min(count, size_t(1500)), q.find_all(0, num_rows, 1500).size());
+    };
+
+    check(table.where().greater(0, 0).less(1, 90).greater(2, 0.1), [&](size_t i) {
+        return table.get_int(0, i) > 0 && table.get_int(1, i) < 90 && table.get_double(2, i) > 0.1;
+    });
+    check(table.where().group().less(0, 5).Or().greater(1, 20).end_group().less(2, 0.9), [&](size_t i) {
+        return (table.get_int(0, i) < 5 || table.get_int(1, i) > 20) && table.get_double(2, i) < 0.9;
+    });
+    // Rare matches in one condition
+    check(table.where().not_equal(0, 3).equal(1, 42), [&](size_t i) {
+        return table.get_int(0, i) != 3 && table.get_int(1, i) == 42;
+    });
+    // Nullable columns are evaluated row by row
+    check(table.where().greater(0, 1).not_equal(3, 2), [&](size_t i) {
+        return table.get_int(0, i) > 1 && (table.is_null(3, i) || table.get_int(3, i) != 2);
+    });
+}
+
+TEST(Query_FindTopK)
+{
+    Table table;
+    table.add_column(type_Int, "int");
+    table.add_column(type_String, "string");
+
+    const size_t num_rows = 3 * REALM_MAX_BPNODE_SIZE + 17;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_int(0, i, int64_t(i * 7919 % 500));
+        table.set_string(1, i, i % 3 == 0 ? "foo" : "bar");
+    }
+
+    auto check = [&](Query q, SortDescriptor order, size_t k) {
+        TableView expected = q.find_all();
+        expected.sort(order);
+        TableView top = q.find_top_k(order, k);
+        CHECK_EQUAL(std::min(k, expected.size()), top.size());
+        for (size_t i = 0; i < std::min(top.size(), expected.size()); ++i)
+            CHECK_EQUAL(expected.get_source_ndx(i), top.get_source_ndx(i));
+    };
+
+    SortDescriptor by_int(table, {{0}});
+    SortDescriptor by_int_desc(table, {{0}}, {false});
+    SortDescriptor by_string_int(table, {{1}, {0}}, {true, false});
+    for (size_t k : {size_t(0), size_t(1), size_t(50), size_t(2 * REALM_MAX_BPNODE_SIZE), num_rows + 1}) {
+        check(table.where(), by_int, k);
+        check(table.where().less(0, 250), by_int_desc, k);
+        check(table.where().equal(1, "foo"), by_string_int, k);
+    }
+
+    // The view keeps its limit when it is synchronized
+    Query q = table.where().greater(0, 100);
+    TableView top = q.find_top_k(by_int, 10);
+    CHECK_EQUAL(10, top.size());
+    table.set_int(0, 5, 0);
+    table.set_int(0, 6, 101);
+    top.sync_if_needed();
+    CHECK_EQUAL(10, top.size());
+    CHECK_EQUAL(6, top.get_source_ndx(0));
+    check(q, by_int, 10);
+
+    // Restricted by a view
+    TableView view = table.where().equal(1, "bar").find_all();
+    check(table.where(&view).less(0, 300), by_int_desc, 20);
+}
+
+TEST(Query_Cursor)
+{
+    Table table;
+    table.add_column(type_Int, "int");
+    table.add_column(type_String, "string");
+
+    const size_t num_rows = 3 * REALM_MAX_BPNODE_SIZE + 17;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_int(0, i, int64_t(i * 7919 % 1000));
+        table.set_string(1, i, i % 3 == 0 ? "foo" : "bar");
+    }
+
+    auto check = [&](Query q, size_t start, size_t end, size_t batch_size) {
+        TableView tv = q.find_all(start, end);
+        std::vector<size_t> rows;
+        std::vector<size_t> buffer(batch_size);
+        QueryCursor cursor = q.get_cursor(start, end);
+        while (!cursor.is_done()) {
+            size_t n = cursor.next(buffer.data(), batch_size);
+            CHECK(n == batch_size || cursor.is_done());
+            rows.insert(rows.end(), buffer.begin(), buffer.begin() + n);
+        }
+        CHECK_EQUAL(0, cursor.next(buffer.data(), batch_size));
+        CHECK_EQUAL(tv.size(), rows.size());
+        for (size_t i = 0; i < std::min(tv.size(), rows.size()); ++i)
+            CHECK_EQUAL(tv.get_source_ndx(i), rows[i]);
+    };
+
+    for (size_t batch_size : {1, 7, 1000}) {
+        check(table.where(), 0, size_t(-1), batch_size);
+        check(table.where(), 10, 20, batch_size);
+        check(table.where().less(0, 100), 0, size_t(-1), batch_size);
+        check(table.where().equal(1, "foo").greater(0, 500), 5, num_rows - 5, batch_size);
+        check(table.column<Int>(0) > 990, 0, size_t(-1), batch_size);
+        check(table.where().equal(0, 12345), 0, size_t(-1), batch_size);
+
+        TableView view = table.where().less(0, 500).find_all();
+        check(table.where(&view).equal(1, "bar"), 0, size_t(-1), batch_size);
+        check(table.where(&view).equal(1, "bar"), 100, 2000, batch_size);
+    }
+
+    // Modifications between batches reset the evaluation state
+    QueryCursor cursor = table.where().equal(0, 7).get_cursor();
+    size_t row;
+    CHECK_EQUAL(1, cursor.next(&row, 1));
+    table.set_int(0, num_rows - 1, 7);
+    table.remove(0);
+    std::vector<size_t> rest(num_rows);
+    size_t n = cursor.next(rest.data(), rest.size());
+    CHECK(cursor.is_done());
+    CHECK_GREATER(n, 0);
+    CHECK_EQUAL(num_rows - 2, rest[n - 1]);
+}
+
+TEST(Query_SelectivityStatistics)
+{
+    using tf = _impl::TableFriend;
+    using EqualNode = IntegerNode<IntegerColumn, Equal>;
+    Table table;
+    table.add_column(type_Int, "rare");
+    table.add_column(type_Int, "common");
+
+    const size_t num_rows = 10000;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_int(0, i, int64_t(i % 1000));
+        table.set_int(1, i, int64_t(i % 2));
+    }
+
+    CHECK_EQUAL(0.0, tf::get_query_match_dist(table, 0, typeid(EqualNode), "'rare' == 7"));
+
+    // Statistics learned by one execution are kept for the next, and do not
+    // change the result
+    Query q = table.where().equal(1, 1).equal(0, 7);
+    size_t count = q.count();
+    CHECK_EQUAL(num_rows / 1000, count);
+    double rare_dist = tf::get_query_match_dist(table, 0, typeid(EqualNode), "'rare' == 7");
+    CHECK_GREATER(rare_dist, 100.0);
+    CHECK_EQUAL(count, table.where().equal(1, 1).equal(0, 7).count());
+    CHECK_EQUAL(count, table.where().equal(0, 7).equal(1, 1).find_all().size());
+    CHECK_GREATER(tf::get_query_match_dist(table, 0, typeid(EqualNode), "'rare' == 7"), 100.0);
+
+    // Conditions of a different kind, or with a different value, on the same
+    // column are tracked separately
+    CHECK_EQUAL(0.0, tf::get_query_match_dist(table, 0, typeid(IntegerNode<IntegerColumn, Greater>), "'rare' > 7"));
+    CHECK_EQUAL(0.0, tf::get_query_match_dist(table, 0, typeid(EqualNode), "'rare' == 8"));
+
+    // Changes of the rows do not invalidate the statistics
+    table.set_int(0, 0, 7);
+    table.add_empty_row();
+    CHECK_GREATER(tf::get_query_match_dist(table, 0, typeid(EqualNode), "'rare' == 7"), 100.0);
+
+    // Adding a search index invalidates the statistics of its column
+    CHECK_NOT_EQUAL(0.0, tf::get_query_match_dist(table, 1, typeid(EqualNode), "'common' == 1"));
+    table.add_search_index(0);
+    CHECK_EQUAL(0.0, tf::get_query_match_dist(table, 0, typeid(EqualNode), "'rare' == 7"));
+    CHECK_NOT_EQUAL(0.0, tf::get_query_match_dist(table, 1, typeid(EqualNode), "'common' == 1"));
+    table.remove_search_index(0);
+
+    // Schema changes invalidate the statistics of the affected columns
+    table.where().equal(1, 1).equal(0, 7).count();
+    CHECK_NOT_EQUAL(0.0, tf::get_query_match_dist(table, 0, typeid(EqualNode), "'rare' == 7"));
+    table.insert_column(0, type_String, "first");
+    CHECK_EQUAL(0.0, tf::get_query_match_dist(table, 0, typeid(EqualNode), "'rare' == 7"));
+    CHECK_EQUAL(0.0, tf::get_query_match_dist(table, 1, typeid(EqualNode), "'rare' == 7"));
+}
+
+TEST(Query_SelectivityStatisticsAdvanceRead)
+{
+    using tf = _impl::TableFriend;
+    using EqualNode = IntegerNode<IntegerColumn, Equal>;
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+    Group& group = const_cast<Group&>(sg.begin_read());
+
+    std::unique_ptr<Replication> hist_w(make_in_realm_history(path));
+    SharedGroup sg_w(*hist_w, SharedGroupOptions(crypt_key()));
+    Group& group_w = const_cast<Group&>(sg_w.begin_read());
+
+    LangBindHelper::promote_to_write(sg_w);
+    TableRef table_w = group_w.add_table("table");
+    table_w->add_column(type_Int, "rare");
+    table_w->add_column(type_Int, "common");
+    table_w->add_empty_row(10000);
+    for (size_t i = 0; i < 10000; ++i) {
+        table_w->set_int(0, i, int64_t(i % 1000));
+        table_w->set_int(1, i, int64_t(i % 2));
+    }
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+
+    LangBindHelper::advance_read(sg);
+    ConstTableRef table = group.get_table("table");
+    CHECK_EQUAL(10, table->where().equal(1, 1).equal(0, 7).count());
+    double rare_dist = tf::get_query_match_dist(*table, 0, typeid(EqualNode), "'rare' == 7");
+    CHECK_GREATER(rare_dist, 100.0);
+
+    // The statistics survive changes of the rows by other transactions, and
+    // changes that are rolled back
+    LangBindHelper::promote_to_write(sg_w);
+    table_w->set_int(0, 0, 7);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+    LangBindHelper::advance_read(sg);
+    CHECK_EQUAL(rare_dist, tf::get_query_match_dist(*table, 0, typeid(EqualNode), "'rare' == 7"));
+    LangBindHelper::promote_to_write(sg);
+    group.get_table("table")->set_int(0, 1, 7);
+    LangBindHelper::rollback_and_continue_as_read(sg);
+    CHECK_EQUAL(rare_dist, tf::get_query_match_dist(*table, 0, typeid(EqualNode), "'rare' == 7"));
+
+    // But not a search index added by another transaction
+    LangBindHelper::promote_to_write(sg_w);
+    table_w->add_search_index(0);
+    LangBindHelper::commit_and_continue_as_read(sg_w);
+    LangBindHelper::advance_read(sg);
+    CHECK_EQUAL(0.0, tf::get_query_match_dist(*table, 0, typeid(EqualNode), "'rare' == 7"));
+}
+
+TEST(Query_Profile)
+{
+    Table table;
+    table.add_column(type_Int, "rare");
+    table.add_column(type_String, "parity");
+
+    const size_t num_rows = 5000;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_int(0, i, int64_t(i % 1000));
+        table.set_string(1, i, i % 2 ? "odd" : "even");
+    }
+
+    Query q = table.where().equal(1, "odd").equal(0, 7);
+    QueryProfile plan = q.explain();
+    CHECK_EQUAL(2, plan.conditions.size());
+    CHECK_EQUAL("'parity' == \"odd\"", plan.conditions[0].description);
+    CHECK_EQUAL("'rare' == 7", plan.conditions[1].description);
+    CHECK(plan.plan.empty());
+    CHECK_EQUAL(0, plan.num_rows);
+
+    QueryProfile profile = q.profile();
+    CHECK_EQUAL(num_rows, profile.num_rows);
+    CHECK_EQUAL(q.count(), profile.num_matches);
+    CHECK_EQUAL(num_rows / 1000, profile.num_matches);
+
+    // Every row and every match is accounted for once
+    size_t rows = 0;
+    for (const auto& step : profile.plan)
+        rows += step.second;
+    CHECK_EQUAL(num_rows, rows);
+    size_t matches = profile.bitmap_matches;
+    size_t leaves_loaded = 0;
+    for (const auto& c : profile.conditions) {
+        matches += c.matches;
+        leaves_loaded += c.leaves_loaded;
+    }
+    CHECK_EQUAL(profile.num_matches, matches);
+    CHECK_GREATER(leaves_loaded, 0);
+    CHECK_GREATER(profile.conditions[1].match_dist, profile.conditions[0].match_dist);
+
+    std::ostringstream text;
+    profile.to_string(text);
+    CHECK_NOT_EQUAL(std::string::npos, text.str().find("#1 'rare' == 7"));
+    std::ostringstream json;
+    profile.to_json(json);
+    CHECK_NOT_EQUAL(std::string::npos, json.str().find("{\"description\":\"'parity' == \\\"odd\\\"\""));
+
+    Query q2 = table.where().group().equal(0, 1).Or().equal(0, 2).end_group().not_equal(1, "odd");
+    QueryProfile or_profile = q2.profile();
+    CHECK_EQUAL(2, or_profile.conditions.size());
+    CHECK_EQUAL("('rare' == 1 || 'rare' == 2)", or_profile.conditions[0].description);
+    CHECK_EQUAL(q2.count(), or_profile.num_matches);
+    CHECK_EQUAL(num_rows / 1000, or_profile.num_matches);
+
+    // Queries restricted by a view are evaluated a row at a time
+    TableView tv = table.where().less(0, 100).find_all();
+    QueryProfile view_profile = table.where(&tv).equal(0, 7).profile();
+    CHECK_EQUAL(tv.size(), view_profile.num_rows);
+    CHECK_EQUAL(num_rows / 1000, view_profile.num_matches);
+    CHECK(view_profile.plan.empty());
+}
+
+TEST(Query_In)
+{
+    Table table;
+    table.add_column(type_Int, "id");
+    table.add_column(type_Int, "group", true);
+    table.add_column(type_String, "name", true);
+    table.add_column(type_Timestamp, "time", true);
+
+    const size_t num_rows = 3000;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_int(0, i, int64_t(i) * 1000);
+        if (i % 7 != 0)
+            table.set_int(1, i, int64_t(i % 50));
+        if (i % 11 != 0) {
+            std::string name = "name " + util::to_string(i % 100);
+            table.set_string(2, i, name);
+        }
+        if (i % 13 != 0)
+            table.set_timestamp(3, i, Timestamp(int64_t(i % 30), 0));
+    }
+
+    // Dense values are looked up in a bitmap, and sparse values by searching
+    std::vector<int64_t> dense_groups = {3, 1, 4, 1, 5, 9, 26, -5};
+    std::vector<int64_t> sparse_ids;
+    for (size_t i = 0; i < num_rows; i += 17)
+        sparse_ids.push_back(int64_t(i) * 1000);
+    sparse_ids.push_back(7);
+    std::vector<StringData> names = {"name 2", "name 37", "name 99", "name 1000", StringData()};
+    std::vector<Timestamp> times = {Timestamp(4, 0), Timestamp(29, 0), Timestamp(4, 1), Timestamp()};
+
+    auto expected_int = [&](size_t col, const std::vector<int64_t>& values) {
+        Query q = table.where().group();
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i != 0)
+                q.Or();
+            q.equal(col, values[i]);
+        }
+        return q.end_group().find_all();
+    };
+    auto expected_string = [&](const std::vector<StringData>& values) {
+        Query q = table.where().group();
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i != 0)
+                q.Or();
+            q.equal(2, values[i]);
+        }
+        return q.end_group().find_all();
+    };
+    auto expected_time = [&](const std::vector<Timestamp>& values) {
+        Query q = table.where().group();
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i != 0)
+                q.Or();
+            if (values[i].is_null())
+                q.equal(3, null());
+            else
+                q.equal(3, values[i]);
+        }
+        return q.end_group().find_all();
+    };
+    auto check_same = [&](const TableView& expected, const TableView& actual) {
+        CHECK_GREATER(expected.size(), 0);
+        if (CHECK_EQUAL(expected.size(), actual.size())) {
+            for (size_t i = 0; i < expected.size(); ++i)
+                CHECK_EQUAL(expected.get_source_ndx(i), actual.get_source_ndx(i));
+        }
+    };
+    auto check_all = [&] {
+        check_same(expected_int(0, sparse_ids), table.where().in(0, sparse_ids).find_all());
+        check_same(expected_int(1, dense_groups), table.where().in(1, dense_groups).find_all());
+        check_same(expected_string(names), table.where().in(2, names).find_all());
+        check_same(expected_time(times), table.where().in(3, times).find_all());
+
+        // Combined with other conditions
+        CHECK_EQUAL(table.where().equal(1, 5).greater(0, 1000000).count(),
+                    table.where().greater(0, 1000000).in(1, std::vector<int64_t>{5}).count());
+        CHECK_EQUAL(num_rows - expected_int(1, dense_groups).size(), table.where().Not().in(1, dense_groups).count());
+        CHECK_EQUAL(0, table.where().in(0, std::vector<int64_t>()).count());
+    };
+
+    check_all();
+    table.add_search_index(0);
+    table.add_search_index(2);
+    table.add_search_index(3);
+    check_all();
+    table.optimize(true);
+    CHECK(dynamic_cast<StringEnumColumn*>(&_impl::TableFriend::get_column(table, 2)));
+    check_all();
+    table.remove_search_index(2);
+    check_all();
+
+    CHECK_EQUAL("'group' IN (-5, 1, 3, 4, 5, 9, 26)",
+                table.where().in(1, dense_groups).explain().conditions[0].description);
+    CHECK_THROW(table.where().in(2, dense_groups), LogicError);
+}
+
+TEST(Query_OrIndexed)
+{
+    Table table;
+    table.add_column(type_Int, "int");
+    table.add_column(type_String, "string", true);
+    table.add_column(type_Timestamp, "time");
+    table.add_column(type_Int, "other");
+
+    const size_t num_rows = 2000;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_int(0, i, int64_t(i % 40));
+        if (i % 9 != 0) {
+            std::string str = "s" + util::to_string(i % 60);
+            table.set_string(1, i, str);
+        }
+        table.set_timestamp(2, i, Timestamp(int64_t(i % 70), 0));
+        table.set_int(3, i, int64_t(i % 3));
+    }
+
+    auto make_queries = [&] {
+        std::vector<Query> queries;
+        queries.push_back(table.where().equal(0, 3).Or().equal(1, "s7").Or().equal(2, Timestamp(11, 0)));
+        queries.push_back(table.where().equal(3, 1).group().equal(1, "s1").Or().equal(1, realm::null()).end_group());
+        queries.push_back(table.where().group().equal(0, 5).Or().in(1, {"s2", "s4", "nothing"}).end_group().less(3, 2));
+        queries.push_back(table.where().equal(0, 100).Or().equal(1, "nothing"));
+        // Not every alternative can be looked up in an index
+        queries.push_back(table.where().equal(0, 6).Or().equal(3, 2));
+        queries.push_back(table.where().equal(0, 6).Or().equal(1, "s6").equal(3, 0));
+        return queries;
+    };
+
+    std::vector<std::vector<size_t>> expected;
+    for (Query& q : make_queries()) {
+        TableView tv = q.find_all();
+        std::vector<size_t> rows;
+        for (size_t i = 0; i < tv.size(); ++i)
+            rows.push_back(tv.get_source_ndx(i));
+        expected.push_back(rows);
+    }
+
+    table.add_search_index(0);
+    table.add_search_index(1);
+    table.add_search_index(2);
+    std::vector<Query> queries = make_queries();
+    for (size_t i = 0; i < queries.size(); ++i) {
+        TableView tv = queries[i].find_all();
+        if (CHECK_EQUAL(expected[i].size(), tv.size())) {
+            for (size_t j = 0; j < tv.size(); ++j)
+                CHECK_EQUAL(expected[i][j], tv.get_source_ndx(j));
+        }
+        CHECK_EQUAL(expected[i].size(), queries[i].count());
+    }
+
+    // An OR of index lookups is looked up in the index, and drives the search
+    CHECK_EQUAL(0.0, queries[0].explain().conditions[0].row_cost);
+    CHECK_EQUAL(0.0, queries[1].explain().conditions[1].row_cost);
+    CHECK_EQUAL(0.0, queries[2].explain().conditions[0].row_cost);
+    CHECK_NOT_EQUAL(0.0, queries[4].explain().conditions[0].row_cost);
+    CHECK_NOT_EQUAL(0.0, queries[5].explain().conditions[0].row_cost);
+}
+
+TEST(Query_OrderedIndex)
+{
+    Table table;
+    table.add_column(type_Int, "int", true);
+    table.add_column(type_Timestamp, "time");
+    table.add_column(type_Double, "double");
+    table.add_column(type_Float, "float", true);
+    table.add_column(type_Int, "other");
+
+    const size_t num_rows = 3000;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        if (i % 11 == 0)
+            table.set_null(0, i);
+        else
+            table.set_int(0, i, int64_t((i * 7) % 500) - 250);
+        table.set_timestamp(1, i, Timestamp(int64_t(i % 300), int32_t(i % 7)));
+        table.set_double(2, i, double((i * 13) % 1000) / 4 - 100);
+        if (i % 5 == 0)
+            table.set_null(3, i);
+        else
+            table.set_float(3, i, float(i % 200) / 2);
+        table.set_int(4, i, int64_t(i % 4));
+    }
+
+    auto make_queries = [&] {
+        std::vector<Query> queries;
+        queries.push_back(table.where().greater(0, 200));
+        queries.push_back(table.where().between(0, -10, 10).equal(4, 1));
+        queries.push_back(table.where().not_equal(0, 3));
+        queries.push_back(table.where().less_equal(0, -240).Or().greater_equal(1, Timestamp(298, 0)));
+        queries.push_back(table.where().less(1, Timestamp(2, 3)));
+        queries.push_back(table.where().greater_equal(2, 140.0).less(4, 2));
+        queries.push_back(table.where().equal(2, -100.0));
+        queries.push_back(table.where().less(3, 1.0f));
+        queries.push_back(table.where().equal(0, realm::null()));
+        return queries;
+    };
+
+    auto results = [](Query& q) {
+        TableView tv = q.find_all();
+        std::vector<size_t> rows;
+        for (size_t i = 0; i < tv.size(); ++i)
+            rows.push_back(tv.get_source_ndx(i));
+        return rows;
+    };
+
+    auto check_queries = [&] {
+        std::vector<std::vector<size_t>> expected;
+        for (Query& q : make_queries())
+            expected.push_back(results(q));
+
+        for (size_t col = 0; col < 4; ++col)
+            table.add_ordered_index(col);
+        std::vector<Query> queries = make_queries();
+        for (size_t i = 0; i < queries.size(); ++i) {
+            CHECK(results(queries[i]) == expected[i]);
+            CHECK_EQUAL(expected[i].size(), queries[i].count());
+        }
+        for (size_t col = 0; col < 4; ++col)
+            table.remove_ordered_index(col);
+        return queries;
+    };
+
+    // Range conditions are looked up in the index, and drive the search
+    std::vector<Query> queries = check_queries();
+    for (size_t col = 0; col < 4; ++col)
+        table.add_ordered_index(col);
+    CHECK_EQUAL(0.0, queries[0].explain().conditions[0].row_cost);
+    CHECK_EQUAL(0.0, queries[1].explain().conditions[0].row_cost);
+    CHECK_EQUAL(0.0, queries[3].explain().conditions[0].row_cost);
+    CHECK_EQUAL(0.0, queries[5].explain().conditions[0].row_cost);
+    // Null is left to the query engine
+    CHECK_NOT_EQUAL(0.0, queries[8].explain().conditions[0].row_cost);
+
+    // The index is rebuilt after the table is modified
+    for (size_t i = 0; i < num_rows; i += 3)
+        table.set_int(0, i, 1000);
+    table.remove(17);
+    table.move_last_over(100);
+    for (size_t col = 0; col < 4; ++col)
+        table.remove_ordered_index(col);
+    check_queries();
+
+    // Sorted rows are read from the index until k matches are found
+    table.add_ordered_index(0);
+    table.add_ordered_index(1);
+    for (bool ascending : {true, false}) {
+        for (size_t col : {0, 1}) {
+            SortDescriptor order(table, {{col}}, {ascending});
+            Query q = table.where().equal(4, 2);
+            TableView top = q.find_top_k(order, 25);
+            TableView all = q.find_all();
+            all.sort(col, ascending);
+            if (CHECK_EQUAL(25, top.size())) {
+                for (size_t i = 0; i < top.size(); ++i)
+                    CHECK_EQUAL(all.get_source_ndx(i), top.get_source_ndx(i));
+            }
+        }
+    }
+}
+
+TEST(Query_CompositeIndex)
+{
+    Table table;
+    table.add_column(type_Int, "tenant");
+    table.add_column(type_Timestamp, "created", true);
+    table.add_column(type_Double, "amount");
+    table.add_column(type_Int, "other");
+
+    const size_t num_rows = 4000;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_int(0, i, int64_t(i % 13));
+        if (i % 17 != 0)
+            table.set_timestamp(1, i, Timestamp(int64_t((i * 31) % 1000), 0));
+        table.set_double(2, i, double(i % 7));
+        table.set_int(3, i, int64_t(i % 5));
+    }
+
+    auto make_queries = [&] {
+        std::vector<Query> queries;
+        queries.push_back(table.where().equal(0, 3).greater(1, Timestamp(500, 0)));
+        queries.push_back(table.where().less_equal(1, Timestamp(200, 0)).equal(3, 1).equal(0, 7));
+        queries.push_back(table.where().equal(0, 5).equal(1, Timestamp(186, 0)).less(2, 4.0));
+        queries.push_back(
+            table.where().equal(2, 3.0).equal(0, 4).greater_equal(1, Timestamp(100, 0)).less(1, Timestamp(900, 0)));
+        queries.push_back(table.where().equal(0, 3).Or().greater(1, Timestamp(990, 0)));
+        // No equality on the first column of an index
+        queries.push_back(table.where().greater(0, 10).less(1, Timestamp(100, 0)));
+        return queries;
+    };
+
+    auto results = [](Query& q) {
+        TableView tv = q.find_all();
+        std::vector<size_t> rows;
+        for (size_t i = 0; i < tv.size(); ++i)
+            rows.push_back(tv.get_source_ndx(i));
+        return rows;
+    };
+
+    auto check_queries = [&] {
+        std::vector<std::vector<size_t>> expected;
+        for (Query& q : make_queries())
+            expected.push_back(results(q));
+
+        table.add_composite_index({0, 1, 2});
+        table.add_composite_index({2, 0});
+        std::vector<Query> queries = make_queries();
+        for (size_t i = 0; i < queries.size(); ++i) {
+            CHECK(results(queries[i]) == expected[i]);
+            CHECK_EQUAL(expected[i].size(), queries[i].count());
+        }
+        table.remove_composite_index({0, 1, 2});
+        table.remove_composite_index({2, 0});
+        return queries;
+    };
+
+    // The first condition found in the index drives the search
+    std::vector<Query> queries = check_queries();
+    table.add_composite_index({0, 1, 2});
+    table.add_composite_index({2, 0});
+    CHECK_EQUAL(0.0, queries[0].explain().conditions[0].row_cost);
+    CHECK_EQUAL(0.0, queries[1].explain().conditions[2].row_cost);
+    CHECK_EQUAL(0.0, queries[2].explain().conditions[0].row_cost);
+    CHECK_EQUAL(0.0, queries[3].explain().conditions[1].row_cost);
+    CHECK_NOT_EQUAL(0.0, queries[5].explain().conditions[0].row_cost);
+    CHECK_NOT_EQUAL(0.0, queries[5].explain().conditions[1].row_cost);
+
+    // The index is rebuilt after the table is modified
+    for (size_t i = 0; i < num_rows; i += 7)
+        table.set_int(0, i, 3);
+    table.remove(11);
+    table.move_last_over(200);
+    table.insert_empty_row(5, 3);
+    table.remove_composite_index({0, 1, 2});
+    table.remove_composite_index({2, 0});
+    check_queries();
+}
+
+TEST(Query_HashIndex)
+{
+    Table table;
+    table.add_column(type_String, "url", true);
+    table.add_column(type_Int, "int");
+    table.add_column(type_Timestamp, "time");
+    table.add_column(type_Int, "other");
+
+    const size_t num_rows = 2000;
+    std::string prefix = "https://www.example.com/some/long/common/path/";
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        if (i % 9 != 0) {
+            std::string url = prefix + util::to_string(i % 150);
+            table.set_string(0, i, url);
+        }
+        table.set_int(1, i, int64_t(i % 40));
+        table.set_timestamp(2, i, Timestamp(int64_t(i % 25), 0));
+        table.set_int(3, i, int64_t(i % 3));
+    }
+
+    std::string url_7 = prefix + "7";
+    std::string url_149 = prefix + "149";
+    auto make_queries = [&] {
+        std::vector<Query> queries;
+        queries.push_back(table.where().equal(0, StringData(url_7)));
+        queries.push_back(table.where().equal(0, StringData(url_149)).equal(3, 2));
+        queries.push_back(table.where().equal(0, realm::null()));
+        queries.push_back(table.where().equal(0, "no such url"));
+        queries.push_back(table.where().equal(1, 12).Or().equal(2, Timestamp(3, 0)));
+        queries.push_back(table.where().equal(2, Timestamp(24, 0)).greater(1, 20));
+        queries.push_back(table.where().greater(1, 37));
+        return queries;
+    };
+
+    auto results = [](Query& q) {
+        TableView tv = q.find_all();
+        std::vector<size_t> rows;
+        for (size_t i = 0; i < tv.size(); ++i)
+            rows.push_back(tv.get_source_ndx(i));
+        return rows;
+    };
+
+    std::vector<std::vector<size_t>> expected;
+    for (Query& q : make_queries())
+        expected.push_back(results(q));
+    size_t first_7 = table.find_first_string(0, url_7);
+    size_t count_7 = table.count_string(0, url_7);
+    size_t first_12 = table.find_first_int(1, 12);
+    size_t count_12 = table.count_int(1, 12);
+    size_t first_3 = table.find_first_timestamp(2, Timestamp(3, 0));
+
+    for (size_t col = 0; col < 3; ++col)
+        table.add_hash_index(col);
+    std::vector<Query> queries = make_queries();
+    for (size_t i = 0; i < queries.size(); ++i) {
+        CHECK(results(queries[i]) == expected[i]);
+        CHECK_EQUAL(expected[i].size(), queries[i].count());
+    }
+    CHECK_EQUAL(first_7, table.find_first_string(0, url_7));
+    CHECK_EQUAL(count_7, table.count_string(0, url_7));
+    CHECK_EQUAL(first_12, table.find_first_int(1, 12));
+    CHECK_EQUAL(count_12, table.count_int(1, 12));
+    CHECK_EQUAL(first_3, table.find_first_timestamp(2, Timestamp(3, 0)));
+    CHECK_EQUAL(not_found, table.find_first_string(0, "no such url"));
+
+    // Equality conditions are looked up in the index, and drive the search
+    CHECK_EQUAL(0.0, queries[0].explain().conditions[0].row_cost);
+    CHECK_EQUAL(0.0, queries[1].explain().conditions[0].row_cost);
+    CHECK_EQUAL(0.0, queries[5].explain().conditions[0].row_cost);
+    CHECK_NOT_EQUAL(0.0, queries[6].explain().conditions[0].row_cost);
+
+    // The index follows the rows that are modified
+    table.set_string(0, 0, url_7);
+    table.set_int(1, 1, 12);
+    table.move_last_over(5);
+    CHECK_EQUAL(0, table.find_first_string(0, url_7));
+    CHECK_EQUAL(count_7 + 1, table.count_string(0, url_7));
+    CHECK_EQUAL(1, table.find_first_int(1, 12));
+    std::vector<std::vector<size_t>> indexed;
+    for (Query& q : make_queries())
+        indexed.push_back(results(q));
+    for (size_t col = 0; col < 3; ++col)
+        table.remove_hash_index(col);
+    queries = make_queries();
+    for (size_t i = 0; i < queries.size(); ++i)
+        CHECK(results(queries[i]) == indexed[i]);
+}
+
+TEST(Query_TrigramIndex)
+{
+    Table table;
+    table.add_column(type_String, "text", true);
+    table.add_column(type_Int, "int");
+
+    const char* words[] = {"alpha", "Beta", "gamma", "delta", "EPSILON", "zeta", "\xc3\x86" "bler", "theta"};
+    const size_t num_rows = 1500;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        if (i % 13 != 0) {
+            std::string text = std::string(words[i % 8]) + " " + words[(i / 8) % 8] + " " + util::to_string(i % 97);
+            table.set_string(0, i, text);
+        }
+        table.set_int(1, i, int64_t(i % 5));
+    }
+
+    auto make_queries = [&] {
+        std::vector<Query> queries;
+        queries.push_back(table.where().contains(0, "ta gam"));
+        queries.push_back(table.where().contains(0, "ETA ALP", false));
+        queries.push_back(table.where().contains(0, "\xc3\x86" "BLER Z", false));
+        queries.push_back(table.where().like(0, "*psilon*9?"));
+        queries.push_back(table.where().like(0, "BETA*THETA*", false));
+        queries.push_back(table.where().ends_with(0, "theta 42"));
+        queries.push_back(table.where().ends_with(0, "DELTA 7", false));
+        queries.push_back(table.where().begins_with(0, "zeta beta").equal(1, 3));
+        queries.push_back(table.where().begins_with(0, "GAMMA", false));
+        queries.push_back(table.where().contains(0, "no such text"));
+        queries.push_back(table.where().contains(0, "ta"));
+        return queries;
+    };
+
+    auto results = [](Query& q) {
+        TableView tv = q.find_all();
+        std::vector<size_t> rows;
+        for (size_t i = 0; i < tv.size(); ++i)
+            rows.push_back(tv.get_source_ndx(i));
+        return rows;
+    };
+
+    std::vector<std::vector<size_t>> expected;
+    for (Query& q : make_queries())
+        expected.push_back(results(q));
+    CHECK(!expected[0].empty());
+    CHECK(!expected[1].empty());
+    CHECK(!expected[2].empty());
+    CHECK(!expected[4].empty());
+
+    table.add_trigram_index(0);
+    std::vector<Query> queries = make_queries();
+    for (size_t i = 0; i < queries.size(); ++i) {
+        CHECK(results(queries[i]) == expected[i]);
+        CHECK_EQUAL(expected[i].size(), queries[i].count());
+    }
+
+    // Patterns with a trigram only check the candidate rows
+    CHECK_EQUAL(0.0, queries[0].explain().conditions[0].row_cost);
+    CHECK_EQUAL(0.0, queries[1].explain().conditions[0].row_cost);
+    CHECK_EQUAL(0.0, queries[3].explain().conditions[0].row_cost);
+    CHECK_NOT_EQUAL(0.0, queries[10].explain().conditions[0].row_cost);
+
+    // The index is rebuilt after the table is modified
+    table.set_string(0, 0, "ta gamma");
+    table.move_last_over(1);
+    std::vector<std::vector<size_t>> indexed;
+    for (Query& q : make_queries())
+        indexed.push_back(results(q));
+    CHECK_EQUAL(0, indexed[0][0]);
+    table.remove_trigram_index(0);
+    queries = make_queries();
+    for (size_t i = 0; i < queries.size(); ++i)
+        CHECK(results(queries[i]) == indexed[i]);
+}
+
+TEST(Query_FullTextIndex)
+{
+    Table table;
+    table.add_column(type_String, "description", true);
+    table.add_column(type_Int, "int");
+
+    const char* words[] = {"Fast", "slow", "red", "blue", "car", "bike", "boat", "plane", "new"};
+    const size_t num_rows = 1200;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        if (i % 11 != 0) {
+            std::string text = std::string(words[i % 9]) + ", " + words[(i / 9) % 9] + " " + words[(i / 81) % 9] +
+                               "-" + util::to_string(i % 7);
+            table.set_string(0, i, text);
+        }
+        table.set_int(1, i, int64_t(i % 4));
+    }
+
+    auto make_queries = [&] {
+        std::vector<Query> queries;
+        queries.push_back(table.where().matches(0, "car"));
+        queries.push_back(table.where().matches(0, "RED fast"));
+        queries.push_back(table.where().matches(0, "blue, boat 3").equal(1, 2));
+        queries.push_back(table.where().matches(0, "car").Or().matches(0, "plane"));
+        queries.push_back(table.where().matches(0, "train"));
+        queries.push_back(table.where().matches(0, ""));
+        return queries;
+    };
+
+    auto results = [](Query& q) {
+        TableView tv = q.find_all();
+        std::vector<size_t> rows;
+        for (size_t i = 0; i < tv.size(); ++i)
+            rows.push_back(tv.get_source_ndx(i));
+        return rows;
+    };
+
+    std::vector<std::vector<size_t>> expected;
+    for (Query& q : make_queries())
+        expected.push_back(results(q));
+    CHECK(!expected[1].empty());
+    CHECK(!expected[2].empty());
+    CHECK(expected[4].empty());
+    CHECK_EQUAL(num_rows, expected[5].size());
+    CHECK_LOGIC_ERROR(table.where().matches(1, "car"), LogicError::type_mismatch);
+
+    table.add_fulltext_index(0);
+    std::vector<Query> queries = make_queries();
+    for (size_t i = 0; i < queries.size(); ++i) {
+        CHECK(results(queries[i]) == expected[i]);
+        CHECK_EQUAL(expected[i].size(), queries[i].count());
+    }
+
+    // The condition is looked up in the index, and drives the search
+    CHECK_EQUAL(0.0, queries[0].explain().conditions[0].row_cost);
+    CHECK_EQUAL(0.0, queries[2].explain().conditions[0].row_cost);
+
+    // The index is rebuilt after the table is modified
+    table.set_string(0, 0, "a red, fast car");
+    table.move_last_over(1);
+    std::vector<std::vector<size_t>> indexed;
+    for (Query& q : make_queries())
+        indexed.push_back(results(q));
+    CHECK_EQUAL(0, indexed[1][0]);
+    table.remove_fulltext_index(0);
+    queries = make_queries();
+    for (size_t i = 0; i < queries.size(); ++i)
+        CHECK(results(queries[i]) == indexed[i]);
+}
+
+TEST(Query_CaseFoldIndex)
+{
+    Table table;
+    table.add_column(type_String, "name", true);
+    table.add_column(type_Int, "int");
+
+    const char* names[] = {"Anna", "ANNABELLE", "bob", "Bobby", "carl", "CARLA", "", "anna-Lena"};
+    const size_t num_rows = 1000;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        if (i % 17 != 0)
+            table.set_string(0, i, names[i % 8]);
+        table.set_int(1, i, int64_t(i % 3));
+    }
+
+    auto make_queries = [&] {
+        std::vector<Query> queries;
+        queries.push_back(table.where().equal(0, "anna", false));
+        queries.push_back(table.where().equal(0, "BOB", false).equal(1, 1));
+        queries.push_back(table.where().equal(0, "", false));
+        queries.push_back(table.where().begins_with(0, "ANNA", false));
+        queries.push_back(table.where().begins_with(0, "car", false));
+        queries.push_back(table.where().ends_with(0, "LA", false));
+        queries.push_back(table.where().contains(0, "nAB", false));
+        queries.push_back(table.where().contains(0, "", false));
+        queries.push_back(table.where().equal(0, "Bob"));
+        queries.push_back(table.where().equal(0, realm::null(), false));
+        return queries;
+    };
+
+    auto results = [](Query& q) {
+        TableView tv = q.find_all();
+        std::vector<size_t> rows;
+        for (size_t i = 0; i < tv.size(); ++i)
+            rows.push_back(tv.get_source_ndx(i));
+        return rows;
+    };
+
+    std::vector<std::vector<size_t>> expected;
+    for (Query& q : make_queries())
+        expected.push_back(results(q));
+    for (size_t i = 0; i < 8; ++i)
+        CHECK(!expected[i].empty());
+
+    table.add_case_fold_index(0);
+    std::vector<Query> queries = make_queries();
+    for (size_t i = 0; i < queries.size(); ++i) {
+        CHECK(results(queries[i]) == expected[i]);
+        CHECK_EQUAL(expected[i].size(), queries[i].count());
+    }
+
+    // Equal and begins with conditions are looked up in the index
+    CHECK_EQUAL(0.0, queries[0].explain().conditions[0].row_cost);
+    CHECK_EQUAL(0.0, queries[3].explain().conditions[0].row_cost);
+    CHECK_NOT_EQUAL(0.0, queries[5].explain().conditions[0].row_cost);
+
+    // The index follows the rows that are modified
+    table.set_string(0, 0, "aNNa");
+    table.move_last_over(1);
+    std::vector<std::vector<size_t>> indexed;
+    for (Query& q : make_queries())
+        indexed.push_back(results(q));
+    CHECK_EQUAL(0, indexed[0][0]);
+    table.remove_case_fold_index(0);
+    queries = make_queries();
+    for (size_t i = 0; i < queries.size(); ++i)
+        CHECK(results(queries[i]) == indexed[i]);
+}
+
 #endif // TEST_QUERY
@@ -0,0 +1,148 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_ROW_BITMAP
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <vector>
+
+#include <realm/row_bitmap.hpp>
+#include <realm/utilities.hpp>
+
+#include "test.hpp"
+
+using namespace realm;
+
+
+namespace {
+
+std::vector<size_t> to_vector(const RowBitmap& bitmap)
+{
+    std::vector<size_t> rows;
+    bitmap.for_each([&](size_t row) { rows.push_back(row); });
+    return rows;
+}
+
+} // anonymous namespace
+
+
+TEST(RowBitmap_Basic)
+{
+    RowBitmap bitmap;
+    CHECK(bitmap.empty());
+    CHECK_EQUAL(0, bitmap.size());
+    CHECK(!bitmap.contains(0));
+
+    // Out of order, duplicates, and several chunks
+    std::vector<size_t> rows = {5, 3, 70000, 3, 0, 65535, 65536, 1000000, 4};
+    for (size_t row : rows)
+        bitmap.add(row);
+    std::vector<size_t> expected = {0, 3, 4, 5, 65535, 65536, 70000, 1000000};
+    CHECK_EQUAL(expected.size(), bitmap.size());
+    CHECK(to_vector(bitmap) == expected);
+    for (size_t row : expected)
+        CHECK(bitmap.contains(row));
+    CHECK(!bitmap.contains(1));
+    CHECK(!bitmap.contains(65537));
+    CHECK(!bitmap.contains(2000000));
+
+    bitmap.clear();
+    CHECK(bitmap.empty());
+    CHECK(to_vector(bitmap).empty());
+}
+
+
+TEST(RowBitmap_Dense)
+{
+    // A dense chunk is converted to a bitmap, which is much smaller than a
+    // column of 64-bit row indexes
+    RowBitmap bitmap;
+    std::set<size_t> reference;
+    for (size_t row = 0; row < 200000; row += 3) {
+        bitmap.add(row);
+        reference.insert(row);
+    }
+    // Insertion into the middle of a dense chunk
+    for (size_t row = 1; row < 10000; row += 7) {
+        bitmap.add(row);
+        reference.insert(row);
+    }
+    CHECK_EQUAL(reference.size(), bitmap.size());
+    CHECK(to_vector(bitmap) == std::vector<size_t>(reference.begin(), reference.end()));
+    CHECK_LESS(bitmap.get_memory_usage(), reference.size() * sizeof(int64_t) / 8);
+
+    RowBitmap range;
+    range.add_range(10, 200000);
+    CHECK_EQUAL(200000 - 10, range.size());
+    CHECK(!range.contains(9));
+    CHECK(range.contains(10));
+    CHECK(range.contains(131072));
+    CHECK(range.contains(199999));
+    CHECK(!range.contains(200000));
+}
+
+
+TEST(RowBitmap_SetOperations)
+{
+    for (int iter = 0; iter < 10; ++iter) {
+        // Vary the density so that all combinations of representations occur
+        size_t modulo_1 = 1 + fastrand(20), modulo_2 = 1 + fastrand(20);
+        RowBitmap a, b;
+        std::set<size_t> ref_a, ref_b;
+        for (size_t i = 0; i < 30000; ++i) {
+            size_t row = size_t(fastrand(300000));
+            if (row % modulo_1 == 0) {
+                a.add(row);
+                ref_a.insert(row);
+            }
+            row = size_t(fastrand(300000));
+            if (row % modulo_2 == 0) {
+                b.add(row);
+                ref_b.insert(row);
+            }
+        }
+        CHECK(to_vector(a) == std::vector<size_t>(ref_a.begin(), ref_a.end()));
+
+        std::vector<size_t> intersection, union_;
+        std::set_intersection(ref_a.begin(), ref_a.end(), ref_b.begin(), ref_b.end(),
+                              std::back_inserter(intersection));
+        std::set_union(ref_a.begin(), ref_a.end(), ref_b.begin(), ref_b.end(), std::back_inserter(union_));
+
+        RowBitmap c = a;
+        c &= b;
+        CHECK_EQUAL(intersection.size(), c.size());
+        CHECK(to_vector(c) == intersection);
+
+        RowBitmap d = a;
+        d |= b;
+        CHECK_EQUAL(union_.size(), d.size());
+        CHECK(to_vector(d) == union_);
+
+        // Equality does not depend on the representation
+        RowBitmap e;
+        for (size_t row : intersection)
+            e.add(row);
+        CHECK(c == e);
+        CHECK(d != e || intersection == union_);
+    }
+}
+
+#endif // TEST_ROW_BITMAP
@@ -2772,6 +2772,192 @@ TEST(Shared_CompactEmpty)
 }
 
 
+TEST(Shared_VersionRetention)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    size_t num_lag_calls = 0;
+    SharedGroup::version_type lag_oldest = 0;
+    SharedGroupOptions options(crypt_key());
+    options.max_version_lag = 2;
+    options.version_lag_callback = [&](uint_fast64_t oldest, uint_fast64_t, size_t) {
+        ++num_lag_calls;
+        lag_oldest = oldest;
+    };
+    SharedGroup sg_w(path, false, options);
+    SharedGroup sg_r(path, false, SharedGroupOptions(crypt_key()));
+    {
+        WriteTransaction wt(sg_w);
+        TableRef table = wt.add_table("table");
+        table->add_column(type_Int, "int");
+        table->add_empty_row(1000);
+        wt.commit();
+    }
+
+    sg_r.begin_read();
+    SharedGroup::VersionID pinned = sg_r.pin_version();
+    sg_r.end_read();
+    SharedGroup::RetentionStats stats = sg_r.get_retention_stats();
+    CHECK_EQUAL(1, stats.num_local_pins);
+    CHECK_EQUAL(pinned.version, stats.local_oldest_version);
+
+    for (int i = 0; i < 4; ++i) {
+        WriteTransaction wt(sg_w);
+        TableRef table = wt.get_table("table");
+        for (size_t row = 0; row < table->size(); ++row)
+            table->set_int(0, row, i * 1000 + row);
+        wt.commit();
+    }
+    CHECK_EQUAL(2, num_lag_calls);
+    CHECK_EQUAL(pinned.version, lag_oldest);
+    stats = sg_w.get_retention_stats();
+    CHECK_EQUAL(pinned.version, stats.oldest_version);
+    CHECK_EQUAL(pinned.version + 4, stats.latest_version);
+    CHECK_EQUAL(1, stats.num_oldest_readers);
+    CHECK_EQUAL(0, stats.num_local_pins);
+    CHECK_EQUAL(std::numeric_limits<SharedGroup::version_type>::max(), stats.local_oldest_version);
+    CHECK_GREATER(stats.locked_space, 0);
+
+    sg_r.unpin_version(pinned);
+    stats = sg_r.get_retention_stats();
+    CHECK_EQUAL(0, stats.num_local_pins);
+    CHECK_EQUAL(0, stats.num_oldest_readers);
+    {
+        WriteTransaction wt(sg_w);
+        wt.get_table("table")->set_int(0, 0, 7);
+        wt.commit();
+    }
+    CHECK_EQUAL(2, num_lag_calls);
+    CHECK_EQUAL(2, sg_w.get_number_of_versions());
+
+    // Pins are identified by version and reader index
+    sg_r.begin_read();
+    SharedGroup::VersionID pinned_1 = sg_r.pin_version();
+    sg_r.end_read();
+    {
+        WriteTransaction wt(sg_w);
+        wt.get_table("table")->set_int(0, 0, 8);
+        wt.commit();
+    }
+    sg_r.begin_read();
+    SharedGroup::VersionID pinned_2 = sg_r.pin_version();
+    sg_r.end_read();
+    CHECK_EQUAL(2, sg_r.get_retention_stats().num_local_pins);
+    sg_r.unpin_version(pinned_1);
+    stats = sg_r.get_retention_stats();
+    CHECK_EQUAL(1, stats.num_local_pins);
+    CHECK_EQUAL(pinned_2.version, stats.local_oldest_version);
+
+    // Closing the SharedGroup forgets its pins
+    sg_r.close();
+    sg_r.open(path, false, SharedGroupOptions(crypt_key()));
+    stats = sg_r.get_retention_stats();
+    CHECK_EQUAL(0, stats.num_local_pins);
+    CHECK_EQUAL(std::numeric_limits<SharedGroup::version_type>::max(), stats.local_oldest_version);
+}
+
+
+TEST(Shared_VersionLagCallbackThrows)
+{
+    // The callback runs after the write transaction has ended, so an exception
+    // from it does not affect the commit
+    SHARED_GROUP_TEST_PATH(path);
+    SharedGroupOptions options(crypt_key());
+    options.max_version_lag = 1;
+    options.version_lag_callback = [](uint_fast64_t, uint_fast64_t, size_t) { throw std::runtime_error("lag"); };
+    SharedGroup sg_w(path, false, options);
+    SharedGroup sg_r(path, false, SharedGroupOptions(crypt_key()));
+    {
+        WriteTransaction wt(sg_w);
+        wt.add_table("table")->add_column(type_Int, "int");
+        wt.commit();
+    }
+    sg_r.begin_read();
+
+    for (int i = 0; i < 2; ++i) {
+        Group& group = sg_w.begin_write();
+        group.get_table("table")->add_empty_row();
+        if (i == 0) {
+            sg_w.commit();
+        }
+        else {
+            CHECK_THROW(sg_w.commit(), std::runtime_error);
+        }
+    }
+    CHECK_EQUAL(SharedGroup::transact_Ready, sg_w.get_transact_stage());
+
+    // The commit is visible, and the write mutex has been released
+    sg_r.end_read();
+    {
+        ReadTransaction rt(sg_r);
+        CHECK_EQUAL(2, rt.get_table("table")->size());
+    }
+    {
+        WriteTransaction wt(sg_w);
+        wt.get_table("table")->add_empty_row();
+        wt.commit();
+    }
+}
+
+
+TEST(Shared_ManyPinnedVersions)
+{
+    // Pinned versions hold on to their ringbuffer entries, so the ringbuffer
+    // is expanded several times while a reader opened up front keeps using it.
+    // The ringbuffer must grow before it runs full, and since room for the
+    // next expansion is reserved up front, the reader must remap less often
+    // than the ringbuffer expands.
+    using sgf = _impl::SharedGroupFriend;
+    SHARED_GROUP_TEST_PATH(path);
+    SharedGroup sg_w(path, false, SharedGroupOptions(crypt_key()));
+    SharedGroup sg_r(path, false, SharedGroupOptions(crypt_key()));
+    {
+        WriteTransaction wt(sg_w);
+        wt.add_table("table")->add_column(type_Int, "int");
+        wt.commit();
+    }
+    std::vector<SharedGroup::VersionID> pinned;
+    uint_fast32_t entries = sgf::get_num_reader_entries(sg_w);
+    uint_fast32_t mapped = sgf::get_num_mapped_reader_entries(sg_r);
+    int num_expansions = 0, num_reader_remaps = 0;
+    for (int i = 0; i < 300; ++i) {
+        {
+            WriteTransaction wt(sg_w);
+            wt.get_table("table")->add_empty_row();
+            wt.commit();
+        }
+        uint_fast32_t new_entries = sgf::get_num_reader_entries(sg_w);
+        if (new_entries != entries)
+            ++num_expansions;
+        entries = new_entries;
+        CHECK_LESS_EQUAL(pinned.size() + 1, entries - entries / 4 + 1);
+
+        sg_r.begin_read();
+        pinned.push_back(sg_r.pin_version());
+        sg_r.end_read();
+        uint_fast32_t new_mapped = sgf::get_num_mapped_reader_entries(sg_r);
+        if (new_mapped != mapped)
+            ++num_reader_remaps;
+        mapped = new_mapped;
+    }
+    CHECK_GREATER_EQUAL(num_expansions, 3);
+    CHECK_GREATER(num_reader_remaps, 0);
+    CHECK_LESS(num_reader_remaps, num_expansions);
+    CHECK_EQUAL(pinned.size(), sg_r.get_retention_stats().num_local_pins);
+    for (size_t i = 0; i < pinned.size(); ++i) {
+        const Group& g = sg_w.begin_read(pinned[i]);
+        CHECK_EQUAL(i + 1, g.get_table("table")->size());
+        sg_w.end_read();
+    }
+    for (auto version : pinned)
+        sg_r.unpin_version(version);
+    {
+        WriteTransaction wt(sg_w);
+        wt.commit();
+    }
+    CHECK_EQUAL(2, sg_w.get_number_of_versions());
+}
+
+
 TEST(Shared_VersionOfBoundSnapshot)
 {
     SHARED_GROUP_TEST_PATH(path);
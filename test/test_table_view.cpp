@@ -26,6 +26,7 @@
 #include <cwchar>
 
 #include <realm/table_macros.hpp>
+#include <realm/util/thread_pool.hpp>
 
 #include "util/misc.hpp"
 
@@ -3431,4 +3432,238 @@ TEST(TableView_InsertColumnsAfterSort)
     CHECK_EQUAL(tv.get_int(2, 10), 0);
 }
 
+TEST(TableView_SortLarge)
+{
+    Table table;
+    table.add_column(type_Int, "nullable int", true);
+    table.add_column(type_Int, "int");
+    table.add_column(type_Double, "double");
+    table.add_column(type_Timestamp, "timestamp", true);
+    table.add_column(type_String, "string", true);
+
+    // Enough rows for integer columns to be radix sorted, with many equal
+    // values so that the order of equal rows is checked too
+    const size_t num_rows = 3000;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        size_t r = (i * 7919) % 1009;
+        if (r % 11 == 0)
+            table.set_null(0, i);
+        else
+            table.set_int(0, i, int64_t(r % 97) - 48 + (r % 5 == 0 ? int64_t(1) << 40 : 0));
+        table.set_int(1, i, int64_t(r % 13) * -1000000007);
+        table.set_double(2, i, double(r % 31) / 7);
+        if (r % 7 == 0)
+            table.set_null(3, i);
+        else
+            table.set_timestamp(3, i, Timestamp(int64_t(r % 17) - 8, int32_t(r % 3)));
+        if (r % 23 != 0) {
+            std::string str = std::string(1, char('a' + r % 26)) + "-" + util::to_string(r % 4);
+            table.set_string(4, i, str);
+        }
+    }
+
+    // The order the column compares rows in, with equal rows in view order
+    auto check_sorted = [&](const TableView& tv, std::vector<size_t> rows, std::vector<size_t> cols,
+                            std::vector<bool> ascending) {
+        std::stable_sort(rows.begin(), rows.end(), [&](size_t a, size_t b) {
+            for (size_t i = 0; i < cols.size(); ++i) {
+                const ColumnBase& col = _impl::TableFriend::get_column(table, cols[i]);
+                if (int c = col.compare_values(a, b))
+                    return ascending[i] ? c > 0 : c < 0;
+            }
+            return false;
+        });
+        CHECK_EQUAL(rows.size(), tv.size());
+        bool equal = true;
+        for (size_t i = 0; i < rows.size() && i < tv.size(); ++i)
+            equal = equal && rows[i] == tv.get_source_ndx(i);
+        CHECK(equal);
+    };
+
+    std::vector<size_t> all_rows;
+    for (size_t i = 0; i < num_rows; ++i)
+        all_rows.push_back(i);
+
+    for (size_t col = 0; col < 5; ++col) {
+        for (bool ascending : {true, false}) {
+            TableView tv = table.where().find_all();
+            tv.sort(col, ascending);
+            check_sorted(tv, all_rows, {col}, {ascending});
+
+            // Sorting a sorted view keeps the order of its equal rows
+            std::vector<size_t> rows;
+            for (size_t i = 0; i < tv.size(); ++i)
+                rows.push_back(tv.get_source_ndx(i));
+            size_t other = (col + 1) % 5;
+            tv.sort(other, !ascending);
+            check_sorted(tv, rows, {other}, {!ascending});
+        }
+    }
+
+    TableView tv = table.where().greater(1, -5000000035).find_all();
+    std::vector<size_t> rows;
+    for (size_t i = 0; i < tv.size(); ++i)
+        rows.push_back(tv.get_source_ndx(i));
+    tv.sort(SortDescriptor(table, {{4}, {0}, {3}}, {true, false, true}));
+    check_sorted(tv, rows, {4, 0, 3}, {true, false, true});
+}
+
+TEST(TableView_ParallelSortAndDistinct)
+{
+    Group group;
+    TableRef table = group.add_table("table");
+    table->add_column(type_Int, "int");
+    table->add_column(type_Double, "double", true);
+    table->add_column(type_String, "string");
+    TableRef origin = group.add_table("origin");
+    origin->add_column_link(type_LinkList, "links", *table);
+
+    const size_t num_rows = RowIndexes::parallel_sort_threshold + 5000;
+    table->add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        size_t r = (i * 48271) % 65521;
+        table->set_int(0, i, int64_t(r % 1000));
+        if (r % 19 == 0)
+            table->set_null(1, i);
+        else
+            table->set_double(1, i, double(r % 3001) / 3 - 500);
+        std::string str = util::to_string(r % 211);
+        table->set_string(2, i, str);
+    }
+    origin->add_empty_row();
+    LinkViewRef links = origin->get_linklist(0, 0);
+    for (size_t i = 0; i < num_rows; ++i)
+        links->add((i * 7) % num_rows);
+
+    util::ThreadPool pool(3);
+    auto rows_of = [](const RowIndexes& view) {
+        std::vector<int64_t> rows;
+        for (size_t i = 0; i < view.m_row_indexes.size(); ++i)
+            rows.push_back(view.m_row_indexes.get(i));
+        return rows;
+    };
+
+    std::vector<SortDescriptor> orders;
+    orders.emplace_back(*table, std::vector<std::vector<size_t>>{{1}}, std::vector<bool>{true});
+    orders.emplace_back(*table, std::vector<std::vector<size_t>>{{2}}, std::vector<bool>{false});
+    orders.emplace_back(*table, std::vector<std::vector<size_t>>{{2}, {1}}, std::vector<bool>{true, false});
+    for (const SortDescriptor& order : orders) {
+        TableView serial = table->where().find_all();
+        serial.sort(order);
+        TableView parallel = table->where().find_all();
+        parallel.set_thread_pool(&pool);
+        parallel.sort(order);
+        CHECK(rows_of(serial) == rows_of(parallel));
+    }
+
+    // Distinct keeps the first of the equal rows, in view order, or sorted
+    std::vector<SortDescriptor> columns;
+    columns.emplace_back(*table, std::vector<std::vector<size_t>>{{0}});
+    columns.emplace_back(*table, std::vector<std::vector<size_t>>{{2}, {1}});
+    for (const SortDescriptor& cols : columns) {
+        TableView serial = table->where().find_all();
+        serial.sort(orders[0]);
+        serial.distinct(cols);
+        TableView parallel = table->where().find_all();
+        parallel.set_thread_pool(&pool);
+        parallel.sort(orders[0]);
+        parallel.distinct(cols);
+        CHECK(rows_of(serial) == rows_of(parallel));
+        CHECK_LESS(parallel.size(), num_rows);
+
+        // The view is sorted and made distinct again when synced
+        table->set_int(0, 0, 1000);
+        serial.sync_if_needed();
+        parallel.sync_if_needed();
+        CHECK(rows_of(serial) == rows_of(parallel));
+    }
+
+    std::vector<int64_t> expected;
+    {
+        TableView tv = links->get_sorted_view(orders[2]);
+        expected = rows_of(tv);
+    }
+    links->sort(orders[2], &pool);
+    std::vector<int64_t> sorted;
+    for (size_t i = 0; i < links->size(); ++i)
+        sorted.push_back(links->get(i).get_index());
+    CHECK(sorted == expected);
+}
+
+
+TEST(TableView_SyncChangedRows)
+{
+    Table table;
+    table.add_column(type_Int, "int");
+    table.add_column(type_String, "string", true);
+    const size_t num_rows = 1000;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_int(0, i, int64_t(i * 37 % 101));
+        if (i % 7 != 0) {
+            std::string str = util::to_string(i % 13);
+            table.set_string(1, i, str);
+        }
+    }
+
+    auto rows_of = [](const RowIndexes& view) {
+        std::vector<int64_t> rows;
+        for (size_t i = 0; i < view.m_row_indexes.size(); ++i)
+            rows.push_back(view.m_row_indexes.get(i));
+        return rows;
+    };
+    SortDescriptor order(table, {{1}, {0}}, {true, false});
+
+    // Views that are kept up to date by checking the changed rows only, and
+    // views that rerun their query, which must give the same rows
+    TableView unsorted = table.where().greater(0, 50).find_all();
+    TableView sorted = table.where().greater(0, 50).find_all();
+    sorted.sort(order);
+    TableView all = table.where().find_all();
+    TableView limited = table.where().greater(0, 50).find_all(0, size_t(-1), 100);
+    auto check = [&] {
+        unsorted.sync_if_needed();
+        sorted.sync_if_needed();
+        all.sync_if_needed();
+        limited.sync_if_needed();
+        TableView expected = table.where().greater(0, 50).find_all();
+        CHECK(rows_of(unsorted) == rows_of(expected));
+        expected.sort(order);
+        CHECK(rows_of(sorted) == rows_of(expected));
+        CHECK_EQUAL(table.size(), all.size());
+        CHECK_EQUAL(std::min(expected.size(), size_t(100)), limited.size());
+    };
+
+    for (size_t i = 0; i < 20; ++i) {
+        size_t row_ndx = i * 7919 % table.size();
+        table.set_int(0, row_ndx, int64_t(i * 13 % 101));
+        table.set_null(1, (row_ndx * 3) % table.size());
+        table.set_string(1, (row_ndx * 5) % table.size(), "7");
+        check();
+
+        table.insert_empty_row(row_ndx);
+        table.set_int(0, row_ndx, 90);
+        table.add_empty_row();
+        table.set_int(0, table.size() - 1, int64_t(50 + i % 3));
+        table.remove((row_ndx * 11) % table.size());
+        table.move_last_over((row_ndx * 13) % table.size());
+        check();
+
+        // Changes that are not made row by row make the views rerun their
+        // queries
+        if (i == 10) {
+            table.swap_rows(1, 2);
+            check();
+        }
+    }
+
+    table.clear();
+    check();
+    table.add_empty_row(3);
+    table.set_int(0, 1, 51);
+    check();
+    CHECK_EQUAL(1, sorted.size());
+}
+
 #endif // TEST_TABLE_VIEW
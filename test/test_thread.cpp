@@ -21,6 +21,7 @@
 
 #include <cstring>
 #include <algorithm>
+#include <atomic>
 #include <queue>
 #include <functional>
 #include <mutex>
@@ -33,6 +34,7 @@
 #include <realm/utilities.hpp>
 #include <realm/util/features.h>
 #include <realm/util/thread.hpp>
+#include <realm/util/thread_pool.hpp>
 #ifndef _WIN32
 #include <realm/util/interprocess_condvar.hpp>
 #endif
@@ -528,6 +530,52 @@ TEST(Thread_CondVar)
     }
 }
 
+
+TEST(Thread_ThreadPool)
+{
+    ThreadPool pool(3);
+    CHECK_EQUAL(4, pool.get_num_threads());
+
+    // Every task is executed exactly once, also when tasks differ in cost
+    for (size_t num_tasks : {0, 1, 2, 5, 1000}) {
+        std::vector<int> counts(num_tasks);
+        std::vector<int> busy(pool.get_num_threads());
+        std::atomic<bool> overlap(false);
+        pool.run(num_tasks, [&](size_t task_ndx, size_t thread_ndx) {
+            if (busy[thread_ndx]++ != 0)
+                overlap = true;
+            if (task_ndx % 97 == 0)
+                millisleep(1);
+            ++counts[task_ndx];
+            --busy[thread_ndx];
+        });
+        CHECK(!overlap);
+        for (size_t i = 0; i < num_tasks; ++i)
+            CHECK_EQUAL(1, counts[i]);
+    }
+
+    // Nested loops are executed on the calling thread
+    std::atomic<int> nested(0);
+    pool.run(8, [&](size_t, size_t) {
+        pool.run(4, [&](size_t, size_t thread_ndx) {
+            if (thread_ndx == 0)
+                ++nested;
+        });
+    });
+    CHECK_EQUAL(32, nested.load());
+
+    // The first exception is propagated, and the pool remains usable
+    CHECK_THROW(pool.run(100, [](size_t task_ndx, size_t) {
+                    if (task_ndx == 50)
+                        throw std::runtime_error("task failed");
+                }),
+                std::runtime_error);
+    std::atomic<int> num_executed(0);
+    pool.run(100, [&](size_t, size_t) { ++num_executed; });
+    CHECK_EQUAL(100, num_executed.load());
+}
+
+
 #ifndef _WIN32 // interprocess condvars not suported in Windows yet
 
 // Detect and flag trivial implementations of condvars.
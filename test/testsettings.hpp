@@ -53,8 +53,15 @@
 #define TEST_FILE
 #define TEST_FILE_LOCKS
 #define TEST_GROUP
+#define TEST_GROUP_BY
 #define TEST_INDEX_STRING
+#define TEST_INDEX_HASH
+#define TEST_INDEX_ORDERED
+#define TEST_INDEX_TRIGRAM
+#define TEST_INDEX_FULLTEXT
+#define TEST_INDEX_CASE_FOLD
 #define TEST_LANG_BIND_HELPER
+#define TEST_MATERIALIZED_AGGREGATE
 #define TEST_QUERY
 #define TEST_SHARED
 #define TEST_STRING_DATA
@@ -66,6 +73,7 @@
 #define TEST_TRANSACTIONS
 #define TEST_TRANSACTIONS_LASSE
 #define TEST_REPLICATION
+#define TEST_ROW_BITMAP
 #define TEST_UTF8
 #define TEST_COLUMN_LARGE
 #define TEST_JSON